@@ -95,4 +95,5 @@ except ImportError:
     from . import rfcnt
 # For backward compatibility supporting rfcnt.rfc() and rfcnt.rfcnt.rfc()
 rfc = rfcnt.rfc
+rfc_batch = rfcnt.rfc_batch
 from . import tests, utils  # noqa F402
@@ -16,3 +16,20 @@ def rfc(data: ArrayLike,
         enforce_margin: Optional[Union[int, bool]] = 0,
         auto_resize: Optional[Union[int, bool]] = 0,
         wl: Optional[dict] = None) -> tuple: ...
+
+
+def rfc_batch(data: Union[ArrayLike, list],
+              class_count: Optional[int] = 100,
+              class_width: Optional[float] = None,
+              class_offset: Optional[float] = None,
+              hysteresis: Optional[float] = None,
+              residual_method: Optional[Union[int, ResidualMethod]] = ResidualMethod.REPEATED,
+              spread_damage: Optional[Union[int, SDMethod]] = SDMethod.NONE,
+              lc_method: Optional[Union[int, LCMethod]] = LCMethod.SLOPES_UP,
+              use_HCM: Optional[Union[int, bool]] = 0,
+              use_ASTM: Optional[Union[int, bool]] = 0,
+              enforce_margin: Optional[Union[int, bool]] = 0,
+              auto_resize: Optional[Union[int, bool]] = 0,
+              wl: Optional[dict] = None,
+              n_threads: Optional[int] = 0,
+              rfm: Optional[bool] = True) -> dict: ...
@@ -1,4 +1,5 @@
 from os import path
+import platform
 from setuptools import setup, Extension
 
 version = (0, 4, 7, "pre")
@@ -35,6 +36,7 @@ def main():
         ('RFC_DH_SUPPORT',            '1'),
         ('RFC_AT_SUPPORT',            '1'),
         ('RFC_AR_SUPPORT',            '1'),
+        ('RFC_USE_THREADS',           '1'),
         ('RFC_DEBUG_FLAGS',           '0'),
         ('RFC_EXPORT_MEX',            '0')]
 
@@ -65,6 +67,7 @@ def main():
                 define_macros=define_macros,
                 include_dirs=['src', np_get_include()],
                 extra_compile_args=['-std=c++11'],
+                extra_link_args=[] if platform.system() == "Windows" else ['-pthread'],
             )
         ],
         classifiers=[
@@ -103,6 +103,10 @@
 #endif /*COAN_INVOKED*/
 
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L  /* ftruncate() with strict ISO C */
+#endif
+
 #include "rainflow.h"
 
 #include <assert.h>  /* assert() */
@@ -110,6 +114,24 @@
 #include <stdlib.h>  /* calloc(), free(), abs() */
 #include <string.h>  /* memset() */
 #include <float.h>   /* DBL_MAX */
+#if RFC_USE_THREADS
+#if defined(_WIN32)
+#include <windows.h> /* CreateThread(), CRITICAL_SECTION */
+#else /*!_WIN32*/
+#include <pthread.h> /* pthread_create(), pthread_mutex_t */
+#include <sched.h>   /* sched_yield() */
+#include <unistd.h>  /* sysconf() */
+#endif /*_WIN32*/
+#endif /*RFC_USE_THREADS*/
+#if RFC_TP_SUPPORT || RFC_DH_SUPPORT
+#if defined(_WIN32)
+#include <windows.h>    /* CreateFileMapping(), MapViewOfFile() */
+#else /*!_WIN32*/
+#include <fcntl.h>      /* open() */
+#include <sys/mman.h>   /* mmap(), munmap() */
+#include <unistd.h>     /* ftruncate(), sysconf(), close() */
+#endif /*_WIN32*/
+#endif /*RFC_TP_SUPPORT || RFC_DH_SUPPORT*/
 
 #ifndef CALLOC
 #define CALLOC calloc
@@ -120,6 +142,24 @@
 #ifndef FREE
 #define FREE free
 #endif
+#ifndef RFC_FEED_BLOCK_SIZE
+#define RFC_FEED_BLOCK_SIZE (16)  /* Samples per block, scanned at once by the turning point pre-filter */
+#endif
+#ifndef RFC_FEED_CONVERT_SIZE
+#define RFC_FEED_CONVERT_SIZE (256)  /* Samples per chunk, converted at once by typed feeds (RFC_feed_f32() etc.) */
+#endif
+#ifndef RFC_BATCH_THREADS_MAX
+#define RFC_BATCH_THREADS_MAX (64)  /* Maximum number of workers in RFC_batch() */
+#endif
+#ifndef RFC_BATCH_CHUNK_MAX
+#define RFC_BATCH_CHUNK_MAX (64)  /* Maximum number of series, claimed at once by a worker in RFC_batch() */
+#endif
+#ifndef RFC_DAMAGE_LUT_PARALLEL_MIN
+#define RFC_DAMAGE_LUT_PARALLEL_MIN (128)  /* Minimum class count to fill a 2D damage look-up table by several workers */
+#endif
+#ifndef RFC_DAMAGE_LUT_PAGE_DIM
+#define RFC_DAMAGE_LUT_PAGE_DIM (64)  /* Rows and columns per page of a paged 2D damage look-up table */
+#endif
 
 
 
@@ -173,6 +213,25 @@ static void                 cycle_find                      (       rfc_ctx_s *,
 #else /*RFC_MINIMAL*/
 #define cycle_find          cycle_find_4ptm
 #endif /*!RFC_MINIMAL*/
+static bool                 feed_values                     (       rfc_ctx_s *, const rfc_value_t *data, size_t data_count );
+#if !RFC_MINIMAL
+static bool                 feed_converted                  (       rfc_ctx_s *, const void *data, int data_type, size_t data_count, size_t stride, double scale, double offset );
+static bool                 bank_load                       (       rfc_bank_s *, size_t channel );
+static void                 bank_sync                       (       rfc_bank_s *, size_t channel, size_t pos, const rfc_value_t *last );
+struct batch_job;
+static unsigned             batch_thread_count              ( unsigned thread_count );
+static bool                 batch_claim                     (       struct batch_job *, size_t *first, size_t *last );
+static void                 batch_worker                    (       struct batch_job * );
+static bool                 snapshot_begin                  (       rfc_ctx_s * );
+static void                 snapshot_end                    (       rfc_ctx_s *, bool opened );
+struct checkpoint;
+static bool                 checkpoint_field                (       struct checkpoint *, void *field, size_t size );
+static bool                 checkpoint_check                (       struct checkpoint *, const void *value, size_t size );
+static bool                 checkpoint_xfer                 (       struct checkpoint *, rfc_ctx_s * );
+#else /*RFC_MINIMAL*/
+#define snapshot_begin( ctx )           false
+#define snapshot_end( ctx, opened )     ( (void)(opened) )
+#endif /*!RFC_MINIMAL*/
 static bool                 feed_once                       (       rfc_ctx_s *, const rfc_value_tuple_s* tp, rfc_flags_e flags );
 #if RFC_DH_SUPPORT
 static bool                 feed_once_dh                    (       rfc_ctx_s *, const rfc_value_tuple_s* pt );
@@ -188,6 +247,8 @@ static bool                 feed_finalize_tp                (       rfc_ctx_s *,
 static bool                 feed_finalize_hcm               (       rfc_ctx_s *, rfc_flags_e flags );
 #endif /*!RFC_HCM_SUPPORT*/
 static rfc_value_tuple_s *  feed_filter_pt                  (       rfc_ctx_s *, const rfc_value_tuple_s *pt );
+static bool                 feed_filter_block_apt           (       rfc_ctx_s * );
+static size_t               feed_filter_block               (       rfc_ctx_s *, const rfc_value_t *data, size_t data_count );
 static void                 cycle_find_4ptm                 (       rfc_ctx_s *, rfc_flags_e flags );
 #if RFC_HCM_SUPPORT
 static void                 cycle_find_hcm                  (       rfc_ctx_s *, rfc_flags_e flags );
@@ -197,8 +258,11 @@ static void                 cycle_find_astm                 (       rfc_ctx_s *,
 #endif /*RFC_ASTM_SUPPORT*/
 #if !RFC_MINIMAL
 static void                 cycle_process_lc                (       rfc_ctx_s *, rfc_flags_e flags );
+static void                 lc_flush                        (       rfc_ctx_s * );
 #endif /*!RFC_MINIMAL*/
 static void                 cycle_process_counts            (       rfc_ctx_s *, rfc_value_tuple_s *from, rfc_value_tuple_s *to, rfc_value_tuple_s *next, rfc_flags_e flags );
+static void                 cycle_process_counts_weighted   (       rfc_ctx_s *, rfc_value_tuple_s *from, rfc_value_tuple_s *to, rfc_value_tuple_s *next, rfc_flags_e flags, rfc_counts_t cycles );
+static void                 counts_bind                     (       rfc_ctx_s * );
 /* Methods on residue */
 static bool                 finalize_res_ignore             (       rfc_ctx_s *, rfc_flags_e flags );
 static bool                 finalize_res_no_finalize        (       rfc_ctx_s *, rfc_flags_e flags );
@@ -211,8 +275,30 @@ static bool                 finalize_res_repeated           (       rfc_ctx_s *,
 static bool                 residue_exchange                (       rfc_ctx_s *, rfc_value_tuple_s **residue, size_t *residue_cap, size_t *residue_cnt, bool restore );
 #endif /*!RFC_MINIMAL*/
 static void                 residue_remove_item             (       rfc_ctx_s *, size_t index, size_t count );
+static void                 residue_mirror_drop             (       rfc_ctx_s *, size_t index );
 /* Memory allocator */
 static void *               mem_alloc                       ( void *ptr, size_t num, size_t size, int aim );
+#if !RFC_MINIMAL
+/* Sparse rainflow matrix */
+static bool                 rfm_sparse_init                 (       rfc_ctx_s * );
+static void                 rfm_sparse_free                 (       rfc_ctx_s * );
+static void                 rfm_sparse_clear                (       rfc_ctx_s * );
+static bool                 rfm_sparse_rehash               (       rfc_ctx_s *, unsigned slots_count );
+static rfc_counts_t *       rfm_sparse_find                 (       rfc_ctx_s *, unsigned from, unsigned to, bool create );
+static void                 rfm_sparse_expand               ( const rfc_rfm_sparse_s *, rfc_counts_t *rfm, unsigned class_count );
+/* Summed-area tables of the rainflow matrix */
+static bool                 rfm_sat_update                  (       rfc_ctx_s *, unsigned rows, bool damage );
+static void                 rfm_sat_free                    (       rfc_ctx_s * );
+#if RFC_AR_SUPPORT
+static bool                 rfm_sparse_resize               (       rfc_ctx_s *, unsigned class_count_old, unsigned class_count, unsigned class_shift );
+#endif /*RFC_AR_SUPPORT*/
+#endif /*!RFC_MINIMAL*/
+#if RFC_TP_SUPPORT || RFC_DH_SUPPORT
+struct rfc_map;
+static struct rfc_map *     map_open                        (       rfc_ctx_s *, const char *filename, int aim );
+static bool                 map_resize                      (       struct rfc_map *, size_t bytes );
+static void                 map_close                       (       rfc_ctx_s *, struct rfc_map *, size_t bytes_keep, int aim );
+#endif /*RFC_TP_SUPPORT || RFC_DH_SUPPORT*/
 #if RFC_TP_SUPPORT
 /* Methods on turning points history */
 static bool                 tp_set                          (       rfc_ctx_s *, size_t tp_pos, rfc_value_tuple_s *pt );
@@ -232,21 +318,45 @@ static bool                 at_alleviation                  (       rfc_ctx_s *,
 /* Other */
 static bool                 damage_calc_amplitude           (       rfc_ctx_s *, double Sa, double *damage );
 static bool                 damage_calc                     (       rfc_ctx_s *, unsigned class_from, unsigned class_to, double *damage, double *Sa_ret );
+#if !RFC_MINIMAL
+static void                 mk_init                         (       rfc_ctx_s * );
+static void                 mk_count                        (       rfc_ctx_s *, double Sa, double D_unimp );
+static void                 mk_flush                        (       rfc_ctx_s * );
+static void                 mk_flushed                      ( const rfc_ctx_s *, rfc_wl_param_s *wl );
+static double               damage_multi_calc               ( const rfc_wl_param_s *, double Sa );
+static bool                 damage_multi_lut_init           (       rfc_ctx_s * );
+static void                 damage_multi_add                (       rfc_ctx_s *, unsigned class_from, unsigned class_to, double weight );
+static void                 damage_multi_free               (       rfc_ctx_s * );
+#endif /*!RFC_MINIMAL*/
 #if RFC_DAMAGE_FAST
+static void                 damage_calc_amplitudes          ( const rfc_ctx_s *, const double *Sa, double *damage, size_t count );
+struct damage_lut_job;
+static void                 damage_lut_rows                 (       struct damage_lut_job * );
+static bool                 damage_lut_own                  (       rfc_ctx_s * );
 static bool                 damage_lut_init                 (       rfc_ctx_s * );
+static const double *       damage_lut_page                 (       rfc_ctx_s *, unsigned class_from, unsigned class_to );
+static void                 damage_lut_pages_free           (       rfc_ctx_s * );
 static bool                 damage_calc_fast                (       rfc_ctx_s *, unsigned class_from, unsigned class_to, double *damage, double *Sa_ret );
 #endif /*RFC_DAMAGE_FAST*/
 static bool                 error_raise                     (       rfc_ctx_s *, rfc_error_e );
 static rfc_value_t          value_delta                     (       rfc_ctx_s *, const rfc_value_tuple_s* pt_from, const rfc_value_tuple_s* pt_to, int *sign_ptr );
+static size_t               quantize_block                  (       rfc_ctx_s *, const rfc_value_t *data, size_t count, unsigned *cls );
 
 
 #define QUANTIZE( r, v )    ( (r)->class_count ? (unsigned)( ((v) - (r)->class_offset) / (r)->class_width ) : 0 )
+#define QUANTIZE_EPS        ( 8.0 * ( sizeof(rfc_value_t) < sizeof(double) ? FLT_EPSILON : DBL_EPSILON ) )
 #define AMPLITUDE( r, i )   ( (r)->class_count ? ( (double)(r)->class_width * (i) / 2 ) : 0.0 )
 #define CLASS_MEAN( r, c )  ( (r)->class_count ? ( (double)(r)->class_width * (0.5 + (c)) + (r)->class_offset ) : 0.0 )
 #define CLASS_UPPER( r, c ) ( (r)->class_count ? ( (double)(r)->class_width * (1.0 + (c)) + (r)->class_offset ) : 0.0 )
 #define NUMEL( x )          ( sizeof(x) / sizeof(*(x)) )
 #define MAT_OFFS( i, j )    ( (i) * class_count + (j) )
 
+/* Data types of typed feeds (feed_converted()) */
+#define FEED_DATA_TYPE_VAL  0
+#define FEED_DATA_TYPE_F32  1
+#define FEED_DATA_TYPE_I16  2
+#define FEED_DATA_TYPE_I32  3
+
 #define RFC_CTX_CHECK_AND_ASSIGN                                                    \
     rfc_ctx_s *rfc_ctx = (rfc_ctx_s*)ctx;                                           \
                                                                                     \
@@ -255,6 +365,51 @@ static rfc_value_t          value_delta                     (       rfc_ctx_s *,
         return error_raise( rfc_ctx, RFC_ERROR_INVARG );                            \
     }                                                                               \
 
+#define RFC_BANK_CHECK_AND_ASSIGN                                                   \
+    rfc_bank_s *rfc_bank = (rfc_bank_s*)bank;                                       \
+                                                                                    \
+    if( !rfc_bank || rfc_bank->version != sizeof(rfc_bank_s) )                      \
+    {                                                                               \
+        return false;                                                               \
+    }                                                                               \
+
+#if !RFC_MINIMAL
+/* Sparse rainflow matrix (RFC_FLAGS_SPARSE_RFM) */
+struct rfc_rfm_sparse
+{
+    rfc_rfm_item_s                     *items;                      /**< Elements counted so far, in order of appearance (counts may have dropped to zero) */
+    unsigned                           *next;                       /**< Next element in the same row (ascending .to), base 1, 0 terminates */
+    unsigned                            count;                      /**< Number of elements */
+    unsigned                            cap;                        /**< Capacity of items and next */
+    unsigned                           *row;                        /**< First element per row (class_count entries), base 1, 0 if row is empty */
+    unsigned                           *slots;                      /**< Hash table (open addressing, linear probing), element index base 1, 0 if empty */
+    unsigned                            slots_mask;                 /**< Number of slots - 1 (power of 2, at least twice the capacity) */
+};
+
+#define RFM_SPARSE_CAP_MIN  (64)
+#define RFM_SPARSE_HASH( from, to ) \
+    ( (unsigned)( (unsigned long)(from) * 0x9E3779B1UL ) ^ (unsigned)( (unsigned long)(to) * 0x85EBCA77UL ) )
+
+/* Summed-area tables of the rainflow matrix stay valid for rows preceding a changed row */
+#define RFM_SAT_INVALIDATE( r, row )                                                \
+    do                                                                              \
+    {                                                                               \
+        if( (r)->internal.rfm_sat.rows > (row) )                                    \
+        {                                                                           \
+            (r)->internal.rfm_sat.rows = (row);                                     \
+            if( (r)->internal.rfm_sat.damage_rows > (row) )                         \
+            {                                                                       \
+                (r)->internal.rfm_sat.damage_rows = (row);                          \
+            }                                                                       \
+        }                                                                           \
+    } while(0)
+/* Damages per element have changed (Woehler curve, classes, amplitude transformation) */
+#define RFM_SAT_INVALIDATE_DAMAGE( r )  ( (r)->internal.rfm_sat.damage_rows = 0 )
+#else /*RFC_MINIMAL*/
+#define RFM_SAT_INVALIDATE( r, row )    ( (void)0 )
+#define RFM_SAT_INVALIDATE_DAMAGE( r )  ( (void)0 )
+#endif /*!RFC_MINIMAL*/
+
 
 
 #if !RFC_TP_SUPPORT
@@ -312,6 +467,13 @@ bool RFC_init( void *ctx, unsigned class_count, rfc_value_t class_width, rfc_val
                                               RFC_FLAGS_COUNT_DAMAGE;
 #endif /*!RFC_MINIMAL*/
     }
+#if !RFC_MINIMAL
+    if( class_count > RFC_CLASS_COUNT_DENSE_MAX )
+    {
+        /* Too large for a dense matrix, storage grows with the non-zero elements instead */
+        flags = (rfc_flags_e)( flags | RFC_FLAGS_SPARSE_RFM );
+    }
+#endif /*!RFC_MINIMAL*/
     rfc_ctx->internal.flags                 = flags;
 
 #if RFC_DEBUG_FLAGS
@@ -329,7 +491,11 @@ bool RFC_init( void *ctx, unsigned class_count, rfc_value_t class_width, rfc_val
 
     if( class_count )
     {
+#if RFC_MINIMAL
+        if( class_count > RFC_CLASS_COUNT_DENSE_MAX || class_width <= 0.0 )
+#else /*!RFC_MINIMAL*/
         if( class_count > RFC_CLASS_COUNT_MAX || class_width <= 0.0 )
+#endif /*RFC_MINIMAL*/
         {
             return error_raise( rfc_ctx, RFC_ERROR_INVARG );
         }
@@ -345,6 +511,7 @@ bool RFC_init( void *ctx, unsigned class_count, rfc_value_t class_width, rfc_val
     rfc_ctx->class_width                    = class_width;
     rfc_ctx->class_offset                   = class_offset;
     rfc_ctx->hysteresis                     = hysteresis;
+    rfc_ctx->internal.class_rcp             = 1.0 / class_width;
 
     /* Values for a "pseudo Woehler curve" */
     rfc_ctx->state = RFC_STATE_INIT;   /* Bypass sanity check for state in wl_init() */
@@ -384,25 +551,39 @@ bool RFC_init( void *ctx, unsigned class_count, rfc_value_t class_width, rfc_val
     {
         rfc_ctx->residue_cap                = rfc_ctx->internal.residue_cap; /* At least 3 elements are needed (two to define a slope and one as interim point) */
         rfc_ctx->residue                    = rfc_ctx->internal.residue;
+        rfc_ctx->internal.res               = rfc_ctx->internal.res_buf;
         rfc_ctx->internal.res_static        = true;
     }
     else
     {
         rfc_ctx->residue                    = (rfc_value_tuple_s*)rfc_ctx->mem_alloc( NULL, rfc_ctx->residue_cap, 
                                                                                       sizeof(rfc_value_tuple_s), RFC_MEM_AIM_RESIDUE );
+        rfc_ctx->internal.res               = (rfc_res_item_s*)rfc_ctx->mem_alloc( NULL, rfc_ctx->residue_cap, 
+                                                                                   sizeof(rfc_res_item_s), RFC_MEM_AIM_RESIDUE );
         rfc_ctx->internal.res_static        = false;
     }
+    rfc_ctx->internal.res_cnt               = 0;
 
     if( rfc_ctx->class_count )
     {
-        int ok = rfc_ctx->residue != NULL;
+        int ok = rfc_ctx->residue != NULL && rfc_ctx->internal.res != NULL;
 
         if( ok && ( flags & RFC_FLAGS_COUNT_RFM ) )
         {
-            /* Non-sparse storages (optional, may be NULL) */
-            rfc_ctx->rfm                    = (rfc_counts_t*)rfc_ctx->mem_alloc( NULL, class_count * class_count, 
+#if !RFC_MINIMAL
+            if( flags & RFC_FLAGS_SPARSE_RFM )
+            {
+                /* Sparse storage, grows with the number of non-zero elements */
+                if( !rfm_sparse_init( rfc_ctx ) ) ok = false;
+            }
+            else
+#endif /*!RFC_MINIMAL*/
+            {
+                /* Non-sparse storages (optional, may be NULL) */
+                rfc_ctx->rfm                = (rfc_counts_t*)rfc_ctx->mem_alloc( NULL, class_count * class_count, 
                                                                                  sizeof(rfc_counts_t), RFC_MEM_AIM_MATRIX );
-            if( !rfc_ctx->rfm ) ok = false;
+                if( !rfc_ctx->rfm ) ok = false;
+            }
         }
 #if !RFC_MINIMAL
         if( ok && ( flags & RFC_FLAGS_COUNT_RP ) )
@@ -416,7 +597,10 @@ bool RFC_init( void *ctx, unsigned class_count, rfc_value_t class_width, rfc_val
         {
             rfc_ctx->lc                     = (rfc_counts_t*)rfc_ctx->mem_alloc( NULL, class_count,
                                                                                  sizeof(rfc_counts_t), RFC_MEM_AIM_LC );
-            if( !rfc_ctx->lc ) ok = false;
+            rfc_ctx->internal.lc_diff       = (rfc_counts_t*)rfc_ctx->mem_alloc( NULL, class_count,
+                                                                                 sizeof(rfc_counts_t), RFC_MEM_AIM_LC );
+            rfc_ctx->internal.lc_dirty      = false;
+            if( !rfc_ctx->lc || !rfc_ctx->internal.lc_diff ) ok = false;
         }
 #endif /*!RFC_MINIMAL*/
         if( !ok )
@@ -438,9 +622,22 @@ bool RFC_init( void *ctx, unsigned class_count, rfc_value_t class_width, rfc_val
     rfc_ctx->internal.extrema_changed       = false;
 #endif /*RFC_GLOBAL_EXTREMA*/
 #if !RFC_MINIMAL
+    rfc_ctx->damage_multi_count             = 0;
+    rfc_ctx->damage_multi_wl                = NULL;
+    rfc_ctx->damage_multi                   = NULL;
+    rfc_ctx->damage_multi_lut               = NULL;
+    rfc_ctx->damage_multi_lut_classes       = 0;
+    rfc_ctx->damage_multi_lut_width         = 0.0;
+    rfc_ctx->internal.rfm_sat.enabled       = false;
+    rfc_ctx->internal.rfm_sat.counts        = NULL;
+    rfc_ctx->internal.rfm_sat.damage        = NULL;
+    rfc_ctx->internal.rfm_sat.rows          = 0;
+    rfc_ctx->internal.rfm_sat.damage_rows   = 0;
     /* Make a shadow copy of the Woehler curve parameters */
     rfc_ctx->state = RFC_STATE_INIT;   /* Bypass sanity check for state in wl_init() */
     RFC_wl_param_get( rfc_ctx, &rfc_ctx->internal.wl );
+    rfc_ctx->internal.mk.valid   = false;
+    rfc_ctx->internal.mk.pending = false;
     rfc_ctx->state = RFC_STATE_INIT0;  /* Reset state */
 #endif /*!RFC_MINIMAL*/
 #if RFC_TP_SUPPORT
@@ -454,6 +651,7 @@ bool RFC_init( void *ctx, unsigned class_count, rfc_value_t class_width, rfc_val
     rfc_ctx->tp_locked                      = 0;
     rfc_ctx->tp_prune_threshold             = (size_t)-1;
     rfc_ctx->tp_prune_size                  = (size_t)-1;
+    rfc_ctx->internal.tp_map                = NULL;
 #endif /*RFC_TP_SUPPORT*/
 
 
@@ -484,14 +682,21 @@ bool RFC_init( void *ctx, unsigned class_count, rfc_value_t class_width, rfc_val
 
     rfc_ctx->state = RFC_STATE_INIT;
 
+    /* Counting kernel according to flags */
+    counts_bind( rfc_ctx );
+
 #if RFC_DAMAGE_FAST
     if( rfc_ctx->class_count )
     {
-        rfc_ctx->damage_lut                 = (double*)rfc_ctx->mem_alloc( rfc_ctx->damage_lut,    class_count * class_count, 
+        /* Damage depends on range only, unless amplitude transformation is set up (damage_lut_init() widens to 2D then) */
+        rfc_ctx->damage_lut                 = (double*)rfc_ctx->mem_alloc( rfc_ctx->damage_lut,    class_count, 
                                                                            sizeof(double), RFC_MEM_AIM_DLUT );
         rfc_ctx->damage_lut_inapt           = 1;
+        rfc_ctx->damage_lut_size            = class_count;
+        rfc_ctx->damage_lut_stride          = 0;
+        rfc_ctx->lut                        = NULL;
 #if RFC_AT_SUPPORT
-        rfc_ctx->amplitude_lut              = (double*)rfc_ctx->mem_alloc( rfc_ctx->amplitude_lut, class_count * class_count, 
+        rfc_ctx->amplitude_lut              = (double*)rfc_ctx->mem_alloc( rfc_ctx->amplitude_lut, class_count, 
                                                                            sizeof(double), RFC_MEM_AIM_ALUT );
 #endif /*RFC_AT_SUPPORT*/
         return damage_lut_init( rfc_ctx );
@@ -562,6 +767,7 @@ bool RFC_wl_init_elementary( void *ctx, double sx, double nx, double k )
         rfc_ctx->damage_lut_inapt++;
     }
 #endif /*RFC_DAMAGE_FAST*/
+    RFM_SAT_INVALIDATE_DAMAGE( rfc_ctx );
 
 /* Woehler curve */
     rfc_ctx->wl_sx        =  sx;
@@ -577,6 +783,8 @@ bool RFC_wl_init_elementary( void *ctx, double sx, double nx, double k )
 
     /* Make a shadow copy of the Woehler parameters */
     RFC_wl_param_get( rfc_ctx, &rfc_ctx->internal.wl );
+    rfc_ctx->internal.mk.valid   = false;
+    rfc_ctx->internal.mk.pending = false;
 #endif /*!RFC_MINIMAL*/
 
 #if RFC_DAMAGE_FAST
@@ -616,6 +824,7 @@ bool RFC_wl_init_original( void *ctx, double sd, double nd, double k )
         rfc_ctx->damage_lut_inapt++;
     }
 #endif /*RFC_DAMAGE_FAST*/
+    RFM_SAT_INVALIDATE_DAMAGE( rfc_ctx );
 
 /* Woehler curve */
     rfc_ctx->wl_sd = sd;             /* Points sx/nx and sd/nd coincide */
@@ -623,6 +832,8 @@ bool RFC_wl_init_original( void *ctx, double sd, double nd, double k )
 
     /* Make a shadow copy of the Woehler parameters */
     RFC_wl_param_get( rfc_ctx, &rfc_ctx->internal.wl );
+    rfc_ctx->internal.mk.valid   = false;
+    rfc_ctx->internal.mk.pending = false;
 
 #if RFC_DAMAGE_FAST
     if( rfc_ctx->damage_lut )
@@ -661,6 +872,7 @@ bool RFC_wl_init_modified( void *ctx, double sx, double nx, double k, double k2
         rfc_ctx->damage_lut_inapt++;
     }
 #endif /*RFC_DAMAGE_FAST*/
+    RFM_SAT_INVALIDATE_DAMAGE( rfc_ctx );
 
     /* Woehler curve */
     /* wl_sd, wl_omission remain zero, as initialized by RFC_wl_init_elementary()! */
@@ -669,6 +881,8 @@ bool RFC_wl_init_modified( void *ctx, double sx, double nx, double k, double k2
 
     /* Make a shadow copy of the Woehler parameters */
     RFC_wl_param_get( rfc_ctx, &rfc_ctx->internal.wl );
+    rfc_ctx->internal.mk.valid   = false;
+    rfc_ctx->internal.mk.pending = false;
 
 #if RFC_DAMAGE_FAST
     if( rfc_ctx->damage_lut )
@@ -704,6 +918,7 @@ bool RFC_wl_init_any( void *ctx, const rfc_wl_param_s* wl_param )
         rfc_ctx->damage_lut_inapt++;
     }
 #endif /*RFC_DAMAGE_FAST*/
+    RFM_SAT_INVALIDATE_DAMAGE( rfc_ctx );
 
 /* Woehler curve */
     rfc_ctx->wl_sd       =  wl_param->sd;
@@ -714,6 +929,8 @@ bool RFC_wl_init_any( void *ctx, const rfc_wl_param_s* wl_param )
 
     /* Make a shadow copy of the Woehler parameters */
     RFC_wl_param_get( rfc_ctx, &rfc_ctx->internal.wl );
+    rfc_ctx->internal.mk.valid   = false;
+    rfc_ctx->internal.mk.pending = false;
 
 #if RFC_DAMAGE_FAST
     if( rfc_ctx->damage_lut )
@@ -727,6 +944,186 @@ bool RFC_wl_init_any( void *ctx, const rfc_wl_param_s* wl_param )
 #endif /*!RFC_MINIMAL*/
 
 
+#if RFC_TP_SUPPORT || RFC_DH_SUPPORT
+/* File mapping, backing turning point storage or damage history */
+struct rfc_map
+{
+#if defined(_WIN32)
+    HANDLE                              file;                       /**< File handle */
+    HANDLE                              mapping;                    /**< File mapping handle */
+#else /*!_WIN32*/
+    int                                 fd;                         /**< File descriptor */
+#endif /*_WIN32*/
+    size_t                              page_size;                  /**< Granularity of growth in bytes */
+    size_t                              bytes;                      /**< Mapped size in bytes */
+    void                               *ptr;                        /**< Mapped memory */
+};
+
+
+/**
+ * @brief      Create (or truncate) a file to be mapped into memory.
+ *
+ * @param      rfc_ctx   The rainflow context
+ * @param[in]  filename  The file name
+ * @param      aim       The memory allocation aim (RFC_MEM_AIM_...)
+ *
+ * @return     The file mapping (nothing mapped yet), NULL on failure
+ */
+static
+struct rfc_map *map_open( rfc_ctx_s *rfc_ctx, const char *filename, int aim )
+{
+    struct rfc_map *map = (struct rfc_map*)rfc_ctx->mem_alloc( NULL, 1, sizeof(struct rfc_map), aim );
+
+    if( !map )
+    {
+        return NULL;
+    }
+
+#if defined(_WIN32)
+    do
+    {
+        SYSTEM_INFO info;
+
+        GetSystemInfo( &info );
+        map->page_size = info.dwAllocationGranularity;
+        map->mapping   = NULL;
+        map->file      = CreateFileA( filename, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+    } while(0);
+
+    if( map->file == INVALID_HANDLE_VALUE )
+#else /*!_WIN32*/
+    map->page_size = (size_t)sysconf( _SC_PAGESIZE );
+    map->fd        = open( filename, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+
+    if( map->fd < 0 )
+#endif /*_WIN32*/
+    {
+        rfc_ctx->mem_alloc( map, 0, 0, aim );
+        return NULL;
+    }
+
+    return map;
+}
+
+
+/**
+ * @brief      Grow a file mapping. The file is extended to a multiple of
+ *             the page size and mapped again, the old mapping is released
+ *             after the new one is established. Contents are kept, the
+ *             extension reads as zero and occupies neither memory nor disk
+ *             space until written (sparse file).
+ *
+ * @param      map    The file mapping
+ * @param      bytes  The new size in bytes (at least)
+ *
+ * @return     true on success
+ */
+static
+bool map_resize( struct rfc_map *map, size_t bytes )
+{
+    void *ptr;
+
+    assert( map );
+
+    bytes = ( bytes + map->page_size - 1 ) / map->page_size * map->page_size;
+
+#if defined(_WIN32)
+    do
+    {
+        HANDLE mapping = CreateFileMappingA( map->file, NULL, PAGE_READWRITE, 
+                                             (DWORD)( (unsigned long long)bytes >> 32 ), (DWORD)bytes, NULL );
+
+        if( !mapping )
+        {
+            return false;
+        }
+
+        ptr = MapViewOfFile( mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes );
+
+        if( !ptr )
+        {
+            CloseHandle( mapping );
+            return false;
+        }
+
+        if( map->ptr )
+        {
+            UnmapViewOfFile( map->ptr );
+            CloseHandle( map->mapping );
+        }
+        map->mapping = mapping;
+    } while(0);
+#else /*!_WIN32*/
+    if( ftruncate( map->fd, (off_t)bytes ) != 0 )
+    {
+        return false;
+    }
+
+    ptr = mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, map->fd, 0 );
+
+    if( ptr == MAP_FAILED )
+    {
+        return false;
+    }
+
+    if( map->ptr )
+    {
+        munmap( map->ptr, map->bytes );
+    }
+#endif /*_WIN32*/
+
+    map->bytes = bytes;
+    map->ptr   = ptr;
+
+    return true;
+}
+
+
+/**
+ * @brief      Release a file mapping. The file is truncated to the bytes
+ *             in use and closed.
+ *
+ * @param      rfc_ctx     The rainflow context
+ * @param      map         The file mapping
+ * @param      bytes_keep  The size of the file in bytes
+ * @param      aim         The memory allocation aim (RFC_MEM_AIM_...)
+ */
+static
+void map_close( rfc_ctx_s *rfc_ctx, struct rfc_map *map, size_t bytes_keep, int aim )
+{
+    assert( map );
+
+#if defined(_WIN32)
+    if( map->ptr )
+    {
+        UnmapViewOfFile( map->ptr );
+        CloseHandle( map->mapping );
+    }
+    do
+    {
+        LARGE_INTEGER size;
+
+        size.QuadPart = (LONGLONG)bytes_keep;
+        if( SetFilePointerEx( map->file, size, NULL, FILE_BEGIN ) )
+        {
+            SetEndOfFile( map->file );
+        }
+    } while(0);
+    CloseHandle( map->file );
+#else /*!_WIN32*/
+    if( map->ptr )
+    {
+        munmap( map->ptr, map->bytes );
+    }
+    (void)!ftruncate( map->fd, (off_t)bytes_keep );
+    close( map->fd );
+#endif /*_WIN32*/
+
+    rfc_ctx->mem_alloc( map, 0, 0, aim );
+}
+#endif /*RFC_TP_SUPPORT || RFC_DH_SUPPORT*/
+
+
 #if RFC_TP_SUPPORT
 /**
  * @brief      Initialize tp buffer
@@ -772,6 +1169,59 @@ bool RFC_tp_init( void *ctx, rfc_value_tuple_s *tp, size_t tp_cap, bool is_stati
 }
 
 
+/**
+ * @brief      Initialize a file backed tp buffer. The file is mapped into
+ *             memory and grows page-wise as turning points are appended, so
+ *             turning point storage isn't limited by memory and doesn't
+ *             copy on growth. On RFC_deinit() the file is truncated to the
+ *             turning points stored (an array of rfc_value_tuple_s) and
+ *             closed.
+ *
+ * @param      ctx       The rainflow context
+ * @param[in]  filename  The file name (created or truncated)
+ * @param      tp_cap    The initial tp capability
+ *
+ * @return     true on success
+ */
+bool RFC_tp_init_mapped( void *ctx, const char *filename, size_t tp_cap )
+{
+    struct rfc_map *map;
+
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( rfc_ctx->state != RFC_STATE_INIT )
+    {
+        return false;
+    }
+
+    if( rfc_ctx->tp || !filename )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    map = map_open( rfc_ctx, filename, RFC_MEM_AIM_TP );
+
+    if( !map )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_TP );
+    }
+
+    if( !map_resize( map, ( tp_cap ? tp_cap : 1 ) * sizeof(rfc_value_tuple_s) ) )
+    {
+        map_close( rfc_ctx, map, 0, RFC_MEM_AIM_TP );
+        return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+    }
+
+    rfc_ctx->internal.tp_map    = map;
+    rfc_ctx->internal.tp_static = true;  /* Not to be freed by mem_alloc */
+    rfc_ctx->tp                 = (rfc_value_tuple_s*)map->ptr;
+    rfc_ctx->tp_cap             = map->bytes / sizeof(rfc_value_tuple_s);
+    rfc_ctx->tp_cnt             = 0;
+
+    return true;
+}
+
+
 /**
  * @brief      Initialize autoprune parameters
  *
@@ -944,6 +1394,12 @@ bool RFC_tp_prune( void *ctx, size_t limit, rfc_flags_e flags )
         rfc_ctx->internal.pos           -= pos_offset;
         rfc_ctx->internal.pos_offset    += pos_offset;
 
+        if( pos_offset )
+        {
+            /* Positions in residue have changed */
+            residue_mirror_drop( rfc_ctx, 0 );
+        }
+
 #if RFC_DH_SUPPORT
         /* Shift damage history */
         if( rfc_ctx->dh && pos_offset )
@@ -1092,6 +1548,65 @@ bool RFC_dh_init( void *ctx, rfc_sd_method_e method, double *dh, size_t dh_cap,
 }
 
 
+/**
+ * @brief      Initialize a file backed damage history storage. The file is
+ *             mapped into memory and grows page-wise as samples are fed.
+ *             Pages that never receive damage remain holes in a sparse
+ *             file, so they occupy neither memory nor disk space. Random
+ *             access (RFC_dh_get(), spread damage of any method) works as
+ *             with an in-memory buffer. On RFC_deinit() the file is
+ *             truncated to the damage history (an array of double) and
+ *             closed.
+ *
+ * @param      ctx       The rainflow context
+ * @param[in]  method    The mode, how to spread (RFC_SD_...)
+ * @param[in]  filename  The file name (created or truncated)
+ * @param      dh_cap    The initial capacity of dh
+ *
+ * @return     true on success
+ */
+bool RFC_dh_init_mapped( void *ctx, rfc_sd_method_e method, const char *filename, size_t dh_cap )
+{
+    struct rfc_map *map;
+
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( rfc_ctx->state != RFC_STATE_INIT )
+    {
+        return false;
+    }
+
+    if( rfc_ctx->dh || !filename )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    map = map_open( rfc_ctx, filename, RFC_MEM_AIM_DH );
+
+    if( !map )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_DH );
+    }
+
+    if( !map_resize( map, ( dh_cap ? dh_cap : 1 ) * sizeof(double) ) )
+    {
+        map_close( rfc_ctx, map, 0, RFC_MEM_AIM_DH );
+        return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+    }
+
+    rfc_ctx->spread_damage_method = method;
+    rfc_ctx->dh_istream           = (const rfc_value_t*)NULL;
+    rfc_ctx->dh                   = (double*)map->ptr;
+    rfc_ctx->dh_cap               = map->bytes / sizeof(double);
+    rfc_ctx->dh_cnt               = 0;
+
+    rfc_ctx->internal.dh_static   = true;  /* Not to be freed by mem_alloc */
+    rfc_ctx->internal.dh_map      = map;
+
+    return true;
+}
+
+
 /**
  * @brief      Get damage history storage
  *
@@ -1151,6 +1666,8 @@ bool RFC_at_init( void *ctx, const double *Sa, const double *Sm, unsigned count,
         return false;
     }
 
+    RFM_SAT_INVALIDATE_DAMAGE( rfc_ctx );
+
     if( count )
     {
         /* Reference curve given, doing some checks */
@@ -1267,6 +1784,7 @@ bool RFC_at_init( void *ctx, const double *Sa, const double *Sm, unsigned count,
 bool RFC_clear_counts( void *ctx )
 {
     rfc_value_tuple_s  nil     = { 0.0 };  /* All other members are zero-initialized, see ISO/IEC 9899:TC3, 6.7.8 (21) */
+    bool               snapshot;
     RFC_CTX_CHECK_AND_ASSIGN
 
     if( rfc_ctx->state < RFC_STATE_INIT )
@@ -1274,10 +1792,20 @@ bool RFC_clear_counts( void *ctx )
         return false;
     }
 
+    snapshot = snapshot_begin( rfc_ctx );
+
     if( rfc_ctx->rfm )
     {
         memset( rfc_ctx->rfm, 0, sizeof(rfc_counts_t) * rfc_ctx->class_count * rfc_ctx->class_count );
+        RFM_SAT_INVALIDATE( rfc_ctx, 0 );
+    }
+
+#if !RFC_MINIMAL
+    if( rfc_ctx->rfm_sparse )
+    {
+        rfm_sparse_clear( rfc_ctx );
     }
+#endif /*!RFC_MINIMAL*/
 
     if( rfc_ctx->rp )
     {
@@ -1289,7 +1817,21 @@ bool RFC_clear_counts( void *ctx )
         memset( rfc_ctx->lc, 0, sizeof(rfc_counts_t) * rfc_ctx->class_count );
     }
 
+#if !RFC_MINIMAL
+    if( rfc_ctx->internal.lc_diff )
+    {
+        memset( rfc_ctx->internal.lc_diff, 0, sizeof(rfc_counts_t) * rfc_ctx->class_count );
+        rfc_ctx->internal.lc_dirty      = false;
+    }
+
+    if( rfc_ctx->damage_multi )
+    {
+        memset( rfc_ctx->damage_multi, 0, sizeof(double) * rfc_ctx->damage_multi_count );
+    }
+#endif /*!RFC_MINIMAL*/
+
     rfc_ctx->residue_cnt                = 0;
+    rfc_ctx->internal.res_cnt           = 0;
 
     rfc_ctx->internal.slope             = 0;
     rfc_ctx->internal.extrema[0]        = nil;  /* local minimum */
@@ -1303,6 +1845,8 @@ bool RFC_clear_counts( void *ctx )
     rfc_ctx->damage                     = 0.0;
     rfc_ctx->damage_residue             = 0.0;
 
+    snapshot_end( rfc_ctx, snapshot );
+
 #if RFC_HCM_SUPPORT
     /* Reset stack pointers */
     rfc_ctx->internal.hcm.IR            = 1;
@@ -1328,7 +1872,9 @@ bool RFC_clear_counts( void *ctx )
         rfc_wl_param_s wl_param;
         
         RFC_wl_param_get( rfc_ctx, &wl_param );
-        rfc_ctx->internal.wl = wl_param;
+        rfc_ctx->internal.wl         = wl_param;
+        rfc_ctx->internal.mk.valid   = false;
+        rfc_ctx->internal.mk.pending = false;
     } while(0);
 #endif /*!RFC_MINIMAL*/
 
@@ -1362,25 +1908,50 @@ bool RFC_deinit( void *ctx )
 
     if( !rfc_ctx->internal.res_static &&
         rfc_ctx->residue )              rfc_ctx->mem_alloc( rfc_ctx->residue,       0, 0, RFC_MEM_AIM_RESIDUE );
+    if( !rfc_ctx->internal.res_static &&
+        rfc_ctx->internal.res )         rfc_ctx->mem_alloc( rfc_ctx->internal.res,  0, 0, RFC_MEM_AIM_RESIDUE );
     if( rfc_ctx->rfm )                  rfc_ctx->mem_alloc( rfc_ctx->rfm,           0, 0, RFC_MEM_AIM_MATRIX );
 #if RFC_DAMAGE_FAST
-    if( rfc_ctx->damage_lut )           rfc_ctx->mem_alloc( rfc_ctx->damage_lut,    0, 0, RFC_MEM_AIM_DLUT );
+    if( rfc_ctx->lut )
+    {
+        /* Shared tables */
+        (void)RFC_lut_release( rfc_ctx->lut );
+    }
+    else
+    {
+        damage_lut_pages_free( rfc_ctx );
+        if( rfc_ctx->damage_lut )       rfc_ctx->mem_alloc( rfc_ctx->damage_lut,    0, 0, RFC_MEM_AIM_DLUT );
 #if RFC_AT_SUPPORT
-    if( rfc_ctx->amplitude_lut )        rfc_ctx->mem_alloc( rfc_ctx->amplitude_lut, 0, 0, RFC_MEM_AIM_ALUT );
+        if( rfc_ctx->amplitude_lut )    rfc_ctx->mem_alloc( rfc_ctx->amplitude_lut, 0, 0, RFC_MEM_AIM_ALUT );
 #endif /*RFC_AT_SUPPORT*/
+    }
 #endif /*RFC_DAMAGE_FAST*/
 #if !RFC_MINIMAL
     if( rfc_ctx->rp )                   rfc_ctx->mem_alloc( rfc_ctx->rp,            0, 0, RFC_MEM_AIM_RP );
     if( rfc_ctx->lc )                   rfc_ctx->mem_alloc( rfc_ctx->lc,            0, 0, RFC_MEM_AIM_LC );
+    if( rfc_ctx->internal.lc_diff )     rfc_ctx->mem_alloc( rfc_ctx->internal.lc_diff, 0, 0, RFC_MEM_AIM_LC );
+    if( rfc_ctx->snapshot_seq )         rfc_ctx->mem_alloc( rfc_ctx->snapshot_seq,  0, 0, RFC_MEM_AIM_SNAPSHOT );
+    if( rfc_ctx->rfm_sparse )           rfm_sparse_free( rfc_ctx );
+    rfm_sat_free( rfc_ctx );
+    rfc_ctx->internal.rfm_sat.enabled   = false;
+    damage_multi_free( rfc_ctx );
 #endif /*!RFC_MINIMAL*/
 #if RFC_TP_SUPPORT
-    if( rfc_ctx->tp && !rfc_ctx->internal.tp_static )
+    if( rfc_ctx->internal.tp_map )
+    {
+        map_close( rfc_ctx, rfc_ctx->internal.tp_map, rfc_ctx->tp_cnt * sizeof(rfc_value_tuple_s), RFC_MEM_AIM_TP );
+    }
+    else if( rfc_ctx->tp && !rfc_ctx->internal.tp_static )
     {
                                         rfc_ctx->mem_alloc( rfc_ctx->tp,            0, 0, RFC_MEM_AIM_TP );
     }           
 #endif /*RFC_TP_SUPPORT*/
 #if RFC_DH_SUPPORT
-    if( rfc_ctx->dh && !rfc_ctx->internal.dh_static )
+    if( rfc_ctx->internal.dh_map )
+    {
+        map_close( rfc_ctx, rfc_ctx->internal.dh_map, rfc_ctx->dh_cnt * sizeof(double), RFC_MEM_AIM_DH );
+    }
+    else if( rfc_ctx->dh && !rfc_ctx->internal.dh_static )
     {               
                                         rfc_ctx->mem_alloc( rfc_ctx->dh,            0, 0, RFC_MEM_AIM_DH );
     }
@@ -1389,6 +1960,11 @@ bool RFC_deinit( void *ctx )
 #if RFC_DAMAGE_FAST
     rfc_ctx->damage_lut                 = NULL;
     rfc_ctx->damage_lut_inapt           = 1;
+    rfc_ctx->damage_lut_size            = 0;
+    rfc_ctx->damage_lut_stride          = 0;
+    rfc_ctx->damage_lut_pages           = NULL;
+    rfc_ctx->damage_lut_pages_dim       = 0;
+    rfc_ctx->lut                        = NULL;
 #if RFC_AT_SUPPORT
     rfc_ctx->amplitude_lut              = NULL;
 #endif /*RFC_AT_SUPPORT*/
@@ -1397,11 +1973,17 @@ bool RFC_deinit( void *ctx )
     rfc_ctx->residue                    = NULL;
     rfc_ctx->residue_cap                = 0;
     rfc_ctx->residue_cnt                = 0;
+    rfc_ctx->internal.res               = NULL;
+    rfc_ctx->internal.res_cnt           = 0;
 
     rfc_ctx->rfm                        = NULL;
 #if !RFC_MINIMAL
     rfc_ctx->rp                         = NULL;
     rfc_ctx->lc                         = NULL;
+    rfc_ctx->internal.lc_diff           = NULL;
+    rfc_ctx->internal.lc_dirty          = false;
+    rfc_ctx->rfm_sparse                 = NULL;
+    rfc_ctx->snapshot_seq               = NULL;
 #endif /*!RFC_MINIMAL*/
     
     rfc_ctx->internal.slope             = 0;
@@ -1422,6 +2004,7 @@ bool RFC_deinit( void *ctx )
     rfc_ctx->tp_cnt                     = 0;
     rfc_ctx->tp_locked                  = 0;
     rfc_ctx->internal.tp_static         = false;
+    rfc_ctx->internal.tp_map            = NULL;
 #endif /*RFC_TP_SUPPORT*/
 
 #if RFC_DH_SUPPORT
@@ -1429,6 +2012,7 @@ bool RFC_deinit( void *ctx )
     rfc_ctx->dh_cap                     = 0;
     rfc_ctx->dh_cnt                     = 0;
     rfc_ctx->internal.dh_static         = false;
+    rfc_ctx->internal.dh_map            = NULL;
 #endif /*RFC_DH_SUPPORT*/
 
 #if RFC_AT_SUPPORT
@@ -1497,743 +2081,986 @@ bool RFC_feed( void *ctx, const rfc_value_t * data, size_t data_count )
     }
 #endif /*RFC_DH_SUPPORT*/
 
-    /* Process data */
-    while( data_count-- )
-    {
-        rfc_value_tuple_s tp = { *data++ };  /* All other members are zero-initialized, see ISO/IEC 9899:TC3, 6.7.8 (21) */
-
-        /* Assign class and global position (base 1) */
-        tp.pos = ++rfc_ctx->internal.pos;
-        tp.cls = QUANTIZE( rfc_ctx, tp.value );
-
-        if( rfc_ctx->class_count && ( tp.cls >= rfc_ctx->class_count || tp.value < rfc_ctx->class_offset ) )
-        {
-#if !RFC_AR_SUPPORT
-            return error_raise( rfc_ctx, RFC_ERROR_DATA_OUT_OF_RANGE );
-#else
-            if( !RFC_flags_check( ctx, RFC_FLAGS_AUTORESIZE, 0 ) )
-            {
-                return error_raise( rfc_ctx, RFC_ERROR_DATA_OUT_OF_RANGE );
-            }
-
-            if( !autoresize( ctx, &tp ) )
-            {
-                return false;
-            }
-#endif /*RFC_AR_SUPPORT*/
-        }
-        
-        if( !feed_once( rfc_ctx, &tp, rfc_ctx->internal.flags ) ) return false;
-    }
-
-    return true;
-}
+    return feed_values( rfc_ctx, data, data_count );
+}
 
 
 #if !RFC_MINIMAL
 /**
- * @brief      Do countings for a given cycle
+ * @brief      "Feed" counting algorithm with single precision data samples,
+ *             converted by value = data * scale + offset (consecutive calls
+ *             allowed).
  *
- * @param      ctx       The rainflow context
- * @param[in]  from_val  The from value
- * @param[in]  to_val    The to value
- * @param[in]  flags     The flags
+ * @param      ctx         The rainflow context
+ * @param[in]  data        The data
+ * @param      data_count  The data count
+ * @param      scale       The scale
+ * @param      offset      The offset
  *
  * @return     true on success
  */
-bool RFC_cycle_process_counts( void *ctx, rfc_value_t from_val, rfc_value_t to_val, rfc_flags_e flags )
+bool RFC_feed_f32( void *ctx, const float * data, size_t data_count, double scale, double offset )
 {
-    rfc_value_tuple_s from = {from_val}, to = {to_val};
     RFC_CTX_CHECK_AND_ASSIGN
 
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state >= RFC_STATE_FINISHED )
-    {
-        return false;
-    }
-
-    from.cls = QUANTIZE( rfc_ctx, from_val );
-    to.cls   = QUANTIZE( rfc_ctx, to_val );
-
-    cycle_process_counts( rfc_ctx, &from, &to, /*next*/ NULL, flags );
-
-    return true;
+    return feed_converted( rfc_ctx, data, FEED_DATA_TYPE_F32, data_count, /*stride*/ 1, scale, offset );
 }
 
 
 /**
- * @brief      "Feed" counting algorithm with data samples, scaled by a factor
+ * @brief      "Feed" counting algorithm with 16 bit integer data samples (e.g.
+ *             ADC counts), converted by value = data * scale + offset
  *             (consecutive calls allowed).
  *
  * @param      ctx         The rainflow context
  * @param[in]  data        The data
  * @param      data_count  The data count
- * @param      factor      The factor
+ * @param      scale       The scale
+ * @param      offset      The offset
  *
  * @return     true on success
  */
-bool RFC_feed_scaled( void *ctx, const rfc_value_t * data, size_t data_count, double factor )
+bool RFC_feed_i16( void *ctx, const int16_t * data, size_t data_count, double scale, double offset )
 {
     RFC_CTX_CHECK_AND_ASSIGN
 
-    if( data_count && !data ) return false;
-
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state >= RFC_STATE_FINISHED )
-    {
-        return false;
-    }
-
-    /* Process data */
-    while( data_count-- )
-    {
-        rfc_value_tuple_s tp = { *data++ * factor };  /* All other members are zero-initialized, see ISO/IEC 9899:TC3, 6.7.8 (21) */
+    return feed_converted( rfc_ctx, data, FEED_DATA_TYPE_I16, data_count, /*stride*/ 1, scale, offset );
+}
 
-        /* Assign class and global position (base 1) */
-        tp.cls = QUANTIZE( rfc_ctx, tp.value );
-        tp.pos = ++rfc_ctx->internal.pos;
 
-        if( rfc_ctx->class_count && ( tp.cls >= rfc_ctx->class_count || tp.value < rfc_ctx->class_offset ) )
-        {
-#if RFC_FLAGS_AUTORESIZE
-            if( RFC_flags_check( ctx, RFC_FLAGS_AUTORESIZE, 0 ) && !autoresize( ctx, &tp ) )
-            {
-                return false;
-            }
-            else
-#endif /*RFC_FLAGS_AUTORESIZE*/
-            {
-                return error_raise( rfc_ctx, RFC_ERROR_DATA_OUT_OF_RANGE );
-            }
-        }
-        
-        if( !feed_once( rfc_ctx, &tp, rfc_ctx->internal.flags ) ) return false;
-    }
+/**
+ * @brief      "Feed" counting algorithm with 32 bit integer data samples (e.g.
+ *             ADC counts), converted by value = data * scale + offset
+ *             (consecutive calls allowed).
+ *
+ * @param      ctx         The rainflow context
+ * @param[in]  data        The data
+ * @param      data_count  The data count
+ * @param      scale       The scale
+ * @param      offset      The offset
+ *
+ * @return     true on success
+ */
+bool RFC_feed_i32( void *ctx, const int32_t * data, size_t data_count, double scale, double offset )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
 
-    return true;
+    return feed_converted( rfc_ctx, data, FEED_DATA_TYPE_I32, data_count, /*stride*/ 1, scale, offset );
 }
 
 
 /**
- * @brief         Feed counting algorithm with data tuples (tp_pos is kept maintaining). 
+ * @brief      "Feed" counting algorithm with data samples, taken from every
+ *             stride'th element of data (consecutive calls allowed).
  *
- * @param         ctx         The rainflow context
- * @param[in,out] data        The data tuples
- * @param         data_count  The data count
+ * @param      ctx         The rainflow context
+ * @param[in]  data        The data (data[0], data[stride], data[2*stride], ...)
+ * @param      data_count  The data count (number of samples, not elements)
+ * @param      stride      The stride (elements between two samples)
  *
- * @return        true on success
+ * @return     true on success
  */
-bool RFC_feed_tuple( void *ctx, rfc_value_tuple_s *data, size_t data_count )
+bool RFC_feed_strided( void *ctx, const rfc_value_t * data, size_t data_count, size_t stride )
 {
     RFC_CTX_CHECK_AND_ASSIGN
 
-    if( data_count && !data ) return false;
-
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state >= RFC_STATE_FINISHED )
+    if( !stride )
     {
-        return false;
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
     }
 
-    /* Process data */
-    while( data_count-- )
+    if( stride == 1 )
     {
-        if( rfc_ctx->class_count && ( data->cls >= rfc_ctx->class_count || data->value < rfc_ctx->class_offset ) )
-        {
-#if RFC_FLAGS_AUTORESIZE
-            unsigned cls = QUANTIZE( ctx, data->value );
-
-            if( data->cls != cls )
-            {
-                return error_raise( rfc_ctx, RFC_ERROR_DATA_INCONSISTENT );
-            }
-            else
-#endif /*RFC_FLAGS_AUTORESIZE*/
-            {
-                return error_raise( rfc_ctx, RFC_ERROR_DATA_OUT_OF_RANGE );
-            }
-        }
-        
-        if( !feed_once( rfc_ctx, data++, rfc_ctx->internal.flags ) ) return false;
+        return RFC_feed( rfc_ctx, data, data_count );
     }
 
-    return true;
+    return feed_converted( rfc_ctx, data, FEED_DATA_TYPE_VAL, data_count, stride, /*scale*/ 1.0, /*offset*/ 0.0 );
 }
-#endif /*!RFC_MINIMAL*/
 
 
 /**
- * @brief      Finalize pending counts and turning point storage.
- *
- * @param      ctx              The rainflow context
- * @param      residual_method  The residual method (RFC_RES_...)
- *
- * @return     true on success
+ * @brief      "Feed" several rainflow contexts with channel-interleaved data
+ *             samples (ch0, ch1, ..., chN-1, ch0, ...), one context per
+ *             channel (consecutive calls allowed). The buffer is processed in
+ *             chunks of RFC_FEED_CONVERT_SIZE frames, so each chunk is read by
+ *             all channels while it resides in cache.
+ *
+ * @param      ctx          The rainflow contexts (array of ctx_count contexts)
+ * @param      ctx_count    The number of contexts (channels)
+ * @param[in]  data         The data (frames of ctx_count samples each)
+ * @param      frame_count  The frame count (samples per channel)
+ *
+ * @return     true on success (all channels)
  */
-bool RFC_finalize( void *ctx, rfc_res_method_e residual_method )
+bool RFC_feed_interleaved( void *ctx, size_t ctx_count, const rfc_value_t * data, size_t frame_count )
 {
-    double damage;
-    bool ok;
-    RFC_CTX_CHECK_AND_ASSIGN
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state >= RFC_STATE_FINISHED )
+    rfc_ctx_s  *rfc_ctx = (rfc_ctx_s*)ctx;
+    bool        ok      = true;
+
+    if( !rfc_ctx || !ctx_count || ( frame_count && !data ) )
     {
         return false;
     }
 
-#if _DEBUG
-    rfc_ctx->internal.finalizing = true;
-#endif /*_DEBUG*/
-
-    damage = rfc_ctx->damage;
-
-#if RFC_USE_DELEGATES
-    if( rfc_ctx->finalize_fcn )
-    {
-        ok = rfc_ctx->finalize_fcn( rfc_ctx, residual_method );
-    }
-    else
-#endif /*RFC_USE_DELEGATES*/
+    while( frame_count )
     {
-        int flags = rfc_ctx->internal.flags;
-
-#if !RFC_MINIMAL
-        /* Level crossing counting is already considered for residue */
-        flags &= ~RFC_FLAGS_COUNT_LC;
-#endif /*!RFC_MINIMAL*/
+        size_t i, count = ( frame_count < RFC_FEED_CONVERT_SIZE ) ? frame_count : RFC_FEED_CONVERT_SIZE;
 
-        switch( residual_method )
+        for( i = 0; i < ctx_count; i++ )
         {
-            case RFC_RES_NONE:
-                /* FALLTHROUGH */
-            case RFC_RES_IGNORE:
-                ok = finalize_res_ignore( rfc_ctx, flags );
-                break;
-            case RFC_RES_NO_FINALIZE:
-                ok = finalize_res_no_finalize( rfc_ctx, flags );
-                break;
-#if !RFC_MINIMAL
-            case RFC_RES_DISCARD:
-                ok = finalize_res_discard( rfc_ctx, flags );
-                break;
-            case RFC_RES_HALFCYCLES:
-                ok = finalize_res_weight_cycles( rfc_ctx, rfc_ctx->half_inc, flags );
-                break;
-            case RFC_RES_FULLCYCLES:
-                ok = finalize_res_weight_cycles( rfc_ctx, rfc_ctx->full_inc, flags );
-                break;
-            case RFC_RES_CLORMANN_SEEGER:
-                ok = finalize_res_clormann_seeger( rfc_ctx, flags );
-                break;
-            case RFC_RES_REPEATED:
-                ok = finalize_res_repeated( rfc_ctx, flags );
-                break;
-            case RFC_RES_RP_DIN45667:
-                ok = finalize_res_rp_DIN45667( rfc_ctx, flags );
-                break;
-#endif /*!RFC_MINIMAL*/
-            default:
-                assert( false );
-                ok = error_raise( rfc_ctx, RFC_ERROR_INVARG );
+            /* Channels in error state are skipped, others are still counted */
+            if( !RFC_feed_strided( rfc_ctx + i, data + i, count, ctx_count ) )
+            {
+                ok = false;
+            }
         }
-        assert( rfc_ctx->state == RFC_STATE_FINALIZE );
-    }
-
-#if !RFC_MINIMAL
-    if( rfc_ctx->counting_method == RFC_COUNTING_METHOD_NONE || !rfc_ctx->class_count )
-    {
-#else /*RFC_MINIMAL*/
-    if( !rfc_ctx->class_count )
-    {
-#endif /*!RFC_MINIMAL*/
-        rfc_ctx->residue_cnt = 0;
-    }
-
-    rfc_ctx->damage_residue = rfc_ctx->damage - damage;
-    rfc_ctx->state          = ok ? RFC_STATE_FINISHED : RFC_STATE_ERROR;
-
-#if _DEBUG
-    rfc_ctx->internal.finalizing = false;
-#endif /*_DEBUG*/
 
-#if RFC_DH_SUPPORT
-    if( ok )
-    {
-        ok = spread_damage_map_tp( rfc_ctx );
+        data        += count * ctx_count;
+        frame_count -= count;
     }
-#endif /*RFC_DH_SUPPORT*/
 
     return ok;
 }
 
 
-#if !RFC_MINIMAL
 /**
- * @brief      Make rainflow matrix symmetrical
+ * @brief      Initialization of a multi-channel bank. All channels share the
+ *             same class parameters.
  *
- * @param      ctx   The rainflow context
+ * @param      bank           The bank
+ * @param      channel_count  The channel count
+ * @param      class_count    The class count
+ * @param      class_width    The class width
+ * @param      class_offset   The class offset
+ * @param      hysteresis     The hysteresis
+ * @param      flags          The flags
  *
  * @return     true on success
  */
-bool RFC_rfm_make_symmetric( void *ctx )
+bool RFC_bank_init( void *bank, size_t channel_count, unsigned class_count, rfc_value_t class_width, rfc_value_t class_offset, 
+                                rfc_value_t hysteresis, rfc_flags_e flags )
 {
-    unsigned       class_count;
-    unsigned       from, to;
-    rfc_counts_t  *rfm;
+    size_t i;
 
-    RFC_CTX_CHECK_AND_ASSIGN
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    RFC_BANK_CHECK_AND_ASSIGN
+
+    if( rfc_bank->ctx || !channel_count )
     {
         return false;
     }
 
-    rfm = rfc_ctx->rfm;
+    if( !rfc_bank->mem_alloc )
+    {
+        rfc_bank->mem_alloc = mem_alloc;
+    }
 
-    if( !rfm )
+    rfc_bank->channel_count     = channel_count;
+    rfc_bank->pos               = 0;
+    rfc_bank->ctx               = (rfc_ctx_s*)  rfc_bank->mem_alloc( NULL, channel_count, sizeof(rfc_ctx_s),   RFC_MEM_AIM_BANK );
+    rfc_bank->soa.active        = (bool*)       rfc_bank->mem_alloc( NULL, channel_count, sizeof(bool),        RFC_MEM_AIM_BANK );
+    rfc_bank->soa.slope         = (int*)        rfc_bank->mem_alloc( NULL, channel_count, sizeof(int),         RFC_MEM_AIM_BANK );
+    rfc_bank->soa.interim       = (rfc_value_t*)rfc_bank->mem_alloc( NULL, channel_count, sizeof(rfc_value_t), RFC_MEM_AIM_BANK );
+    rfc_bank->soa.interim_pos   = (size_t*)     rfc_bank->mem_alloc( NULL, channel_count, sizeof(size_t),      RFC_MEM_AIM_BANK );
+#if RFC_GLOBAL_EXTREMA
+    for( i = 0; i < 2; i++ )
     {
-        return false;
+        rfc_bank->soa.extrema[i]     = (rfc_value_t*)rfc_bank->mem_alloc( NULL, channel_count, sizeof(rfc_value_t), RFC_MEM_AIM_BANK );
+        rfc_bank->soa.extrema_pos[i] = (size_t*)     rfc_bank->mem_alloc( NULL, channel_count, sizeof(size_t),      RFC_MEM_AIM_BANK );
+
+        if( !rfc_bank->soa.extrema[i] || !rfc_bank->soa.extrema_pos[i] )
+        {
+            RFC_bank_deinit( rfc_bank );
+            return false;
+        }
     }
+#endif /*RFC_GLOBAL_EXTREMA*/
 
-    class_count = rfc_ctx->class_count;
+    if( !rfc_bank->ctx || !rfc_bank->soa.active || !rfc_bank->soa.slope || !rfc_bank->soa.interim || !rfc_bank->soa.interim_pos )
+    {
+        RFC_bank_deinit( rfc_bank );
+        return false;
+    }
 
-    /* Cumulate entries symmetric by major diagonal */
-    for( from = 0; from < class_count; from++ )
+    for( i = 0; i < channel_count; i++ )
     {
-        for( to = from + 1; to < class_count; to++ )
+        rfc_bank->ctx[i].version = sizeof(rfc_ctx_s);
+
+        if( !RFC_init( &rfc_bank->ctx[i], class_count, class_width, class_offset, hysteresis, flags ) )
         {
-            /* to > from, always */
-            rfm[ MAT_OFFS( from, to ) ] += rfm[ MAT_OFFS( to, from ) ];
-            rfm[ MAT_OFFS( to, from ) ]  = 0;
+            RFC_bank_deinit( rfc_bank );
+            return false;
         }
     }
 
+    /* Take class parameters as adjusted by RFC_init() */
+    rfc_bank->class_count       = rfc_bank->ctx[0].class_count;
+    rfc_bank->class_width       = rfc_bank->ctx[0].class_width;
+    rfc_bank->class_offset      = rfc_bank->ctx[0].class_offset;
+    rfc_bank->hysteresis        = rfc_bank->ctx[0].hysteresis;
+
     return true;
 }
 
 
 /**
- * @brief      Returns the number of non zero entries in rainflow matrix
- *
- * @param[in]  ctx   The rainflow context
- *
- * @return     true on success
+ * @brief      "Feed" all channels of a bank with channel-interleaved data
+ *             samples (ch0, ch1, ..., chN-1, ch0, ...), consecutive calls
+ *             allowed. Samples, that can't become turning points, are
+ *             consumed by the pre-filter, sweeping over the per channel hot
+ *             state (structure of arrays). Candidates are passed to the
+ *             channel's context.
+ *
+ * @param      bank         The bank
+ * @param[in]  data         The data (frames of channel_count samples each)
+ * @param      frame_count  The frame count (samples per channel)
+ *
+ * @return     true on success (all channels)
  */
-bool RFC_rfm_non_zeros( const void *ctx, unsigned *count )
+bool RFC_bank_feed( void *bank, const rfc_value_t * data, size_t frame_count )
 {
-    unsigned            class_count;
-    unsigned            from, to;
-    rfc_counts_t       *rfm_it;
+    size_t          channel_count;
+    size_t          c, f;
+    bool            ok = true;
 
-    RFC_CTX_CHECK_AND_ASSIGN
+    RFC_BANK_CHECK_AND_ASSIGN
 
-    if( !count )
-    {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
-    }
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    if( !rfc_bank->ctx || ( frame_count && !data ) )
     {
         return false;
     }
 
-    class_count = rfc_ctx->class_count;
-
-    rfm_it = rfc_ctx->rfm;
+    channel_count = rfc_bank->channel_count;
 
-    if( !rfm_it || !class_count )
+    /* Load hot state */
+    for( c = 0; c < channel_count; c++ )
     {
-        return false;
+        rfc_bank->soa.active[c] = bank_load( rfc_bank, c );
     }
 
-    *count = 0;
-    for( from = 0; from < class_count; from++ )
+    for( f = 0; f < frame_count; f++, data += channel_count )
     {
-        for( to = 0; to < class_count; to++ )
+        size_t pos = ++rfc_bank->pos;
+
+        for( c = 0; c < channel_count; c++ )
         {
-            if( *rfm_it++ ) (*count)++;
+            rfc_value_t x = data[c];
+
+            if( rfc_bank->soa.active[c] )
+            {
+                /* Pre-filter, as feed_filter_block() does */
+                if( x == x && ( !rfc_bank->class_count || ( x >= rfc_bank->class_offset && QUANTIZE( rfc_bank, x ) < rfc_bank->class_count ) ) )
+                {
+                    double  delta     = (double)x - (double)rfc_bank->soa.interim[c];
+                    bool    candidate = false;
+
+                    if( ( delta < 0.0 ? -1 : 1 ) == rfc_bank->soa.slope[c] )
+                    {
+                        if( x != rfc_bank->soa.interim[c] )
+                        {
+                            rfc_bank->soa.interim[c]     = x;
+                            rfc_bank->soa.interim_pos[c] = pos;
+                        }
+                    }
+                    else if( (rfc_value_t)fabs( delta ) > rfc_bank->hysteresis )
+                    {
+                        candidate = true;
+                    }
+
+                    if( !candidate )
+                    {
+#if RFC_GLOBAL_EXTREMA
+                        if( x < rfc_bank->soa.extrema[0][c] )
+                        {
+                            rfc_bank->soa.extrema[0][c]     = x;
+                            rfc_bank->soa.extrema_pos[0][c] = pos;
+                        }
+                        else if( x > rfc_bank->soa.extrema[1][c] )
+                        {
+                            rfc_bank->soa.extrema[1][c]     = x;
+                            rfc_bank->soa.extrema_pos[1][c] = pos;
+                        }
+#endif /*RFC_GLOBAL_EXTREMA*/
+                        continue;
+                    }
+                }
+
+                /* Turning point candidate (or invalid sample), hand over to the channel context */
+                bank_sync( rfc_bank, c, pos - 1, f ? data + c - channel_count : NULL );
+                rfc_bank->soa.active[c] = false;
+            }
+
+            if( !feed_converted( &rfc_bank->ctx[c], data + c, FEED_DATA_TYPE_VAL, 1, /*stride*/ 1, /*scale*/ 1.0, /*offset*/ 0.0 ) )
+            {
+                ok = false;
+                continue;
+            }
+
+            rfc_bank->soa.active[c] = bank_load( rfc_bank, c );
         }
     }
 
-    return true;
+    /* Store hot state */
+    for( c = 0; c < channel_count; c++ )
+    {
+        if( rfc_bank->soa.active[c] )
+        {
+            bank_sync( rfc_bank, c, rfc_bank->pos, frame_count ? data + c - channel_count : NULL );
+            rfc_bank->soa.active[c] = false;
+        }
+    }
+
+    return ok;
 }
 
 
 /**
- * @brief      Get the rainflow matrix as sparse elements
+ * @brief      Finalize all channels of a bank.
  *
- * @param      ctx     The rainflow context
- * @param[out] buffer  The elements buffer, if NULL memory will be allocated
- * @param[out] count   The number of elements in buffer
+ * @param      bank             The bank
+ * @param      residual_method  The residual method
  *
- * @return     true on success
- * @note       The counts are natively returned, regardless of .full_inc!
-*/
-bool RFC_rfm_get( const void *ctx, rfc_rfm_item_s **buffer, unsigned *count )
+ * @return     true on success (all channels)
+ */
+bool RFC_bank_finalize( void *bank, rfc_res_method_e residual_method )
 {
-    unsigned            class_count;
-    unsigned            from, to;
-    unsigned            count_old;
-    rfc_counts_t       *rfm_it;
-    rfc_rfm_item_s     *item;
+    size_t  i;
+    bool    ok = true;
 
-    RFC_CTX_CHECK_AND_ASSIGN
+    RFC_BANK_CHECK_AND_ASSIGN
 
-    if( !buffer || !count )
+    if( !rfc_bank->ctx )
     {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        return false;
     }
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+
+    for( i = 0; i < rfc_bank->channel_count; i++ )
     {
-        return false;
+        if( !RFC_finalize( &rfc_bank->ctx[i], residual_method ) )
+        {
+            ok = false;
+        }
     }
 
-    class_count = rfc_ctx->class_count;
+    return ok;
+}
 
-    rfm_it = rfc_ctx->rfm;
 
-    if( !rfm_it || !class_count )
+/**
+ * @brief      Deinitialize a multi-channel bank and all its channels.
+ *
+ * @param      bank  The bank
+ *
+ * @return     true on success
+ */
+bool RFC_bank_deinit( void *bank )
+{
+    size_t  i;
+
+    RFC_BANK_CHECK_AND_ASSIGN
+
+    if( !rfc_bank->mem_alloc )
     {
         return false;
     }
 
-    /* *buffer = NULL; */
-    count_old  = *count;
-    *count     = 0;
-    for( from = 0; from < class_count; from++ )
+    if( rfc_bank->ctx )
     {
-        for( to = 0; to < class_count; to++, rfm_it++ )
+        for( i = 0; i < rfc_bank->channel_count; i++ )
         {
-            if( *rfm_it )
+            if( rfc_bank->ctx[i].state >= RFC_STATE_INIT )
             {
-                (*count)++;
+                RFC_deinit( &rfc_bank->ctx[i] );
             }
         }
     }
 
-    if( *count > count_old )
+    if( rfc_bank->ctx )                 rfc_bank->mem_alloc( rfc_bank->ctx,             0, 0, RFC_MEM_AIM_BANK );
+    if( rfc_bank->soa.active )          rfc_bank->mem_alloc( rfc_bank->soa.active,      0, 0, RFC_MEM_AIM_BANK );
+    if( rfc_bank->soa.slope )           rfc_bank->mem_alloc( rfc_bank->soa.slope,       0, 0, RFC_MEM_AIM_BANK );
+    if( rfc_bank->soa.interim )         rfc_bank->mem_alloc( rfc_bank->soa.interim,     0, 0, RFC_MEM_AIM_BANK );
+    if( rfc_bank->soa.interim_pos )     rfc_bank->mem_alloc( rfc_bank->soa.interim_pos, 0, 0, RFC_MEM_AIM_BANK );
+#if RFC_GLOBAL_EXTREMA
+    for( i = 0; i < 2; i++ )
     {
-        *buffer = rfc_ctx->mem_alloc( *buffer, *count, sizeof(rfc_rfm_item_s), RFC_MEM_AIM_RFM_ELEMENTS );
-
-        if( !*buffer )
-        {
-            error_raise( rfc_ctx, RFC_ERROR_MEMORY );
-            return false;
-        }
+        if( rfc_bank->soa.extrema[i] )      rfc_bank->mem_alloc( rfc_bank->soa.extrema[i],     0, 0, RFC_MEM_AIM_BANK );
+        if( rfc_bank->soa.extrema_pos[i] )  rfc_bank->mem_alloc( rfc_bank->soa.extrema_pos[i], 0, 0, RFC_MEM_AIM_BANK );
+        rfc_bank->soa.extrema[i]     = NULL;
+        rfc_bank->soa.extrema_pos[i] = NULL;
     }
-        
-    item   = *buffer;
-    rfm_it = rfc_ctx->rfm;
-    for( from = 0; from < class_count; from++ )
-    {
-        for( to = 0; to < class_count; to++, rfm_it++ )
-        {
-            if( *rfm_it )
-            {
-                item->from   = from;
-                item->to     = to;
-                item->counts = *rfm_it;
+#endif /*RFC_GLOBAL_EXTREMA*/
 
-                item++;
-            }
-        }
-    }
+    rfc_bank->ctx               = NULL;
+    rfc_bank->channel_count     = 0;
+    rfc_bank->pos               = 0;
+    rfc_bank->soa.active        = NULL;
+    rfc_bank->soa.slope         = NULL;
+    rfc_bank->soa.interim       = NULL;
+    rfc_bank->soa.interim_pos   = NULL;
 
     return true;
 }
 
 
 /**
- * @brief      Set (or increment) rainflow matrix with given elements
- *
- * @param      ctx       The rainflow context
- * @param[in]  buffer    The elements buffer
- * @param      count     The number of elements in buffer
- * @param      add_only  Counts are added if set to true
+ * Batch job, shared by all workers of RFC_batch()
+ */
+struct batch_job
+{
+    const rfc_ctx_s                    *proto;                      /**< Prototype context, parameters for all series */
+    const rfc_value_t * const          *data;                       /**< Series */
+    const size_t                       *data_count;                 /**< Number of samples per series */
+    size_t                              series_count;               /**< Number of series */
+    rfc_res_method_e                    residual_method;            /**< Residual method */
+    double                             *damage;                     /**< Damage per series (may be NULL) */
+    rfc_counts_t                       *rfm;                        /**< Rainflow matrix per series (may be NULL) */
+    rfc_counts_t                       *rp;                         /**< Range pair counts per series (may be NULL) */
+    size_t                              chunk;                      /**< Number of series claimed at once */
+    size_t                              next;                       /**< Next series to claim */
+    rfc_error_e                         error;                      /**< First error occurred */
+#if RFC_USE_THREADS
+#if defined(_WIN32)
+    CRITICAL_SECTION                    lock;                       /**< Guards next and error */
+#else /*!_WIN32*/
+    pthread_mutex_t                     lock;                       /**< Guards next and error */
+#endif /*_WIN32*/
+#endif /*RFC_USE_THREADS*/
+};
+
+
+#if RFC_USE_THREADS
+#if defined(_WIN32)
+#define BATCH_LOCK( job )       EnterCriticalSection( &(job)->lock )
+#define BATCH_UNLOCK( job )     LeaveCriticalSection( &(job)->lock )
+
+static
+DWORD WINAPI batch_thread( LPVOID arg )
+{
+    batch_worker( (struct batch_job*)arg );
+    return 0;
+}
+#else /*!_WIN32*/
+#define BATCH_LOCK( job )       pthread_mutex_lock( &(job)->lock )
+#define BATCH_UNLOCK( job )     pthread_mutex_unlock( &(job)->lock )
+
+static
+void* batch_thread( void *arg )
+{
+    batch_worker( (struct batch_job*)arg );
+    return NULL;
+}
+#endif /*_WIN32*/
+#else /*!RFC_USE_THREADS*/
+#define BATCH_LOCK( job )
+#define BATCH_UNLOCK( job )
+#endif /*RFC_USE_THREADS*/
+
+
+/**
+ * @brief      Count many independent series, sharing the parameters of a
+ *             prototype context (class parameters, hysteresis, flags,
+ *             counting method, Woehler curve and amplitude transformation).
+ *             Damage, rainflow matrix and range pair counts are returned per
+ *             series. Turning point storage, damage history, delegates
+ *             (except for turning point storage) and RFC_FLAGS_AUTORESIZE
+ *             are not supported.
+ *             Series are counted by a pool of workers, each of them reusing
+ *             one context of its own (no allocations per series). Idle
+ *             workers claim the next chunk of pending series, so uneven
+ *             series lengths are balanced dynamically.
+ *
+ * @param      ctx              The prototype context (initialized)
+ * @param      series_count     The number of series
+ * @param[in]  data             The series (series_count pointers)
+ * @param[in]  data_count       The number of samples per series
+ * @param      residual_method  The residual method (RFC_RES_...)
+ * @param      thread_count     The number of workers (0: one per processor)
+ * @param[out] damage           Damage per series (series_count values, may
+ *                              be NULL)
+ * @param[out] rfm              Rainflow matrix per series (series_count
+ *                              matrices of class_count^2 counts, may be
+ *                              NULL)
+ * @param[out] rp               Range pair counts per series (series_count
+ *                              vectors of class_count counts, may be NULL)
  *
  * @return     true on success
- * @note       The counts are natively added, regardless of .full_inc!
  */
-bool RFC_rfm_set( void *ctx, const rfc_rfm_item_s *buffer, unsigned count, bool add_only )
+bool RFC_batch( void *ctx, size_t series_count, const rfc_value_t * const *data, const size_t *data_count,
+                           rfc_res_method_e residual_method, unsigned thread_count, double *damage, rfc_counts_t *rfm, rfc_counts_t *rp )
 {
-          unsigned           class_count, i;
-    const rfc_rfm_item_s    *item;
-          rfc_counts_t      *rfm;
+    struct batch_job    job;
 
     RFC_CTX_CHECK_AND_ASSIGN
 
-    if( !buffer )
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
+
+    if( ( series_count && ( !data || !data_count ) ) ||
+        ( rfm && ( !rfc_ctx->class_count || !( rfc_ctx->internal.flags & RFC_FLAGS_COUNT_RFM ) ) ) ||
+        ( rp  && ( !rfc_ctx->class_count || !( rfc_ctx->internal.flags & RFC_FLAGS_COUNT_RP ) ) ) )
     {
         return error_raise( rfc_ctx, RFC_ERROR_INVARG );
     }
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+
+    /* Workers count on contexts of their own, settings not carried over are refused */
+#if RFC_AR_SUPPORT
+    if( rfc_ctx->internal.flags & RFC_FLAGS_AUTORESIZE )
     {
-        return false;
+        /* Class count may differ per series */
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
     }
+#endif /*RFC_AR_SUPPORT*/
 
-    class_count = rfc_ctx->class_count;
+#if RFC_TP_SUPPORT
+    if( rfc_ctx->tp )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
+    }
+#endif /*RFC_TP_SUPPORT*/
 
-    rfm = rfc_ctx->rfm;
+#if RFC_DH_SUPPORT
+    if( rfc_ctx->dh )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
+    }
+#endif /*RFC_DH_SUPPORT*/
 
-    if( !rfm || !class_count )
+#if RFC_USE_DELEGATES
+    /* Turning point storage delegates don't affect the results, batch mode doesn't deliver turning points */
+    if( rfc_ctx->tp_next_fcn || rfc_ctx->finalize_fcn || rfc_ctx->cycle_find_fcn || rfc_ctx->damage_calc_fcn
+#if RFC_DH_SUPPORT
+        || rfc_ctx->spread_damage_fcn
+#endif /*RFC_DH_SUPPORT*/
+#if RFC_AT_SUPPORT
+        || rfc_ctx->at_transform_fcn
+#endif /*RFC_AT_SUPPORT*/
+      )
     {
-        return false;
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
     }
+#endif /*RFC_USE_DELEGATES*/
 
-    if( !add_only )
+    if( !series_count )
     {
-        /* Initialize with zeros */
-        memset( rfm, 0, sizeof(rfc_rfm_item_s) * class_count * class_count );
+        return true;
     }
 
-    item = buffer;
-    for( i = 0; i < count; i++ )
+    thread_count = batch_thread_count( thread_count );
+    if( thread_count > series_count )
     {
-        unsigned from, to;
+        thread_count = (unsigned)series_count;
+    }
 
-        from = ( item->from < 0 ) ? 1 : ( item->from + 1 );
-        to   = ( item->to   < 0 ) ? 1 : ( item->to   + 1 );
+    memset( &job, 0, sizeof(job) );
+    job.proto           = rfc_ctx;
+    job.data            = data;
+    job.data_count      = data_count;
+    job.series_count    = series_count;
+    job.residual_method = residual_method;
+    job.damage          = damage;
+    job.rfm             = rfm;
+    job.rp              = rp;
+    job.error           = RFC_ERROR_NOERROR;
 
-        if( from > class_count ) from = class_count;
-        if( to   > class_count ) to   = class_count;
+    /* Some chunks per worker for balancing, but few claims */
+    job.chunk = series_count / ( 8 * thread_count );
+    if( job.chunk < 1 )                   job.chunk = 1;
+    if( job.chunk > RFC_BATCH_CHUNK_MAX ) job.chunk = RFC_BATCH_CHUNK_MAX;
 
-        if( from > 0 && to > 0 )
-        {
-            rfm[ MAT_OFFS( from-1, to-1 ) ] += item->counts;
-        }
-    }
+#if RFC_USE_THREADS
+    {
+        unsigned    started = 0;
+        unsigned    i;
+#if defined(_WIN32)
+        HANDLE      threads[RFC_BATCH_THREADS_MAX];
 
-    return true;
-}
+        InitializeCriticalSection( &job.lock );
 
+        /* The calling thread is a worker too */
+        for( i = 1; i < thread_count; i++ )
+        {
+            threads[started] = CreateThread( NULL, 0, batch_thread, &job, 0, NULL );
+            if( threads[started] ) started++;
+        }
 
-/**
- * @brief      Get counts of a single element from the rainflow matrix
- *
- * @param      ctx       The rainflow context
- * @param      from_val  The cycles start value
- * @param      to_val    The cycles target value
- * @param[out] counts    The corresponding count from the matrix element (not cycles!), regardless of .full_inc!
- *
- * @return     true on success
- */
-bool RFC_rfm_peek( const void *ctx, rfc_value_t from_val, rfc_value_t to_val, rfc_counts_t *counts )
-{
-    unsigned           from, to;
-    unsigned           class_count;
-    rfc_counts_t      *rfm;
+        batch_worker( &job );
 
-    RFC_CTX_CHECK_AND_ASSIGN
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
-    {
-        return false;
-    }
+        for( i = 0; i < started; i++ )
+        {
+            WaitForSingleObject( threads[i], INFINITE );
+            CloseHandle( threads[i] );
+        }
 
-    class_count = rfc_ctx->class_count;
+        DeleteCriticalSection( &job.lock );
+#else /*!_WIN32*/
+        pthread_t   threads[RFC_BATCH_THREADS_MAX];
 
-    rfm = rfc_ctx->rfm;
+        if( pthread_mutex_init( &job.lock, NULL ) != 0 )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_UNEXP );
+        }
 
-    if( !rfm || !class_count )
-    {
-        return false;
-    }
+        /* The calling thread is a worker too */
+        for( i = 1; i < thread_count; i++ )
+        {
+            if( pthread_create( &threads[started], NULL, batch_thread, &job ) == 0 ) started++;
+        }
 
-    assert( from_val >= rfc_ctx->class_offset );
-    assert( to_val   >= rfc_ctx->class_offset );
+        batch_worker( &job );
 
-    from = QUANTIZE( rfc_ctx, from_val );
-    to   = QUANTIZE( rfc_ctx, to_val );
+        for( i = 0; i < started; i++ )
+        {
+            pthread_join( threads[i], NULL );
+        }
 
-    if( from > class_count ) from = class_count;
-    if( to   > class_count ) to   = class_count;
+        pthread_mutex_destroy( &job.lock );
+#endif /*_WIN32*/
+    }
+#else /*!RFC_USE_THREADS*/
+    batch_worker( &job );
+#endif /*RFC_USE_THREADS*/
 
-    if( counts )
+    if( job.error != RFC_ERROR_NOERROR )
     {
-        *counts = rfm[ MAT_OFFS( from, to ) ];
+        return error_raise( rfc_ctx, job.error );
     }
 
     return true;
 }
 
 
+#if RFC_DAMAGE_FAST
+/* Damage look-up tables, shared among contexts with equal parameters */
+struct rfc_lut
+{
+    long                                refs;                       /**< Reference count (creator and contexts attached) */
+    rfc_mem_alloc_fcn_t                 mem_alloc;                  /**< Memory allocator of the prototype context */
+    rfc_class_param_s                   class_param;                /**< Class parameters */
+    rfc_wl_param_s                      wl_param;                   /**< Woehler curve parameters */
+#if RFC_AT_SUPPORT
+    unsigned                            at_count;                   /**< Amplitude transformation (reference curve values aren't compared) */
+    double                              at_M;
+    double                              at_Sm_rig;
+    double                              at_R_rig;
+    bool                                at_R_pinned;
+#endif /*RFC_AT_SUPPORT*/
+    size_t                              size;                       /**< Number of entries per table */
+    unsigned                            stride;                     /**< Row length, 0 if indexed by range class only */
+    double                             *damage;                     /**< Damage look-up table */
+    double                             *amplitude;                  /**< Amplitude look-up table (may be NULL) */
+};
+
+
+#if RFC_USE_THREADS && defined(_WIN32)
+#define LUT_REFS_INC( lut )     InterlockedIncrement( &(lut)->refs )
+#define LUT_REFS_DEC( lut )     InterlockedDecrement( &(lut)->refs )
+#elif RFC_USE_THREADS && defined(__GNUC__)
+#define LUT_REFS_INC( lut )     __atomic_add_fetch( &(lut)->refs, 1, __ATOMIC_RELAXED )
+#define LUT_REFS_DEC( lut )     __atomic_sub_fetch( &(lut)->refs, 1, __ATOMIC_ACQ_REL )
+#else /*!RFC_USE_THREADS*/
+#define LUT_REFS_INC( lut )     ( ++(lut)->refs )
+#define LUT_REFS_DEC( lut )     ( --(lut)->refs )
+#endif /*RFC_USE_THREADS*/
+
+
 /**
- * @brief      Set (or increment) one matrix value of the rainflow matrix
+ * @brief      Create read-only damage look-up tables from a prototype
+ *             context (class parameters, Woehler curve and amplitude
+ *             transformation), to be shared by other contexts with
+ *             RFC_lut_attach(). The caller holds one reference and releases
+ *             it with RFC_lut_release().
  *
- * @param      ctx       The rainflow context
- * @param      from_val  The cycles start value
- * @param      to_val    The cycles target value
- * @param      counts    The count value for the matrix element (not cycles!), regardless of .full_inc!
- * @param      add_only  Value is added if set to true
+ * @param      ctx   The prototype context (look-up tables set up, no
+ *                   damage or amplitude transformation delegates)
+ * @param[out] lut   The shared look-up tables
  *
  * @return     true on success
  */
-bool RFC_rfm_poke( void *ctx, rfc_value_t from_val, rfc_value_t to_val, rfc_counts_t counts, bool add_only )
+bool RFC_lut_create( const void *ctx, rfc_lut_s **lut )
 {
-    unsigned           from, to;
-    unsigned           class_count;
-    rfc_counts_t      *rfm;
+    rfc_lut_s  *lut_new;
+    size_t      tables = 1;
+    void       *ptr;
 
     RFC_CTX_CHECK_AND_ASSIGN
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+
+    if( !lut )
     {
-        return false;
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
     }
 
-    class_count = rfc_ctx->class_count;
-
-    rfm = rfc_ctx->rfm;
+    *lut = NULL;
 
-    if( !rfm || !class_count )
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
     {
         return false;
     }
 
-    assert( from_val >= rfc_ctx->class_offset );
-    assert( to_val   >= rfc_ctx->class_offset );
+    if( !rfc_ctx->damage_lut || rfc_ctx->damage_lut_inapt )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_LUT );
+    }
 
-    from = QUANTIZE( rfc_ctx, from_val );
-    to   = QUANTIZE( rfc_ctx, to_val );
+    if( rfc_ctx->damage_lut_pages )
+    {
+        /* Paged tables are completed on demand, they can't be shared read-only */
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
+    }
 
-    if( from > class_count ) from = class_count;
-    if( to   > class_count ) to   = class_count;
+#if RFC_USE_DELEGATES
+#if RFC_AT_SUPPORT
+    if( rfc_ctx->damage_calc_fcn || rfc_ctx->at_transform_fcn )
+#else /*!RFC_AT_SUPPORT*/
+    if( rfc_ctx->damage_calc_fcn )
+#endif /*RFC_AT_SUPPORT*/
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
+    }
+#endif /*RFC_USE_DELEGATES*/
 
-    if( add_only )
+    if( rfc_ctx->lut )
     {
-        rfm[ MAT_OFFS( from, to ) ] += counts;
+        /* Already shared */
+        LUT_REFS_INC( rfc_ctx->lut );
+        *lut = rfc_ctx->lut;
+        return true;
     }
-    else
+
+#if RFC_AT_SUPPORT
+    if( rfc_ctx->amplitude_lut ) tables++;
+#endif /*RFC_AT_SUPPORT*/
+
+    /* One block, tables following the header */
+    ptr = rfc_ctx->mem_alloc( NULL, 1, sizeof(rfc_lut_s) + tables * rfc_ctx->damage_lut_size * sizeof(double), RFC_MEM_AIM_DLUT );
+    if( !ptr )
     {
-        rfm[ MAT_OFFS( from, to ) ] = counts;
+        return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+    }
+
+    lut_new                 = (rfc_lut_s*)ptr;
+    lut_new->refs           = 1;
+    lut_new->mem_alloc      = rfc_ctx->mem_alloc;
+    lut_new->size           = rfc_ctx->damage_lut_size;
+    lut_new->stride         = rfc_ctx->damage_lut_stride;
+    lut_new->damage         = (double*)( lut_new + 1 );
+    lut_new->amplitude      = NULL;
+    (void)RFC_class_param_get( rfc_ctx, &lut_new->class_param );
+    (void)RFC_wl_param_get( rfc_ctx, &lut_new->wl_param );
+    memcpy( lut_new->damage, rfc_ctx->damage_lut, lut_new->size * sizeof(double) );
+
+#if RFC_AT_SUPPORT
+    lut_new->at_count       = rfc_ctx->at.count;
+    lut_new->at_M           = rfc_ctx->at.M;
+    lut_new->at_Sm_rig      = rfc_ctx->at.Sm_rig;
+    lut_new->at_R_rig       = rfc_ctx->at.R_rig;
+    lut_new->at_R_pinned    = rfc_ctx->at.R_pinned;
+
+    if( rfc_ctx->amplitude_lut )
+    {
+        lut_new->amplitude  = lut_new->damage + lut_new->size;
+        memcpy( lut_new->amplitude, rfc_ctx->amplitude_lut, lut_new->size * sizeof(double) );
     }
+#endif /*RFC_AT_SUPPORT*/
+
+    *lut = lut_new;
 
     return true;
 }
 
 
 /**
- * @brief      Sum cycles of a rainflow matrix region
+ * @brief      Attach shared damage look-up tables to a context, instead of
+ *             its own tables. Parameters of the context must match those of
+ *             the prototype. Tables are copied, as soon as the context
+ *             changes its parameters (copy on write).
  *
- * @param      ctx         The rainflow context
- * @param      from_first  The first start class (row)
- * @param      from_last   The last start class (row)
- * @param      to_first    The first target class (col)
- * @param      to_last     The last target class (col)
- * @param      count       The sum of the matrix region
+ * @param      ctx   The rainflow context
+ * @param      lut   The shared look-up tables
  *
  * @return     true on success
- * @note       The sum is natively built, regardless of .full_inc!
  */
-bool RFC_rfm_sum( const void *ctx, unsigned from_first, unsigned from_last, unsigned to_first, unsigned to_last, rfc_counts_t *count )
+bool RFC_lut_attach( void *ctx, rfc_lut_s *lut )
 {
-    unsigned         from, to;
-    unsigned         class_count;
-    rfc_counts_t    *rfm;
+    rfc_class_param_s   class_param;
+    rfc_wl_param_s      wl_param;
 
     RFC_CTX_CHECK_AND_ASSIGN
-    
+
     if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
     {
         return false;
     }
 
-    class_count = rfc_ctx->class_count;
-
-    rfm = rfc_ctx->rfm;
+    if( !lut || !rfc_ctx->damage_lut )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
 
-    if( !rfm || !class_count )
+    if( rfc_ctx->lut == lut )
     {
-        return false;
+        return true;
     }
 
-    assert( from_first < class_count );
-    assert( from_last  < class_count );
-    assert( to_first   < class_count );
-    assert( to_last    < class_count );
-    assert( from_first < from_last );
-    assert( to_first   < to_last );
+    (void)RFC_class_param_get( rfc_ctx, &class_param );
+    (void)RFC_wl_param_get( rfc_ctx, &wl_param );
 
-    if( count )
+    /* Tables must be the same as the context would set up */
+    if( memcmp( &class_param, &lut->class_param, sizeof(class_param) ) ||
+        memcmp( &wl_param,    &lut->wl_param,    sizeof(wl_param) ) )
     {
-        rfc_counts_t sum = 0;
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
 
-        for( from = from_first; from <= from_last; from++ )
-        {
-            for( to = to_first; to < to_last; to++ )
-            {
-                sum += rfm[ MAT_OFFS( from, to ) ];
-            }
-        }
+#if RFC_USE_DELEGATES
+#if RFC_AT_SUPPORT
+    if( rfc_ctx->damage_calc_fcn || rfc_ctx->at_transform_fcn )
+#else /*!RFC_AT_SUPPORT*/
+    if( rfc_ctx->damage_calc_fcn )
+#endif /*RFC_AT_SUPPORT*/
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
+    }
+#endif /*RFC_USE_DELEGATES*/
 
-        *count = sum;
+#if RFC_AT_SUPPORT
+    if( rfc_ctx->at.count    != lut->at_count  || rfc_ctx->at.M      != lut->at_M      ||
+        rfc_ctx->at.Sm_rig   != lut->at_Sm_rig || rfc_ctx->at.R_rig  != lut->at_R_rig  ||
+        rfc_ctx->at.R_pinned != lut->at_R_pinned )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+#endif /*RFC_AT_SUPPORT*/
+
+    /* Drop tables used so far */
+    if( rfc_ctx->lut )
+    {
+        (void)RFC_lut_release( rfc_ctx->lut );
+    }
+    else
+    {
+        damage_lut_pages_free( rfc_ctx );
+        rfc_ctx->mem_alloc( rfc_ctx->damage_lut, 0, 0, RFC_MEM_AIM_DLUT );
+#if RFC_AT_SUPPORT
+        if( rfc_ctx->amplitude_lut ) rfc_ctx->mem_alloc( rfc_ctx->amplitude_lut, 0, 0, RFC_MEM_AIM_ALUT );
+#endif /*RFC_AT_SUPPORT*/
     }
 
+    LUT_REFS_INC( lut );
+
+    rfc_ctx->lut                = lut;
+    rfc_ctx->damage_lut         = lut->damage;
+    rfc_ctx->damage_lut_size    = lut->size;
+    rfc_ctx->damage_lut_stride  = lut->stride;
+    rfc_ctx->damage_lut_inapt   = 0;
+#if RFC_AT_SUPPORT
+    rfc_ctx->amplitude_lut      = lut->amplitude;
+#endif /*RFC_AT_SUPPORT*/
+
     return true;
 }
 
 
 /**
- * @brief      Calculates the sum of damages for a rainflow matrix
- *             region
+ * @brief      Release a reference to shared damage look-up tables. Tables
+ *             are freed, when the last reference is released.
  *
- * @param      ctx         The rainflow context
- * @param      from_first  The first start class (row)
- * @param      from_last   The last start class (row)
- * @param      to_first    The first target class (col)
- * @param      to_last     The last target class (col)
- * @param[out] damage      The result (sum)
+ * @param      lut   The shared look-up tables
  *
  * @return     true on success
  */
-bool RFC_rfm_damage( const void *ctx, unsigned from_first, unsigned from_last, unsigned to_first, unsigned to_last, double *damage )
+bool RFC_lut_release( rfc_lut_s *lut )
 {
-    unsigned          from, to;
-    unsigned          class_count;
-    rfc_counts_t     *rfm;
-
-    RFC_CTX_CHECK_AND_ASSIGN
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    if( !lut )
     {
         return false;
     }
 
-    class_count = rfc_ctx->class_count;
+    if( LUT_REFS_DEC( lut ) == 0 )
+    {
+        lut->mem_alloc( lut, 0, 0, RFC_MEM_AIM_DLUT );
+    }
 
-    rfm = rfc_ctx->rfm;
+    return true;
+}
+#endif /*RFC_DAMAGE_FAST*/
 
-    if( !rfm || !class_count )
+
+#if RFC_USE_THREADS && defined(_WIN32)
+#define SNAPSHOT_LOAD_ACQUIRE( seq )        InterlockedCompareExchange( (volatile LONG*)(seq), 0, 0 )
+#define SNAPSHOT_LOAD_RELAXED( seq )        ( *(volatile const long*)(seq) )
+#define SNAPSHOT_STORE_RELAXED( seq, val )  ( *(volatile long*)(seq) = (val) )
+#define SNAPSHOT_STORE_RELEASE( seq, val )  InterlockedExchange( (volatile LONG*)(seq), (val) )
+#define SNAPSHOT_FENCE_ACQUIRE()            MemoryBarrier()
+#define SNAPSHOT_FENCE_RELEASE()            MemoryBarrier()
+#define SNAPSHOT_YIELD()                    SwitchToThread()
+#elif defined(__GNUC__)
+#define SNAPSHOT_LOAD_ACQUIRE( seq )        __atomic_load_n( (seq), __ATOMIC_ACQUIRE )
+#define SNAPSHOT_LOAD_RELAXED( seq )        __atomic_load_n( (seq), __ATOMIC_RELAXED )
+#define SNAPSHOT_STORE_RELAXED( seq, val )  __atomic_store_n( (seq), (val), __ATOMIC_RELAXED )
+#define SNAPSHOT_STORE_RELEASE( seq, val )  __atomic_store_n( (seq), (val), __ATOMIC_RELEASE )
+#define SNAPSHOT_FENCE_ACQUIRE()            __atomic_thread_fence( __ATOMIC_ACQUIRE )
+#define SNAPSHOT_FENCE_RELEASE()            __atomic_thread_fence( __ATOMIC_RELEASE )
+#if RFC_USE_THREADS
+#define SNAPSHOT_YIELD()                    sched_yield()
+#else /*!RFC_USE_THREADS*/
+#define SNAPSHOT_YIELD()                    ( (void)0 )
+#endif /*RFC_USE_THREADS*/
+#else /*!__GNUC__*/
+#define SNAPSHOT_LOAD_ACQUIRE( seq )        ( *(volatile const long*)(seq) )
+#define SNAPSHOT_LOAD_RELAXED( seq )        ( *(volatile const long*)(seq) )
+#define SNAPSHOT_STORE_RELAXED( seq, val )  ( *(volatile long*)(seq) = (val) )
+#define SNAPSHOT_STORE_RELEASE( seq, val )  ( *(volatile long*)(seq) = (val) )
+#define SNAPSHOT_FENCE_ACQUIRE()            ( (void)0 )
+#define SNAPSHOT_FENCE_RELEASE()            ( (void)0 )
+#define SNAPSHOT_YIELD()                    ( (void)0 )
+#endif /*__GNUC__*/
+
+
+/**
+ * @brief      Enable snapshots of the counting results (RFC_snapshot()),
+ *             while the context is fed by one writer thread. Counting
+ *             results are published by a sequence counter (seqlock):
+ *             The writer makes the counter odd before it updates damage
+ *             and histograms and even afterwards, readers copy the results
+ *             and retry, if the counter has changed meanwhile. The writer
+ *             never waits for readers.
+ *             Published are updates by RFC_feed() (blockwise), its typed
+ *             and strided variants, RFC_feed_scaled(), RFC_feed_tuple(),
+ *             RFC_cycle_process_counts(), RFC_finalize() and
+ *             RFC_clear_counts(). Other modifying functions must not run
+ *             concurrently with readers. Automatic resizing is not
+ *             supported, since it reallocates the histograms.
+ *
+ * @param      ctx   The rainflow context
+ *
+ * @return     true on success
+ */
+bool RFC_snapshot_enable( void *ctx )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( rfc_ctx->state < RFC_STATE_INIT )
     {
         return false;
     }
 
-    assert( from_first < class_count );
-    assert( from_last  < class_count );
-    assert( to_first   < class_count );
-    assert( to_last    < class_count );
-    assert( from_first < from_last );
-    assert( to_first   < to_last );
+#if RFC_AR_SUPPORT
+    if( rfc_ctx->internal.flags & RFC_FLAGS_AUTORESIZE )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
+    }
+#endif /*RFC_AR_SUPPORT*/
 
-    if( damage )
+    if( !rfc_ctx->snapshot_seq )
     {
-        double sum = 0.0;
-        for( from = from_first; from <= from_last; from++ )
-        {
-            for( to = to_first; to < to_last; to++ )
-            {
-                rfc_counts_t count = rfm[ MAT_OFFS( from, to ) ];
-                double damage_i;
-                
-                if( !damage_calc( rfc_ctx, from, to, &damage_i, NULL /*Sa_ret*/ ) )
-                {
-                    return false;
-                }
+        /* The counter has to be naturally aligned for atomic access, rfc_ctx_s is packed */
+        rfc_ctx->snapshot_seq = (long*)rfc_ctx->mem_alloc( NULL, 1, sizeof(long), RFC_MEM_AIM_SNAPSHOT );
 
-                sum += damage_i * count;
-            }
+        if( !rfc_ctx->snapshot_seq )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
         }
-
-        *damage = sum / rfc_ctx->full_inc;
     }
 
     return true;
@@ -2241,399 +3068,658 @@ bool RFC_rfm_damage( const void *ctx, unsigned from_first, unsigned from_last, u
 
 
 /**
- * @brief      Check the consistency of the rainflow matrix
+ * @brief      Take a consistent snapshot of the counting results, while
+ *             another thread feeds the context. The context isn't
+ *             modified, not even on failure. Must not be called from
+ *             delegates of the context being fed.
  *
- * @param      rfc_ctx  The rfc context
+ * @param      ctx     The rainflow context (snapshots enabled)
+ * @param[out] damage  The cumulated damage (may be NULL)
+ * @param[out] rfm     The rainflow matrix, class_count^2 elements (may be NULL)
+ * @param[out] rp      The range pair counts, class_count elements (may be NULL)
+ * @param[out] lc      The level crossing counts, class_count elements (may be NULL)
  *
  * @return     true on success
  */
-bool RFC_rfm_check( const void *ctx )
+bool RFC_snapshot( const void *ctx, double *damage, rfc_counts_t *rfm, rfc_counts_t *rp, rfc_counts_t *lc )
 {
-    unsigned          class_count;
-    rfc_counts_t     *rfm;
+    const rfc_ctx_s    *rfc_ctx = (const rfc_ctx_s*)ctx;
+    const long         *seq;
+    size_t              n;
 
-    RFC_CTX_CHECK_AND_ASSIGN
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    if( !rfc_ctx || rfc_ctx->version != sizeof(rfc_ctx_s) || !rfc_ctx->snapshot_seq )
     {
         return false;
     }
 
-    class_count = rfc_ctx->class_count;
-
-    rfm = rfc_ctx->rfm;
-
-    if( !rfm || !class_count )
+    if( ( rfm && !rfc_ctx->rfm ) || ( rp && !rfc_ctx->rp ) || ( lc && !rfc_ctx->lc ) )
     {
         return false;
     }
-    else
+
+    seq = rfc_ctx->snapshot_seq;
+    n   = rfc_ctx->class_count;
+
+    for(;;)
     {
-        int i;
+        long seq_begin = SNAPSHOT_LOAD_ACQUIRE( seq );
 
-        for( i = 0; i < (int)class_count; i++ )
+        if( !( seq_begin & 1 ) )
         {
-            /* Matrix diagonal must be all zero */
-            if( rfm[ MAT_OFFS( i, i ) ] != 0 )
+            if( damage ) *damage = rfc_ctx->damage;
+            if( rfm )    memcpy( rfm, rfc_ctx->rfm, sizeof(rfc_counts_t) * n * n );
+            if( rp )     memcpy( rp,  rfc_ctx->rp,  sizeof(rfc_counts_t) * n );
+            if( lc )
             {
-                return false;
+                /* Level crossings pending in the difference array included */
+                rfc_counts_t sum = 0;
+                size_t       i;
+
+                for( i = 0; i < n; i++ )
+                {
+                    sum  += rfc_ctx->internal.lc_diff[i];
+                    lc[i] = rfc_ctx->lc[i] + sum;
+                }
+            }
+
+            SNAPSHOT_FENCE_ACQUIRE();
+
+            if( SNAPSHOT_LOAD_RELAXED( seq ) == seq_begin )
+            {
+                return true;
             }
         }
+
+        /* Writer is updating the results */
+        SNAPSHOT_YIELD();
     }
-    return true;
 }
 
 
 /**
- * @brief      Repeat countings basen on given rainflow matrix
+ * @brief      Open an update of the counting results for snapshot readers.
  *
- * @param      ctx              The rainflow context
- * @param[in]  new_hysteresis   The new hysteresis
- * @param[in]  new_class_param  The new class parameter, may be NULL
+ * @param      rfc_ctx  The rainflow context
  *
- * @return     true on success
+ * @return     true, if opened (snapshots enabled and no update opened by
+ *             a calling function)
  */
-bool RFC_rfm_refeed( void *ctx, rfc_value_t new_hysteresis, const rfc_class_param_s *new_class_param )
+static
+bool snapshot_begin( rfc_ctx_s *rfc_ctx )
 {
-    rfc_class_param_s old_class_param;
-    rfc_value_tuple_s from = {0}, 
-                      to   = {0};
-    rfc_rfm_item_s   *buffer;
-    unsigned          count, i;
-    rfc_counts_t      j;
-
-    RFC_CTX_CHECK_AND_ASSIGN
+    long *seq = rfc_ctx->snapshot_seq;
 
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    /* Only the writer modifies the counter, a plain read is sufficient */
+    if( !seq || ( *seq & 1 ) )
     {
         return false;
     }
 
-    if( !rfc_ctx->rfm || !rfc_ctx->class_count )
+    SNAPSHOT_STORE_RELAXED( seq, *seq + 1 );
+    SNAPSHOT_FENCE_RELEASE();
+
+    return true;
+}
+
+
+/**
+ * @brief      Close an update of the counting results, opened by
+ *             snapshot_begin().
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      opened   The result of snapshot_begin()
+ */
+static
+void snapshot_end( rfc_ctx_s *rfc_ctx, bool opened )
+{
+    if( opened )
     {
-        return RFC_clear_counts( rfc_ctx );
+        long *seq = rfc_ctx->snapshot_seq;
+
+        SNAPSHOT_STORE_RELEASE( seq, *seq + 1 );
     }
+}
 
-    if( !RFC_rfm_get( rfc_ctx, &buffer, &count ) )
+
+#define RFC_CHECKPOINT_VERSION      2           /* Format version of checkpoints */
+#define RFC_CHECKPOINT_ENDIAN_TAG   0x01020304  /* Byte order tag, read back in foreign byte order on other platforms */
+
+/* Checkpoint (de)serialization, one set of transfer functions for both directions */
+struct checkpoint
+{
+    unsigned char                      *data;                       /**< Checkpoint blob, NULL to determine the size only */
+    size_t                              size;                       /**< Size of the blob in bytes */
+    size_t                              pos;                        /**< Current position in the blob */
+    bool                                restore;                    /**< true, if fields are read from the blob */
+};
+
+
+/**
+ * @brief      Write a checkpoint of a live rainflow context. The checkpoint
+ *             holds the counting state (residue, interim turning point,
+ *             local extrema and slope, HCM stack, shadowed Woehler curve
+ *             parameters of "Miner consequent"), damage and histograms
+ *             (rfm, rp, lc) as a versioned binary blob, tagged with the
+ *             byte order. Parameters (classes, hysteresis, flags, Woehler
+ *             curve, amplitude transformation) aren't serialized, the
+ *             context to restore must be initialized alike. Contexts with
+ *             turning point storage or damage history aren't supported.
+ *             The context isn't modified, not even on failure.
+ *
+ * @param      ctx     The rainflow context
+ * @param[out] buffer  The buffer for the checkpoint (NULL to query the size)
+ * @param[in,out] size The buffer size in bytes, checkpoint size on return
+ *
+ * @return     true on success
+ */
+bool RFC_checkpoint_write( const void *ctx, void *buffer, size_t *size )
+{
+    struct checkpoint   cp = { NULL, 0, 0, false };
+    const rfc_ctx_s    *rfc_ctx = (const rfc_ctx_s*)ctx;
+    rfc_ctx_s           shadow;
+
+    if( !rfc_ctx || rfc_ctx->version != sizeof(rfc_ctx_s) || !size )
     {
         return false;
     }
 
-    if( !RFC_clear_counts( rfc_ctx ) )
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state == RFC_STATE_ERROR )
     {
         return false;
     }
 
-    if( !RFC_class_param_get( rfc_ctx, &old_class_param ) )
+    if( rfc_ctx->rfm_sparse ) return false;
+#if RFC_TP_SUPPORT
+    if( rfc_ctx->tp ) return false;
+#endif /*RFC_TP_SUPPORT*/
+#if RFC_DH_SUPPORT
+    if( rfc_ctx->dh ) return false;
+#endif /*RFC_DH_SUPPORT*/
+
+    /* Fields are read from a shallow copy, holding the impaired Woehler curve */
+    shadow = *rfc_ctx;
+    if( rfc_ctx->internal.mk.pending )
     {
-        return false;
+        mk_flushed( rfc_ctx, &shadow.internal.wl );
     }
 
-#if RFC_DAMAGE_FAST
-    if( new_class_param && 
-        ( !RFC_class_param_set( rfc_ctx, new_class_param ) ||
-          !damage_lut_init( rfc_ctx ) ) )
-#else /*!RFC_DAMAGE_FAST*/
-    if( new_class_param && 
-        !RFC_class_param_set( rfc_ctx, new_class_param ) )
-#endif /*RFC_DAMAGE_FAST*/
+    /* Determine the size */
+    (void)checkpoint_xfer( &cp, &shadow );
+
+    if( !buffer )
     {
-        return false;
+        *size = cp.pos;
+        return true;
     }
 
-    rfc_ctx->hysteresis = new_hysteresis;
-
-    for( i = 0; i < count; i++ )
+    if( *size < cp.pos )
     {
-        from.value = old_class_param.width * buffer[i].from + old_class_param.offset + old_class_param.width / 2;
-        from.cls   = QUANTIZE( rfc_ctx, from.value );
-        to.value   = old_class_param.width * buffer[i].to   + old_class_param.offset + old_class_param.width / 2;
-        to.cls     = QUANTIZE( rfc_ctx, to.value );
-
-        for( j = 0; j < buffer[i].counts; j+= rfc_ctx->full_inc )
-        {
-            cycle_process_counts( rfc_ctx, &from, &to, /*next*/ NULL, rfc_ctx->internal.flags );
-        }
+        *size = cp.pos;
+        return false;
     }
 
-    return true;
+    cp.data = (unsigned char*)buffer;
+    cp.size = cp.pos;
+    cp.pos  = 0;
+
+    *size = cp.size;
+
+    return checkpoint_xfer( &cp, &shadow );
 }
 
 
 /**
- * @brief      Get level crossing histogram
+ * @brief      Restore a rainflow context from a checkpoint, written by
+ *             RFC_checkpoint_write(). The context has to be initialized
+ *             with the same parameters as the one checkpointed. Counting
+ *             continues as if it had never been interrupted.
  *
- * @param      ctx    The rainflow context
- * @param[out] lc     The buffer for LC histogram (counts), .full_inc represents one "count", space for 1..class_count values must be preserved!
- * @param[out] level  The buffer for LC upper class borders (dropped if NULL, otherwise space for 1..class_count values must be preserved!)
+ * @param      ctx     The rainflow context
+ * @param[in]  buffer  The checkpoint
+ * @param      size    The checkpoint size in bytes
  *
  * @return     true on success
  */
-bool RFC_lc_get( const void *ctx, rfc_counts_t *lc, rfc_value_t *level )
+bool RFC_checkpoint_read( void *ctx, const void *buffer, size_t size )
 {
-    unsigned i;
-    unsigned class_count;
+    struct checkpoint   cp = { NULL, 0, 0, true };
+    bool                snapshot, ok;
 
     RFC_CTX_CHECK_AND_ASSIGN
 
-    if( !lc )
+    if( !buffer )
     {
         return error_raise( rfc_ctx, RFC_ERROR_INVARG );
     }
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+
+    if( rfc_ctx->state < RFC_STATE_INIT )
     {
         return false;
     }
 
-    class_count = rfc_ctx->class_count;
-
-    if( !rfc_ctx->lc || !lc || !class_count )
+    if( rfc_ctx->rfm_sparse )
     {
-        return false;
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
+    }
+#if RFC_TP_SUPPORT
+    if( rfc_ctx->tp )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
+    }
+#endif /*RFC_TP_SUPPORT*/
+#if RFC_DH_SUPPORT
+    if( rfc_ctx->dh )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
     }
+#endif /*RFC_DH_SUPPORT*/
 
-    for( i = 0; i < class_count; i++ )
+    cp.data = (unsigned char*)buffer;
+    cp.size = size;
+
+    snapshot = snapshot_begin( rfc_ctx );
+    ok       = checkpoint_xfer( &cp, rfc_ctx );
+    RFM_SAT_INVALIDATE( rfc_ctx, 0 );
+    rfc_ctx->internal.mk.valid   = false;
+    rfc_ctx->internal.mk.pending = false;
+    snapshot_end( rfc_ctx, snapshot );
+
+    return ok ? true : error_raise( rfc_ctx, RFC_ERROR_INVARG );
+}
+
+
+/**
+ * @brief      Transfer a field from or to the checkpoint blob.
+ *
+ * @param      cp     The checkpoint
+ * @param      field  The field
+ * @param      size   The field size in bytes
+ *
+ * @return     true on success
+ */
+static
+bool checkpoint_field( struct checkpoint *cp, void *field, size_t size )
+{
+    if( cp->data )
     {
-        lc[i] = rfc_ctx->lc[i];
+        if( size > cp->size - cp->pos )
+        {
+            return false;
+        }
 
-        if( level )
+        if( cp->restore )
         {
-            level[i] = CLASS_UPPER( rfc_ctx, i );
+            memcpy( field, cp->data + cp->pos, size );
+        }
+        else
+        {
+            memcpy( cp->data + cp->pos, field, size );
         }
     }
 
+    cp->pos += size;
+
     return true;
 }
 
 
 /**
- * @brief      Create level crossing histogram from rainflow matrix
+ * @brief      Write a value to the checkpoint blob, or check it against
+ *             the blob on restore (header and parameters).
  *
- * @param      ctx     The rainflow context
- * @param[out] lc      The buffer for LC histogram (counts), .full_inc represents one "count", space for 1..class_count values must be preserved!
- * @param[out] level   The buffer for LC upper class borders (dropped if NULL, otherwise space for 1..class_count values must be preserved!)
- * @param[in]  rfm     The input rainflow matrix to use instead of ctx rfm, may be NULL
- * @param      flags   The flags
+ * @param      cp     The checkpoint
+ * @param      value  The value
+ * @param      size   The value size in bytes (8 at most)
+ *
+ * @return     true on success, false if the values differ
+ */
+static
+bool checkpoint_check( struct checkpoint *cp, const void *value, size_t size )
+{
+    unsigned char stored[8];
+
+    assert( size <= sizeof(stored) );
+
+    if( !cp->restore )
+    {
+        return checkpoint_field( cp, (void*)value, size );
+    }
+
+    return checkpoint_field( cp, stored, size ) && !memcmp( stored, value, size );
+}
+
+
+/**
+ * @brief      Write or restore a checkpoint, depending on cp->restore.
+ *             The order of the fields defines the checkpoint format.
+ *
+ * @param      cp       The checkpoint
+ * @param      rfc_ctx  The rainflow context
  *
  * @return     true on success
- * @note       Returned lc usually differs from .lc, when counting is finalized with any flag other than RFC_RES_NONE!
  */
-bool RFC_lc_from_rfm( const void *ctx, rfc_counts_t *lc, rfc_value_t *level, const rfc_counts_t *rfm, rfc_flags_e flags )
+static
+bool checkpoint_xfer( struct checkpoint *cp, rfc_ctx_s *rfc_ctx )
 {
-    unsigned             from, to, i;
-    unsigned             class_count;
-    bool                 up = flags & RFC_FLAGS_COUNT_LC_UP;
-    bool                 dn = flags & RFC_FLAGS_COUNT_LC_DN;
+    const char  magic[4]    = { 'R', 'F', 'C', 'K' };
+    uint32_t    endian      = RFC_CHECKPOINT_ENDIAN_TAG;
+    uint32_t    version     = RFC_CHECKPOINT_VERSION;
+    uint32_t    sizes[4]    = { (uint32_t)sizeof(size_t), (uint32_t)sizeof(rfc_value_t), 
+                                (uint32_t)sizeof(rfc_counts_t), (uint32_t)sizeof(rfc_value_tuple_s) };
+    uint64_t    size        = cp->size;
+    int         flags       = rfc_ctx->internal.flags;
+    int         method      = rfc_ctx->counting_method;
+    size_t      n           = rfc_ctx->class_count;
+    size_t      residue_n;
+#if RFC_HCM_SUPPORT
+    uint64_t    stack_cap   = rfc_ctx->internal.hcm.stack ? rfc_ctx->internal.hcm.stack_cap : 0;
+#endif /*RFC_HCM_SUPPORT*/
 
-    RFC_CTX_CHECK_AND_ASSIGN
+    /* Header */
+    if( !checkpoint_check( cp, magic,                      sizeof(magic) )                      ||
+        !checkpoint_check( cp, &endian,                    sizeof(endian) )                     ||
+        !checkpoint_check( cp, &version,                   sizeof(version) )                    ||
+        !checkpoint_check( cp, &sizes[0],                  sizeof(sizes[0]) )                   ||
+        !checkpoint_check( cp, &sizes[1],                  sizeof(sizes[1]) )                   ||
+        !checkpoint_check( cp, &sizes[2],                  sizeof(sizes[2]) )                   ||
+        !checkpoint_check( cp, &sizes[3],                  sizeof(sizes[3]) )                   ||
+        !checkpoint_check( cp, &size,                      sizeof(size) ) )
+    {
+        return false;
+    }
 
-    if( !lc )
+    /* Parameters have to match */
+    if( !checkpoint_check( cp, &flags,                     sizeof(flags) )                      ||
+        !checkpoint_check( cp, &method,                    sizeof(method) )                     ||
+        !checkpoint_check( cp, &rfc_ctx->class_count,      sizeof(rfc_ctx->class_count) )       ||
+        !checkpoint_check( cp, &rfc_ctx->class_width,      sizeof(rfc_ctx->class_width) )       ||
+        !checkpoint_check( cp, &rfc_ctx->class_offset,     sizeof(rfc_ctx->class_offset) )      ||
+        !checkpoint_check( cp, &rfc_ctx->hysteresis,       sizeof(rfc_ctx->hysteresis) )
+#if RFC_HCM_SUPPORT
+     || !checkpoint_check( cp, &stack_cap,                 sizeof(stack_cap) )
+#endif /*RFC_HCM_SUPPORT*/
+      )
     {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        return false;
     }
 
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    /* Residue, including the interim turning point */
+    residue_n = ( rfc_ctx->residue_cnt < rfc_ctx->residue_cap ) ? rfc_ctx->residue_cnt + 1 : rfc_ctx->residue_cap;
+
+    if( !checkpoint_field( cp, &residue_n,                 sizeof(residue_n) ) )
     {
         return false;
     }
 
-    if( !rfm )
+    if( residue_n > rfc_ctx->residue_cap )
     {
-        rfm = rfc_ctx->rfm;
+        return false;
     }
 
-    class_count = rfc_ctx->class_count;
-    
-    if( !rfm || !class_count )
+    if( !checkpoint_field( cp, &rfc_ctx->state,            sizeof(rfc_ctx->state) )             ||
+        !checkpoint_field( cp, &rfc_ctx->curr_inc,         sizeof(rfc_ctx->curr_inc) )          ||
+        !checkpoint_field( cp, &rfc_ctx->residue_cnt,      sizeof(rfc_ctx->residue_cnt) )       ||
+        !checkpoint_field( cp, rfc_ctx->residue,           sizeof(rfc_value_tuple_s) * residue_n ) )
     {
         return false;
     }
 
-    memset( lc, 0, sizeof(rfc_counts_t) * class_count );
+    if( rfc_ctx->residue_cnt > residue_n )
+    {
+        return false;
+    }
 
-    for( i = 0; i < class_count; i++ ) 
+    if( cp->restore )
     {
-        rfc_counts_t sum = 0;
+        residue_mirror_drop( rfc_ctx, 0 );
+    }
 
-        /* First index (0) counts crossings of upper class limit of the first class */
-        if( level )
-        {
-            level[i] = CLASS_UPPER( rfc_ctx, i );
-        }
-        
-        for( from = 0; from <= i; from++ )
-        {
-            for( to = i + 1; to < class_count; to++ )
-            {
-                /* One closed cycle has always a rising and a falling slope */
-                 
-                if( up )
-                {
-                    /* Count rising slopes */
-                    assert( sum < RFC_COUNTS_LIMIT - rfm[ MAT_OFFS( from, to ) ] );
-                    sum += rfm[ MAT_OFFS( from, to ) ];
+    /* Internal counting state */
+    if( !checkpoint_field( cp, &rfc_ctx->internal.slope,   sizeof(rfc_ctx->internal.slope) )    ||
+        !checkpoint_field( cp, rfc_ctx->internal.extrema,  sizeof(rfc_ctx->internal.extrema) )  ||
+#if RFC_GLOBAL_EXTREMA
+        !checkpoint_field( cp, &rfc_ctx->internal.extrema_changed, sizeof(rfc_ctx->internal.extrema_changed) ) ||
+#endif /*RFC_GLOBAL_EXTREMA*/
+        !checkpoint_field( cp, &rfc_ctx->internal.pos,     sizeof(rfc_ctx->internal.pos) )      ||
+        !checkpoint_field( cp, &rfc_ctx->internal.pos_offset, sizeof(rfc_ctx->internal.pos_offset) ) ||
+        !checkpoint_field( cp, &rfc_ctx->internal.wl,      sizeof(rfc_ctx->internal.wl) ) )
+    {
+        return false;
+    }
 
-                    assert( sum < RFC_COUNTS_LIMIT - rfm[ MAT_OFFS( from, to ) ] );
-                    sum += rfm[ MAT_OFFS( to, from ) ];
-                }
-                if( dn )
-                {
-                    /* Count falling slopes */
-                    assert( sum < RFC_COUNTS_LIMIT - rfm[ MAT_OFFS( from, to ) ] );
-                    sum += rfm[ MAT_OFFS( from, to ) ];
+#if RFC_TP_SUPPORT
+    if( !checkpoint_field( cp, rfc_ctx->internal.margin,   sizeof(rfc_ctx->internal.margin) )   ||
+        !checkpoint_field( cp, &rfc_ctx->internal.margin_stage, sizeof(rfc_ctx->internal.margin_stage) ) )
+    {
+        return false;
+    }
+#endif /*RFC_TP_SUPPORT*/
 
-                    assert( sum < RFC_COUNTS_LIMIT - rfm[ MAT_OFFS( from, to ) ] );
-                    sum += rfm[ MAT_OFFS( to, from ) ];
-                }
-            }
-        }
+#if RFC_HCM_SUPPORT
+    if( !checkpoint_field( cp, &rfc_ctx->internal.hcm.IR,  sizeof(rfc_ctx->internal.hcm.IR) )   ||
+        !checkpoint_field( cp, &rfc_ctx->internal.hcm.IZ,  sizeof(rfc_ctx->internal.hcm.IZ) ) )
+    {
+        return false;
+    }
+
+    if( stack_cap && !checkpoint_field( cp, rfc_ctx->internal.hcm.stack, sizeof(rfc_value_tuple_s) * (size_t)stack_cap ) )
+    {
+        return false;
+    }
+#endif /*RFC_HCM_SUPPORT*/
 
-        lc[i] = sum;
+    /* Results */
+    if( !checkpoint_field( cp, &rfc_ctx->damage,           sizeof(rfc_ctx->damage) )            ||
+        !checkpoint_field( cp, &rfc_ctx->damage_residue,   sizeof(rfc_ctx->damage_residue) ) )
+    {
+        return false;
     }
 
-    return true;
+    if( rfc_ctx->rfm && !checkpoint_field( cp, rfc_ctx->rfm, sizeof(rfc_counts_t) * n * n ) ) return false;
+    if( rfc_ctx->rp  && !checkpoint_field( cp, rfc_ctx->rp,  sizeof(rfc_counts_t) * n ) )     return false;
+    if( rfc_ctx->lc  && !checkpoint_field( cp, rfc_ctx->lc,  sizeof(rfc_counts_t) * n ) )     return false;
+    if( rfc_ctx->lc  && !checkpoint_field( cp, rfc_ctx->internal.lc_diff, sizeof(rfc_counts_t) * n ) ) return false;
+    if( rfc_ctx->lc  && !checkpoint_field( cp, &rfc_ctx->internal.lc_dirty, sizeof(rfc_ctx->internal.lc_dirty) ) ) return false;
+    if( rfc_ctx->damage_multi && !checkpoint_field( cp, rfc_ctx->damage_multi, sizeof(double) * rfc_ctx->damage_multi_count ) ) return false;
+
+    /* Whole blob consumed */
+    return !cp->data || cp->pos == cp->size;
 }
+#endif /*!RFC_MINIMAL*/
 
 
 /**
- * Calculate level crossing counts from rainflow matrix, write results to lc
- * histogram buffer.
+ * @brief      Process data samples (turning point pre-filter, quantization and
+ *             counting).
  *
- * @param      ctx          The rainflow context
- * @param[out] lc           The buffer for LC histogram (counts), .full_inc represents one "count", space for 1..class_count values must be preserved!
- * @param[out] level        The buffer for LC upper class borders (dropped if NULL, otherwise space for 1..class_count values must be preserved!)
- * @param[in]  residue      The residue to use instead of ctx residue (may be NULL)
- * @param[in]  residue_cnt  The length of the residue
- * @param      flags        The flags
+ * @param      rfc_ctx     The rainflow context
+ * @param[in]  data        The data
+ * @param      data_count  The data count
  *
  * @return     true on success
  */
-bool RFC_lc_from_residue( const void *ctx, rfc_counts_t *lc, rfc_value_t *level, const rfc_value_t* residue, unsigned residue_cnt, rfc_flags_e flags )
+static
+bool feed_values( rfc_ctx_s *rfc_ctx, const rfc_value_t * data, size_t data_count )
 {
-    rfc_value_tuple_s* residue_tuples;
-    unsigned i;
-    bool result;
+    bool ok = true;
 
-    RFC_CTX_CHECK_AND_ASSIGN
+    assert( rfc_ctx );
 
-    if( !residue || !residue_cnt )
+    /* Process data */
+    while( data_count )
     {
-        return RFC_lc_from_residue_tuples( ctx, lc, level, NULL, 0, flags );
-    }
+        unsigned    cls[RFC_FEED_BLOCK_SIZE];
+        size_t      count, valid, i;
+        bool        snapshot;
 
-    residue_tuples = (rfc_value_tuple_s*)CALLOC( residue_cnt, sizeof(rfc_value_tuple_s) );
+        /* Skip samples, that can't become turning points */
+        count       = feed_filter_block( rfc_ctx, data, data_count );
+        data       += count;
+        data_count -= count;
 
-    if( !residue_tuples )
-    {
-        return false;
-    }
+        if( !data_count ) break;
 
-    for( i = 0; i < residue_cnt; i++ )
-    {
-        residue_tuples[i].value = residue[i];
-        residue_tuples[i].cls   = QUANTIZE( rfc_ctx, residue[i] );
-        residue_tuples[i].pos   = 0;
-    }
+        /* Next sample is a turning point candidate, or (pre-filter inactive) feed a whole block */
+        count = feed_filter_block_apt( rfc_ctx ) ? 1 : ( data_count < RFC_FEED_BLOCK_SIZE ? data_count : RFC_FEED_BLOCK_SIZE );
 
-    result = RFC_lc_from_residue_tuples( ctx, lc, level, residue_tuples, residue_cnt, flags );
+        /* Assign classes */
+        valid = quantize_block( rfc_ctx, data, count, cls );
 
-    FREE( residue_tuples );
+        /* Counts are published blockwise, snapshot readers don't have to wait for the whole feed */
+        snapshot = snapshot_begin( rfc_ctx );
 
-    return result;
+        for( i = 0; i < count; i++ )
+        {
+            rfc_value_tuple_s tp = { data[i] };  /* All other members are zero-initialized, see ISO/IEC 9899:TC3, 6.7.8 (21) */
+
+            /* Assign class and global position (base 1) */
+            tp.pos = ++rfc_ctx->internal.pos;
+            tp.cls = cls[i];
+
+            if( i == valid )
+            {
+#if !RFC_AR_SUPPORT
+                ok = error_raise( rfc_ctx, RFC_ERROR_DATA_OUT_OF_RANGE );
+                break;
+#else
+                if( !RFC_flags_check( rfc_ctx, RFC_FLAGS_AUTORESIZE, 0 ) )
+                {
+                    ok = error_raise( rfc_ctx, RFC_ERROR_DATA_OUT_OF_RANGE );
+                    break;
+                }
+
+                if( !autoresize( rfc_ctx, &tp ) )
+                {
+                    ok = false;
+                    break;
+                }
+
+                /* Class parameters have changed, remaining samples must be quantized again */
+                count = i + 1;
+#endif /*RFC_AR_SUPPORT*/
+            }
+
+            if( !feed_once( rfc_ctx, &tp, rfc_ctx->internal.flags ) )
+            {
+                ok = false;
+                break;
+            }
+        }
+
+        snapshot_end( rfc_ctx, snapshot );
+
+        if( !ok ) return false;
+
+        data       += count;
+        data_count -= count;
+    }
+
+    return true;
 }
 
 
+#if !RFC_MINIMAL
 /**
- * Calculate level crossing counts from rainflow matrix, write results to lc
- * histogram buffer.
+ * @brief      Convert typed (or strided) data samples chunkwise into
+ *             rfc_value_t and process them. Chunks of RFC_FEED_CONVERT_SIZE
+ *             samples are converted into a local buffer, so the input
+ *             buffer is read only once in its native width.
  *
- * @param      ctx          The rainflow context
- * @param[out] lc           The buffer for LC histogram (counts), .full_inc represents one "count", space for 1..class_count values must be preserved!
- * @param[out] level        The buffer for LC upper class borders (dropped if NULL, otherwise space for 1..class_count values must be preserved!)
- * @param[in]  residue      The residue to use instead of ctx residue (may be NULL)
- * @param[in]  residue_cnt  The length of the residue
- * @param      flags        The flags
+ * @param      rfc_ctx     The rainflow context
+ * @param[in]  data        The data
+ * @param      data_type   The data type (FEED_DATA_TYPE_*)
+ * @param      data_count  The data count
+ * @param      stride      The stride (elements between two samples)
+ * @param      scale       The scale
+ * @param      offset      The offset
  *
  * @return     true on success
  */
-bool RFC_lc_from_residue_tuples( const void *ctx, rfc_counts_t* lc, rfc_value_t *level, const rfc_value_tuple_s *residue, unsigned residue_cnt, rfc_flags_e flags )
+static
+bool feed_converted( rfc_ctx_s *rfc_ctx, const void *data, int data_type, size_t data_count, size_t stride, double scale, double offset )
 {
-          unsigned           i;
-          unsigned           class_count;
-          bool               up   = flags & RFC_FLAGS_COUNT_LC_UP;
-          bool               dn   = flags & RFC_FLAGS_COUNT_LC_DN;
-    const rfc_value_tuple_s *from;
+    rfc_value_t buffer[RFC_FEED_CONVERT_SIZE];
 
-    RFC_CTX_CHECK_AND_ASSIGN
+    assert( rfc_ctx && stride );
 
-    if( !lc )
-    {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
-    }
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    if( data_count && !data ) return false;
+
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state >= RFC_STATE_FINISHED )
     {
         return false;
     }
 
-    if( !residue )
+#if RFC_DH_SUPPORT
+    if( rfc_ctx->dh && rfc_ctx->spread_damage_method >= RFC_SD_TRANSIENT_23 )
     {
-        residue     = rfc_ctx->residue;
-        residue_cnt = rfc_ctx->residue_cnt;
+        /* Transient damage spreading refers to the input stream, which has to be contiguous and of type rfc_value_t */
+        return error_raise( rfc_ctx, RFC_ERROR_DH_BAD_STREAM );
     }
+#endif /*RFC_DH_SUPPORT*/
 
-    class_count = rfc_ctx->class_count;
-
-    if( !residue || !class_count )
+    /* Process data */
+    while( data_count )
     {
-        return false;
-    }
-
-    memset( lc, 0, sizeof(rfc_counts_t) * class_count );
+        size_t i, count = ( data_count < RFC_FEED_CONVERT_SIZE ) ? data_count : RFC_FEED_CONVERT_SIZE;
 
-    if( level )
-    {
-        for( i = 0; i < class_count; i++ )
+        switch( data_type )
         {
-            level[i] = CLASS_UPPER( rfc_ctx, i );
-        }
-    }
+            case FEED_DATA_TYPE_VAL:
+            {
+                const rfc_value_t *in = (const rfc_value_t*)data;
 
-    from = residue;
-    for( i = 1; i < residue_cnt; i++ ) 
-    {
-        const rfc_value_tuple_s *to         = from + 1;
-              unsigned           class_from = from->cls;
-              unsigned           class_to   = to->cls;
+                for( i = 0; i < count; i++ )
+                {
+                    buffer[i] = in[i * stride];
+                }
+                data = in + count * stride;
+                break;
+            }
 
-        /* Level crossing, count rising and falling slopes.
-         * Level crossing histogram (vector storage)
-         * Counts class upper bound crossings
-         * Class upper bound value = (idx+1) * class_width + class_offset
-         */
-        if( class_from < class_to && up )
-        {
-            /* Count rising slopes */
-            unsigned idx;
-            for( idx = class_from; idx < class_to; idx++ )
+            case FEED_DATA_TYPE_F32:
             {
-                assert( lc[idx] <= RFC_COUNTS_LIMIT );
-                lc[idx] += rfc_ctx->full_inc;
+                const float *in = (const float*)data;
+
+                for( i = 0; i < count; i++ )
+                {
+                    buffer[i] = (rfc_value_t)( (double)in[i * stride] * scale + offset );
+                }
+                data = in + count * stride;
+                break;
             }
-        }
-        else if( class_to < class_from && dn )
-        {
-            /* Count falling slopes */
-            unsigned idx;
-            for( idx = class_to; idx < class_from; idx++ )
+
+            case FEED_DATA_TYPE_I16:
             {
-                assert( lc[idx] <= RFC_COUNTS_LIMIT );
-                lc[idx] += rfc_ctx->full_inc;
+                const int16_t *in = (const int16_t*)data;
+
+                for( i = 0; i < count; i++ )
+                {
+                    buffer[i] = (rfc_value_t)( (double)in[i * stride] * scale + offset );
+                }
+                data = in + count * stride;
+                break;
+            }
+
+            case FEED_DATA_TYPE_I32:
+            {
+                const int32_t *in = (const int32_t*)data;
+
+                for( i = 0; i < count; i++ )
+                {
+                    buffer[i] = (rfc_value_t)( (double)in[i * stride] * scale + offset );
+                }
+                data = in + count * stride;
+                break;
             }
+
+            default:
+                assert( false );
+                return false;
         }
 
-        from = to;
+        if( !feed_values( rfc_ctx, buffer, count ) ) return false;
+
+        data_count -= count;
     }
 
     return true;
@@ -2641,903 +3727,1149 @@ bool RFC_lc_from_residue_tuples( const void *ctx, rfc_counts_t* lc, rfc_value_t
 
 
 /**
- * @brief      Get range pair histogram
+ * @brief      Load the hot state of a bank channel from its context, if the
+ *             pre-filter applies.
  *
- * @param      ctx          The rainflow context
- * @param[out] rp           The histogram (counts), .full_inc represent one "cycle", space for 1..class_count values must be preserved!
- * @param[out] Sa           The amplitudes (dropped if NULL, otherwise space for 1..class_count values must be preserved!)
+ * @param      rfc_bank  The bank
+ * @param      channel   The channel
  *
- * @return     true on success
+ * @return     true, if the channel is pre-filtered from now on
  */
-bool RFC_rp_get( const void *ctx, rfc_counts_t *rp, rfc_value_t *Sa )
+static
+bool bank_load( rfc_bank_s *rfc_bank, size_t channel )
 {
-    unsigned i;
-    unsigned class_count;
-
-    RFC_CTX_CHECK_AND_ASSIGN
+    rfc_ctx_s *rfc_ctx;
 
-    if( !rp )
-    {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
-    }
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
-    {
-        return false;
-    }
+    assert( rfc_bank && channel < rfc_bank->channel_count );
 
-    class_count = rfc_ctx->class_count;
+    rfc_ctx = &rfc_bank->ctx[channel];
 
-    if( !rfc_ctx->rp || !rp || !class_count )
+    /* Channel must be in sync and share the class parameters (may have changed by autoresize) */
+    if( !feed_filter_block_apt( rfc_ctx )                  ||
+        rfc_ctx->internal.pos != rfc_bank->pos             ||
+        rfc_ctx->class_count  != rfc_bank->class_count     ||
+        rfc_ctx->class_width  != rfc_bank->class_width     ||
+        rfc_ctx->class_offset != rfc_bank->class_offset    ||
+        rfc_ctx->hysteresis   != rfc_bank->hysteresis )
     {
         return false;
     }
 
-    memset( rp, 0, sizeof(rfc_counts_t) * class_count );
-
-    for( i = 0; i < class_count; i++ )
-    {
-        rp[i] = rfc_ctx->rp[i];
-
-        if( Sa )
-        {
-            Sa[i] = rfc_ctx->class_width * i / 2;  /* range / 2 */
-        }
-    }
+    rfc_bank->soa.slope[channel]          = rfc_ctx->internal.slope;
+    rfc_bank->soa.interim[channel]        = rfc_ctx->residue[rfc_ctx->residue_cnt].value;
+    rfc_bank->soa.interim_pos[channel]    = 0;
+#if RFC_GLOBAL_EXTREMA
+    rfc_bank->soa.extrema[0][channel]     = rfc_ctx->internal.extrema[0].value;
+    rfc_bank->soa.extrema[1][channel]     = rfc_ctx->internal.extrema[1].value;
+    rfc_bank->soa.extrema_pos[0][channel] = 0;
+    rfc_bank->soa.extrema_pos[1][channel] = 0;
+#endif /*RFC_GLOBAL_EXTREMA*/
 
     return true;
 }
 
 
 /**
- * @brief      Generate range pair histogram from rainflow matrix
- *
- * @param      ctx          The rainflow context
- * @param[out] rp           The buffer for range pair counts (not cycles!), .full_inc represents one "cycle", space for 1..class_count values must be preserved!
- * @param[out] Sa           The buffer for amplitudes (dropped if NULL, otherwise space for 1..class_count values must be preserved!)
- * @param[in]  rfm          The input rainflow matrix to use instead of the ctx matrix (may be NULL)
- *
- * @return     true on success
+ * @brief      Store the hot state of a pre-filtered bank channel into its
+ *             context, exactly as feed_filter_block() does.
+ *
+ * @param      rfc_bank  The bank
+ * @param      channel   The channel
+ * @param      pos       The position of the last sample consumed
+ * @param[in]  last      The last sample consumed (NULL if none since
+ *                       bank_load())
  */
-bool RFC_rp_from_rfm( const void *ctx, rfc_counts_t *rp, rfc_value_t *Sa, const rfc_counts_t *rfm )
+static
+void bank_sync( rfc_bank_s *rfc_bank, size_t channel, size_t pos, const rfc_value_t *last )
 {
-    unsigned    i, j;
-    unsigned    class_count;
+    rfc_ctx_s *rfc_ctx;
+#if RFC_GLOBAL_EXTREMA
+    int        i;
+#endif /*RFC_GLOBAL_EXTREMA*/
 
-    RFC_CTX_CHECK_AND_ASSIGN
+    assert( rfc_bank && channel < rfc_bank->channel_count );
 
-    if( !rp )
-    {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
-    }
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
-    {
-        return false;
-    }
+    rfc_ctx = &rfc_bank->ctx[channel];
 
-    if( !rfm )
+    if( rfc_bank->soa.interim_pos[channel] )
     {
-        rfm = rfc_ctx->rfm;
-    }
+        rfc_value_tuple_s tp = { rfc_bank->soa.interim[channel] };
 
-    class_count = rfc_ctx->class_count;
+        tp.pos = rfc_bank->soa.interim_pos[channel];
+        tp.cls = QUANTIZE( rfc_ctx, tp.value );
+        rfc_ctx->residue[rfc_ctx->residue_cnt] = tp;
+        rfc_bank->soa.interim_pos[channel] = 0;
+    }
 
-    if( !rfm || !class_count )
+#if RFC_GLOBAL_EXTREMA
+    for( i = 0; i < 2; i++ )
     {
-        return false;
-    }
+        if( rfc_bank->soa.extrema_pos[i][channel] )
+        {
+            rfc_value_tuple_s tp = { rfc_bank->soa.extrema[i][channel] };
 
-    memset( rp, 0, sizeof(rfc_counts_t) * class_count );
+            tp.pos = rfc_bank->soa.extrema_pos[i][channel];
+            tp.cls = QUANTIZE( rfc_ctx, tp.value );
+            rfc_ctx->internal.extrema[i]      = tp;
+            rfc_ctx->internal.extrema_changed = true;
+            rfc_bank->soa.extrema_pos[i][channel] = 0;
+        }
+    }
+#endif /*RFC_GLOBAL_EXTREMA*/
 
-    for( i = 0; i < class_count; i++ ) 
+    if( pos > rfc_ctx->internal.pos )
     {
-        rfc_counts_t sum = (rfc_counts_t)0;
+        assert( last );
 
-        if( Sa )
+#if RFC_TP_SUPPORT
+        if( ( rfc_ctx->internal.flags & RFC_FLAGS_ENFORCE_MARGIN ) && !rfc_ctx->tp_locked )
         {
-            Sa[i] = rfc_ctx->class_width * i / 2;  /* range / 2 */
-        }
+            rfc_value_tuple_s tp = { *last };
 
-        for( j = i; j < class_count; j++ ) 
-        {
-            /* Count rising and falling slopes */
-            assert( sum < ( RFC_COUNTS_LIMIT - rfm[ MAT_OFFS( j-i, j ) ] - rfm[ MAT_OFFS( j, j-i ) ] ) );
-            sum += rfm[ MAT_OFFS( j-i, j ) ];
-            sum += rfm[ MAT_OFFS( j, j-i ) ];
+            tp.pos = pos;
+            tp.cls = QUANTIZE( rfc_ctx, tp.value );
+            rfc_ctx->internal.margin[1] = tp;
         }
+#endif /*RFC_TP_SUPPORT*/
 
-        rp[i] = sum;
+        rfc_ctx->internal.pos = pos;
     }
-
-    return true;
 }
 
 
 /**
- * @brief      Return cumulated damage
+ * @brief      Number of workers for RFC_batch().
  *
- * @param      ctx             The rainflow context
- * @param[out] damage          The buffer for cumulated damage (including damage from residue)
- * @param[out] damage_residue  The buffer for partial damage from residue
+ * @param      thread_count  The number of workers requested (0: one per
+ *                           processor)
  *
- * @return     true on success
+ * @return     The number of workers
  */
-bool RFC_damage( const void *ctx, rfc_value_t *damage, rfc_value_t *damage_residue )
+static
+unsigned batch_thread_count( unsigned thread_count )
 {
-    RFC_CTX_CHECK_AND_ASSIGN
-
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+#if RFC_USE_THREADS
+    if( !thread_count )
     {
-        return false;
-    }
+#if defined(_WIN32)
+        SYSTEM_INFO info;
 
-    if( damage )
-    {
-        *damage = rfc_ctx->damage;
-    }
+        GetSystemInfo( &info );
+        thread_count = (unsigned)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+        long count = sysconf( _SC_NPROCESSORS_ONLN );
 
-    if( damage_residue )
-    {
-        *damage_residue = rfc_ctx->damage_residue;
+        thread_count = ( count > 0 ) ? (unsigned)count : 1;
+#endif /*_WIN32*/
     }
+#else /*!RFC_USE_THREADS*/
+    thread_count = 1;
+#endif /*RFC_USE_THREADS*/
 
-    return true;
+    if( thread_count < 1 )                     thread_count = 1;
+    if( thread_count > RFC_BATCH_THREADS_MAX ) thread_count = RFC_BATCH_THREADS_MAX;
+
+    return thread_count;
 }
 
 
 /**
- * @brief      Calculate the damage from a range pair histogram
+ * @brief      Claim the next chunk of pending series of a batch job.
  *
- * @param      ctx             The rainflow context
- * @param[out] damage          The buffer for cumulated damage
- * @param[in]  rp              The range pair counts to use instead of ctx rp, may be NULL (Mind that
- *                             full_inc describes 1 cycle!), space for 1..class_count values must be preserved!
- * @param[in]  Sa              The buffer for amplitudes respective rp, may be
- *                             NULL, space for 1..class_count values must be preserved!
- * @param      rp_calc_method  The rp calculate method
- *                             (RFC_RP_DAMAGE_CALC_METHOD_*)
+ * @param      job    The batch job
+ * @param[out] first  The first series claimed
+ * @param[out] last   The series following the last one claimed
  *
- * @return     true on success
+ * @return     false, if no series are pending (or an error occurred)
  */
-bool RFC_damage_from_rp( const void *ctx, double *damage, const rfc_counts_t *rp, const rfc_value_t *Sa, rfc_rp_damage_method_e rp_calc_method )
+static
+bool batch_claim( struct batch_job *job, size_t *first, size_t *last )
 {
-    const unsigned    from = 0;
-          unsigned    class_count;
-          double      D;             /* Cumulative damage */
-          int         i, j;
+    bool ok;
 
-    RFC_CTX_CHECK_AND_ASSIGN
+    BATCH_LOCK( job );
 
-    if( !damage )
+    ok = job->error == RFC_ERROR_NOERROR && job->next < job->series_count;
+    if( ok )
     {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        *first     = job->next;
+        *last      = ( job->series_count - job->next > job->chunk ) ? job->next + job->chunk : job->series_count;
+        job->next  = *last;
     }
 
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    BATCH_UNLOCK( job );
+
+    return ok;
+}
+
+
+/**
+ * @brief      Batch worker: Count series claimed from a batch job, reusing one
+ *             context.
+ *
+ * @param      job   The batch job
+ */
+static
+void batch_worker( struct batch_job *job )
+{
+    const rfc_ctx_s    *proto       = job->proto;
+    rfc_ctx_s           rfc_ctx     = { sizeof(rfc_ctx_s) };
+    size_t              n           = (size_t)proto->class_count * proto->class_count;
+    rfc_error_e         error       = RFC_ERROR_NOERROR;
+    rfc_wl_param_s      wl_param;
+    size_t              first, last, i;
+
+    rfc_ctx.mem_alloc = proto->mem_alloc;
+
+    if( RFC_init( &rfc_ctx, proto->class_count, proto->class_width, proto->class_offset, proto->hysteresis, proto->internal.flags ) )
     {
-        return false;
+#if RFC_AT_SUPPORT
+        /* Amplitude transformation (before the Woehler curve, which rebuilds the damage look-up table) */
+        rfc_ctx.at                = proto->at;
+        rfc_ctx.internal.at_haigh = proto->internal.at_haigh;
+
+        if( proto->at.Sa == proto->internal.at_haigh.Sa )
+        {
+            /* Standard reference curve, held by each context */
+            rfc_ctx.at.Sa = rfc_ctx.internal.at_haigh.Sa;
+            rfc_ctx.at.Sm = rfc_ctx.internal.at_haigh.Sm;
+        }
+#endif /*RFC_AT_SUPPORT*/
+#if RFC_USE_DELEGATES && RFC_DEBUG_FLAGS
+        rfc_ctx.debug_vfprintf_fcn = proto->debug_vfprintf_fcn;
+#endif /*RFC_USE_DELEGATES && RFC_DEBUG_FLAGS*/
     }
 
-    if( !rp )
+    if( rfc_ctx.state != RFC_STATE_INIT ||
+        !RFC_wl_param_get( proto, &wl_param ) || !RFC_wl_init_any( &rfc_ctx, &wl_param ) )
     {
-        rp = rfc_ctx->rp;
+        error = ( rfc_ctx.error != RFC_ERROR_NOERROR ) ? rfc_ctx.error : RFC_ERROR_MEMORY;
     }
+    else
+    {
+        rfc_ctx.counting_method = proto->counting_method;
 
-    class_count = rfc_ctx->class_count;
+        while( error == RFC_ERROR_NOERROR && batch_claim( job, &first, &last ) )
+        {
+            for( i = first; i < last; i++ )
+            {
+                if( !RFC_clear_counts( &rfc_ctx ) ||
+                    !RFC_feed( &rfc_ctx, job->data[i], job->data_count[i] ) ||
+                    !RFC_finalize( &rfc_ctx, job->residual_method ) )
+                {
+                    error = ( rfc_ctx.error != RFC_ERROR_NOERROR ) ? rfc_ctx.error : RFC_ERROR_UNEXP;
+                    break;
+                }
 
-    if( !rp || !class_count )
+                if( job->damage )
+                {
+                    job->damage[i] = rfc_ctx.damage;
+                }
+
+                if( job->rfm )
+                {
+                    if( rfc_ctx.rfm_sparse )
+                    {
+                        rfm_sparse_expand( rfc_ctx.rfm_sparse, job->rfm + i * n, rfc_ctx.class_count );
+                    }
+                    else
+                    {
+                        memcpy( job->rfm + i * n, rfc_ctx.rfm, n * sizeof(rfc_counts_t) );
+                    }
+                }
+
+                if( job->rp )
+                {
+                    memcpy( job->rp + i * proto->class_count, rfc_ctx.rp, proto->class_count * sizeof(rfc_counts_t) );
+                }
+            }
+        }
+    }
+
+    if( rfc_ctx.state >= RFC_STATE_INIT )
     {
-        return false;
+        RFC_deinit( &rfc_ctx );
     }
 
-    /* Sa must be sorted in ascending order */
-    for( i = 1; Sa && i < (int)class_count; i++ )
+    if( error != RFC_ERROR_NOERROR )
     {
-        if( Sa[i] < Sa[i-1] )
+        BATCH_LOCK( job );
+        if( job->error == RFC_ERROR_NOERROR )
         {
-            return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+            job->error = error;
         }
+        BATCH_UNLOCK( job );
     }
+}
 
-    D = 0.0;
 
-    /* Calculate the "Miner Consequent" approach */
-    if( rp_calc_method == RFC_RP_DAMAGE_CALC_METHOD_CONSEQUENT )
-    {
-        rfc_wl_param_s      wl;
-        double              q     = rfc_ctx->wl_q;   /* Fatigue strength depression exponent */
-        double              Sd    = rfc_ctx->wl_sd;  /* Fatigue strength SD for the unimpaired(!) part */
-        double              Nd    = rfc_ctx->wl_nd;  /* Fatigue strength cycle count ND for the unimpaired(!) part */
-        double              Sj    = Sd;              /* Current fatigue strength, impacted part */
-        double              D_inv = 0.0;             /* The inverse damage */
-        bool                ok    = true;
-
-        /* Omission not allowed here! */
-        if( rfc_ctx->wl_omission > 0.0 )
-        {
-            return error_raise( rfc_ctx, RFC_ERROR_INVARG );
-        }
+/**
+ * @brief      Do countings for a given cycle
+ *
+ * @param      ctx       The rainflow context
+ * @param[in]  from_val  The from value
+ * @param[in]  to_val    The to value
+ * @param[in]  flags     The flags
+ *
+ * @return     true on success
+ */
+bool RFC_cycle_process_counts( void *ctx, rfc_value_t from_val, rfc_value_t to_val, rfc_flags_e flags )
+{
+    rfc_value_tuple_s from = {from_val}, to = {to_val};
+    bool snapshot;
+    RFC_CTX_CHECK_AND_ASSIGN
 
-        /* Backup WL parameters */
-        RFC_wl_param_get( rfc_ctx, &wl );
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state >= RFC_STATE_FINISHED )
+    {
+        return false;
+    }
 
-        /* Remove fatigue strength temporarily */
-        rfc_ctx->wl_sd = 0.0;
-        rfc_ctx->wl_nd = DBL_MAX;
+    from.cls = QUANTIZE( rfc_ctx, from_val );
+    to.cls   = QUANTIZE( rfc_ctx, to_val );
 
-        for( j = (int)class_count - 1; j >= -1 && ok; j-- )
-        {
-            double D_j = 0.0;  /* Damage for partial histogram */
-            double Sa_j;       /* New fatigue strength */
-            double weight;     /* Weight for partial histogram */
+    snapshot = snapshot_begin( rfc_ctx );
+    cycle_process_counts( rfc_ctx, &from, &to, /*next*/ NULL, flags );
+    snapshot_end( rfc_ctx, snapshot );
 
-            /* Get the new degraded fatigue strength in Sa_j */
-            if( j >= 0 )
-            {
-                Sa_j = Sa ? Sa[j] : AMPLITUDE( rfc_ctx, j );
-            }
-            else
-            {
-                Sa_j = 0.0;
-            }
+    return true;
+}
 
-            /* Forward until amplitude is below fatigue strength SD for the unimpaired part */
-            if( Sa_j >= Sd && Sd > 0.0 ) continue;
 
-            /**
-             *  The following lines of code reflect the original formulas as in [6] 3.2.11 and 3.2-59.
-             *  This realization resolves his approach to use partial damages instead of particular cycles from the histogram.
-             *  This procedure benefits from inserting an abstraction layer, which permits to use any representation of 
-             *  a Woehler curve with a given fatigue strength limit providing a damage per cycle representation. 
-             *  Note that the Miner Consequent approach, in contrast to Original/Elementary/Modified, is unsuitable when using 
-             *  an inappropriate Woehler curve, to estimate so called "pseudo damages".
-             */
+/**
+ * @brief      Do countings for a number of identical cycles at once
+ *
+ * @param      ctx       The rainflow context
+ * @param[in]  from_val  The from value
+ * @param[in]  to_val    The to value
+ * @param[in]  flags     The flags
+ * @param[in]  cycles    The number of cycles
+ *
+ * @return     true on success
+ */
+bool RFC_cycle_process_counts_weighted( void *ctx, rfc_value_t from_val, rfc_value_t to_val, rfc_flags_e flags, rfc_counts_t cycles )
+{
+    rfc_value_tuple_s from = {from_val}, to = {to_val};
+    bool snapshot;
+    RFC_CTX_CHECK_AND_ASSIGN
 
-            /* Weighted damage */
-            weight = pow( Sj / Sd, q ) - pow( Sa_j / Sd, q );
-            Sj     = Sa_j;
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state >= RFC_STATE_FINISHED )
+    {
+        return false;
+    }
 
-            if( weight <= 0.0 ) continue;
+    from.cls = QUANTIZE( rfc_ctx, from_val );
+    to.cls   = QUANTIZE( rfc_ctx, to_val );
 
-            /* Calculate damage for partial histogram */
-            for( i = (int)class_count - 1; i > j; i-- )
-            {
-                double Sa_i = Sa ? Sa[i] : AMPLITUDE( rfc_ctx, i );
-                double D_i;
-                
-                if( !damage_calc_amplitude( rfc_ctx, Sa_i, &D_i ) )
-                {
-                    ok = false;
-                    break;
-                }
+    snapshot = snapshot_begin( rfc_ctx );
+    cycle_process_counts_weighted( rfc_ctx, &from, &to, /*next*/ NULL, flags, cycles );
+    snapshot_end( rfc_ctx, snapshot );
 
-                D_j += D_i * rp[i];
-            }
+    return true;
+}
 
-            if( D_j > 0.0 )
-            {
-                D_inv += weight / D_j;
-            }
-        }
 
-        /* Restore WL parameters */
-        RFC_wl_param_set( rfc_ctx, &wl );
+/**
+ * @brief      "Feed" counting algorithm with data samples, scaled by a factor
+ *             (consecutive calls allowed).
+ *
+ * @param      ctx         The rainflow context
+ * @param[in]  data        The data
+ * @param      data_count  The data count
+ * @param      factor      The factor
+ *
+ * @return     true on success
+ */
+bool RFC_feed_scaled( void *ctx, const rfc_value_t * data, size_t data_count, double factor )
+{
+    bool snapshot, ok;
+    RFC_CTX_CHECK_AND_ASSIGN
 
-        if( !ok ) return false;
+    if( data_count && !data ) return false;
 
-        /* Get the final damage value */
-        D = 1.0 / D_inv;
-    }
-    else if( rp_calc_method == RFC_RP_DAMAGE_CALC_METHOD_ELEMENTAR )
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state >= RFC_STATE_FINISHED )
     {
-        rfc_wl_param_s  wl;
-        bool ok;
+        return false;
+    }
 
-        (void)RFC_wl_param_get( rfc_ctx, &wl );
+    /* Process data */
+    while( data_count-- )
+    {
+        rfc_value_tuple_s tp = { *data++ * factor };  /* All other members are zero-initialized, see ISO/IEC 9899:TC3, 6.7.8 (21) */
 
-        rfc_ctx->wl_sd = 0.0;
-        rfc_ctx->wl_nd = DBL_MAX;
-        rfc_ctx->wl_k2 = rfc_ctx->wl_k;
-        rfc_ctx->wl_q2 = rfc_ctx->wl_q2;
+        /* Assign class and global position (base 1) */
+        tp.cls = QUANTIZE( rfc_ctx, tp.value );
+        tp.pos = ++rfc_ctx->internal.pos;
 
-#if RFC_DAMAGE_FAST
+        if( rfc_ctx->class_count && ( tp.cls >= rfc_ctx->class_count || tp.value < rfc_ctx->class_offset ) )
         {
-            rfc_ctx->damage_lut_inapt++;
-            ok = RFC_damage_from_rp( rfc_ctx, damage, rp, Sa, RFC_RP_DAMAGE_CALC_METHOD_DEFAULT );
-            rfc_ctx->damage_lut_inapt--;
+#if RFC_FLAGS_AUTORESIZE
+            if( RFC_flags_check( ctx, RFC_FLAGS_AUTORESIZE, 0 ) && !autoresize( ctx, &tp ) )
+            {
+                return false;
+            }
+            else
+#endif /*RFC_FLAGS_AUTORESIZE*/
+            {
+                return error_raise( rfc_ctx, RFC_ERROR_DATA_OUT_OF_RANGE );
+            }
         }
-#else /*!RFC_DAMAGE_FAST*/
-        ok = RFC_damage_from_rp( rfc_ctx, damage, rp, Sa, RFC_RP_DAMAGE_CALC_METHOD_DEFAULT );
-#endif /*RFC_DAMAGE_FAST*/
-
-        (void)RFC_wl_param_set( rfc_ctx, &wl );
+        
+        snapshot = snapshot_begin( rfc_ctx );
+        ok       = feed_once( rfc_ctx, &tp, rfc_ctx->internal.flags );
+        snapshot_end( rfc_ctx, snapshot );
 
-        return ok;
+        if( !ok ) return false;
     }
-    else if( rp_calc_method == RFC_RP_DAMAGE_CALC_METHOD_MODIFIED)
-    {
-        rfc_wl_param_s wl;
-        bool ok;
 
-        (void)RFC_wl_param_get( rfc_ctx, &wl );
+    return true;
+}
 
-        rfc_ctx->wl_sd = 0.0;
-        rfc_ctx->wl_nd = DBL_MAX;
 
-#if RFC_DAMAGE_FAST
-        {
-            rfc_ctx->damage_lut_inapt++;
-            ok = RFC_damage_from_rp( rfc_ctx, damage, rp, Sa, RFC_RP_DAMAGE_CALC_METHOD_DEFAULT );
-            rfc_ctx->damage_lut_inapt--;
-        }
-#else /*!RFC_DAMAGE_FAST*/
-        ok = RFC_damage_from_rp( rfc_ctx, damage, rp, Sa, RFC_RP_DAMAGE_CALC_METHOD_DEFAULT );
-#endif /*RFC_DAMAGE_FAST*/
+/**
+ * @brief         Feed counting algorithm with data tuples (tp_pos is kept maintaining). 
+ *
+ * @param         ctx         The rainflow context
+ * @param[in,out] data        The data tuples
+ * @param         data_count  The data count
+ *
+ * @return        true on success
+ */
+bool RFC_feed_tuple( void *ctx, rfc_value_tuple_s *data, size_t data_count )
+{
+    bool snapshot, ok;
+    RFC_CTX_CHECK_AND_ASSIGN
 
-        (void)RFC_wl_param_set( rfc_ctx, &wl );
+    if( data_count && !data ) return false;
 
-        return ok;
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state >= RFC_STATE_FINISHED )
+    {
+        return false;
     }
-    else if( rp_calc_method == RFC_RP_DAMAGE_CALC_METHOD_DEFAULT )
+
+    /* Process data */
+    while( data_count-- )
     {
-        for( i = 0; i < (int)class_count; i++ )
+        if( rfc_ctx->class_count && ( data->cls >= rfc_ctx->class_count || data->value < rfc_ctx->class_offset ) )
         {
-            if( rp[i] )
-            {
-                double D_i;
+#if RFC_FLAGS_AUTORESIZE
+            unsigned cls = QUANTIZE( ctx, data->value );
 
-                if( Sa )
-                {
-                    if( !damage_calc_amplitude( rfc_ctx, Sa[i], &D_i ) )
-                    {
-                        return false;
-                    }
-                    D += D_i * rp[i];
-                }
-                else
-                {
-                    if( !damage_calc( rfc_ctx, from, i /*to*/, &D_i, NULL /*Sa_ret*/ ) )
-                    {
-                        return false;
-                    }
-                    D += D_i * rp[i];
-                }
+            if( data->cls != cls )
+            {
+                return error_raise( rfc_ctx, RFC_ERROR_DATA_INCONSISTENT );
+            }
+            else
+#endif /*RFC_FLAGS_AUTORESIZE*/
+            {
+                return error_raise( rfc_ctx, RFC_ERROR_DATA_OUT_OF_RANGE );
             }
         }
+        
+        snapshot = snapshot_begin( rfc_ctx );
+        ok       = feed_once( rfc_ctx, data++, rfc_ctx->internal.flags );
+        snapshot_end( rfc_ctx, snapshot );
+
+        if( !ok ) return false;
     }
-    else return false;
 
-    *damage = D / rfc_ctx->full_inc;
     return true;
 }
 
 
 /**
- * @brief      Calculate the damage from rainflow matrix
- *
- * @param      ctx     The rainflow context
- * @param[out] damage  The buffer for cumulated damage
- * @param[in]  rfm     The input rainflow matrix to use instead of ctx rfm (may be NULL), .full_inc represents one "cycle"!
+ * @brief      Merge a context, that has counted the segment immediately
+ *             following the segment counted in ctx (divide and conquer).
+ *             The residue of ctx_src (and its interim turning point) is fed
+ *             into ctx, closing the cycles across the joint, and the
+ *             countings of ctx_src are added. The cost depends on the
+ *             residue length and the class count only, not on the segment
+ *             length. ctx_src remains unchanged.
+ *             Compared to counting both segments sequentially in ctx, the
+ *             following is equal: residue values and classes, interim
+ *             turning point, global extrema, position, range pair (rp) and
+ *             level crossing (lc) counts, the ranges of all cycles counted
+ *             and so the damage (up to the order of summation).
+ *             On class ties the 4 point method pairs turning points
+ *             depending on the whole history, which is not kept in the
+ *             residue of ctx_src. So a cycle may be counted in the
+ *             transposed cell of the rainflow matrix (from/to swapped, the
+ *             sum of rfm and its transpose is equal) and a residue turning
+ *             point may be kept from an earlier position of equal value.
+ *             Both contexts must share class parameters, hysteresis and
+ *             flags and must not be finalized. Turning point storage,
+ *             damage history, enforced margins, Miner consequent
+ *             (RFC_FLAGS_COUNT_MK) and counting methods other than 4PTM are
+ *             not supported.
+ *
+ * @param      ctx      The rainflow context (preceding segment)
+ * @param[in]  ctx_src  The rainflow context (following segment)
  *
  * @return     true on success
  */
-bool RFC_damage_from_rfm( const void *ctx, double *damage, const rfc_counts_t *rfm )
+bool RFC_merge( void *ctx, const void *ctx_src )
 {
-    unsigned    from, to;
-    unsigned    class_count;
-    double      D;
+    const rfc_ctx_s    *rfc_src = (const rfc_ctx_s*)ctx_src;
+    rfc_value_tuple_s   tp_head[2];
+    size_t              pos_offset, count, i;
+    bool                snapshot;
+    int                 flags;
 
     RFC_CTX_CHECK_AND_ASSIGN
 
-    if( !damage )
+    if( !rfc_src || rfc_src == rfc_ctx || rfc_src->version != sizeof(rfc_ctx_s) )
     {
         return error_raise( rfc_ctx, RFC_ERROR_INVARG );
     }
-    
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state >= RFC_STATE_FINALIZE ||
+        rfc_src->state < RFC_STATE_INIT || rfc_src->state >= RFC_STATE_FINALIZE )
     {
         return false;
     }
 
-    if( !rfm )
+    flags = rfc_ctx->internal.flags;
+
+    /* Both segments must be counted the same way */
+    if( rfc_src->internal.flags     != flags                 ||
+        rfc_src->class_count    != rfc_ctx->class_count  ||
+        rfc_src->class_width    != rfc_ctx->class_width  ||
+        rfc_src->class_offset   != rfc_ctx->class_offset ||
+        rfc_src->hysteresis     != rfc_ctx->hysteresis   ||
+        rfc_src->counting_method != rfc_ctx->counting_method ||
+        rfc_src->damage_multi_count != rfc_ctx->damage_multi_count ||
+       !rfc_src->damage_multi   != !rfc_ctx->damage_multi )
     {
-        rfm = rfc_ctx->rfm;
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
     }
 
-    class_count = rfc_ctx->class_count;
-
-    if( !rfm || !class_count )
+    /* Countings depending on the history of the whole stream can't be merged */
+    if( ( flags & ( RFC_FLAGS_COUNT_MK | RFC_FLAGS_ENFORCE_MARGIN ) ) ||
+        ( rfc_ctx->counting_method != RFC_COUNTING_METHOD_4PTM && rfc_ctx->counting_method != RFC_COUNTING_METHOD_NONE ) )
     {
-        return false;
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
     }
 
-    D = 0.0;
-    for( from = 0; from < class_count; from++ )
+#if RFC_TP_SUPPORT
+    if( rfc_ctx->tp || rfc_src->tp )
     {
-        for( to = 0; to < class_count; to++ )
-        {
-            if( rfm[ from * class_count + to ] )
-            {
-                double D_i;
-
-                if( !damage_calc( rfc_ctx, from, to, &D_i, NULL /*Sa_ret*/ ) )
-                {
-                    return false;
-                }
-                D += D_i * rfm[ MAT_OFFS( from, to ) ];
-            }
-        }
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
     }
+#endif /*RFC_TP_SUPPORT*/
 
-    *damage = D / rfc_ctx->full_inc;
-    return true;
-}
-
-
-/**
- * @brief      Calculate junction point between k and k2 for a Woehler curve
- *
- * @param      ctx   The rainflow context
- * @param      s0    Any point on slope k
- * @param      n0    Any point on slope k
- * @param      k     Slope k
- * @param[out] sx    Junction point between k and k2
- * @param      nx    Junction point between k and k2
- * @param      k2    Slope k2
- * @param      sd    The fatigue strength
- * @param      nd    The cycle count at sd
- *
- * @return     true on success
- */
-bool RFC_wl_calc_sx( const void *ctx, double s0, double n0, double k, double *sx, double nx, double k2, double sd, double nd )
-{
-    double nom, den;
-
-    k  = fabs(k);
-    k2 = fabs(k2);
-
-    if(    s0 <= 0.0    ||    n0 <= 0.0    ||
-        /* sx <= 0.0    || */ nx <= 0.0    ||
-           sd <= 0.0    ||    nd <= 0.0    ||    !sx )
+#if RFC_DH_SUPPORT
+    if( rfc_ctx->dh || rfc_src->dh )
     {
-        return false;
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
     }
+#endif /*RFC_DH_SUPPORT*/
 
-    nom = log(s0)*k - log(sd)*k2 + log(n0) - log(nd);
-    den = k - k2;
-
-    if( den == 0.0 ) return false;
-
-    *sx = exp( nom / den );
+#if RFC_USE_DELEGATES
+    if( rfc_ctx->tp_next_fcn || rfc_src->tp_next_fcn )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
+    }
+#endif /*RFC_USE_DELEGATES*/
 
-    return true;
-}
+    /* Positions in ctx_src continue the stream in ctx */
+    pos_offset = rfc_ctx->internal.pos;
 
+    if( rfc_src->state == RFC_STATE_BUSY )
+    {
+        /* No turning point found in ctx_src so far, its local extrema represent the segment */
+        const rfc_value_tuple_s *ext = rfc_src->internal.extrema;
 
-/**
- * @brief      Calculate fatigue strength for a Woehler curve
- *
- * @param      ctx   The rainflow context
- * @param      s0    Any point on slope k
- * @param      n0    Any point on slope k
- * @param      k     Slope k
- * @param      sx    Junction point between k and k2
- * @param      nx    The cycle
- * @param      k2    Slope k2
- * @param[out] sd    The fatigue strength
- * @param      nd    The cycle count at sd
- *
- * @return     true on success
- */
-bool RFC_wl_calc_sd( const void *ctx, double s0, double n0, double k, double sx, double nx, double k2, double *sd, double nd )
-{
-    double nom, den;
+        count = ( ext[0].pos == ext[1].pos ) ? 1 : 2;
+        i     = ( ext[0].pos > ext[1].pos ) ? 1 : 0;
 
-    k  = fabs(k);
-    k2 = fabs(k2);
+        tp_head[0]      = ext[i];
+        tp_head[1]      = ext[!i];
+        tp_head[0].pos += pos_offset;
+        tp_head[1].pos += pos_offset;
 
-    if(    s0 <= 0.0    ||    n0 <= 0.0    ||
-           sx <= 0.0    ||    nx <= 0.0    ||
-        /* sd <= 0.0    || */ nd <= 0.0    ||    !sd )
-    {
-        return false;
+        for( i = 0; i < count; i++ )
+        {
+            if( !feed_once( rfc_ctx, &tp_head[i], flags ) ) return false;
+        }
     }
+    else if( rfc_src->state == RFC_STATE_BUSY_INTERIM )
+    {
+        bool has_joint = false;
 
-    nom = log(s0)*k - log(sx)*(k-k2) + log(n0) - log(nd);
-    den = k2;
+        /* Residue of ctx_src and its interim turning point. Adjacent points differ by more than
+         * the hysteresis, so the filter keeps them all, except for the first one, that may be
+         * replaced by a turning point of ctx with greater amplitude. */
+        count = rfc_src->residue_cnt + 1;
 
-    if( den == 0.0 ) return false;
+        for( i = 0; i < count; i++ )
+        {
+            rfc_value_tuple_s tp = { 0 };
 
-    *sd = exp( nom / den );
+            tp.value = rfc_src->residue[i].value;
+            tp.cls   = rfc_src->residue[i].cls;
+            tp.pos   = rfc_src->residue[i].pos + pos_offset;
 
-    return true;
-}
+            /* ctx_src has counted level crossings from its first turning point on, the
+             * ones of the residue slopes must not be counted twice */
+            if( !feed_once( rfc_ctx, &tp, ( i > 0 ) ? ( flags & ~RFC_FLAGS_COUNT_LC ) : flags ) ) return false;
 
+            if( i == 0 )
+            {
+                tp_head[0] = tp;
+            }
 
-/**
- * @brief      Calculate the slope k2 for a Woehler curve
- *
- * @param      ctx   The rainflow context
- * @param      s0    Any point on slope k
- * @param      n0    Any point on slope k
- * @param      k     Slope k
- * @param      sx    Junction point between k and k2
- * @param      nx    Junction point between k and k2
- * @param[out] k2    Slope k2
- * @param      sd    The fatigue strength
- * @param      nd    The cycle count at sd
- *
- * @return     true on success
- */
-bool RFC_wl_calc_k2( const void *ctx, double s0, double n0, double k, double sx, double nx, double *k2, double sd, double nd )
-{
-    double nom, den;
+            if( !has_joint && i < 2 && rfc_ctx->residue_cnt )
+            {
+                /* Turning point in ctx preceding the first one of ctx_src (joint) */
+                tp_head[1] = rfc_ctx->residue[rfc_ctx->residue_cnt - 1];
+                has_joint  = true;
+            }
+        }
 
-    k  = fabs(k);
+        /* Add the crossings from the joint to the first turning point of ctx_src. If the 
+         * first one has been dropped, the joint lies beyond in the same direction. */
+        if( has_joint && tp_head[1].pos != tp_head[0].pos )
+        {
+            cycle_process_counts( rfc_ctx, &tp_head[1], &tp_head[0], /*next*/ NULL, 
+                                  flags & ( ( tp_head[0].value > tp_head[1].value ) ? RFC_FLAGS_COUNT_LC_UP : RFC_FLAGS_COUNT_LC_DN ) );
+        }
 
-    if(    s0 <= 0.0    ||    n0 <= 0.0    ||
-           sx <= 0.0    ||    nx <= 0.0    ||
-           sd <= 0.0    ||    nd <= 0.0    ||    !k2 )
-    {
-        return false;
-    }
+#if RFC_GLOBAL_EXTREMA
+        /* Global extrema of ctx_src (first occurrence), turning points fed may have adjusted them already */
+        for( i = 0; i < 2; i++ )
+        {
+            rfc_value_tuple_s        ext      = rfc_src->internal.extrema[i];
+            const rfc_value_tuple_s *ext_dst  = &rfc_ctx->internal.extrema[i];
 
-    nom = ( log(s0) - log(sx) ) * k + log(n0) - log(nd);
-    den =   log(sd) - log(sx);
+            ext.pos += pos_offset;
 
-    if( den == 0.0 )
-    {
-        *k2 = -DBL_MAX;  /* Negative infinity */
-    }
-    else
-    {
-        *k2 = -fabs( nom / den );
+            if( ( i ? ( ext.value > ext_dst->value ) : ( ext.value < ext_dst->value ) ) ||
+                ( ext.value == ext_dst->value && ext.pos < ext_dst->pos && ext_dst->pos > pos_offset ) )
+            {
+                rfc_ctx->internal.extrema[i]      = ext;
+                rfc_ctx->internal.extrema_changed = true;
+            }
+        }
+#endif /*RFC_GLOBAL_EXTREMA*/
     }
 
-    return true;
-}
+    rfc_ctx->internal.pos = pos_offset + rfc_src->internal.pos;
 
-/**
- * @brief      Calculate a point on a Woehler slope
- *
- * @param      ctx   The rainflow context
- * @param      s0    Any point on the slope, Sa
- * @param      n0    Any point on the slope, N
- * @param      k     The Woehler slope
- * @param      n     Given cycles for required Sa
- * @param[out] sa    The buffer for Sa(N)
- *
- * @return     true on success
- */
-bool RFC_wl_calc_sa( const void *ctx, double s0, double n0, double k, double n, double *sa )
-{
-    /* (s0/Sa)^-k = n0/n */
-    /* (Sa/s0)^k  = n0/n */
+    /* Add countings of ctx_src */
+    snapshot = snapshot_begin( rfc_ctx );
 
-    k  = fabs(k);
+    rfc_ctx->damage += rfc_src->damage;
 
-    if(    s0 <= 0.0    ||    n0 <= 0.0    ||
-           n  <= 0.0    ||   !sa           )
+    for( i = 0; rfc_ctx->damage_multi && i < rfc_ctx->damage_multi_count; i++ )
     {
-        return false;
+        rfc_ctx->damage_multi[i] += rfc_src->damage_multi[i];
     }
 
-    *sa = pow( n0 / n, 1.0 / k ) * s0;
+    if( rfc_ctx->class_count )
+    {
+        size_t n = rfc_ctx->class_count;
 
-    return true;
-}
+        if( rfc_ctx->rfm && rfc_src->rfm )
+        {
+            for( i = 0; i < n * n; i++ )
+            {
+                assert( rfc_ctx->rfm[i] <= RFC_COUNTS_LIMIT - rfc_src->rfm[i] );
+                rfc_ctx->rfm[i] += rfc_src->rfm[i];
+            }
+        }
+        else if( rfc_ctx->rfm_sparse && rfc_src->rfm_sparse )
+        {
+            for( i = 0; i < rfc_src->rfm_sparse->count; i++ )
+            {
+                const rfc_rfm_item_s *item   = &rfc_src->rfm_sparse->items[i];
+                rfc_counts_t         *counts = rfm_sparse_find( rfc_ctx, item->from, item->to, /*create*/ true );
 
+                if( !counts )
+                {
+                    snapshot_end( rfc_ctx, snapshot );
+                    return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+                }
 
-/**
- * @brief      Calculate a point on a Woehler slope
- *
- * @param      ctx   The rainflow context
- * @param      s0    Any point on the slope, Sa
- * @param      n0    Any point on the slope, N
- * @param      k     The Woehler slope
- * @param      sa    Given amplitude Sa for required N
- * @param[out] n     The buffer for N(Sa)
- *
- * @return     true on success
- */
-bool RFC_wl_calc_n( const void *ctx, double s0, double n0, double k, double sa, double *n )
-{
-    /* (Sa/s0)^-k = n/n0 */
-    /* (s0/Sa)^k  = n/n0 */
+                assert( *counts <= RFC_COUNTS_LIMIT - item->counts );
+                *counts += item->counts;
+            }
+        }
+        RFM_SAT_INVALIDATE( rfc_ctx, 0 );
 
-    k  = fabs(k);
+        if( rfc_ctx->rp && rfc_src->rp )
+        {
+            for( i = 0; i < n; i++ )
+            {
+                assert( rfc_ctx->rp[i] <= RFC_COUNTS_LIMIT - rfc_src->rp[i] );
+                rfc_ctx->rp[i] += rfc_src->rp[i];
+            }
+        }
 
-    if(    s0 <= 0.0    ||    n0 <= 0.0    ||
-           sa <= 0.0    ||   !n            )
-    {
-        return false;
+        if( rfc_ctx->lc && rfc_src->lc )
+        {
+            for( i = 0; i < n; i++ )
+            {
+                assert( rfc_ctx->lc[i] <= RFC_COUNTS_LIMIT - rfc_src->lc[i] );
+                rfc_ctx->lc[i] += rfc_src->lc[i];
+
+                /* Pending crossings (difference arrays add up as well) */
+                rfc_ctx->internal.lc_diff[i] += rfc_src->internal.lc_diff[i];
+            }
+            rfc_ctx->internal.lc_dirty |= rfc_src->internal.lc_dirty;
+        }
     }
 
-    *n = pow( s0 / sa, k ) * n0;
+    snapshot_end( rfc_ctx, snapshot );
 
     return true;
 }
+#endif /*!RFC_MINIMAL*/
 
 
 /**
- * @brief      Set class parameter.
+ * @brief      Finalize pending counts and turning point storage.
  *
- * @param      ctx          The rainflow context
- * @param[in]  class_param  The new class parameter
+ * @param      ctx              The rainflow context
+ * @param      residual_method  The residual method (RFC_RES_...)
  *
  * @return     true on success
- * 
- * @note       Changing class parameters invalidate look-up tables!
  */
-bool RFC_class_param_set( void *ctx, const rfc_class_param_s *class_param )
+bool RFC_finalize( void *ctx, rfc_res_method_e residual_method )
 {
+    double damage;
+    bool ok, snapshot;
     RFC_CTX_CHECK_AND_ASSIGN
-
-    if( !class_param                                || 
-         rfc_ctx->state     != RFC_STATE_INIT       || 
-         class_param->count != rfc_ctx->class_count ||
-         class_param->width  < 0.0                  )
+    
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state >= RFC_STATE_FINISHED )
     {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        return false;
     }
 
-    if( class_param->count > 0.0 && class_param->width <= 0.0 )
-    {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
-    }
+    snapshot = snapshot_begin( rfc_ctx );
 
-    rfc_ctx->class_count  = class_param->count;
-    rfc_ctx->class_width  = class_param->width;
-    rfc_ctx->class_offset = class_param->offset;
+#if _DEBUG
+    rfc_ctx->internal.finalizing = true;
+#endif /*_DEBUG*/
 
-#if RFC_DAMAGE_FAST
-    rfc_ctx->damage_lut_inapt++;
-#endif /*RFC_DAMAGE_FAST*/
+    damage = rfc_ctx->damage;
 
-    return true;
-}
+#if RFC_USE_DELEGATES
+    if( rfc_ctx->finalize_fcn )
+    {
+        ok = rfc_ctx->finalize_fcn( rfc_ctx, residual_method );
+        residue_mirror_drop( rfc_ctx, 0 );
+    }
+    else
+#endif /*RFC_USE_DELEGATES*/
+    {
+        int flags = rfc_ctx->internal.flags;
 
+#if !RFC_MINIMAL
+        /* Level crossing counting is already considered for residue */
+        flags &= ~RFC_FLAGS_COUNT_LC;
+#endif /*!RFC_MINIMAL*/
 
-/**
- * @brief      Get class parameter.
- *
- * @param      ctx          The rainflow context
- * @param[out] class_param  The class parameter
- *
- * @return     true on success
- */
-bool RFC_class_param_get( const void *ctx, rfc_class_param_s *class_param )
-{
-    RFC_CTX_CHECK_AND_ASSIGN
+        switch( residual_method )
+        {
+            case RFC_RES_NONE:
+                /* FALLTHROUGH */
+            case RFC_RES_IGNORE:
+                ok = finalize_res_ignore( rfc_ctx, flags );
+                break;
+            case RFC_RES_NO_FINALIZE:
+                ok = finalize_res_no_finalize( rfc_ctx, flags );
+                break;
+#if !RFC_MINIMAL
+            case RFC_RES_DISCARD:
+                ok = finalize_res_discard( rfc_ctx, flags );
+                break;
+            case RFC_RES_HALFCYCLES:
+                ok = finalize_res_weight_cycles( rfc_ctx, rfc_ctx->half_inc, flags );
+                break;
+            case RFC_RES_FULLCYCLES:
+                ok = finalize_res_weight_cycles( rfc_ctx, rfc_ctx->full_inc, flags );
+                break;
+            case RFC_RES_CLORMANN_SEEGER:
+                ok = finalize_res_clormann_seeger( rfc_ctx, flags );
+                break;
+            case RFC_RES_REPEATED:
+                ok = finalize_res_repeated( rfc_ctx, flags );
+                break;
+            case RFC_RES_RP_DIN45667:
+                ok = finalize_res_rp_DIN45667( rfc_ctx, flags );
+                break;
+#endif /*!RFC_MINIMAL*/
+            default:
+                assert( false );
+                ok = error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        }
+        assert( rfc_ctx->state == RFC_STATE_FINALIZE );
+    }
 
-    if( !class_param                     ||
-         rfc_ctx->state < RFC_STATE_INIT )
+#if !RFC_MINIMAL
+    if( rfc_ctx->counting_method == RFC_COUNTING_METHOD_NONE || !rfc_ctx->class_count )
     {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+#else /*RFC_MINIMAL*/
+    if( !rfc_ctx->class_count )
+    {
+#endif /*!RFC_MINIMAL*/
+        rfc_ctx->residue_cnt = 0;
     }
 
-    class_param->count  = rfc_ctx->class_count;
-    class_param->width  = rfc_ctx->class_width;
-    class_param->offset = rfc_ctx->class_offset;
+#if !RFC_MINIMAL
+    lc_flush( rfc_ctx );
+    mk_flush( rfc_ctx );
+#endif /*!RFC_MINIMAL*/
 
-    return true;
-}
+    rfc_ctx->damage_residue = rfc_ctx->damage - damage;
+    rfc_ctx->state          = ok ? RFC_STATE_FINISHED : RFC_STATE_ERROR;
 
+    snapshot_end( rfc_ctx, snapshot );
 
-/**
- * @brief      Get class number from value
- *
- * @param[in]  ctx           The rainflow context
- * @param[in]  value         The value
- * @param      class_number  The class number
- *
- * @return     true on success
- */
-bool RFC_class_number( const void *ctx, rfc_value_t value, unsigned *class_number )
-{
-    RFC_CTX_CHECK_AND_ASSIGN
+#if _DEBUG
+    rfc_ctx->internal.finalizing = false;
+#endif /*_DEBUG*/
 
-    if( !class_number                    ||
-         rfc_ctx->state < RFC_STATE_INIT )
+#if RFC_DH_SUPPORT
+    if( ok )
     {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        ok = spread_damage_map_tp( rfc_ctx );
     }
+#endif /*RFC_DH_SUPPORT*/
 
-    *class_number = QUANTIZE( rfc_ctx, value );
-
-    return true;
+    return ok;
 }
 
 
+#if !RFC_MINIMAL
 /**
- * @brief      Get class mean from class number
+ * @brief      Make rainflow matrix symmetrical
  *
- * @param[in]  ctx           The rainflow context
- * @param[in]  class_number  The class number
- * @param      class_mean    The class mean
+ * @param      ctx   The rainflow context
  *
  * @return     true on success
  */
-bool RFC_class_mean( const void *ctx, unsigned class_number, rfc_value_t *class_mean )
+bool RFC_rfm_make_symmetric( void *ctx )
 {
-    RFC_CTX_CHECK_AND_ASSIGN
+    unsigned       class_count;
+    unsigned       from, to;
+    rfc_counts_t  *rfm;
 
-    if( !class_mean                      ||
-         rfc_ctx->state < RFC_STATE_INIT )
+    RFC_CTX_CHECK_AND_ASSIGN
+    
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
     {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        return false;
     }
 
-    *class_mean = CLASS_MEAN( rfc_ctx, class_number );
+    rfm = rfc_ctx->rfm;
 
-    return true;
-}
+    if( rfc_ctx->rfm_sparse )
+    {
+        rfc_rfm_sparse_s   *rfm_sparse = rfc_ctx->rfm_sparse;
+        unsigned            i;
 
+        /* Cumulate entries below the major diagonal into their mirror elements */
+        for( i = 0; i < rfm_sparse->count; i++ )
+        {
+            rfc_rfm_item_s  item = rfm_sparse->items[i];
+            rfc_counts_t   *mirror;
 
-/**
- * @brief      Get class upper value from class nummer
- *
- * @param[in]  ctx           The rainflow context
- * @param[in]  class_number  The class number
- * @param      class_upper   The class upper
- *
- * @return     true on success
- */
-bool RFC_class_upper( const void *ctx, unsigned class_number, rfc_value_t *class_upper )
-{
-    RFC_CTX_CHECK_AND_ASSIGN
+            if( item.from > item.to && item.counts )
+            {
+                /* May reallocate items */
+                mirror = rfm_sparse_find( rfc_ctx, item.to, item.from, /*create*/ true );
 
-    if( !class_upper                     ||
-         rfc_ctx->state < RFC_STATE_INIT )
+                if( !mirror )
+                {
+                    return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+                }
+
+                *mirror                        += item.counts;
+                rfm_sparse->items[i].counts     = 0;
+            }
+        }
+
+        return true;
+    }
+
+    if( !rfm )
     {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        return false;
     }
 
-    *class_upper = CLASS_UPPER( rfc_ctx, class_number );
+    class_count = rfc_ctx->class_count;
+
+    /* Cumulate entries symmetric by major diagonal */
+    for( from = 0; from < class_count; from++ )
+    {
+        for( to = from + 1; to < class_count; to++ )
+        {
+            /* to > from, always */
+            rfm[ MAT_OFFS( from, to ) ] += rfm[ MAT_OFFS( to, from ) ];
+            rfm[ MAT_OFFS( to, from ) ]  = 0;
+        }
+    }
+    RFM_SAT_INVALIDATE( rfc_ctx, 0 );
 
     return true;
 }
 
 
 /**
- * @brief      Get class count
+ * @brief      Returns the number of non zero entries in rainflow matrix
  *
- * @param[in]  ctx           The rainflow context
- * @param      class_count   The class count
+ * @param[in]  ctx   The rainflow context
  *
  * @return     true on success
  */
-bool RFC_class_count( const void *ctx, unsigned *class_count )
+bool RFC_rfm_non_zeros( const void *ctx, unsigned *count )
 {
+    unsigned            class_count;
+    unsigned            from, to;
+    rfc_counts_t       *rfm_it;
+
     RFC_CTX_CHECK_AND_ASSIGN
 
-    if( !class_count                     ||
-         rfc_ctx->state < RFC_STATE_INIT )
+    if( !count )
     {
         return error_raise( rfc_ctx, RFC_ERROR_INVARG );
     }
+    
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
 
-    *class_count = rfc_ctx->class_count;
+    class_count = rfc_ctx->class_count;
 
-    return true;
-}
+    rfm_it = rfc_ctx->rfm;
 
+    if( rfc_ctx->rfm_sparse && class_count )
+    {
+        const rfc_rfm_sparse_s *rfm_sparse = rfc_ctx->rfm_sparse;
+        unsigned                i;
 
-/**
- * @brief      Get class offset
- *
- * @param[in]  ctx           The rainflow context
- * @param      class_offset  The class offset
- *
- * @return     true on success
- */
-bool RFC_class_offset( const void *ctx, rfc_value_t *class_offset )
-{
-    RFC_CTX_CHECK_AND_ASSIGN
+        *count = 0;
+        for( i = 0; i < rfm_sparse->count; i++ )
+        {
+            if( rfm_sparse->items[i].counts ) (*count)++;
+        }
 
-    if( !class_offset                    ||
-         rfc_ctx->state < RFC_STATE_INIT )
+        return true;
+    }
+
+    if( !rfm_it || !class_count )
     {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        return false;
     }
 
-    *class_offset = rfc_ctx->class_offset;
+    *count = 0;
+    for( from = 0; from < class_count; from++ )
+    {
+        for( to = 0; to < class_count; to++ )
+        {
+            if( *rfm_it++ ) (*count)++;
+        }
+    }
 
     return true;
 }
 
 
 /**
- * @brief      Get class width
+ * @brief      Get the rainflow matrix as sparse elements
  *
- * @param[in]  ctx           The rainflow context
- * @param      class_width   The class width
+ * @param      ctx     The rainflow context
+ * @param[out] buffer  The elements buffer, if NULL memory will be allocated
+ * @param[out] count   The number of elements in buffer
  *
  * @return     true on success
- */
-bool RFC_class_width( const void *ctx, rfc_value_t *class_width )
+ * @note       The counts are natively returned, regardless of .full_inc!
+*/
+bool RFC_rfm_get( const void *ctx, rfc_rfm_item_s **buffer, unsigned *count )
 {
+    unsigned            class_count;
+    unsigned            from, to;
+    unsigned            count_old;
+    rfc_counts_t       *rfm_it;
+    rfc_rfm_item_s     *item;
+
     RFC_CTX_CHECK_AND_ASSIGN
 
-    if( !class_width                     ||
-         rfc_ctx->state < RFC_STATE_INIT )
+    if( !buffer || !count )
     {
         return error_raise( rfc_ctx, RFC_ERROR_INVARG );
     }
+    
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
 
-    *class_width = rfc_ctx->class_width;
+    class_count = rfc_ctx->class_count;
 
-    return true;
-}
+    rfm_it = rfc_ctx->rfm;
 
+    if( ( !rfm_it && !rfc_ctx->rfm_sparse ) || !class_count )
+    {
+        return false;
+    }
 
-/**
- * @brief      Get hysteresis
- *
- * @param[in]  ctx           The rainflow context
- * @param      hysteresis    The hysteresis
- *
- * @return     true on success
- */
-bool RFC_hysteresis( const void *ctx, rfc_value_t *hysteresis )
-{
-    RFC_CTX_CHECK_AND_ASSIGN
+    /* *buffer = NULL; */
+    count_old  = *count;
+    *count     = 0;
+    if( rfc_ctx->rfm_sparse )
+    {
+        if( !RFC_rfm_non_zeros( rfc_ctx, count ) )
+        {
+            return false;
+        }
+    }
+    else for( from = 0; from < class_count; from++ )
+    {
+        for( to = 0; to < class_count; to++, rfm_it++ )
+        {
+            if( *rfm_it )
+            {
+                (*count)++;
+            }
+        }
+    }
 
-    if( !hysteresis                      ||
-         rfc_ctx->state < RFC_STATE_INIT )
+    if( *count > count_old )
     {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        *buffer = rfc_ctx->mem_alloc( *buffer, *count, sizeof(rfc_rfm_item_s), RFC_MEM_AIM_RFM_ELEMENTS );
+
+        if( !*buffer )
+        {
+            error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+            return false;
+        }
     }
+        
+    item   = *buffer;
+    rfm_it = rfc_ctx->rfm;
+    if( rfc_ctx->rfm_sparse )
+    {
+        const rfc_rfm_sparse_s *rfm_sparse = rfc_ctx->rfm_sparse;
+        unsigned                k;
 
-    *hysteresis = rfc_ctx->hysteresis;
+        /* Row lists are sorted, elements are returned in row-major order as well */
+        for( from = 0; from < class_count; from++ )
+        {
+            for( k = rfm_sparse->row[from]; k; k = rfm_sparse->next[k-1] )
+            {
+                if( rfm_sparse->items[k-1].counts )
+                {
+                    *item++ = rfm_sparse->items[k-1];
+                }
+            }
+        }
+    }
+    else for( from = 0; from < class_count; from++ )
+    {
+        for( to = 0; to < class_count; to++, rfm_it++ )
+        {
+            if( *rfm_it )
+            {
+                item->from   = from;
+                item->to     = to;
+                item->counts = *rfm_it;
+
+                item++;
+            }
+        }
+    }
 
     return true;
 }
 
 
 /**
- * @brief      Set flags
+ * @brief      Set (or increment) rainflow matrix with given elements
  *
- * @param      ctx        The rainflow context
- * @param[in]  flags      The flags
- * @param[in]  overwrite  Overwrites, if true
- * @param[in]  stack      ID of flags stack
+ * @param      ctx       The rainflow context
+ * @param[in]  buffer    The elements buffer
+ * @param      count     The number of elements in buffer
+ * @param      add_only  Counts are added if set to true
  *
  * @return     true on success
+ * @note       The counts are natively added, regardless of .full_inc!
  */
-bool RFC_flags_set( void *ctx, int flags, int stack, bool overwrite )
+bool RFC_rfm_set( void *ctx, const rfc_rfm_item_s *buffer, unsigned count, bool add_only )
 {
+          unsigned           class_count, i;
+    const rfc_rfm_item_s    *item;
+          rfc_counts_t      *rfm;
+
     RFC_CTX_CHECK_AND_ASSIGN
 
-    switch( stack )
+    if( !buffer )
     {
-        case 0:
-            if( overwrite )
-            {
-                rfc_ctx->internal.flags = (rfc_flags_e)flags;
-            }
-            else
-            {
-                rfc_ctx->internal.flags |= (rfc_flags_e)flags;
-            }
-            break;
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+    
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
 
-#if RFC_DEBUG_FLAGS
-        case 1:
-            if( overwrite )
+    class_count = rfc_ctx->class_count;
+
+    rfm = rfc_ctx->rfm;
+
+    if( ( !rfm && !rfc_ctx->rfm_sparse ) || !class_count )
+    {
+        return false;
+    }
+
+    if( !add_only )
+    {
+        /* Initialize with zeros */
+        if( rfm )
+        {
+            memset( rfm, 0, sizeof(rfc_counts_t) * class_count * class_count );
+        }
+        else
+        {
+            rfm_sparse_clear( rfc_ctx );
+        }
+    }
+
+    item = buffer;
+    for( i = 0; i < count; i++, item++ )
+    {
+        unsigned from, to;
+
+        from = ( item->from < 0 ) ? 1 : ( item->from + 1 );
+        to   = ( item->to   < 0 ) ? 1 : ( item->to   + 1 );
+
+        if( from > class_count ) from = class_count;
+        if( to   > class_count ) to   = class_count;
+
+        if( from > 0 && to > 0 )
+        {
+            if( rfm )
             {
-                rfc_ctx->internal.debug_flags = (rfc_debug_flags_e)flags;
+                rfm[ MAT_OFFS( from-1, to-1 ) ] += item->counts;
             }
-            else
+            else if( item->counts )
             {
-                rfc_ctx->internal.debug_flags |= (rfc_debug_flags_e)flags;
+                rfc_counts_t *counts = rfm_sparse_find( rfc_ctx, from-1, to-1, /*create*/ true );
+
+                if( !counts )
+                {
+                    return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+                }
+
+                *counts += item->counts;
             }
-            break;
-#endif /*RFC_DEBUG_FLAGS*/
+        }
+    }
 
-        default:
-            return false;
+    if( rfm )
+    {
+        RFM_SAT_INVALIDATE( rfc_ctx, 0 );
     }
 
     return true;
@@ -3545,65 +4877,58 @@ bool RFC_flags_set( void *ctx, int flags, int stack, bool overwrite )
 
 
 /**
- * @brief      Unset flags (mask)
+ * @brief      Get counts of a single element from the rainflow matrix
  *
- * @param      ctx        The rainflow context
- * @param[in]  flags      The flags
- * @param[in]  stack      ID of flags stack
+ * @param      ctx       The rainflow context
+ * @param      from_val  The cycles start value
+ * @param      to_val    The cycles target value
+ * @param[out] counts    The corresponding count from the matrix element (not cycles!), regardless of .full_inc!
  *
  * @return     true on success
  */
-bool RFC_flags_unset( void *ctx, int flags, int stack )
+bool RFC_rfm_peek( const void *ctx, rfc_value_t from_val, rfc_value_t to_val, rfc_counts_t *counts )
 {
-    RFC_CTX_CHECK_AND_ASSIGN
+    unsigned           from, to;
+    unsigned           class_count;
+    rfc_counts_t      *rfm;
 
-    switch( stack )
+    RFC_CTX_CHECK_AND_ASSIGN
+    
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
     {
-        case 0:
-            rfc_ctx->internal.flags &= (rfc_flags_e)~flags;
-            break;
+        return false;
+    }
 
-#if RFC_DEBUG_FLAGS
-        case 1:
-            rfc_ctx->internal.debug_flags &= (rfc_debug_flags_e)~flags;
-            break;
-#endif /*RFC_DEBUG_FLAGS*/
+    class_count = rfc_ctx->class_count;
 
-        default:
-            return false;
+    rfm = rfc_ctx->rfm;
+
+    if( ( !rfm && !rfc_ctx->rfm_sparse ) || !class_count )
+    {
+        return false;
     }
 
-    return true;
-}
+    assert( from_val >= rfc_ctx->class_offset );
+    assert( to_val   >= rfc_ctx->class_offset );
 
+    from = QUANTIZE( rfc_ctx, from_val );
+    to   = QUANTIZE( rfc_ctx, to_val );
 
-/**
- * @brief      Get flags
- *
- * @param      ctx    The rainflow context
- * @param[out] flags  Flag for debugging flags
- * @param[in]  stack  ID of flags stack
- *
- * @return     true on success
- */
-bool RFC_flags_get( const void *ctx, int *flags, int stack )
-{
-    RFC_CTX_CHECK_AND_ASSIGN
+    if( from >= class_count ) from = class_count - 1;
+    if( to   >= class_count ) to   = class_count - 1;
 
-    switch( stack )
+    if( counts )
     {
-        case 0:
-            *flags = (int)rfc_ctx->internal.flags;
-            break;
-
-#if RFC_DEBUG_FLAGS
-        case 1:
-            *flags = (int)rfc_ctx->internal.debug_flags;
-            break;
-#endif /*RFC_DEBUG_FLAGS*/
+        if( rfm )
+        {
+            *counts = rfm[ MAT_OFFS( from, to ) ];
+        }
+        else
+        {
+            const rfc_counts_t *element = rfm_sparse_find( rfc_ctx, from, to, /*create*/ false );
 
-        default:
-            return false;
+            *counts = element ? *element : 0;
+        }
     }
 
     return true;
@@ -3611,2333 +4936,6139 @@ bool RFC_flags_get( const void *ctx, int *flags, int stack )
 
 
 /**
- * @brief      Check flags
+ * @brief      Set (or increment) one matrix value of the rainflow matrix
  *
- * @param      ctx              The rainflow context
- * @param[in]  flags_to_check   flags to test if set
- * @param[in]  stack            ID of flags stack
+ * @param      ctx       The rainflow context
+ * @param      from_val  The cycles start value
+ * @param      to_val    The cycles target value
+ * @param      counts    The count value for the matrix element (not cycles!), regardless of .full_inc!
+ * @param      add_only  Value is added if set to true
  *
- * @return     true if flags are set
+ * @return     true on success
  */
-bool RFC_flags_check( const void *ctx, int flags_to_check, int stack )
+bool RFC_rfm_poke( void *ctx, rfc_value_t from_val, rfc_value_t to_val, rfc_counts_t counts, bool add_only )
 {
+    unsigned           from, to;
+    unsigned           class_count;
+    rfc_counts_t      *rfm;
+
     RFC_CTX_CHECK_AND_ASSIGN
+    
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
 
-    int flags;
+    class_count = rfc_ctx->class_count;
 
-    if( !RFC_flags_get( ctx, &flags, stack ) )
+    rfm = rfc_ctx->rfm;
+
+    if( ( !rfm && !rfc_ctx->rfm_sparse ) || !class_count )
     {
         return false;
     }
 
-    return ( flags & flags_to_check ) == flags_to_check;
-}
-
+    assert( from_val >= rfc_ctx->class_offset );
+    assert( to_val   >= rfc_ctx->class_offset );
 
-/**
- * @brief      Set Woehler curve parameters
- *
- * @param      ctx       The rainflow context
- * @param[in]  wl_param  The Woehler curve parameters
- *
- * @return     true on success
- */
-bool RFC_wl_param_set( void *ctx, const rfc_wl_param_s *wl_param )
-{
-    RFC_CTX_CHECK_AND_ASSIGN
+    from = QUANTIZE( rfc_ctx, from_val );
+    to   = QUANTIZE( rfc_ctx, to_val );
 
-    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    if( from >= class_count ) from = class_count - 1;
+    if( to   >= class_count ) to   = class_count - 1;
+
+    if( !rfm )
     {
-        return false;
+        /* Zero counts don't need a new element */
+        rfc_counts_t *element = rfm_sparse_find( rfc_ctx, from, to, /*create*/ counts != 0 );
+
+        if( element )
+        {
+            *element = add_only ? ( *element + counts ) : counts;
+        }
+        else if( counts )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
     }
-    
-    if( !wl_param                        ||
-         rfc_ctx->state < RFC_STATE_INIT )
+    else if( add_only )
     {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        rfm[ MAT_OFFS( from, to ) ] += counts;
+        RFM_SAT_INVALIDATE( rfc_ctx, from );
+    }
+    else
+    {
+        rfm[ MAT_OFFS( from, to ) ] = counts;
+        RFM_SAT_INVALIDATE( rfc_ctx, from );
     }
-
-    rfc_ctx->wl_sx          = wl_param->sx;
-    rfc_ctx->wl_nx          = wl_param->nx;
-    rfc_ctx->wl_k           = wl_param->k;
-    rfc_ctx->wl_q           = wl_param->q;
-    rfc_ctx->wl_sd          = wl_param->sd;
-    rfc_ctx->wl_nd          = wl_param->nd;
-    rfc_ctx->wl_k2          = wl_param->k2;
-    rfc_ctx->wl_q2          = wl_param->q2;
-    rfc_ctx->wl_omission    = wl_param->omission;
 
     return true;
 }
 
 
 /**
- * @brief      Get Woehler curve parameters
+ * @brief      Sum cycles of a rainflow matrix region
  *
- * @param      ctx       The rainflow context
- * @param[out] wl_param  The Woehler curve parameters
+ * @param      ctx         The rainflow context
+ * @param      from_first  The first start class (row)
+ * @param      from_last   The last start class (row)
+ * @param      to_first    The first target class (col)
+ * @param      to_last     The last target class (col)
+ * @param      count       The sum of the matrix region
  *
  * @return     true on success
+ * @note       The sum is natively built, regardless of .full_inc!
  */
-bool RFC_wl_param_get( const void *ctx, rfc_wl_param_s *wl_param )
+bool RFC_rfm_sum( const void *ctx, unsigned from_first, unsigned from_last, unsigned to_first, unsigned to_last, rfc_counts_t *count )
 {
-    RFC_CTX_CHECK_AND_ASSIGN
+    unsigned         from, to;
+    unsigned         class_count;
+    rfc_counts_t    *rfm;
 
+    RFC_CTX_CHECK_AND_ASSIGN
+    
     if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
     {
         return false;
     }
-    
-    if( !wl_param                        ||
-         rfc_ctx->state < RFC_STATE_INIT )
+
+    class_count = rfc_ctx->class_count;
+
+    rfm = rfc_ctx->rfm;
+
+    if( ( !rfm && !rfc_ctx->rfm_sparse ) || !class_count )
     {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        return false;
     }
 
-    wl_param->sx            = rfc_ctx->wl_sx;
-    wl_param->nx            = rfc_ctx->wl_nx;
-    wl_param->k             = rfc_ctx->wl_k;
-    wl_param->q             = rfc_ctx->wl_q;
-    wl_param->sd            = rfc_ctx->wl_sd;
-    wl_param->nd            = rfc_ctx->wl_nd;
-    wl_param->q2            = rfc_ctx->wl_q2;
-    wl_param->k2            = rfc_ctx->wl_k2;
-    wl_param->omission      = rfc_ctx->wl_omission;
-    wl_param->D             = 0.0;
+    assert( from_first < class_count );
+    assert( from_last  < class_count );
+    assert( to_first   < class_count );
+    assert( to_last    < class_count );
+    assert( from_first < from_last );
+    assert( to_first   < to_last );
 
-    return true;
-}
+    if( count )
+    {
+        rfc_counts_t sum = 0;
+
+        if( !rfm )
+        {
+            const rfc_rfm_sparse_s *rfm_sparse = rfc_ctx->rfm_sparse;
+            unsigned                k;
+
+            for( from = from_first; from <= from_last; from++ )
+            {
+                /* Row lists are sorted by .to */
+                for( k = rfm_sparse->row[from]; k && rfm_sparse->items[k-1].to < to_last; k = rfm_sparse->next[k-1] )
+                {
+                    if( rfm_sparse->items[k-1].to >= to_first )
+                    {
+                        sum += rfm_sparse->items[k-1].counts;
+                    }
+                }
+            }
+        }
+#if !RFC_MINIMAL
+        else if( rfc_ctx->internal.rfm_sat.enabled )
+        {
+            const rfc_counts_t *sat;
+            unsigned            n = class_count + 1;
+
+            if( !rfm_sat_update( rfc_ctx, from_last + 1, /*damage*/ false ) )
+            {
+                return false;
+            }
+
+            /* Sum over rows [from_first,from_last] and columns [to_first,to_last) */
+            sat = rfc_ctx->internal.rfm_sat.counts;
+            sum = sat[ ( from_last + 1 ) * n + to_last  ] - sat[ from_first * n + to_last  ]
+                - sat[ ( from_last + 1 ) * n + to_first ] + sat[ from_first * n + to_first ];
+        }
 #endif /*!RFC_MINIMAL*/
+        else for( from = from_first; from <= from_last; from++ )
+        {
+            for( to = to_first; to < to_last; to++ )
+            {
+                sum += rfm[ MAT_OFFS( from, to ) ];
+            }
+        }
 
+        *count = sum;
+    }
+
+    return true;
+}
 
 
-#if RFC_AT_SUPPORT
 /**
- * @brief      Amplitude transformation to take mean load influence into
- *             account.
+ * @brief      Calculates the sum of damages for a rainflow matrix
+ *             region
  *
- * @param      ctx             The rainflow context
- * @param      Sa              Amplitude
- * @param      Sm              Mean load
- * @param[out] Sa_transformed  Transformed amplitude Sa
+ * @param      ctx         The rainflow context
+ * @param      from_first  The first start class (row)
+ * @param      from_last   The last start class (row)
+ * @param      to_first    The first target class (col)
+ * @param      to_last     The last target class (col)
+ * @param[out] damage      The result (sum)
  *
  * @return     true on success
  */
-bool RFC_at_transform( const void *ctx, double Sa, double Sm, double *Sa_transformed )
+bool RFC_rfm_damage( const void *ctx, unsigned from_first, unsigned from_last, unsigned to_first, unsigned to_last, double *damage )
 {
-    double Sa_transform = Sa;
+    unsigned          from, to;
+    unsigned          class_count;
+    rfc_counts_t     *rfm;
 
     RFC_CTX_CHECK_AND_ASSIGN
-
-    if( !Sa_transformed )
-    {
-        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
-    }
     
-    /* Amplitude is always positive */
-    Sa = fabs( Sa );
-
-#if RFC_USE_DELEGATES
-    if( rfc_ctx->at_transform_fcn )
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
     {
-        return rfc_ctx->at_transform_fcn( rfc_ctx, Sa, Sm, Sa_transformed );
+        return false;
     }
-#endif
 
-    if( !rfc_ctx->at.count )
-    {
-        /* No reference curve given, return original amplitude */
-        *Sa_transformed = Sa;
-        return true;
-    }
+    class_count = rfc_ctx->class_count;
 
-    if( Sa == 0.0 )
+    rfm = rfc_ctx->rfm;
+
+    if( ( !rfm && !rfc_ctx->rfm_sparse ) || !class_count )
     {
-        /* Zero amplitude */
-        Sa_transform = 0.0;
+        return false;
     }
-    else
+
+    assert( from_first < class_count );
+    assert( from_last  < class_count );
+    assert( to_first   < class_count );
+    assert( to_last    < class_count );
+    assert( from_first < from_last );
+    assert( to_first   < to_last );
+
+    if( damage )
     {
-        double Sm_norm_base;
-        double Sm_norm_target;
-        double alleviation_base;
-        double alleviation_target;
+        double sum = 0.0;
 
-        /* Normalize Sm (Sa=1) */
-        Sm_norm_base = Sm / Sa;
-        if( !at_alleviation( rfc_ctx, Sm_norm_base, &alleviation_base ) )
+        if( !rfm )
         {
-            return false;
-        }
+            const rfc_rfm_sparse_s *rfm_sparse = rfc_ctx->rfm_sparse;
+            unsigned                k;
 
-        if( rfc_ctx->at.R_pinned )
-        {
-            /* Calculate intersection of R slope and M slope */
-            if( !at_R_to_Sm_norm( rfc_ctx, rfc_ctx->at.R_rig, &Sm_norm_target ) )
+            for( from = from_first; from <= from_last; from++ )
             {
-                return false;
+                /* Row lists are sorted by .to */
+                for( k = rfm_sparse->row[from]; k && rfm_sparse->items[k-1].to < to_last; k = rfm_sparse->next[k-1] )
+                {
+                    const rfc_rfm_item_s *item = &rfm_sparse->items[k-1];
+                    double                damage_i;
+
+                    if( item->to < to_first || !item->counts )
+                    {
+                        continue;
+                    }
+
+                    if( !damage_calc( rfc_ctx, from, item->to, &damage_i, NULL /*Sa_ret*/ ) )
+                    {
+                        return false;
+                    }
+
+                    sum += damage_i * item->counts;
+                }
             }
+        }
+#if !RFC_MINIMAL
+        else if( rfc_ctx->internal.rfm_sat.enabled )
+        {
+            const double *sat;
+            unsigned      n = class_count + 1;
 
-            if( !at_alleviation( rfc_ctx, Sm_norm_target, &alleviation_target ) )
+            if( !rfm_sat_update( rfc_ctx, from_last + 1, /*damage*/ true ) )
             {
                 return false;
             }
 
-            Sa_transform = Sa / alleviation_base * alleviation_target;
+            sat = rfc_ctx->internal.rfm_sat.damage;
+            sum = sat[ ( from_last + 1 ) * n + to_last  ] - sat[ from_first * n + to_last  ]
+                - sat[ ( from_last + 1 ) * n + to_first ] + sat[ from_first * n + to_first ];
         }
-        else
+#endif /*!RFC_MINIMAL*/
+        else for( from = from_first; from <= from_last; from++ )
         {
-            /* Calculate intersection of mean load on test rig (Sm_rig) with curve taken from Haigh diagram */
-            const double   *Sa_   = rfc_ctx->at.Sa;
-            const double   *Sm_   = rfc_ctx->at.Sm;
-                  unsigned  count = rfc_ctx->at.count;
-                  unsigned  n;
-                  double    Sa_lhs, Sa_rhs;
-                  double    Sm_lhs, Sm_rhs;
-
-            /* Check each segment from the reference curve */
-            for( n = 0; n <= count; n++ )
+            for( to = to_first; to < to_last; to++ )
             {
-                if( n )
+                rfc_counts_t count = rfm[ MAT_OFFS( from, to ) ];
+                double damage_i;
+                
+                if( !damage_calc( rfc_ctx, from, to, &damage_i, NULL /*Sa_ret*/ ) )
                 {
-                    Sa_lhs = Sa_rhs;
-                    Sm_lhs = Sm_rhs;
+                    return false;
+                }
 
-                    if( n < count )
-                    {
-                        if( !at_alleviation( rfc_ctx, Sm_[n] / Sa_[n], &alleviation_target ) )
-                        {
-                            return false;
-                        }
+                sum += damage_i * count;
+            }
+        }
 
-                        /* Next segment */
-                        Sa_rhs = Sa / alleviation_base * alleviation_target;
-                        Sm_rhs = Sa_rhs / Sa_[n] * Sm_[n];
-                    }
-                    else
-                    {
-                        /* Last segment */
-                        assert( Sm_lhs <= rfc_ctx->at.Sm_rig );
-
-                        Sa_transform = Sa_lhs;
-                    }
-                }
-                else /* n == 0 */
-                {
-                    if( !at_alleviation( rfc_ctx, Sm_[0] / Sa_[0], &alleviation_target ) )
-                    {
-                        return false;
-                    }
-
-                    /* First segment */
-                    Sa_rhs = Sa / alleviation_base * alleviation_target;
-                    Sm_rhs = Sa_rhs / Sa_[0] * Sm_[0];
-
-                    if( rfc_ctx->at.Sm_rig <= Sm_rhs)
-                    {
-                        Sa_transform = Sa_rhs;
-                        break;
-                    }
-                    else continue;
-                }
-
-                /* Interpolate intermediate points */
-                if( Sm_lhs <= rfc_ctx->at.Sm_rig && rfc_ctx->at.Sm_rig <= Sm_rhs )
-                {
-                    double frac, denom;
-
-                    denom = Sm_rhs - Sm_lhs;
-
-                    frac = ( denom < 1e-20 ) ? 1.0 : ( ( rfc_ctx->at.Sm_rig - Sm_lhs ) / denom );
-
-                    Sa_transform = Sa_lhs * ( 1.0 - frac ) + Sa_rhs * frac;
-                    break;
-                }
-            }
-        }
-    }
-
-    *Sa_transformed = Sa_transform;
+        *damage = sum / rfc_ctx->full_inc;
+    }
 
     return true;
 }
-#endif /*RFC_AT_SUPPORT*/
 
-#if RFC_DEBUG_FLAGS
-int RFC_debug_fprintf( void *ctx, FILE *stream, const char *fmt, ... )
-{
-    int result;
-    va_list arg;
 
+/**
+ * @brief      Enable or disable summed-area tables for RFC_rfm_sum() and
+ *             RFC_rfm_damage(). Tables are built on first query and kept up
+ *             to date incrementally, so repeated range queries cost O(1).
+ *             Needs a dense rainflow matrix.
+ *
+ * @param      ctx     The rainflow context
+ * @param      enable  true to enable
+ *
+ * @return     true on success
+ */
+bool RFC_rfm_sat_enable( void *ctx, bool enable )
+{
     RFC_CTX_CHECK_AND_ASSIGN
 
-    va_start( arg, fmt );
-
-#if RFC_USE_DELEGATES
-    if( rfc_ctx->debug_vfprintf_fcn )
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
     {
-        result = rfc_ctx->debug_vfprintf_fcn( rfc_ctx, stream, fmt, arg );
+        return false;
     }
-    else
-#endif /*RFC_USE_DELEGATES*/
+
+    if( enable && !rfc_ctx->rfm )
     {
-        result = vfprintf( stream, fmt, arg );
+        return error_raise( rfc_ctx, RFC_ERROR_UNSUPPORTED );
     }
 
-    va_end( arg );
+    rfm_sat_free( rfc_ctx );
+    rfc_ctx->internal.rfm_sat.enabled = enable;
 
-    return result;
+    return true;
 }
-#endif /*RFC_DEBUG_FLAGS*/
-
 
 
+/**
+ * @brief      Check the consistency of the rainflow matrix
+ *
+ * @param      rfc_ctx  The rfc context
+ *
+ * @return     true on success
+ */
+bool RFC_rfm_check( const void *ctx )
+{
+    unsigned          class_count;
+    rfc_counts_t     *rfm;
 
+    RFC_CTX_CHECK_AND_ASSIGN
+    
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
 
+    class_count = rfc_ctx->class_count;
 
+    rfm = rfc_ctx->rfm;
 
+    if( rfc_ctx->rfm_sparse && class_count )
+    {
+        const rfc_rfm_sparse_s *rfm_sparse = rfc_ctx->rfm_sparse;
+        unsigned                i;
 
+        for( i = 0; i < rfm_sparse->count; i++ )
+        {
+            /* Matrix diagonal must be all zero */
+            if( rfm_sparse->items[i].from == rfm_sparse->items[i].to && rfm_sparse->items[i].counts != 0 )
+            {
+                return false;
+            }
+        }
+    }
+    else if( !rfm || !class_count )
+    {
+        return false;
+    }
+    else
+    {
+        int i;
 
+        for( i = 0; i < (int)class_count; i++ )
+        {
+            /* Matrix diagonal must be all zero */
+            if( rfm[ MAT_OFFS( i, i ) ] != 0 )
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
 
-/*** Implementation static functions ***/
 
-#if RFC_AT_SUPPORT
 /**
- * @brief      Clear all data for amplitude transformation
+ * @brief      Repeat countings basen on given rainflow matrix
  *
- * @param      rfc_ctx  The rainflow context
+ * @param      ctx              The rainflow context
+ * @param[in]  new_hysteresis   The new hysteresis
+ * @param[in]  new_class_param  The new class parameter, may be NULL
+ *
+ * @return     true on success
  */
-static
-void clear_at( rfc_ctx_s *rfc_ctx )
+bool RFC_rfm_refeed( void *ctx, rfc_value_t new_hysteresis, const rfc_class_param_s *new_class_param )
 {
-    assert( rfc_ctx );
+    rfc_class_param_s old_class_param;
+    rfc_value_tuple_s from = {0}, 
+                      to   = {0};
+    rfc_rfm_item_s   *buffer = NULL;
+    unsigned          count  = 0, i;
+    rfc_counts_t      cycles;
+    bool              ok;
 
-    rfc_ctx->at.Sa                      = NULL;
-    rfc_ctx->at.Sm                      = NULL;
-    rfc_ctx->at.count                   = 0;
-    rfc_ctx->at.M                       = 0.0;
-    rfc_ctx->at.Sm_rig                  = 0.0;
-    rfc_ctx->at.R_rig                   = 0.0;
-    rfc_ctx->at.R_pinned                = false;
+    RFC_CTX_CHECK_AND_ASSIGN
 
-    rfc_ctx->internal.at_haigh.count    = 0;
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
 
-}
-#endif /*RFC_AT_SUPPORT*/
+    if( ( !rfc_ctx->rfm && !rfc_ctx->rfm_sparse ) || !rfc_ctx->class_count )
+    {
+        return RFC_clear_counts( rfc_ctx );
+    }
+
+    if( !RFC_rfm_get( rfc_ctx, &buffer, &count ) )
+    {
+        return false;
+    }
 
+    ok = RFC_clear_counts( rfc_ctx ) && RFC_class_param_get( rfc_ctx, &old_class_param );
 
 #if RFC_DAMAGE_FAST
-static
-void clear_lut( rfc_ctx_s *rfc_ctx )
-{
-    assert( rfc_ctx && rfc_ctx->state >= RFC_STATE_INIT );
+    if( ok && new_class_param && 
+        ( !RFC_class_param_set( rfc_ctx, new_class_param ) ||
+          !damage_lut_init( rfc_ctx ) ) )
+#else /*!RFC_DAMAGE_FAST*/
+    if( ok && new_class_param && 
+        !RFC_class_param_set( rfc_ctx, new_class_param ) )
+#endif /*RFC_DAMAGE_FAST*/
+    {
+        ok = false;
+    }
 
-    if( rfc_ctx->damage_lut )
+    if( !ok )
     {
-        memset( rfc_ctx->damage_lut, 0, sizeof(double) * rfc_ctx->class_count * rfc_ctx->class_count );
+        rfc_ctx->mem_alloc( buffer, 0, 0, RFC_MEM_AIM_RFM_ELEMENTS );
+        return false;
     }
-    rfc_ctx->damage_lut_inapt = 1;
 
-#if RFC_AT_SUPPORT
-    if( rfc_ctx->amplitude_lut )
+    rfc_ctx->hysteresis = new_hysteresis;
+
+    for( i = 0; i < count; i++ )
     {
-        memset( rfc_ctx->amplitude_lut, 0, sizeof(double) * rfc_ctx->class_count * rfc_ctx->class_count );
+        from.value = old_class_param.width * buffer[i].from + old_class_param.offset + old_class_param.width / 2;
+        from.cls   = QUANTIZE( rfc_ctx, from.value );
+        to.value   = old_class_param.width * buffer[i].to   + old_class_param.offset + old_class_param.width / 2;
+        to.cls     = QUANTIZE( rfc_ctx, to.value );
+
+        /* Partial cycles count as whole ones */
+#if RFC_USE_INTEGRAL_COUNTS
+        cycles = ( buffer[i].counts + rfc_ctx->full_inc - 1 ) / rfc_ctx->full_inc;
+#else /*!RFC_USE_INTEGRAL_COUNTS*/
+        cycles = ceil( buffer[i].counts / rfc_ctx->full_inc );
+#endif /*RFC_USE_INTEGRAL_COUNTS*/
+
+        /* All cycles of an element at once */
+        cycle_process_counts_weighted( rfc_ctx, &from, &to, /*next*/ NULL, rfc_ctx->internal.flags, cycles );
     }
-#endif /*RFC_AT_SUPPORT*/
+
+    rfc_ctx->mem_alloc( buffer, 0, 0, RFC_MEM_AIM_RFM_ELEMENTS );
+
+    return true;
 }
-#endif /*RFC_DH_SUPPORT*/
 
 
-#if RFC_AR_SUPPORT
-static
-bool autoresize( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s* pt )
+/**
+ * @brief      Get level crossing histogram
+ *
+ * @param      ctx    The rainflow context
+ * @param[out] lc     The buffer for LC histogram (counts), .full_inc represents one "count", space for 1..class_count values must be preserved!
+ * @param[out] level  The buffer for LC upper class borders (dropped if NULL, otherwise space for 1..class_count values must be preserved!)
+ *
+ * @return     true on success
+ */
+bool RFC_lc_get( const void *ctx, rfc_counts_t *lc, rfc_value_t *level )
 {
-    unsigned     cls             = QUANTIZE( rfc_ctx, pt->value );
-    unsigned     class_count     = rfc_ctx->class_count,
-                 class_count_old = class_count,
-                 class_shift     = 0;
-    rfc_value_t  class_offset    = rfc_ctx->class_offset;
-    void        *ptr;
-    size_t       i, j;
+    unsigned i;
+    unsigned class_count;
 
-    if( pt->value < rfc_ctx->class_offset )
-    {
-        class_shift   = (unsigned)ceil( ( class_offset - (rfc_value_t)(pt->value) ) / rfc_ctx->class_width + 0.5 );
-        class_count  += class_shift;
-        class_offset -= rfc_ctx->class_width * class_shift;
-    }
-    else if( pt->cls >= class_count )
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !lc )
     {
-        class_count = (unsigned)ceil( ( (rfc_value_t)(pt->value) - class_offset ) / rfc_ctx->class_width + 0.5 );
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
     }
-    else
+    
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
     {
-        return true;
+        return false;
     }
 
-    if( class_count > RFC_CLASS_COUNT_MAX )
+    class_count = rfc_ctx->class_count;
+
+    if( !rfc_ctx->lc || !lc || !class_count )
     {
-        return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        return false;
     }
 
-    rfc_ctx->class_count  = class_count;
-    rfc_ctx->class_offset = class_offset;
-
-    pt->cls = QUANTIZE( rfc_ctx, pt->value );
+    lc_flush( rfc_ctx );
 
-#if RFC_DAMAGE_FAST
+    for( i = 0; i < class_count; i++ )
     {
-        rfc_state_e old_state = rfc_ctx->state;
-
-        if( rfc_ctx->damage_lut )
-        {
-            ptr = rfc_ctx->mem_alloc( rfc_ctx->damage_lut, class_count * class_count, 
-                                      sizeof(double), RFC_MEM_AIM_DLUT );
-            if( !ptr )
-            {
-                rfc_ctx->state = old_state;
-                return false;
-            }
-            else
-            {
-                rfc_ctx->damage_lut       = (double*)ptr;
-                rfc_ctx->damage_lut_inapt = 1;
-            }
-        }
+        lc[i] = rfc_ctx->lc[i];
 
-#if RFC_AT_SUPPORT
-        if( rfc_ctx->amplitude_lut )
+        if( level )
         {
-            ptr = rfc_ctx->mem_alloc( rfc_ctx->amplitude_lut, class_count * class_count, 
-                                      sizeof(double), RFC_MEM_AIM_ALUT );
-            if( !ptr )
-            {
-                rfc_ctx->state = old_state;
-                return false;
-            }
-            else
-            {
-                rfc_ctx->amplitude_lut = (double*)ptr;
-            }
+            level[i] = CLASS_UPPER( rfc_ctx, i );
         }
-#endif /*RFC_AT_SUPPORT*/
-    
-        rfc_ctx->state = RFC_STATE_INIT;
-        damage_lut_init( rfc_ctx );
-        rfc_ctx->state = old_state;
     }
-#endif /*RFC_DAMAGE_FAST*/
 
-    if( rfc_ctx->residue )
-    {
-        size_t residue_cap = 2 * class_count + 1;
+    return true;
+}
 
-        ptr = rfc_ctx->mem_alloc( rfc_ctx->residue, residue_cap, 
-                                  sizeof( rfc_value_tuple_s ), RFC_MEM_AIM_RESIDUE );
 
-        if( !ptr )
-        {
-            return false;
-        }
+/**
+ * @brief      Create level crossing histogram from rainflow matrix
+ *
+ * @param      ctx     The rainflow context
+ * @param[out] lc      The buffer for LC histogram (counts), .full_inc represents one "count", space for 1..class_count values must be preserved!
+ * @param[out] level   The buffer for LC upper class borders (dropped if NULL, otherwise space for 1..class_count values must be preserved!)
+ * @param[in]  rfm     The input rainflow matrix to use instead of ctx rfm, may be NULL
+ * @param      flags   The flags
+ *
+ * @return     true on success
+ * @note       Returned lc usually differs from .lc, when counting is finalized with any flag other than RFC_RES_NONE!
+ */
+bool RFC_lc_from_rfm( const void *ctx, rfc_counts_t *lc, rfc_value_t *level, const rfc_counts_t *rfm, rfc_flags_e flags )
+{
+    unsigned             from, to, i;
+    unsigned             class_count;
+    bool                 up = flags & RFC_FLAGS_COUNT_LC_UP;
+    bool                 dn = flags & RFC_FLAGS_COUNT_LC_DN;
+    rfc_counts_t         weight;
+    rfc_counts_t         sum = 0;
 
-        rfc_ctx->residue     = (rfc_value_tuple_s*)ptr;
-        rfc_ctx->residue_cap = residue_cap;
+    RFC_CTX_CHECK_AND_ASSIGN
 
-        /* Residuum */
-        for( i = 0; i < rfc_ctx->residue_cnt; i++ )
-        {
-            rfc_ctx->residue[i].cls = QUANTIZE( rfc_ctx, rfc_ctx->residue[i].value );
-        }
+    if( !lc )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
     }
 
-    for( i = 0; i < rfc_ctx->internal.residue_cap; i++ )
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
     {
-        rfc_ctx->internal.residue[i].cls = QUANTIZE( rfc_ctx, rfc_ctx->internal.residue[i].value );
+        return false;
     }
 
-    /* RFM */
-    if( rfc_ctx->rfm )
+    if( !rfm )
     {
-        ptr = rfc_ctx->mem_alloc( NULL, class_count * class_count, 
-                                  sizeof(rfc_counts_t), RFC_MEM_AIM_MATRIX );    
-        if( !ptr )
-        {
-            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
-        }
-        else
-        {
-            rfc_counts_t *rfm = (rfc_counts_t*)ptr;
+        rfm = rfc_ctx->rfm;
+    }
 
-            for( i = 0; i < class_count_old; i++ )
-            {
-                for( j = 0; j < class_count_old; j++ )
-                {
-                    rfm[ MAT_OFFS( i + class_shift, j + class_shift ) ] = rfc_ctx->rfm[ i * class_count_old + j ];
-                }
-            }
+    class_count = rfc_ctx->class_count;
 
-            ptr = rfc_ctx->rfm;
-            rfc_ctx->rfm = rfm;
-            rfc_ctx->mem_alloc( ptr, 0, 0, RFC_MEM_AIM_MATRIX );
-        }
+    if( ( !rfm && !rfc_ctx->rfm_sparse ) || !class_count )
+    {
+        return false;
     }
 
-#if !RFC_MINIMAL
-    /* LC */
-    if( rfc_ctx->lc )
-    {
-        ptr = rfc_ctx->mem_alloc( NULL, class_count,
-                                  sizeof(rfc_counts_t), RFC_MEM_AIM_LC );
-        if( !ptr )
-        {
-            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
-        }
-        else
-        {
-            rfc_counts_t* lc = (rfc_counts_t*)ptr;
+    /* One closed cycle has always a rising and a falling slope.
+       A cycle between classes lo < hi crosses the upper limits of classes lo..hi-1,
+       noted as difference and summed up afterwards */
+    weight = (rfc_counts_t)( ( up ? 1 : 0 ) + ( dn ? 1 : 0 ) );
 
-            for( i = 0; i < class_count_old; i++ )
-            {
-                lc[i + class_shift] = rfc_ctx->lc[i];
-            }
+    memset( lc, 0, sizeof(rfc_counts_t) * class_count );
 
-            ptr = rfc_ctx->lc;
-            rfc_ctx->lc = lc;
-            rfc_ctx->mem_alloc( ptr, 0, 0, RFC_MEM_AIM_LC );
-        }
+    if( !rfm )
+    {
+        const rfc_rfm_sparse_s *rfm_sparse = rfc_ctx->rfm_sparse;
 
-        /* RP */
-        ptr = rfc_ctx->mem_alloc( NULL, class_count,
-                                  sizeof(rfc_counts_t), RFC_MEM_AIM_RP );
-        if( !ptr )
-        {
-            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
-        }
-        else
+        for( i = 0; i < rfm_sparse->count; i++ )
         {
-            rfc_counts_t* rp = (rfc_counts_t*)ptr;
+            const rfc_rfm_item_s *item = &rfm_sparse->items[i];
 
-            for( i = 0; i < class_count_old; i++ )
+            if( item->counts && item->from != item->to )
             {
-                rp[i] = rfc_ctx->rp[i];
-            }
+                from = ( item->from < item->to ) ? item->from : item->to;
+                to   = ( item->from < item->to ) ? item->to   : item->from;
 
-            ptr = rfc_ctx->rp;
-            rfc_ctx->rp = rp;
-            rfc_ctx->mem_alloc( ptr, 0, 0, RFC_MEM_AIM_RP );
+                lc[from] += item->counts * weight;
+                lc[to]   -= item->counts * weight;
+            }
         }
     }
-#endif /*!RFC_MINIMAL*/
-
-#if RFC_TP_SUPPORT
-    for( i = 0; i < rfc_ctx->tp_cnt + ( rfc_ctx->state == RFC_STATE_BUSY_INTERIM ); i++ )
+    else for( from = 0; from < class_count; from++ )
     {
-#if RFC_USE_DELEGATES
-        if( rfc_ctx->tp_get_fcn || rfc_ctx->tp_set_fcn )
-        {
-            rfc_value_tuple_s *pt;
+        const rfc_counts_t *row   = rfm + MAT_OFFS( from, 0 );
+        rfc_counts_t        lower = 0;  /* Cycles ending below "from" */
+        rfc_counts_t        upper = 0;  /* Cycles ending above "from" */
 
-            tp_get( rfc_ctx, i + 1, &pt );  /* tp_pos is base 1 */
-            pt->cls = QUANTIZE( rfc_ctx, pt->value );
-            tp_set( rfc_ctx, i + 1, pt );  /* tp_pos is base 1 */
+        /* Row-major pass, start and end points of each row are cumulated */
+        for( to = 0; to < from; to++ )
+        {
+            lower  += row[to];
+            lc[to] += row[to] * weight;
         }
-#else /*!RFC_USE_DELEGATES*/
-        rfc_ctx->tp[i].cls = QUANTIZE( rfc_ctx, rfc_ctx->tp[i].value );
-#endif /*RFC_USE_DELEGATES*/
-    }
 
-    rfc_ctx->internal.margin[0].cls = QUANTIZE( rfc_ctx, rfc_ctx->internal.margin[0].value );
-    rfc_ctx->internal.margin[1].cls = QUANTIZE( rfc_ctx, rfc_ctx->internal.margin[1].value );
-
-#endif /*RFC_TP_SUPPORT*/
+        for( to = from + 1; to < class_count; to++ )
+        {
+            upper  += row[to];
+            lc[to] -= row[to] * weight;
+        }
 
-#if RFC_GLOBAL_EXTREMA
-    rfc_ctx->internal.extrema[0].cls = QUANTIZE( rfc_ctx, rfc_ctx->internal.extrema[0].value );
-    rfc_ctx->internal.extrema[1].cls = QUANTIZE( rfc_ctx, rfc_ctx->internal.extrema[1].value );
-#endif /*RFC_GLOBAL_EXTREMA*/
+        lc[from] += upper * weight;
+        lc[from] -= lower * weight;
+    }
 
-#if RFC_HCM_SUPPORT
-    for( i = 0; i < rfc_ctx->internal.hcm.stack_cap; i++ )
+    for( i = 0; i < class_count; i++ )
     {
-        rfc_ctx->internal.hcm.stack[i].cls = QUANTIZE( rfc_ctx, rfc_ctx->internal.hcm.stack[i].value );
+        /* First index (0) counts crossings of upper class limit of the first class */
+        sum   += lc[i];
+        lc[i]  = sum;
+
+        if( level )
+        {
+            level[i] = CLASS_UPPER( rfc_ctx, i );
+        }
     }
-#endif /*RFC_HCM_SUPPORT*/
 
     return true;
 }
 
-#endif /*RFC_AR_SUPPORT*/
-
 
 /**
- * @brief      Processing one data point. Find turning points and check for
- *             closed cycles.
+ * Calculate level crossing counts from rainflow matrix, write results to lc
+ * histogram buffer.
  *
- * @param      rfc_ctx  The rainflow context
- * @param[in]  pt       The data tuple
- * @param      flags    The flags
+ * @param      ctx          The rainflow context
+ * @param[out] lc           The buffer for LC histogram (counts), .full_inc represents one "count", space for 1..class_count values must be preserved!
+ * @param[out] level        The buffer for LC upper class borders (dropped if NULL, otherwise space for 1..class_count values must be preserved!)
+ * @param[in]  residue      The residue to use instead of ctx residue (may be NULL)
+ * @param[in]  residue_cnt  The length of the residue
+ * @param      flags        The flags
  *
  * @return     true on success
  */
-static
-bool feed_once( rfc_ctx_s *rfc_ctx, const rfc_value_tuple_s* pt, rfc_flags_e flags )
+bool RFC_lc_from_residue( const void *ctx, rfc_counts_t *lc, rfc_value_t *level, const rfc_value_t* residue, unsigned residue_cnt, rfc_flags_e flags )
 {
-    rfc_value_tuple_s *tp_residue;  /* Pointer to residue element */
+    rfc_value_tuple_s* residue_tuples;
+    unsigned i;
+    bool result;
 
-    assert( rfc_ctx && pt );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    RFC_CTX_CHECK_AND_ASSIGN
 
-#if RFC_DH_SUPPORT
-    /* Resize damage history if necessary */
-    if( !feed_once_dh( rfc_ctx, pt ) )
+    if( !residue || !residue_cnt )
     {
-        return false;
+        return RFC_lc_from_residue_tuples( ctx, lc, level, NULL, 0, flags );
     }
-#endif /*RFC_DH_SUPPORT*/
 
-    /* Check for next turning point and update residue. tp_residue is NULL, if there is no turning point */
-    /* Otherwise tp_residue refers the forelast element in member rfc_ctx->residue */
-    tp_residue = feed_filter_pt( rfc_ctx, pt );
+    residue_tuples = (rfc_value_tuple_s*)CALLOC( residue_cnt, sizeof(rfc_value_tuple_s) );
 
-#if RFC_TP_SUPPORT
-    /* Check if pt influences margins (tp_residue may be set to NULL then!) */
-    if( !feed_once_tp_check_margin( rfc_ctx, pt, &tp_residue ) )
+    if( !residue_tuples )
     {
         return false;
     }
-#endif /*RFC_TP_SUPPORT*/
 
-    /* Countings */
-
-    /* Add turning point and check for closed cycles */
-    if( tp_residue )
+    for( i = 0; i < residue_cnt; i++ )
     {
-#if RFC_TP_SUPPORT
-        /* Add a copy of tp_residue to rfc_ctx->tp and alter tp_residue->tp_pos to its position in rfc_ctx->tp */
-        if( !tp_set( rfc_ctx, 0, tp_residue ) )
-        {
-            return false;
-        }
-#endif /*RFC_TP_SUPPORT*/
+        residue_tuples[i].value = residue[i];
+        residue_tuples[i].cls   = QUANTIZE( rfc_ctx, residue[i] );
+        residue_tuples[i].pos   = 0;
+    }
 
-#if !RFC_MINIMAL
-        /* New turning point, do LC count */
-        cycle_process_lc( rfc_ctx, flags & (RFC_FLAGS_COUNT_LC | RFC_FLAGS_ENFORCE_MARGIN) );
-        flags &= ~RFC_FLAGS_COUNT_LC;
-#endif /*!RFC_MINIMAL*/
+    result = RFC_lc_from_residue_tuples( ctx, lc, level, residue_tuples, residue_cnt, flags );
 
-        if( rfc_ctx->class_count )
-        {
-            /* Check for closed cycles and count. Modifies residue! */
-            cycle_find( rfc_ctx, flags );
-        }
-        else
-        {
-            if( rfc_ctx->residue_cnt > 1 )
-            {
-                residue_remove_item( rfc_ctx, 0, 1 );
-            }
-        }
-    }
+    FREE( residue_tuples );
 
-    return true;
+    return result;
 }
 
 
-#if RFC_DH_SUPPORT
 /**
- * @brief      Resize damage history if necessary.
+ * Calculate level crossing counts from rainflow matrix, write results to lc
+ * histogram buffer.
  *
- * @param      rfc_ctx  The rainflow context
- * @param[in]  pt       The data tuple
+ * @param      ctx          The rainflow context
+ * @param[out] lc           The buffer for LC histogram (counts), .full_inc represents one "count", space for 1..class_count values must be preserved!
+ * @param[out] level        The buffer for LC upper class borders (dropped if NULL, otherwise space for 1..class_count values must be preserved!)
+ * @param[in]  residue      The residue to use instead of ctx residue (may be NULL)
+ * @param[in]  residue_cnt  The length of the residue
+ * @param      flags        The flags
  *
  * @return     true on success
  */
-static
-bool feed_once_dh( rfc_ctx_s *rfc_ctx, const rfc_value_tuple_s* pt )
+bool RFC_lc_from_residue_tuples( const void *ctx, rfc_counts_t* lc, rfc_value_t *level, const rfc_value_tuple_s *residue, unsigned residue_cnt, rfc_flags_e flags )
 {
-    assert( rfc_ctx );
-    assert( pt );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+          unsigned           i;
+          unsigned           class_count;
+          bool               up   = flags & RFC_FLAGS_COUNT_LC_UP;
+          bool               dn   = flags & RFC_FLAGS_COUNT_LC_DN;
+    const rfc_value_tuple_s *from;
 
-    if( rfc_ctx->dh )
-    {
-        if( pt->pos > rfc_ctx->dh_cap )
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !lc )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+    
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
+
+    if( !residue )
+    {
+        residue     = rfc_ctx->residue;
+        residue_cnt = rfc_ctx->residue_cnt;
+    }
+
+    class_count = rfc_ctx->class_count;
+
+    if( !residue || !class_count )
+    {
+        return false;
+    }
+
+    memset( lc, 0, sizeof(rfc_counts_t) * class_count );
+
+    if( level )
+    {
+        for( i = 0; i < class_count; i++ )
         {
-            size_t new_cap = (size_t)1024 * ( pt->pos / 640 + 1 ); /* + 60% + 1024 */
+            level[i] = CLASS_UPPER( rfc_ctx, i );
+        }
+    }
 
-            rfc_ctx->dh = (double*)rfc_ctx->mem_alloc( rfc_ctx->dh, new_cap, 
-                                                       sizeof(rfc_value_t), RFC_MEM_AIM_DH );
+    from = residue;
+    for( i = 1; i < residue_cnt; i++ ) 
+    {
+        const rfc_value_tuple_s *to         = from + 1;
+              unsigned           class_from = from->cls;
+              unsigned           class_to   = to->cls;
 
-            if( !rfc_ctx->dh )
+        /* Level crossing, count rising and falling slopes.
+         * Level crossing histogram (vector storage)
+         * Counts class upper bound crossings
+         * Class upper bound value = (idx+1) * class_width + class_offset
+         */
+        if( class_from < class_to && up )
+        {
+            /* Count rising slopes */
+            unsigned idx;
+            for( idx = class_from; idx < class_to; idx++ )
             {
-                return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+                assert( lc[idx] <= RFC_COUNTS_LIMIT );
+                lc[idx] += rfc_ctx->full_inc;
+            }
+        }
+        else if( class_to < class_from && dn )
+        {
+            /* Count falling slopes */
+            unsigned idx;
+            for( idx = class_to; idx < class_from; idx++ )
+            {
+                assert( lc[idx] <= RFC_COUNTS_LIMIT );
+                lc[idx] += rfc_ctx->full_inc;
             }
-
-            memset( rfc_ctx->dh + rfc_ctx->dh_cnt, 0, sizeof(rfc_value_t) * ( new_cap - rfc_ctx->dh_cap ) );
-            rfc_ctx->dh_cap = new_cap;
         }
 
-        rfc_ctx->dh_cnt = pt->pos;
+        from = to;
     }
 
     return true;
 }
-#endif /*RFC_DH_SUPPORT*/
 
 
-#if RFC_TP_SUPPORT
 /**
- * @brief         Check if pt influences margins.
+ * @brief      Get range pair histogram
  *
- * @param         rfc_ctx     The rainflow context
- * @param[in]     pt          The new data tuple
- * @param[in,out] tp_residue  The new turning point (or NULL)
+ * @param      ctx          The rainflow context
+ * @param[out] rp           The histogram (counts), .full_inc represent one "cycle", space for 1..class_count values must be preserved!
+ * @param[out] Sa           The amplitudes (dropped if NULL, otherwise space for 1..class_count values must be preserved!)
  *
- * @return        true on success
+ * @return     true on success
  */
-bool feed_once_tp_check_margin( rfc_ctx_s *rfc_ctx, const rfc_value_tuple_s* pt, rfc_value_tuple_s** tp_residue )
+bool RFC_rp_get( const void *ctx, rfc_counts_t *rp, rfc_value_t *Sa )
 {
-    bool do_margin;
-
-    assert( rfc_ctx && tp_residue );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    unsigned i;
+    unsigned class_count;
 
-    do_margin = rfc_ctx->internal.flags & RFC_FLAGS_ENFORCE_MARGIN;
+    RFC_CTX_CHECK_AND_ASSIGN
 
-    if( do_margin && !rfc_ctx->tp_locked )
+    if( !rp )
     {
-        /* Check for left and right margin */
-        switch( rfc_ctx->internal.margin_stage )
-        {
-            case 0:
-            {
-                rfc_value_tuple_s pt_left = *pt;
-
-                assert( *tp_residue == NULL );
-
-                /* Save left margin */
-                rfc_ctx->internal.margin[0]  = *pt;
-
-                /* Enqueue left margin as turning point */
-                if( !tp_set( rfc_ctx, 0, &pt_left ) ) return false;
-
-                rfc_ctx->internal.margin_stage = 1;
-                break;
-            }
-
-            case 1:
-            {
-                /* Save right margin so far */
-                rfc_ctx->internal.margin[1] = *pt;
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+    
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
 
-                /* Prevent storing 1st point twice */
-                if( *tp_residue )
-                {
-                    /* First turning point found */
-                    rfc_ctx->internal.margin_stage = 2;
+    class_count = rfc_ctx->class_count;
 
-                    if( (*tp_residue)->value == rfc_ctx->internal.margin[0].value )
-                    {
-                        assert( rfc_ctx->tp_cnt <= 1 );
+    if( !rfc_ctx->rp || !rp || !class_count )
+    {
+        return false;
+    }
 
-                        /* Left margin and first turning point are identical, set reference in residue */
-                        (*tp_residue)->tp_pos = 1;
-                        (*tp_residue) = 0;  /* Avoid further processing of this turning point */
-                    }
-                }
-                break;
-            }
+    memset( rp, 0, sizeof(rfc_counts_t) * class_count );
 
-            case 2:
-                /* Save right margin so far */
-                rfc_ctx->internal.margin[1] = *pt;
-                break;
+    for( i = 0; i < class_count; i++ )
+    {
+        rp[i] = rfc_ctx->rp[i];
 
-            default:
-                assert( false );
+        if( Sa )
+        {
+            Sa[i] = rfc_ctx->class_width * i / 2;  /* range / 2 */
         }
     }
 
     return true;
 }
-#endif /*RFC_TP_SUPPORT*/
 
 
 /**
- * @brief      Handling interim turning point and margin. If there are still
- *             unhandled turning point left, "finalizing" takes this into
- *             account for the rainflow algorithm.
+ * @brief      Generate range pair histogram from rainflow matrix
  *
- * @param      rfc_ctx  The rainflow context
+ * @param      ctx          The rainflow context
+ * @param[out] rp           The buffer for range pair counts (not cycles!), .full_inc represents one "cycle", space for 1..class_count values must be preserved!
+ * @param[out] Sa           The buffer for amplitudes (dropped if NULL, otherwise space for 1..class_count values must be preserved!)
+ * @param[in]  rfm          The input rainflow matrix to use instead of the ctx matrix (may be NULL)
  *
  * @return     true on success
  */
-static
-bool feed_finalize( rfc_ctx_s *rfc_ctx )
+bool RFC_rp_from_rfm( const void *ctx, rfc_counts_t *rp, rfc_value_t *Sa, const rfc_counts_t *rfm )
 {
-    rfc_value_tuple_s *tp_interim = NULL;
+    unsigned    i, j;
+    unsigned    class_count;
 
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    RFC_CTX_CHECK_AND_ASSIGN
 
-    if( rfc_ctx->state < RFC_STATE_FINALIZE )
+    if( !rp )
     {
-        /* Adjust residue: Incorporate interim turning point */
-        if( rfc_ctx->state == RFC_STATE_BUSY_INTERIM )
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+    
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
+
+    if( !rfm )
+    {
+        rfm = rfc_ctx->rfm;
+    }
+
+    class_count = rfc_ctx->class_count;
+
+    if( !rfm && rfc_ctx->rfm_sparse && class_count )
+    {
+        const rfc_rfm_sparse_s *rfm_sparse = rfc_ctx->rfm_sparse;
+
+        memset( rp, 0, sizeof(rfc_counts_t) * class_count );
+
+        for( i = 0; i < rfm_sparse->count; i++ )
         {
-            tp_interim = &rfc_ctx->residue[rfc_ctx->residue_cnt];
-            rfc_ctx->residue_cnt++;
+            const rfc_rfm_item_s *item = &rfm_sparse->items[i];
 
-            rfc_ctx->state = RFC_STATE_BUSY;
+            /* Range class, elements on the major diagonal are taken twice (as rising and falling slope) */
+            j = ( item->from < item->to ) ? ( item->to - item->from ) : ( item->from - item->to );
+            rp[j] += ( j ? 1 : 2 ) * item->counts;
         }
 
-#if RFC_TP_SUPPORT
-        /* Finalize turning point storage */
-        if( !feed_finalize_tp( rfc_ctx, tp_interim, rfc_ctx->internal.flags ) )
+        if( Sa )
         {
-            return false;
+            for( i = 0; i < class_count; i++ )
+            {
+                Sa[i] = rfc_ctx->class_width * i / 2;  /* range / 2 */
+            }
         }
-#endif /*RFC_TP_SUPPORT*/
 
-        if( tp_interim )
-        {
-            int flags = rfc_ctx->internal.flags;
-#if !RFC_MINIMAL
-            /* New turning point, do LC count */
-            cycle_process_lc( rfc_ctx, rfc_ctx->internal.flags & (RFC_FLAGS_COUNT_LC | RFC_FLAGS_ENFORCE_MARGIN) );
-            flags &= ~RFC_FLAGS_COUNT_LC;
-#endif /*!RFC_MINIMAL*/
+        return true;
+    }
 
-            /* Check once more if a new cycle is closed now */
-#if RFC_TP_SUPPORT
-            /* feed_finalize_tp(...) has locked the tp storage, but we may need to alter .pos and .adj_pos */
-            tp_lock( rfc_ctx, false );
-            cycle_find( rfc_ctx, flags );
-            tp_lock( rfc_ctx, true );
-#else /*!RFC_TP_SUPPORT*/
-            cycle_find( rfc_ctx, flags );
-#endif /*RFC_TP_SUPPORT*/
+    if( !rfm || !class_count )
+    {
+        return false;
+    }
+
+    memset( rp, 0, sizeof(rfc_counts_t) * class_count );
+
+    /* Row-major pass instead of walking the diagonals, range class is |from-to|.
+       Elements on the major diagonal are taken twice (as rising and falling slope) */
+    for( i = 0; i < class_count; i++ ) 
+    {
+        const rfc_counts_t *row = rfm + MAT_OFFS( i, 0 );
+
+        for( j = 0; j < i; j++ ) 
+        {
+            assert( rp[i-j] <= RFC_COUNTS_LIMIT - row[j] );
+            rp[i-j] += row[j];
         }
 
-#if RFC_HCM_SUPPORT
-        if( !feed_finalize_hcm( rfc_ctx, rfc_ctx->internal.flags ) )
+        assert( rp[0] <= RFC_COUNTS_LIMIT - 2 * row[i] );
+        rp[0] += 2 * row[i];
+
+        for( j = i + 1; j < class_count; j++ ) 
         {
-            return false;
+            assert( rp[j-i] <= RFC_COUNTS_LIMIT - row[j] );
+            rp[j-i] += row[j];
         }
-#endif /*RFC_HCM_SUPPORT*/
+    }
 
-        rfc_ctx->state = RFC_STATE_FINALIZE;
+    if( Sa )
+    {
+        for( i = 0; i < class_count; i++ )
+        {
+            Sa[i] = rfc_ctx->class_width * i / 2;  /* range / 2 */
+        }
     }
 
     return true;
 }
 
 
-#if RFC_TP_SUPPORT
 /**
- * @brief         Finalize turning point storage.
+ * @brief      Return cumulated damage
  *
- * @param         rfc_ctx     The rainflow context
- * @param[in,out] tp_interim  The interim turning point (or NULL)
- * @param         flags       Only flag RFC_FLAGS_ENFORCE_MARGIN encounters
+ * @param      ctx             The rainflow context
+ * @param[out] damage          The buffer for cumulated damage (including damage from residue)
+ * @param[out] damage_residue  The buffer for partial damage from residue
+ *
+ * @return     true on success
+ */
+bool RFC_damage( const void *ctx, rfc_value_t *damage, rfc_value_t *damage_residue )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
+
+    if( damage )
+    {
+        *damage = rfc_ctx->damage;
+    }
+
+    if( damage_residue )
+    {
+        *damage_residue = rfc_ctx->damage_residue;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief      Calculate the damage from a range pair histogram
+ *
+ * @param      ctx             The rainflow context
+ * @param[out] damage          The buffer for cumulated damage
+ * @param[in]  rp              The range pair counts to use instead of ctx rp, may be NULL (Mind that
+ *                             full_inc describes 1 cycle!), space for 1..class_count values must be preserved!
+ * @param[in]  Sa              The buffer for amplitudes respective rp, may be
+ *                             NULL, space for 1..class_count values must be preserved!
+ * @param      rp_calc_method  The rp calculate method
+ *                             (RFC_RP_DAMAGE_CALC_METHOD_*)
+ *
+ * @return     true on success
+ */
+bool RFC_damage_from_rp( const void *ctx, double *damage, const rfc_counts_t *rp, const rfc_value_t *Sa, rfc_rp_damage_method_e rp_calc_method )
+{
+    const unsigned    from = 0;
+          unsigned    class_count;
+          double      D;             /* Cumulative damage */
+          int         i, j;
+
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !damage )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
+
+    if( !rp )
+    {
+        rp = rfc_ctx->rp;
+    }
+
+    class_count = rfc_ctx->class_count;
+
+    if( !rp || !class_count )
+    {
+        return false;
+    }
+
+    /* Sa must be sorted in ascending order */
+    for( i = 1; Sa && i < (int)class_count; i++ )
+    {
+        if( Sa[i] < Sa[i-1] )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        }
+    }
+
+    D = 0.0;
+
+    /* Calculate the "Miner Consequent" approach */
+    if( rp_calc_method == RFC_RP_DAMAGE_CALC_METHOD_CONSEQUENT )
+    {
+        rfc_wl_param_s      wl;
+        double              q     = rfc_ctx->wl_q;   /* Fatigue strength depression exponent */
+        double              Sd    = rfc_ctx->wl_sd;  /* Fatigue strength SD for the unimpaired(!) part */
+        double              Nd    = rfc_ctx->wl_nd;  /* Fatigue strength cycle count ND for the unimpaired(!) part */
+        double              Sj    = Sd;              /* Current fatigue strength, impacted part */
+        double              Pj;                      /* (Sj/Sd)^q */
+        double              D_inv = 0.0;             /* The inverse damage */
+        double              D_sum = 0.0;             /* Damage for partial histogram, classes above j */
+        bool                ok    = true;
+
+        /* Omission not allowed here! */
+        if( rfc_ctx->wl_omission > 0.0 )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        }
+
+        /* Backup WL parameters */
+        RFC_wl_param_get( rfc_ctx, &wl );
+
+        /* Remove fatigue strength temporarily */
+        rfc_ctx->wl_sd = 0.0;
+        rfc_ctx->wl_nd = DBL_MAX;
+
+        Pj = pow( Sj / Sd, q );
+
+        for( j = (int)class_count - 1; j >= -1 && ok; j-- )
+        {
+            double Sa_j;       /* New fatigue strength */
+            double Pa_j;       /* (Sa_j/Sd)^q */
+            double weight;     /* Weight for partial histogram */
+
+            /* Partial histograms are nested, damage for classes above j is a running sum.
+               Summation order (descending classes) is that of the original formula */
+            i = j + 1;
+            if( i < (int)class_count && rp[i] )
+            {
+                double Sa_i = Sa ? Sa[i] : AMPLITUDE( rfc_ctx, i );
+                double D_i;
+                
+                if( !damage_calc_amplitude( rfc_ctx, Sa_i, &D_i ) )
+                {
+                    ok = false;
+                    break;
+                }
+
+                D_sum += D_i * rp[i];
+            }
+
+            /* Get the new degraded fatigue strength in Sa_j */
+            if( j >= 0 )
+            {
+                Sa_j = Sa ? Sa[j] : AMPLITUDE( rfc_ctx, j );
+            }
+            else
+            {
+                Sa_j = 0.0;
+            }
+
+            /* Forward until amplitude is below fatigue strength SD for the unimpaired part */
+            if( Sa_j >= Sd && Sd > 0.0 ) continue;
+
+            /**
+             *  The following lines of code reflect the original formulas as in [6] 3.2.11 and 3.2-59.
+             *  This realization resolves his approach to use partial damages instead of particular cycles from the histogram.
+             *  This procedure benefits from inserting an abstraction layer, which permits to use any representation of 
+             *  a Woehler curve with a given fatigue strength limit providing a damage per cycle representation. 
+             *  Note that the Miner Consequent approach, in contrast to Original/Elementary/Modified, is unsuitable when using 
+             *  an inappropriate Woehler curve, to estimate so called "pseudo damages".
+             */
+
+            /* Weighted damage, (Sj/Sd)^q is known from the previous step */
+            Pa_j   = pow( Sa_j / Sd, q );
+            weight = Pj - Pa_j;
+            Pj     = Pa_j;
+
+            if( weight <= 0.0 ) continue;
+
+            if( D_sum > 0.0 )
+            {
+                D_inv += weight / D_sum;
+            }
+        }
+
+        /* Restore WL parameters */
+        RFC_wl_param_set( rfc_ctx, &wl );
+
+        if( !ok ) return false;
+
+        /* Get the final damage value */
+        D = 1.0 / D_inv;
+    }
+    else if( rp_calc_method == RFC_RP_DAMAGE_CALC_METHOD_ELEMENTAR )
+    {
+        rfc_wl_param_s  wl;
+        bool ok;
+
+        (void)RFC_wl_param_get( rfc_ctx, &wl );
+
+        rfc_ctx->wl_sd = 0.0;
+        rfc_ctx->wl_nd = DBL_MAX;
+        rfc_ctx->wl_k2 = rfc_ctx->wl_k;
+        rfc_ctx->wl_q2 = rfc_ctx->wl_q2;
+
+#if RFC_DAMAGE_FAST
+        {
+            rfc_ctx->damage_lut_inapt++;
+            ok = RFC_damage_from_rp( rfc_ctx, damage, rp, Sa, RFC_RP_DAMAGE_CALC_METHOD_DEFAULT );
+            rfc_ctx->damage_lut_inapt--;
+        }
+#else /*!RFC_DAMAGE_FAST*/
+        ok = RFC_damage_from_rp( rfc_ctx, damage, rp, Sa, RFC_RP_DAMAGE_CALC_METHOD_DEFAULT );
+#endif /*RFC_DAMAGE_FAST*/
+
+        (void)RFC_wl_param_set( rfc_ctx, &wl );
+
+        return ok;
+    }
+    else if( rp_calc_method == RFC_RP_DAMAGE_CALC_METHOD_MODIFIED)
+    {
+        rfc_wl_param_s wl;
+        bool ok;
+
+        (void)RFC_wl_param_get( rfc_ctx, &wl );
+
+        rfc_ctx->wl_sd = 0.0;
+        rfc_ctx->wl_nd = DBL_MAX;
+
+#if RFC_DAMAGE_FAST
+        {
+            rfc_ctx->damage_lut_inapt++;
+            ok = RFC_damage_from_rp( rfc_ctx, damage, rp, Sa, RFC_RP_DAMAGE_CALC_METHOD_DEFAULT );
+            rfc_ctx->damage_lut_inapt--;
+        }
+#else /*!RFC_DAMAGE_FAST*/
+        ok = RFC_damage_from_rp( rfc_ctx, damage, rp, Sa, RFC_RP_DAMAGE_CALC_METHOD_DEFAULT );
+#endif /*RFC_DAMAGE_FAST*/
+
+        (void)RFC_wl_param_set( rfc_ctx, &wl );
+
+        return ok;
+    }
+    else if( rp_calc_method == RFC_RP_DAMAGE_CALC_METHOD_DEFAULT )
+    {
+        for( i = 0; i < (int)class_count; i++ )
+        {
+            if( rp[i] )
+            {
+                double D_i;
+
+                if( Sa )
+                {
+                    if( !damage_calc_amplitude( rfc_ctx, Sa[i], &D_i ) )
+                    {
+                        return false;
+                    }
+                    D += D_i * rp[i];
+                }
+                else
+                {
+                    if( !damage_calc( rfc_ctx, from, i /*to*/, &D_i, NULL /*Sa_ret*/ ) )
+                    {
+                        return false;
+                    }
+                    D += D_i * rp[i];
+                }
+            }
+        }
+    }
+    else return false;
+
+    *damage = D / rfc_ctx->full_inc;
+    return true;
+}
+
+
+/**
+ * @brief      Calculate the damage from rainflow matrix
+ *
+ * @param      ctx     The rainflow context
+ * @param[out] damage  The buffer for cumulated damage
+ * @param[in]  rfm     The input rainflow matrix to use instead of ctx rfm (may be NULL), .full_inc represents one "cycle"!
+ *
+ * @return     true on success
+ */
+bool RFC_damage_from_rfm( const void *ctx, double *damage, const rfc_counts_t *rfm )
+{
+    unsigned    from, to;
+    unsigned    class_count;
+    double      D;
+
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !damage )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+    
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
+
+    if( !rfm )
+    {
+        rfm = rfc_ctx->rfm;
+    }
+
+    class_count = rfc_ctx->class_count;
+
+    if( !rfm && rfc_ctx->rfm_sparse && class_count )
+    {
+        const rfc_rfm_sparse_s *rfm_sparse = rfc_ctx->rfm_sparse;
+        unsigned                i;
+
+        D = 0.0;
+        for( i = 0; i < rfm_sparse->count; i++ )
+        {
+            const rfc_rfm_item_s *item = &rfm_sparse->items[i];
+            double                D_i;
+
+            if( item->counts )
+            {
+                if( !damage_calc( rfc_ctx, item->from, item->to, &D_i, NULL /*Sa_ret*/ ) )
+                {
+                    return false;
+                }
+                D += D_i * item->counts;
+            }
+        }
+
+        *damage = D / rfc_ctx->full_inc;
+        return true;
+    }
+
+    if( !rfm || !class_count )
+    {
+        return false;
+    }
+
+    D = 0.0;
+    for( from = 0; from < class_count; from++ )
+    {
+        for( to = 0; to < class_count; to++ )
+        {
+            if( rfm[ from * class_count + to ] )
+            {
+                double D_i;
+
+                if( !damage_calc( rfc_ctx, from, to, &D_i, NULL /*Sa_ret*/ ) )
+                {
+                    return false;
+                }
+                D += D_i * rfm[ MAT_OFFS( from, to ) ];
+            }
+        }
+    }
+
+    *damage = D / rfc_ctx->full_inc;
+    return true;
+}
+
+
+/**
+ * @brief      Set up additional Woehler curves, whose damages are cumulated
+ *             in the same counting pass (see RFC_damage_multi_get()).
+ *             Parameters are taken as they are, see RFC_wl_param_get().
+ *
+ * @param      ctx       The rainflow context
+ * @param[in]  wl_param  The Woehler curve parameters (count entries)
+ * @param      count     The number of Woehler curves, 0 disables
+ *
+ * @return     true on success
+ */
+bool RFC_damage_multi_init( void *ctx, const rfc_wl_param_s *wl_param, unsigned count )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( rfc_ctx->state != RFC_STATE_INIT )
+    {
+        return false;
+    }
+
+    if( count && !wl_param )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    damage_multi_free( rfc_ctx );
+
+    if( count )
+    {
+        rfc_ctx->damage_multi_wl = (rfc_wl_param_s*)rfc_ctx->mem_alloc( NULL, count, sizeof(rfc_wl_param_s), RFC_MEM_AIM_DAMAGE_MULTI );
+        rfc_ctx->damage_multi    = (double*)        rfc_ctx->mem_alloc( NULL, count, sizeof(double),         RFC_MEM_AIM_DAMAGE_MULTI );
+
+        if( !rfc_ctx->damage_multi_wl || !rfc_ctx->damage_multi )
+        {
+            damage_multi_free( rfc_ctx );
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
+
+        memcpy( rfc_ctx->damage_multi_wl, wl_param, sizeof(rfc_wl_param_s) * count );
+        rfc_ctx->damage_multi_count = count;
+
+        if( !damage_multi_lut_init( rfc_ctx ) )
+        {
+            damage_multi_free( rfc_ctx );
+            return false;
+        }
+    }
+
+    /* Fast kernels don't cumulate multi-curve damage */
+    counts_bind( rfc_ctx );
+
+    return true;
+}
+
+
+/**
+ * @brief      Get the cumulated damages of the Woehler curves given by
+ *             RFC_damage_multi_init()
+ *
+ * @param      ctx     The rainflow context
+ * @param[out] damage  The buffer for the damages
+ * @param      count   The number of damages to get
+ *
+ * @return     true on success
+ */
+bool RFC_damage_multi_get( const void *ctx, double *damage, unsigned count )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
+
+    if( !damage || count > rfc_ctx->damage_multi_count )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    if( count )
+    {
+        memcpy( damage, rfc_ctx->damage_multi, sizeof(double) * count );
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief      Calculate junction point between k and k2 for a Woehler curve
+ *
+ * @param      ctx   The rainflow context
+ * @param      s0    Any point on slope k
+ * @param      n0    Any point on slope k
+ * @param      k     Slope k
+ * @param[out] sx    Junction point between k and k2
+ * @param      nx    Junction point between k and k2
+ * @param      k2    Slope k2
+ * @param      sd    The fatigue strength
+ * @param      nd    The cycle count at sd
+ *
+ * @return     true on success
+ */
+bool RFC_wl_calc_sx( const void *ctx, double s0, double n0, double k, double *sx, double nx, double k2, double sd, double nd )
+{
+    double nom, den;
+
+    k  = fabs(k);
+    k2 = fabs(k2);
+
+    if(    s0 <= 0.0    ||    n0 <= 0.0    ||
+        /* sx <= 0.0    || */ nx <= 0.0    ||
+           sd <= 0.0    ||    nd <= 0.0    ||    !sx )
+    {
+        return false;
+    }
+
+    nom = log(s0)*k - log(sd)*k2 + log(n0) - log(nd);
+    den = k - k2;
+
+    if( den == 0.0 ) return false;
+
+    *sx = exp( nom / den );
+
+    return true;
+}
+
+
+/**
+ * @brief      Calculate fatigue strength for a Woehler curve
+ *
+ * @param      ctx   The rainflow context
+ * @param      s0    Any point on slope k
+ * @param      n0    Any point on slope k
+ * @param      k     Slope k
+ * @param      sx    Junction point between k and k2
+ * @param      nx    The cycle
+ * @param      k2    Slope k2
+ * @param[out] sd    The fatigue strength
+ * @param      nd    The cycle count at sd
+ *
+ * @return     true on success
+ */
+bool RFC_wl_calc_sd( const void *ctx, double s0, double n0, double k, double sx, double nx, double k2, double *sd, double nd )
+{
+    double nom, den;
+
+    k  = fabs(k);
+    k2 = fabs(k2);
+
+    if(    s0 <= 0.0    ||    n0 <= 0.0    ||
+           sx <= 0.0    ||    nx <= 0.0    ||
+        /* sd <= 0.0    || */ nd <= 0.0    ||    !sd )
+    {
+        return false;
+    }
+
+    nom = log(s0)*k - log(sx)*(k-k2) + log(n0) - log(nd);
+    den = k2;
+
+    if( den == 0.0 ) return false;
+
+    *sd = exp( nom / den );
+
+    return true;
+}
+
+
+/**
+ * @brief      Calculate the slope k2 for a Woehler curve
+ *
+ * @param      ctx   The rainflow context
+ * @param      s0    Any point on slope k
+ * @param      n0    Any point on slope k
+ * @param      k     Slope k
+ * @param      sx    Junction point between k and k2
+ * @param      nx    Junction point between k and k2
+ * @param[out] k2    Slope k2
+ * @param      sd    The fatigue strength
+ * @param      nd    The cycle count at sd
+ *
+ * @return     true on success
+ */
+bool RFC_wl_calc_k2( const void *ctx, double s0, double n0, double k, double sx, double nx, double *k2, double sd, double nd )
+{
+    double nom, den;
+
+    k  = fabs(k);
+
+    if(    s0 <= 0.0    ||    n0 <= 0.0    ||
+           sx <= 0.0    ||    nx <= 0.0    ||
+           sd <= 0.0    ||    nd <= 0.0    ||    !k2 )
+    {
+        return false;
+    }
+
+    nom = ( log(s0) - log(sx) ) * k + log(n0) - log(nd);
+    den =   log(sd) - log(sx);
+
+    if( den == 0.0 )
+    {
+        *k2 = -DBL_MAX;  /* Negative infinity */
+    }
+    else
+    {
+        *k2 = -fabs( nom / den );
+    }
+
+    return true;
+}
+
+/**
+ * @brief      Calculate a point on a Woehler slope
+ *
+ * @param      ctx   The rainflow context
+ * @param      s0    Any point on the slope, Sa
+ * @param      n0    Any point on the slope, N
+ * @param      k     The Woehler slope
+ * @param      n     Given cycles for required Sa
+ * @param[out] sa    The buffer for Sa(N)
+ *
+ * @return     true on success
+ */
+bool RFC_wl_calc_sa( const void *ctx, double s0, double n0, double k, double n, double *sa )
+{
+    /* (s0/Sa)^-k = n0/n */
+    /* (Sa/s0)^k  = n0/n */
+
+    k  = fabs(k);
+
+    if(    s0 <= 0.0    ||    n0 <= 0.0    ||
+           n  <= 0.0    ||   !sa           )
+    {
+        return false;
+    }
+
+    *sa = pow( n0 / n, 1.0 / k ) * s0;
+
+    return true;
+}
+
+
+/**
+ * @brief      Calculate a point on a Woehler slope
+ *
+ * @param      ctx   The rainflow context
+ * @param      s0    Any point on the slope, Sa
+ * @param      n0    Any point on the slope, N
+ * @param      k     The Woehler slope
+ * @param      sa    Given amplitude Sa for required N
+ * @param[out] n     The buffer for N(Sa)
+ *
+ * @return     true on success
+ */
+bool RFC_wl_calc_n( const void *ctx, double s0, double n0, double k, double sa, double *n )
+{
+    /* (Sa/s0)^-k = n/n0 */
+    /* (s0/Sa)^k  = n/n0 */
+
+    k  = fabs(k);
+
+    if(    s0 <= 0.0    ||    n0 <= 0.0    ||
+           sa <= 0.0    ||   !n            )
+    {
+        return false;
+    }
+
+    *n = pow( s0 / sa, k ) * n0;
+
+    return true;
+}
+
+
+/**
+ * @brief      Set class parameter.
+ *
+ * @param      ctx          The rainflow context
+ * @param[in]  class_param  The new class parameter
+ *
+ * @return     true on success
+ * 
+ * @note       Changing class parameters invalidate look-up tables!
+ */
+bool RFC_class_param_set( void *ctx, const rfc_class_param_s *class_param )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !class_param                                || 
+         rfc_ctx->state     != RFC_STATE_INIT       || 
+         class_param->count != rfc_ctx->class_count ||
+         class_param->width  < 0.0                  )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    if( class_param->count > 0.0 && class_param->width <= 0.0 )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    rfc_ctx->class_count  = class_param->count;
+    rfc_ctx->class_width  = class_param->width;
+    rfc_ctx->class_offset = class_param->offset;
+
+    rfc_ctx->internal.class_rcp = class_param->count ? 1.0 / class_param->width : 0.0;
+
+#if RFC_DAMAGE_FAST
+    rfc_ctx->damage_lut_inapt++;
+#endif /*RFC_DAMAGE_FAST*/
+    RFM_SAT_INVALIDATE_DAMAGE( rfc_ctx );
+
+#if !RFC_MINIMAL
+    if( rfc_ctx->damage_multi_count )
+    {
+        return damage_multi_lut_init( rfc_ctx );
+    }
+#endif /*!RFC_MINIMAL*/
+
+    return true;
+}
+
+
+/**
+ * @brief      Get class parameter.
+ *
+ * @param      ctx          The rainflow context
+ * @param[out] class_param  The class parameter
+ *
+ * @return     true on success
+ */
+bool RFC_class_param_get( const void *ctx, rfc_class_param_s *class_param )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !class_param                     ||
+         rfc_ctx->state < RFC_STATE_INIT )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    class_param->count  = rfc_ctx->class_count;
+    class_param->width  = rfc_ctx->class_width;
+    class_param->offset = rfc_ctx->class_offset;
+
+    return true;
+}
+
+
+/**
+ * @brief      Get class number from value
+ *
+ * @param[in]  ctx           The rainflow context
+ * @param[in]  value         The value
+ * @param      class_number  The class number
+ *
+ * @return     true on success
+ */
+bool RFC_class_number( const void *ctx, rfc_value_t value, unsigned *class_number )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !class_number                    ||
+         rfc_ctx->state < RFC_STATE_INIT )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    *class_number = QUANTIZE( rfc_ctx, value );
+
+    return true;
+}
+
+
+/**
+ * @brief      Get class mean from class number
+ *
+ * @param[in]  ctx           The rainflow context
+ * @param[in]  class_number  The class number
+ * @param      class_mean    The class mean
+ *
+ * @return     true on success
+ */
+bool RFC_class_mean( const void *ctx, unsigned class_number, rfc_value_t *class_mean )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !class_mean                      ||
+         rfc_ctx->state < RFC_STATE_INIT )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    *class_mean = CLASS_MEAN( rfc_ctx, class_number );
+
+    return true;
+}
+
+
+/**
+ * @brief      Get class upper value from class nummer
+ *
+ * @param[in]  ctx           The rainflow context
+ * @param[in]  class_number  The class number
+ * @param      class_upper   The class upper
+ *
+ * @return     true on success
+ */
+bool RFC_class_upper( const void *ctx, unsigned class_number, rfc_value_t *class_upper )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !class_upper                     ||
+         rfc_ctx->state < RFC_STATE_INIT )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    *class_upper = CLASS_UPPER( rfc_ctx, class_number );
+
+    return true;
+}
+
+
+/**
+ * @brief      Get class count
+ *
+ * @param[in]  ctx           The rainflow context
+ * @param      class_count   The class count
+ *
+ * @return     true on success
+ */
+bool RFC_class_count( const void *ctx, unsigned *class_count )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !class_count                     ||
+         rfc_ctx->state < RFC_STATE_INIT )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    *class_count = rfc_ctx->class_count;
+
+    return true;
+}
+
+
+/**
+ * @brief      Get class offset
+ *
+ * @param[in]  ctx           The rainflow context
+ * @param      class_offset  The class offset
+ *
+ * @return     true on success
+ */
+bool RFC_class_offset( const void *ctx, rfc_value_t *class_offset )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !class_offset                    ||
+         rfc_ctx->state < RFC_STATE_INIT )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    *class_offset = rfc_ctx->class_offset;
+
+    return true;
+}
+
+
+/**
+ * @brief      Get class width
+ *
+ * @param[in]  ctx           The rainflow context
+ * @param      class_width   The class width
+ *
+ * @return     true on success
+ */
+bool RFC_class_width( const void *ctx, rfc_value_t *class_width )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !class_width                     ||
+         rfc_ctx->state < RFC_STATE_INIT )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    *class_width = rfc_ctx->class_width;
+
+    return true;
+}
+
+
+/**
+ * @brief      Get hysteresis
+ *
+ * @param[in]  ctx           The rainflow context
+ * @param      hysteresis    The hysteresis
+ *
+ * @return     true on success
+ */
+bool RFC_hysteresis( const void *ctx, rfc_value_t *hysteresis )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !hysteresis                      ||
+         rfc_ctx->state < RFC_STATE_INIT )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    *hysteresis = rfc_ctx->hysteresis;
+
+    return true;
+}
+
+
+/**
+ * @brief      Set flags
+ *
+ * @param      ctx        The rainflow context
+ * @param[in]  flags      The flags
+ * @param[in]  overwrite  Overwrites, if true
+ * @param[in]  stack      ID of flags stack
+ *
+ * @return     true on success
+ */
+bool RFC_flags_set( void *ctx, int flags, int stack, bool overwrite )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    switch( stack )
+    {
+        case 0:
+            if( overwrite )
+            {
+                rfc_ctx->internal.flags = (rfc_flags_e)flags;
+            }
+            else
+            {
+                rfc_ctx->internal.flags |= (rfc_flags_e)flags;
+            }
+            break;
+
+#if RFC_DEBUG_FLAGS
+        case 1:
+            if( overwrite )
+            {
+                rfc_ctx->internal.debug_flags = (rfc_debug_flags_e)flags;
+            }
+            else
+            {
+                rfc_ctx->internal.debug_flags |= (rfc_debug_flags_e)flags;
+            }
+            break;
+#endif /*RFC_DEBUG_FLAGS*/
+
+        default:
+            return false;
+    }
+
+    counts_bind( rfc_ctx );
+
+    return true;
+}
+
+
+/**
+ * @brief      Unset flags (mask)
+ *
+ * @param      ctx        The rainflow context
+ * @param[in]  flags      The flags
+ * @param[in]  stack      ID of flags stack
+ *
+ * @return     true on success
+ */
+bool RFC_flags_unset( void *ctx, int flags, int stack )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    switch( stack )
+    {
+        case 0:
+            rfc_ctx->internal.flags &= (rfc_flags_e)~flags;
+            break;
+
+#if RFC_DEBUG_FLAGS
+        case 1:
+            rfc_ctx->internal.debug_flags &= (rfc_debug_flags_e)~flags;
+            break;
+#endif /*RFC_DEBUG_FLAGS*/
+
+        default:
+            return false;
+    }
+
+    counts_bind( rfc_ctx );
+
+    return true;
+}
+
+
+/**
+ * @brief      Get flags
+ *
+ * @param      ctx    The rainflow context
+ * @param[out] flags  Flag for debugging flags
+ * @param[in]  stack  ID of flags stack
+ *
+ * @return     true on success
+ */
+bool RFC_flags_get( const void *ctx, int *flags, int stack )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    switch( stack )
+    {
+        case 0:
+            *flags = (int)rfc_ctx->internal.flags;
+            break;
+
+#if RFC_DEBUG_FLAGS
+        case 1:
+            *flags = (int)rfc_ctx->internal.debug_flags;
+            break;
+#endif /*RFC_DEBUG_FLAGS*/
+
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief      Check flags
+ *
+ * @param      ctx              The rainflow context
+ * @param[in]  flags_to_check   flags to test if set
+ * @param[in]  stack            ID of flags stack
+ *
+ * @return     true if flags are set
+ */
+bool RFC_flags_check( const void *ctx, int flags_to_check, int stack )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    int flags;
+
+    if( !RFC_flags_get( ctx, &flags, stack ) )
+    {
+        return false;
+    }
+
+    return ( flags & flags_to_check ) == flags_to_check;
+}
+
+
+/**
+ * @brief      Set Woehler curve parameters
+ *
+ * @param      ctx       The rainflow context
+ * @param[in]  wl_param  The Woehler curve parameters
+ *
+ * @return     true on success
+ */
+bool RFC_wl_param_set( void *ctx, const rfc_wl_param_s *wl_param )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
+    
+    if( !wl_param                        ||
+         rfc_ctx->state < RFC_STATE_INIT )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    rfc_ctx->wl_sx          = wl_param->sx;
+    rfc_ctx->wl_nx          = wl_param->nx;
+    rfc_ctx->wl_k           = wl_param->k;
+    rfc_ctx->wl_q           = wl_param->q;
+    rfc_ctx->wl_sd          = wl_param->sd;
+    rfc_ctx->wl_nd          = wl_param->nd;
+    rfc_ctx->wl_k2          = wl_param->k2;
+    rfc_ctx->wl_q2          = wl_param->q2;
+    rfc_ctx->wl_omission    = wl_param->omission;
+
+    RFM_SAT_INVALIDATE_DAMAGE( rfc_ctx );
+
+    /* Miner consequent constants are based on the unimpaired curve */
+    mk_flush( rfc_ctx );
+    rfc_ctx->internal.mk.valid = false;
+
+    return true;
+}
+
+
+/**
+ * @brief      Get Woehler curve parameters
+ *
+ * @param      ctx       The rainflow context
+ * @param[out] wl_param  The Woehler curve parameters
+ *
+ * @return     true on success
+ */
+bool RFC_wl_param_get( const void *ctx, rfc_wl_param_s *wl_param )
+{
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( rfc_ctx->state < RFC_STATE_INIT || rfc_ctx->state > RFC_STATE_FINISHED )
+    {
+        return false;
+    }
+    
+    if( !wl_param                        ||
+         rfc_ctx->state < RFC_STATE_INIT )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+
+    wl_param->sx            = rfc_ctx->wl_sx;
+    wl_param->nx            = rfc_ctx->wl_nx;
+    wl_param->k             = rfc_ctx->wl_k;
+    wl_param->q             = rfc_ctx->wl_q;
+    wl_param->sd            = rfc_ctx->wl_sd;
+    wl_param->nd            = rfc_ctx->wl_nd;
+    wl_param->q2            = rfc_ctx->wl_q2;
+    wl_param->k2            = rfc_ctx->wl_k2;
+    wl_param->omission      = rfc_ctx->wl_omission;
+    wl_param->D             = 0.0;
+
+    return true;
+}
+#endif /*!RFC_MINIMAL*/
+
+
+
+#if RFC_AT_SUPPORT
+/**
+ * @brief      Amplitude transformation to take mean load influence into
+ *             account.
+ *
+ * @param      ctx             The rainflow context
+ * @param      Sa              Amplitude
+ * @param      Sm              Mean load
+ * @param[out] Sa_transformed  Transformed amplitude Sa
+ *
+ * @return     true on success
+ */
+bool RFC_at_transform( const void *ctx, double Sa, double Sm, double *Sa_transformed )
+{
+    double Sa_transform = Sa;
+
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    if( !Sa_transformed )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+    }
+    
+    /* Amplitude is always positive */
+    Sa = fabs( Sa );
+
+#if RFC_USE_DELEGATES
+    if( rfc_ctx->at_transform_fcn )
+    {
+        return rfc_ctx->at_transform_fcn( rfc_ctx, Sa, Sm, Sa_transformed );
+    }
+#endif
+
+    if( !rfc_ctx->at.count )
+    {
+        /* No reference curve given, return original amplitude */
+        *Sa_transformed = Sa;
+        return true;
+    }
+
+    if( Sa == 0.0 )
+    {
+        /* Zero amplitude */
+        Sa_transform = 0.0;
+    }
+    else
+    {
+        double Sm_norm_base;
+        double Sm_norm_target;
+        double alleviation_base;
+        double alleviation_target;
+
+        /* Normalize Sm (Sa=1) */
+        Sm_norm_base = Sm / Sa;
+        if( !at_alleviation( rfc_ctx, Sm_norm_base, &alleviation_base ) )
+        {
+            return false;
+        }
+
+        if( rfc_ctx->at.R_pinned )
+        {
+            /* Calculate intersection of R slope and M slope */
+            if( !at_R_to_Sm_norm( rfc_ctx, rfc_ctx->at.R_rig, &Sm_norm_target ) )
+            {
+                return false;
+            }
+
+            if( !at_alleviation( rfc_ctx, Sm_norm_target, &alleviation_target ) )
+            {
+                return false;
+            }
+
+            Sa_transform = Sa / alleviation_base * alleviation_target;
+        }
+        else
+        {
+            /* Calculate intersection of mean load on test rig (Sm_rig) with curve taken from Haigh diagram */
+            const double   *Sa_   = rfc_ctx->at.Sa;
+            const double   *Sm_   = rfc_ctx->at.Sm;
+                  unsigned  count = rfc_ctx->at.count;
+                  unsigned  n;
+                  double    Sa_lhs, Sa_rhs;
+                  double    Sm_lhs, Sm_rhs;
+
+            /* Check each segment from the reference curve */
+            for( n = 0; n <= count; n++ )
+            {
+                if( n )
+                {
+                    Sa_lhs = Sa_rhs;
+                    Sm_lhs = Sm_rhs;
+
+                    if( n < count )
+                    {
+                        if( !at_alleviation( rfc_ctx, Sm_[n] / Sa_[n], &alleviation_target ) )
+                        {
+                            return false;
+                        }
+
+                        /* Next segment */
+                        Sa_rhs = Sa / alleviation_base * alleviation_target;
+                        Sm_rhs = Sa_rhs / Sa_[n] * Sm_[n];
+                    }
+                    else
+                    {
+                        /* Last segment */
+                        assert( Sm_lhs <= rfc_ctx->at.Sm_rig );
+
+                        Sa_transform = Sa_lhs;
+                    }
+                }
+                else /* n == 0 */
+                {
+                    if( !at_alleviation( rfc_ctx, Sm_[0] / Sa_[0], &alleviation_target ) )
+                    {
+                        return false;
+                    }
+
+                    /* First segment */
+                    Sa_rhs = Sa / alleviation_base * alleviation_target;
+                    Sm_rhs = Sa_rhs / Sa_[0] * Sm_[0];
+
+                    if( rfc_ctx->at.Sm_rig <= Sm_rhs)
+                    {
+                        Sa_transform = Sa_rhs;
+                        break;
+                    }
+                    else continue;
+                }
+
+                /* Interpolate intermediate points */
+                if( Sm_lhs <= rfc_ctx->at.Sm_rig && rfc_ctx->at.Sm_rig <= Sm_rhs )
+                {
+                    double frac, denom;
+
+                    denom = Sm_rhs - Sm_lhs;
+
+                    frac = ( denom < 1e-20 ) ? 1.0 : ( ( rfc_ctx->at.Sm_rig - Sm_lhs ) / denom );
+
+                    Sa_transform = Sa_lhs * ( 1.0 - frac ) + Sa_rhs * frac;
+                    break;
+                }
+            }
+        }
+    }
+
+    *Sa_transformed = Sa_transform;
+
+    return true;
+}
+#endif /*RFC_AT_SUPPORT*/
+
+#if RFC_DEBUG_FLAGS
+int RFC_debug_fprintf( void *ctx, FILE *stream, const char *fmt, ... )
+{
+    int result;
+    va_list arg;
+
+    RFC_CTX_CHECK_AND_ASSIGN
+
+    va_start( arg, fmt );
+
+#if RFC_USE_DELEGATES
+    if( rfc_ctx->debug_vfprintf_fcn )
+    {
+        result = rfc_ctx->debug_vfprintf_fcn( rfc_ctx, stream, fmt, arg );
+    }
+    else
+#endif /*RFC_USE_DELEGATES*/
+    {
+        result = vfprintf( stream, fmt, arg );
+    }
+
+    va_end( arg );
+
+    return result;
+}
+#endif /*RFC_DEBUG_FLAGS*/
+
+
+
+
+
+
+
+
+
+
+/*** Implementation static functions ***/
+
+#if RFC_AT_SUPPORT
+/**
+ * @brief      Clear all data for amplitude transformation
+ *
+ * @param      rfc_ctx  The rainflow context
+ */
+static
+void clear_at( rfc_ctx_s *rfc_ctx )
+{
+    assert( rfc_ctx );
+
+    rfc_ctx->at.Sa                      = NULL;
+    rfc_ctx->at.Sm                      = NULL;
+    rfc_ctx->at.count                   = 0;
+    rfc_ctx->at.M                       = 0.0;
+    rfc_ctx->at.Sm_rig                  = 0.0;
+    rfc_ctx->at.R_rig                   = 0.0;
+    rfc_ctx->at.R_pinned                = false;
+
+    rfc_ctx->internal.at_haigh.count    = 0;
+
+}
+#endif /*RFC_AT_SUPPORT*/
+
+
+#if RFC_DAMAGE_FAST
+static
+void clear_lut( rfc_ctx_s *rfc_ctx )
+{
+    assert( rfc_ctx && rfc_ctx->state >= RFC_STATE_INIT );
+
+    rfc_ctx->damage_lut_inapt = 1;
+
+    if( rfc_ctx->lut && !damage_lut_own( rfc_ctx ) )
+    {
+        return;
+    }
+
+    damage_lut_pages_free( rfc_ctx );
+
+    if( rfc_ctx->damage_lut )
+    {
+        memset( rfc_ctx->damage_lut, 0, sizeof(double) * rfc_ctx->damage_lut_size );
+    }
+
+#if RFC_AT_SUPPORT
+    if( rfc_ctx->amplitude_lut )
+    {
+        memset( rfc_ctx->amplitude_lut, 0, sizeof(double) * rfc_ctx->damage_lut_size );
+    }
+#endif /*RFC_AT_SUPPORT*/
+}
+#endif /*RFC_DH_SUPPORT*/
+
+
+#if RFC_AR_SUPPORT
+static
+bool autoresize( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s* pt )
+{
+    unsigned     cls             = QUANTIZE( rfc_ctx, pt->value );
+    unsigned     class_count     = rfc_ctx->class_count,
+                 class_count_old = class_count,
+                 class_shift     = 0;
+    rfc_value_t  class_offset    = rfc_ctx->class_offset;
+    void        *ptr;
+    size_t       i, j;
+
+    if( pt->value < rfc_ctx->class_offset )
+    {
+        class_shift   = (unsigned)ceil( ( class_offset - (rfc_value_t)(pt->value) ) / rfc_ctx->class_width + 0.5 );
+        class_count  += class_shift;
+        class_offset -= rfc_ctx->class_width * class_shift;
+    }
+    else if( pt->cls >= class_count )
+    {
+        class_count = (unsigned)ceil( ( (rfc_value_t)(pt->value) - class_offset ) / rfc_ctx->class_width + 0.5 );
+    }
+    else
+    {
+        return true;
+    }
+
+    if( class_count > RFC_CLASS_COUNT_MAX )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+    }
+
+    rfc_ctx->class_count  = class_count;
+    rfc_ctx->class_offset = class_offset;
+
+    pt->cls = QUANTIZE( rfc_ctx, pt->value );
+
+#if RFC_DAMAGE_FAST
+    {
+        rfc_state_e old_state = rfc_ctx->state;
+        bool        ok;
+
+        /* Look-up tables are resized according to the new class count */
+        rfc_ctx->damage_lut_inapt = 1;
+        rfc_ctx->state = RFC_STATE_INIT;
+        ok = damage_lut_init( rfc_ctx );
+        rfc_ctx->state = old_state;
+
+        if( !ok )
+        {
+            return false;
+        }
+    }
+#endif /*RFC_DAMAGE_FAST*/
+
+#if !RFC_MINIMAL
+    if( rfc_ctx->damage_multi_count && !damage_multi_lut_init( rfc_ctx ) )
+    {
+        return false;
+    }
+#endif /*!RFC_MINIMAL*/
+
+    if( rfc_ctx->residue )
+    {
+        size_t residue_cap = 2 * class_count + 1;
+
+        ptr = rfc_ctx->mem_alloc( rfc_ctx->residue, residue_cap, 
+                                  sizeof( rfc_value_tuple_s ), RFC_MEM_AIM_RESIDUE );
+
+        if( !ptr )
+        {
+            return false;
+        }
+
+        rfc_ctx->residue     = (rfc_value_tuple_s*)ptr;
+
+        ptr = rfc_ctx->mem_alloc( rfc_ctx->internal.res, residue_cap, 
+                                  sizeof( rfc_res_item_s ), RFC_MEM_AIM_RESIDUE );
+
+        if( !ptr )
+        {
+            return false;
+        }
+
+        rfc_ctx->internal.res     = (rfc_res_item_s*)ptr;
+        rfc_ctx->internal.res_cnt = 0;  /* Classes change */
+        rfc_ctx->residue_cap      = residue_cap;
+
+        /* Residuum */
+        for( i = 0; i < rfc_ctx->residue_cnt; i++ )
+        {
+            rfc_ctx->residue[i].cls = QUANTIZE( rfc_ctx, rfc_ctx->residue[i].value );
+        }
+    }
+
+    for( i = 0; i < rfc_ctx->internal.residue_cap; i++ )
+    {
+        rfc_ctx->internal.residue[i].cls = QUANTIZE( rfc_ctx, rfc_ctx->internal.residue[i].value );
+    }
+
+    /* RFM */
+    if( rfc_ctx->rfm && class_count > RFC_CLASS_COUNT_DENSE_MAX )
+    {
+        /* Dense matrix would exceed its limit, continue with sparse storage */
+        rfc_counts_t *rfm = rfc_ctx->rfm;
+
+        if( !rfm_sparse_init( rfc_ctx ) )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
+
+        for( i = 0; i < class_count_old; i++ )
+        {
+            for( j = 0; j < class_count_old; j++ )
+            {
+                rfc_counts_t  counts = rfm[ i * class_count_old + j ];
+                rfc_counts_t *element;
+
+                if( !counts ) continue;
+
+                element = rfm_sparse_find( rfc_ctx, (unsigned)( i + class_shift ), (unsigned)( j + class_shift ), /*create*/ true );
+                if( !element )
+                {
+                    rfm_sparse_free( rfc_ctx );
+                    return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+                }
+                *element = counts;
+            }
+        }
+
+        rfc_ctx->rfm            = NULL;
+        rfc_ctx->internal.flags = (rfc_flags_e)( rfc_ctx->internal.flags | RFC_FLAGS_SPARSE_RFM );
+        rfc_ctx->mem_alloc( rfm, 0, 0, RFC_MEM_AIM_MATRIX );
+
+        /* Summed-area tables need dense storage */
+        rfm_sat_free( rfc_ctx );
+        rfc_ctx->internal.rfm_sat.enabled = false;
+
+        /* Kernels count into dense storage only */
+        counts_bind( rfc_ctx );
+    }
+    else if( rfc_ctx->rfm )
+    {
+        ptr = rfc_ctx->mem_alloc( NULL, class_count * class_count, 
+                                  sizeof(rfc_counts_t), RFC_MEM_AIM_MATRIX );    
+        if( !ptr )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
+        else
+        {
+            rfc_counts_t *rfm = (rfc_counts_t*)ptr;
+
+            for( i = 0; i < class_count_old; i++ )
+            {
+                for( j = 0; j < class_count_old; j++ )
+                {
+                    rfm[ MAT_OFFS( i + class_shift, j + class_shift ) ] = rfc_ctx->rfm[ i * class_count_old + j ];
+                }
+            }
+
+            ptr = rfc_ctx->rfm;
+            rfc_ctx->rfm = rfm;
+            rfc_ctx->mem_alloc( ptr, 0, 0, RFC_MEM_AIM_MATRIX );
+
+            /* Summed-area tables are rebuilt on next query */
+            rfm_sat_free( rfc_ctx );
+        }
+    }
+    else if( rfc_ctx->rfm_sparse && !rfm_sparse_resize( rfc_ctx, class_count_old, class_count, class_shift ) )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+    }
+
+#if !RFC_MINIMAL
+    /* LC */
+    if( rfc_ctx->lc )
+    {
+        /* Pending level crossings are counted on old classes */
+        rfc_ctx->class_count = class_count_old;
+        lc_flush( rfc_ctx );
+        rfc_ctx->class_count = class_count;
+
+        ptr = rfc_ctx->mem_alloc( rfc_ctx->internal.lc_diff, class_count,
+                                  sizeof(rfc_counts_t), RFC_MEM_AIM_LC );
+        if( !ptr )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
+        rfc_ctx->internal.lc_diff = (rfc_counts_t*)ptr;
+        memset( rfc_ctx->internal.lc_diff, 0, sizeof(rfc_counts_t) * class_count );
+
+        ptr = rfc_ctx->mem_alloc( NULL, class_count,
+                                  sizeof(rfc_counts_t), RFC_MEM_AIM_LC );
+        if( !ptr )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
+        else
+        {
+            rfc_counts_t* lc = (rfc_counts_t*)ptr;
+
+            for( i = 0; i < class_count_old; i++ )
+            {
+                lc[i + class_shift] = rfc_ctx->lc[i];
+            }
+
+            ptr = rfc_ctx->lc;
+            rfc_ctx->lc = lc;
+            rfc_ctx->mem_alloc( ptr, 0, 0, RFC_MEM_AIM_LC );
+        }
+
+        /* RP */
+        ptr = rfc_ctx->mem_alloc( NULL, class_count,
+                                  sizeof(rfc_counts_t), RFC_MEM_AIM_RP );
+        if( !ptr )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
+        else
+        {
+            rfc_counts_t* rp = (rfc_counts_t*)ptr;
+
+            for( i = 0; i < class_count_old; i++ )
+            {
+                rp[i] = rfc_ctx->rp[i];
+            }
+
+            ptr = rfc_ctx->rp;
+            rfc_ctx->rp = rp;
+            rfc_ctx->mem_alloc( ptr, 0, 0, RFC_MEM_AIM_RP );
+        }
+    }
+#endif /*!RFC_MINIMAL*/
+
+#if RFC_TP_SUPPORT
+    for( i = 0; i < rfc_ctx->tp_cnt + ( rfc_ctx->state == RFC_STATE_BUSY_INTERIM ); i++ )
+    {
+#if RFC_USE_DELEGATES
+        if( rfc_ctx->tp_get_fcn || rfc_ctx->tp_set_fcn )
+        {
+            rfc_value_tuple_s *pt;
+
+            tp_get( rfc_ctx, i + 1, &pt );  /* tp_pos is base 1 */
+            pt->cls = QUANTIZE( rfc_ctx, pt->value );
+            tp_set( rfc_ctx, i + 1, pt );  /* tp_pos is base 1 */
+        }
+#else /*!RFC_USE_DELEGATES*/
+        rfc_ctx->tp[i].cls = QUANTIZE( rfc_ctx, rfc_ctx->tp[i].value );
+#endif /*RFC_USE_DELEGATES*/
+    }
+
+    rfc_ctx->internal.margin[0].cls = QUANTIZE( rfc_ctx, rfc_ctx->internal.margin[0].value );
+    rfc_ctx->internal.margin[1].cls = QUANTIZE( rfc_ctx, rfc_ctx->internal.margin[1].value );
+
+#endif /*RFC_TP_SUPPORT*/
+
+#if RFC_GLOBAL_EXTREMA
+    rfc_ctx->internal.extrema[0].cls = QUANTIZE( rfc_ctx, rfc_ctx->internal.extrema[0].value );
+    rfc_ctx->internal.extrema[1].cls = QUANTIZE( rfc_ctx, rfc_ctx->internal.extrema[1].value );
+#endif /*RFC_GLOBAL_EXTREMA*/
+
+#if RFC_HCM_SUPPORT
+    for( i = 0; i < rfc_ctx->internal.hcm.stack_cap; i++ )
+    {
+        rfc_ctx->internal.hcm.stack[i].cls = QUANTIZE( rfc_ctx, rfc_ctx->internal.hcm.stack[i].value );
+    }
+#endif /*RFC_HCM_SUPPORT*/
+
+    return true;
+}
+
+#endif /*RFC_AR_SUPPORT*/
+
+
+/**
+ * @brief      Processing one data point. Find turning points and check for
+ *             closed cycles.
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param[in]  pt       The data tuple
+ * @param      flags    The flags
+ *
+ * @return     true on success
+ */
+static
+bool feed_once( rfc_ctx_s *rfc_ctx, const rfc_value_tuple_s* pt, rfc_flags_e flags )
+{
+    rfc_value_tuple_s *tp_residue;  /* Pointer to residue element */
+
+    assert( rfc_ctx && pt );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+
+#if RFC_DH_SUPPORT
+    /* Resize damage history if necessary */
+    if( !feed_once_dh( rfc_ctx, pt ) )
+    {
+        return false;
+    }
+#endif /*RFC_DH_SUPPORT*/
+
+    /* Check for next turning point and update residue. tp_residue is NULL, if there is no turning point */
+    /* Otherwise tp_residue refers the forelast element in member rfc_ctx->residue */
+    tp_residue = feed_filter_pt( rfc_ctx, pt );
+
+#if RFC_TP_SUPPORT
+    /* Check if pt influences margins (tp_residue may be set to NULL then!) */
+    if( !feed_once_tp_check_margin( rfc_ctx, pt, &tp_residue ) )
+    {
+        return false;
+    }
+#endif /*RFC_TP_SUPPORT*/
+
+    /* Countings */
+
+    /* Add turning point and check for closed cycles */
+    if( tp_residue )
+    {
+#if RFC_TP_SUPPORT
+        /* Add a copy of tp_residue to rfc_ctx->tp and alter tp_residue->tp_pos to its position in rfc_ctx->tp */
+        if( !tp_set( rfc_ctx, 0, tp_residue ) )
+        {
+            return false;
+        }
+#endif /*RFC_TP_SUPPORT*/
+
+#if !RFC_MINIMAL
+        /* New turning point, do LC count */
+        cycle_process_lc( rfc_ctx, flags & (RFC_FLAGS_COUNT_LC | RFC_FLAGS_ENFORCE_MARGIN) );
+        flags &= ~RFC_FLAGS_COUNT_LC;
+#endif /*!RFC_MINIMAL*/
+
+        if( rfc_ctx->class_count )
+        {
+            /* Check for closed cycles and count. Modifies residue! */
+            cycle_find( rfc_ctx, flags );
+        }
+        else
+        {
+            if( rfc_ctx->residue_cnt > 1 )
+            {
+                residue_remove_item( rfc_ctx, 0, 1 );
+            }
+        }
+    }
+
+    return true;
+}
+
+
+#if RFC_DH_SUPPORT
+/**
+ * @brief      Resize damage history if necessary.
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param[in]  pt       The data tuple
+ *
+ * @return     true on success
+ */
+static
+bool feed_once_dh( rfc_ctx_s *rfc_ctx, const rfc_value_tuple_s* pt )
+{
+    assert( rfc_ctx );
+    assert( pt );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+
+    if( rfc_ctx->dh )
+    {
+        if( pt->pos > rfc_ctx->dh_cap )
+        {
+            size_t new_cap = (size_t)1024 * ( pt->pos / 640 + 1 ); /* + 60% + 1024 */
+
+            if( rfc_ctx->internal.dh_map )
+            {
+                /* File backed storage, the extension reads as zero and stays a hole until written */
+                if( !map_resize( rfc_ctx->internal.dh_map, new_cap * sizeof(double) ) )
+                {
+                    return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+                }
+
+                rfc_ctx->dh     = (double*)rfc_ctx->internal.dh_map->ptr;
+                rfc_ctx->dh_cap = rfc_ctx->internal.dh_map->bytes / sizeof(double);
+            }
+            else
+            {
+                rfc_ctx->dh = (double*)rfc_ctx->mem_alloc( rfc_ctx->dh, new_cap, 
+                                                           sizeof(rfc_value_t), RFC_MEM_AIM_DH );
+
+                if( !rfc_ctx->dh )
+                {
+                    return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+                }
+
+                memset( rfc_ctx->dh + rfc_ctx->dh_cnt, 0, sizeof(rfc_value_t) * ( new_cap - rfc_ctx->dh_cap ) );
+                rfc_ctx->dh_cap = new_cap;
+            }
+        }
+
+        rfc_ctx->dh_cnt = pt->pos;
+    }
+
+    return true;
+}
+#endif /*RFC_DH_SUPPORT*/
+
+
+#if RFC_TP_SUPPORT
+/**
+ * @brief         Check if pt influences margins.
+ *
+ * @param         rfc_ctx     The rainflow context
+ * @param[in]     pt          The new data tuple
+ * @param[in,out] tp_residue  The new turning point (or NULL)
+ *
+ * @return        true on success
+ */
+bool feed_once_tp_check_margin( rfc_ctx_s *rfc_ctx, const rfc_value_tuple_s* pt, rfc_value_tuple_s** tp_residue )
+{
+    bool do_margin;
+
+    assert( rfc_ctx && tp_residue );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+
+    do_margin = rfc_ctx->internal.flags & RFC_FLAGS_ENFORCE_MARGIN;
+
+    if( do_margin && !rfc_ctx->tp_locked )
+    {
+        /* Check for left and right margin */
+        switch( rfc_ctx->internal.margin_stage )
+        {
+            case 0:
+            {
+                rfc_value_tuple_s pt_left = *pt;
+
+                assert( *tp_residue == NULL );
+
+                /* Save left margin */
+                rfc_ctx->internal.margin[0]  = *pt;
+
+                /* Enqueue left margin as turning point */
+                if( !tp_set( rfc_ctx, 0, &pt_left ) ) return false;
+
+                rfc_ctx->internal.margin_stage = 1;
+                break;
+            }
+
+            case 1:
+            {
+                /* Save right margin so far */
+                rfc_ctx->internal.margin[1] = *pt;
+
+                /* Prevent storing 1st point twice */
+                if( *tp_residue )
+                {
+                    /* First turning point found */
+                    rfc_ctx->internal.margin_stage = 2;
+
+                    if( (*tp_residue)->value == rfc_ctx->internal.margin[0].value )
+                    {
+                        assert( rfc_ctx->tp_cnt <= 1 );
+
+                        /* Left margin and first turning point are identical, set reference in residue */
+                        (*tp_residue)->tp_pos = 1;
+                        (*tp_residue) = 0;  /* Avoid further processing of this turning point */
+                    }
+                }
+                break;
+            }
+
+            case 2:
+                /* Save right margin so far */
+                rfc_ctx->internal.margin[1] = *pt;
+                break;
+
+            default:
+                assert( false );
+        }
+    }
+
+    return true;
+}
+#endif /*RFC_TP_SUPPORT*/
+
+
+/**
+ * @brief      Handling interim turning point and margin. If there are still
+ *             unhandled turning point left, "finalizing" takes this into
+ *             account for the rainflow algorithm.
+ *
+ * @param      rfc_ctx  The rainflow context
+ *
+ * @return     true on success
+ */
+static
+bool feed_finalize( rfc_ctx_s *rfc_ctx )
+{
+    rfc_value_tuple_s *tp_interim = NULL;
+
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+
+    if( rfc_ctx->state < RFC_STATE_FINALIZE )
+    {
+        /* Adjust residue: Incorporate interim turning point */
+        if( rfc_ctx->state == RFC_STATE_BUSY_INTERIM )
+        {
+            tp_interim = &rfc_ctx->residue[rfc_ctx->residue_cnt];
+            rfc_ctx->residue_cnt++;
+
+            rfc_ctx->state = RFC_STATE_BUSY;
+        }
+
+#if RFC_TP_SUPPORT
+        /* Finalize turning point storage */
+        if( !feed_finalize_tp( rfc_ctx, tp_interim, rfc_ctx->internal.flags ) )
+        {
+            return false;
+        }
+#endif /*RFC_TP_SUPPORT*/
+
+        if( tp_interim )
+        {
+            int flags = rfc_ctx->internal.flags;
+#if !RFC_MINIMAL
+            /* New turning point, do LC count */
+            cycle_process_lc( rfc_ctx, rfc_ctx->internal.flags & (RFC_FLAGS_COUNT_LC | RFC_FLAGS_ENFORCE_MARGIN) );
+            flags &= ~RFC_FLAGS_COUNT_LC;
+#endif /*!RFC_MINIMAL*/
+
+            /* Check once more if a new cycle is closed now */
+#if RFC_TP_SUPPORT
+            /* feed_finalize_tp(...) has locked the tp storage, but we may need to alter .pos and .adj_pos */
+            tp_lock( rfc_ctx, false );
+            cycle_find( rfc_ctx, flags );
+            tp_lock( rfc_ctx, true );
+#else /*!RFC_TP_SUPPORT*/
+            cycle_find( rfc_ctx, flags );
+#endif /*RFC_TP_SUPPORT*/
+        }
+
+#if RFC_HCM_SUPPORT
+        if( !feed_finalize_hcm( rfc_ctx, rfc_ctx->internal.flags ) )
+        {
+            return false;
+        }
+#endif /*RFC_HCM_SUPPORT*/
+
+        rfc_ctx->state = RFC_STATE_FINALIZE;
+    }
+
+    return true;
+}
+
+
+#if RFC_TP_SUPPORT
+/**
+ * @brief         Finalize turning point storage.
+ *
+ * @param         rfc_ctx     The rainflow context
+ * @param[in,out] tp_interim  The interim turning point (or NULL)
+ * @param         flags       Only flag RFC_FLAGS_ENFORCE_MARGIN encounters
+ *
+ * @return        true on success
+ */
+static
+bool feed_finalize_tp( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s *tp_interim, rfc_flags_e flags )
+{
+    bool do_margin;
+
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    
+    /* Finalize turning points storage */
+    do_margin = rfc_ctx->internal.flags & RFC_FLAGS_ENFORCE_MARGIN;
+    if( do_margin && !rfc_ctx->tp_locked )
+    {
+        rfc_value_tuple_s *pt_right = &rfc_ctx->internal.margin[1];
+
+        if( tp_interim )
+        {
+            if( rfc_ctx->internal.margin_stage > 0 && tp_interim->value == pt_right->value )
+            {
+                if( !tp_set( rfc_ctx, 0, pt_right ) ) return false;
+                tp_interim->tp_pos = pt_right->tp_pos;
+            }
+            else
+            {
+                if( !tp_set( rfc_ctx, 0, tp_interim ) ) return false;
+                if( !tp_set( rfc_ctx, 0, pt_right ) )   return false;
+            }
+        }
+        else if( pt_right->pos > 0 )
+        {
+            if( !tp_set( rfc_ctx, 0, pt_right ) )   return false;
+        }
+    }
+    else if( tp_interim )
+    {
+        if( !tp_set( rfc_ctx, 0, tp_interim ) ) return false;
+    }
+
+    /* Lock turning points storage */
+    tp_lock( rfc_ctx, true );
+    return true;
+}
+#endif /*RFC_TP_SUPPORT*/
+
+
+#if RFC_HCM_SUPPORT
+/**
+ * @brief      Finalize HCM algorithm: copy residue.
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      flags    The flags
+ *
+ * @return     true on success
+ */
+static
+bool feed_finalize_hcm( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+{
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+
+    /* Move HCM stack to residue */
+    if( rfc_ctx->counting_method == RFC_COUNTING_METHOD_HCM )
+    {
+        int stack_cnt = rfc_ctx->internal.hcm.IZ; /* Number of turning points in HCM stack */
+
+        if( stack_cnt )
+        {
+            /* Reallocate residue */
+            rfc_ctx->residue = (rfc_value_tuple_s*)rfc_ctx->mem_alloc( rfc_ctx->residue, (size_t)stack_cnt, 
+                                                                       sizeof(rfc_value_tuple_s), RFC_MEM_AIM_RESIDUE );
+
+            if( !rfc_ctx->residue )
+            {
+                return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+            }
+
+            memcpy( rfc_ctx->residue, rfc_ctx->internal.hcm.stack, sizeof(rfc_value_tuple_s) * stack_cnt );
+
+            rfc_ctx->residue_cap = stack_cnt;
+            rfc_ctx->residue_cnt = stack_cnt;
+
+            /* Make HCM stack empty */
+            rfc_ctx->internal.hcm.IZ = 0;
+            rfc_ctx->internal.hcm.IR = 1;
+        }
+    }
+
+    return true;
+}
+#endif /*RFC_HCM_SUPPORT*/
+
+
+/**
+ * @brief      Finalize pending counts, ignore residue.
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      flags    The flags
+ *
+ * @return     true on success
+ */
+static
+bool finalize_res_ignore( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+{
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+
+    /* Include interim turning point */
+    return feed_finalize( rfc_ctx );
+}
+
+
+/**
+ * @brief      Finalize pending counts, ignore residue, don't finalize
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      flags    The flags
+ *
+ * @return     true on success
+ */
+static
+bool finalize_res_no_finalize( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+{
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+
+    rfc_ctx->state = RFC_STATE_FINALIZE;
+
+    return true;
+}
+
+
+#if !RFC_MINIMAL
+/**
+ * @brief      Finalize pending counts, discard residue.
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      flags    The flags
+ *
+ * @return     true on success
+ */
+static
+bool finalize_res_discard( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+{
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+
+    /* Include interim turning point */
+    if( !feed_finalize( rfc_ctx ) )
+    {
+        return false;
+    }
+
+    /* Empty residue */
+    rfc_ctx->residue_cnt = 0;
+
+    return true;
+}
+
+
+/**
+ * @brief      Finalize pending counts, weight unclosed cycles into RP,
+ *             RF-matrix and damage and discard residue.
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      weight   The weight for closed cycles
+ * @param      flags    The flags
+ *
+ * @return     true on success
+ */
+static
+bool finalize_res_weight_cycles( rfc_ctx_s *rfc_ctx, rfc_counts_t weight, rfc_flags_e flags )
+{
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+
+    /* Include interim turning point */
+    if( !feed_finalize( rfc_ctx ) )
+    {
+        return false;
+    }
+
+    /* Count every unclosed cycle with the given weight */
+    if( rfc_ctx->residue && rfc_ctx->residue_cnt >= 2 )
+    {
+        size_t             i;
+        int                flags    = rfc_ctx->internal.flags;
+        rfc_value_tuple_s *from     = rfc_ctx->residue;
+        rfc_counts_t       old_inc  = rfc_ctx->curr_inc;
+
+        rfc_ctx->curr_inc = weight;
+
+        for( i = 0; i + 1 < rfc_ctx->residue_cnt; i++ )
+        {
+            rfc_value_tuple_s *to   = from + 1;
+            rfc_value_tuple_s *next = ( i + 2 < rfc_ctx->residue_cnt ) ? to + 1 : NULL;
+
+            cycle_process_counts( rfc_ctx, from, to, next, flags );
+
+            from = to;
+        }
+
+        rfc_ctx->curr_inc = old_inc;
+    }
+
+    /* Empty residue */
+    rfc_ctx->residue_cnt = 0;
+
+    return true;
+}
+
+
+/**
+ * @brief      Finalize pending counts to fit HCM results.
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      flags    The flags
+ *
+ * @return     true on success
+ */
+static
+bool finalize_res_clormann_seeger( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+{
+    size_t i;
+
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+
+    /* Include interim turning point */
+    if( !feed_finalize( rfc_ctx ) )
+    {
+        return false;
+    }
+
+    if( rfc_ctx->counting_method == RFC_COUNTING_METHOD_4PTM )
+    {
+        /* Counting correction on residue */
+
+        for( i = 0; i + 4 < rfc_ctx->residue_cnt; )
+        {
+            size_t idx = rfc_ctx->residue_cnt + i;
+
+            double A = (double)rfc_ctx->residue[idx+0].value;
+            double B = (double)rfc_ctx->residue[idx+1].value;
+            double C = (double)rfc_ctx->residue[idx+2].value;
+            double D = (double)rfc_ctx->residue[idx+3].value;
+
+            if( B * C < 0.0 && fabs(D) >= fabs(B) && fabs(B) >= fabs(C) )
+            {
+                rfc_value_tuple_s *from = &rfc_ctx->residue[idx+1];
+                rfc_value_tuple_s *to   = &rfc_ctx->residue[idx+2];
+
+                cycle_process_counts( rfc_ctx, from, to, to + 1, flags );
+
+                /* Remove two inner turning points (idx+1 and idx+2) */
+                residue_remove_item( rfc_ctx, i + 1, 2 );
+                rfc_ctx->residue_cnt -= 2;
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief      Finalize pending counts, DIN method.
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      flags    The flags
+ *
+ * @return     true on success
+ */
+static
+bool finalize_res_rp_DIN45667( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+{
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+
+    /* Include interim turning point */
+    if( !feed_finalize( rfc_ctx ) )
+    {
+        return false;
+    }
+
+    if( flags && rfc_ctx->residue_cnt > 2 )
+    {
+        int i, j, k;
+        int slopes_cnt = (int)rfc_ctx->residue_cnt - 1;
+        struct slopes
+        {
+            int slope;
+            rfc_value_tuple_s *lhs;
+            rfc_value_tuple_s *rhs;
+        } *slopes, tmp;
+
+        slopes = (struct slopes*)rfc_ctx->mem_alloc( NULL, slopes_cnt, sizeof( slopes[0] ), RFC_MEM_AIM_TEMP );
+
+        if( !slopes )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
+
+        /* Evaluate slopes */
+        for( i = 0; i < slopes_cnt; i++ )
+        {
+            slopes[i].lhs   = &rfc_ctx->residue[i];
+            slopes[i].rhs   = &rfc_ctx->residue[i+1];
+            slopes[i].slope = (int)slopes[i].rhs->cls - slopes[i].lhs->cls;
+        }
+
+        /* Order slopes (simple "bubble sort") */
+        k = 0;
+        for( i = 0; i < slopes_cnt; i++ )
+        {
+            /* Drag higher ranks */
+            for( j = slopes_cnt - 2; j >= i; j-- )
+            {
+                bool do_swap = false;
+
+                if( ( slopes[j].slope > 0 ) == ( slopes[j+1].slope > 0 ) )
+                {
+                    do_swap = abs( slopes[j].slope ) < abs( slopes[j+1].slope );
+                }
+                else
+                {
+                    do_swap = slopes[j].slope < 0;
+                    k       = j + 1;  /* k indicates the first falling slope now */
+                }
+
+                if( do_swap )
+                {
+                    tmp         = slopes[j];
+                    slopes[j]   = slopes[j+1];
+                    slopes[j+1] = tmp;
+                }
+            }
+        }
+
+        assert( k > 0 );
+
+        /* Compare positive slopes with adjacent negative slopes */
+        for( i = 0; i < k && i + k < slopes_cnt; i++ )
+        {
+            /* Get the smaller slope of two adjacent. On equality choose the primarily in time */
+            int lh_slope = slopes[i].slope;
+            int rh_slope = slopes[i+k].slope;
+
+            if( abs( lh_slope ) == abs( rh_slope ) )
+            {
+                j = ( slopes[i].rhs->pos < slopes[i+k].rhs->pos ) ? i : (i+k);
+            }
+            else
+            {
+                j = ( abs( lh_slope ) < abs( rh_slope ) ) ? i : (i+k);
+            }
+
+            /* Do the countings for the matching slope */
+            cycle_process_counts( rfc_ctx, slopes[j].lhs, slopes[j].rhs, NULL, flags );
+        }
+
+        rfc_ctx->mem_alloc( slopes, 0, 0, RFC_MEM_AIM_TEMP );
+    }
+
+    /* Empty residue */
+    rfc_ctx->residue_cnt = 0;
+
+    return true;
+}
+
+
+/**
+ * @brief      Finalize pending counts, repeated residue method.
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      flags    The flags
+ *
+ * @return     true on success
+ */
+static
+bool finalize_res_repeated( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+{
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+
+    /* Process only, if residue is present */
+    if( rfc_ctx->residue && rfc_ctx->residue_cnt && flags )
+    {
+        /* Feed again with the content of the residue itself */
+        size_t              cnt     = rfc_ctx->residue_cnt;
+        rfc_value_tuple_s  *residue = (rfc_value_tuple_s*)rfc_ctx->mem_alloc( NULL, cnt + 1, 
+                                                                              sizeof(rfc_value_tuple_s), RFC_MEM_AIM_TEMP );
+
+        if( rfc_ctx->state == RFC_STATE_BUSY_INTERIM )
+        {
+            cnt++;
+        }
+
+        if( !residue )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
+        else
+        {
+            /* Make a copy of the residue */
+            bool                     ok;
+            size_t                   n         = cnt; 
+            int                      old_flags = rfc_ctx->internal.flags;
+            const rfc_value_tuple_s *from      = rfc_ctx->residue;
+                  rfc_value_tuple_s *to        = residue;
+
+            while( n-- )
+            {
+                *to++ = *from++;
+            }
+
+            rfc_ctx->internal.flags = flags;
+
+            /* 
+             * Feed again with the copy, no new turning points are generated, since residue[].tp_pos
+             * but last cycle might not be closed due to interim state of the last point.
+             * Remove that cycle before feeding with the residue again:
+             */
+            if( cnt >= 4 )
+            {
+                size_t idx = cnt - 4;
+
+                unsigned A = residue[idx+0].cls;
+                unsigned B = residue[idx+1].cls;
+                unsigned C = residue[idx+2].cls;
+                unsigned D = residue[idx+3].cls;
+
+                if( B > C )
+                {
+                    unsigned temp = B;
+                    B = C;
+                    C = temp;
+                }
+
+                if( A > D )
+                {
+                    unsigned temp = A;
+                    A = D;
+                    D = temp;
+                }
+
+                /* Check for closed cycles [3] */
+                if( A <= B && C <= D )
+                {
+                    residue[idx+1] = residue[idx+3];
+                    cnt -= 2;
+                }
+            }
+
+#if RFC_TP_SUPPORT
+            do
+            {
+                size_t tp_cnt = rfc_ctx->tp_cnt;
+
+                /* Feed with all but the last data point, which will be handled later */
+                ok = RFC_feed_tuple( rfc_ctx, residue, cnt - 1 );
+
+                if( ok )
+                {
+                    /* The only scenario in which the number of turning points increases, is when
+                       the interim turning point gets a real turning point */
+                    if( rfc_ctx->tp_cnt > tp_cnt )
+                    {
+                        /* Interim turning point became a turning point, fix the copy */
+                        residue[cnt-1].tp_pos = tp_cnt + 1;
+                    }
+                    // Process the last data point
+                    ok = RFC_feed_tuple( rfc_ctx, residue + cnt - 1, 1 );
+                }
+            } while(0);
+#else /*!RFC_TP_SUPPORT*/
+            ok = RFC_feed_tuple( rfc_ctx, residue, cnt );
+#endif /*RFC_TP_SUPPORT*/
+
+            rfc_ctx->internal.flags = old_flags;
+
+            /* Free temporary residue */
+            rfc_ctx->mem_alloc( residue, 0, 0, RFC_MEM_AIM_TEMP );
+
+            if( !ok )
+            {
+                return false;
+            }
+        }
+    }
+
+    /* Include interim turning point */
+    if( !feed_finalize( rfc_ctx ) )
+    {
+        return false;
+    }
+
+    /* Empty residue */
+    rfc_ctx->residue_cnt = 0;
+
+    return true;
+}
+
+
+/**
+ * @brief         Backup/restore of residue
+ *
+ * @param         rfc_ctx      The rainflow context
+ * @param[in,out] residue      The copy of the current residue
+ * @param[out]    residue_cap  The capacity of the given residue
+ * @param[out]    residue_cnt  The number of points in the given residue
+ * @param         restore      true->restore, false->backup
  *
  * @return        true on success
  */
 static
-bool feed_finalize_tp( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s *tp_interim, rfc_flags_e flags )
+bool residue_exchange( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s **residue, size_t *residue_cap, size_t *residue_cnt, bool restore )
+{
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    assert( residue && residue_cap && residue_cnt );
+    assert( rfc_ctx->residue_cap > 0 );
+
+    if( !restore )
+    {
+        /* Backup */
+        *residue_cap = rfc_ctx->residue_cap;
+        *residue_cnt = rfc_ctx->residue_cnt;
+        *residue     = (rfc_value_tuple_s*)rfc_ctx->mem_alloc( NULL, *residue_cap, 
+                                                               sizeof(rfc_value_tuple_s), RFC_MEM_AIM_TEMP );
+
+        if( !*residue )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
+
+        memcpy( *residue, rfc_ctx->residue, *residue_cnt * sizeof(rfc_value_tuple_s) );
+        residue_mirror_drop( rfc_ctx, 0 );
+    }
+    else
+    {
+        /* Restore */
+
+        /* Release residue */
+        (rfc_value_tuple_s*)rfc_ctx->mem_alloc( rfc_ctx->residue, /*num*/ 0, /*size*/ 0, RFC_MEM_AIM_TEMP );
+
+        /* Assign backup */
+        rfc_ctx->residue_cap = *residue_cap;
+        rfc_ctx->residue_cnt = *residue_cnt;
+        rfc_ctx->residue     = *residue;
+        residue_mirror_drop( rfc_ctx, 0 );
+    }
+
+    return true;
+}
+#endif /*!RFC_MINIMAL*/
+
+
+/**
+ * @brief      Remove items (points) from the residue
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      index    The item position in residue, base 0
+ * @param      count    The number of elements to remove
+ */
+static
+void residue_remove_item( rfc_ctx_s *rfc_ctx, size_t index, size_t count )
+{
+    size_t  from = index + count,
+            to   = index, 
+            end;
+
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    assert( rfc_ctx->residue && index + count <= rfc_ctx->residue_cnt );
+
+    end = (int)rfc_ctx->residue_cnt;
+
+    /* Example
+                         |cnt(5)
+                         v
+               |O|O|X|O|O|
+                   ^
+                   |index(2)
+
+        elements = 2    (5-2-1+0 = 2, no interim turning point)
+    */
+
+    if( rfc_ctx->state == RFC_STATE_BUSY_INTERIM )
+    {
+        /* Include interim turning point */
+        end++;
+    }
+
+    /* Shift points */
+    while( from < end )
+    {
+        rfc_ctx->residue[to++] = rfc_ctx->residue[from++];
+    }
+
+    rfc_ctx->residue_cnt -= count;
+    residue_mirror_drop( rfc_ctx, index );
+}
+
+
+/**
+ * @brief      Invalidate the residue mirror (.internal.res) from a given
+ *             position on. Needed, whenever points already mirrored are
+ *             altered or removed, apart from cycle_find_4ptm().
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      index    The first position to invalidate, base 0
+ */
+static
+void residue_mirror_drop( rfc_ctx_s *rfc_ctx, size_t index )
+{
+    assert( rfc_ctx );
+
+    if( rfc_ctx->internal.res_cnt > index )
+    {
+        rfc_ctx->internal.res_cnt = index;
+    }
+}
+
+
+/**
+ * @brief      Calculate damage for one cycle with given amplitude Sa
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      Sa       The amplitude
+ * @param[out] damage   The damage
+ *
+ * @return     true on success
+ */
+static
+bool damage_calc_amplitude( rfc_ctx_s *rfc_ctx, double Sa, double *damage )
+{
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT );
+
+    do {
+        /* Damage */
+        double D = 0.0;
+
+        if( Sa >= 0.0 )
+        {
+            /* D =           h /    ND   *    ( Sa /    SD)  ^ ABS(k)   */
+            /* D = exp(  log(h /    ND)  + log( Sa /    SD)  * ABS(k) ) */
+            /* D = exp( (log(h)-log(ND)) + (log(Sa)-log(SD)) * ABS(k) ) */
+            /* D = exp(      0 -log(ND)  + (log(Sa)-log(SD)) * ABS(k) ) */
+
+            /* If D is integer format count:
+             * 
+             * D_integer = (double)(int)range ^ ABS(k)  // where range is 0..class_count-1
+             * 
+             * D = D_integer_sum * exp( log( ND * 2*SD/class_width ) * -ABS(k) )
+             * 
+             */
+
+#if !RFC_MINIMAL
+            if( Sa > rfc_ctx->wl_omission )
+            {
+                /* Constants for the Woehler curve */
+                const double SX_log = log(rfc_ctx->wl_sx);
+                const double NX_log = log(rfc_ctx->wl_nx);
+
+                if( Sa > rfc_ctx->wl_sx )
+                {
+                    const double k = rfc_ctx->wl_k;
+                    
+                    /* Upper slope, finite life scope */
+                    D = exp( fabs(k) * ( log(Sa) - SX_log ) - NX_log );
+                }
+                else if( Sa > rfc_ctx->wl_sd )
+                {
+                    const double k2 = rfc_ctx->wl_k2;
+
+                    /* Lower slope, transition scope, modified Miners' rule */
+                    D = exp( fabs(k2) * ( log(Sa) - SX_log ) - NX_log );
+                }
+                /* Amplitudes below fatigue strength have no influence */
+            }
+#else /*RFC_MINIMAL*/
+            /* Constants for the Woehler curve */
+            const double SX_log = log(rfc_ctx->wl_sx);
+            const double NX_log = log(rfc_ctx->wl_nx);
+            const double k      = rfc_ctx->wl_k;
+
+            /* Miner original */
+            D = exp( fabs(k)  * ( log(Sa) - SX_log ) - NX_log );
+#endif /*!RFC_MINIMAL*/
+        }
+        else
+        {
+            assert( false );
+            return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+        }
+
+        *damage = D;
+        
+    } while(0);
+
+    return true;
+}
+
+
+#if !RFC_MINIMAL
+/**
+ * @brief      Prepare the Miner consequent state. Constants are taken from the
+ *             Woehler curve parameters (unimpaired part) and their shadow copy
+ *             .internal.wl (impaired part).
+ *
+ * @param      rfc_ctx  The rainflow context
+ */
+static
+void mk_init( rfc_ctx_s *rfc_ctx )
+{
+    const rfc_wl_param_s *wl_imp = &rfc_ctx->internal.wl;
+    double                upper, upper_imp;
+
+    assert( !rfc_ctx->internal.mk.pending );
+
+    rfc_ctx->internal.mk.sx         = rfc_ctx->wl_sx;
+    rfc_ctx->internal.mk.sd         = rfc_ctx->wl_sd;
+    rfc_ctx->internal.mk.nd         = rfc_ctx->wl_nd;
+    rfc_ctx->internal.mk.sx_log     = log( rfc_ctx->wl_sx );
+    rfc_ctx->internal.mk.nx_log     = log( rfc_ctx->wl_nx );
+    rfc_ctx->internal.mk.k          = fabs( wl_imp->k );
+    rfc_ctx->internal.mk.k2         = fabs( wl_imp->k2 );
+    rfc_ctx->internal.mk.q_rcp      = 1.0 / wl_imp->q;
+    rfc_ctx->internal.mk.q2_rcp     = 1.0 / wl_imp->q2;
+    rfc_ctx->internal.mk.omission   = wl_imp->omission;
+    rfc_ctx->internal.mk.sx_log_imp = log( wl_imp->sx );
+    rfc_ctx->internal.mk.nx_log_imp = log( wl_imp->nx );
+
+    /* The impaired curve extends the upper slope (sx and nx move along k),
+       so damages above sx are those of the unimpaired curve */
+    upper     = rfc_ctx->internal.mk.k * rfc_ctx->internal.mk.sx_log     + rfc_ctx->internal.mk.nx_log;
+    upper_imp = rfc_ctx->internal.mk.k * rfc_ctx->internal.mk.sx_log_imp + rfc_ctx->internal.mk.nx_log_imp;
+
+    rfc_ctx->internal.mk.lut        = fabs( rfc_ctx->wl_k ) == rfc_ctx->internal.mk.k &&
+                                      rfc_ctx->wl_omission  == rfc_ctx->internal.mk.omission &&
+                                      fabs( upper_imp - upper ) <= 1e-12 * fabs( upper );
+    rfc_ctx->internal.mk.valid      = true;
+}
+
+
+/**
+ * @brief      Count one damaging cycle on the impaired Woehler curve and
+ *             depress the impaired curve, according to Miner's consequent rule.
+ *             Sd(D)/Sd = (1-D)^(1/q), [6] chapter 3.2.9, formula 3.2-44 and 3.2-46.
+ *             Parameters sx and nx of the impaired part are kept in log domain,
+ *             .internal.wl is brought up to date by mk_flush().
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      Sa       The amplitude
+ * @param      D_unimp  The damage of Sa on the unimpaired curve
+ */
+static
+void mk_count( rfc_ctx_s *rfc_ctx, double Sa, double D_unimp )
+{
+    double D_con = 0.0;  /* Current damage, Miners' consequent rule */
+
+    if( !rfc_ctx->internal.mk.valid )
+    {
+        mk_init( rfc_ctx );
+    }
+
+    /* Damage on the impaired curve, as damage_calc_amplitude() would do */
+    if( Sa > rfc_ctx->internal.mk.omission )
+    {
+        if( rfc_ctx->internal.mk.lut && Sa > rfc_ctx->internal.mk.sx )
+        {
+            /* Upper slope, finite life scope, unaltered */
+            D_con = D_unimp;
+        }
+        else
+        {
+            double Sa_log = log( Sa );
+
+            if( Sa_log > rfc_ctx->internal.mk.sx_log_imp )
+            {
+                /* Upper slope, finite life scope */
+                D_con = exp( rfc_ctx->internal.mk.k * ( Sa_log - rfc_ctx->internal.mk.sx_log_imp ) - rfc_ctx->internal.mk.nx_log_imp );
+            }
+            else if( Sa > rfc_ctx->internal.wl.sd )
+            {
+                /* Lower slope, transition scope */
+                D_con = exp( rfc_ctx->internal.mk.k2 * ( Sa_log - rfc_ctx->internal.mk.sx_log_imp ) - rfc_ctx->internal.mk.nx_log_imp );
+            }
+        }
+    }
+
+    D_con += rfc_ctx->internal.wl.D;
+
+    if( D_con < 1.0 )
+    {
+        /* Calculate new parameters for the Woehler curve, impaired part */
+        double depression_log = log( 1.0 - D_con );
+
+        if( rfc_ctx->internal.mk.sx > 0.0 )
+        {
+            /* sx(D) = sx * (1-D)^(1/q), nx(D) = nx * (sx/sx(D))^k */
+            rfc_ctx->internal.mk.sx_log_imp = rfc_ctx->internal.mk.sx_log + depression_log * rfc_ctx->internal.mk.q_rcp;
+            rfc_ctx->internal.mk.nx_log_imp = rfc_ctx->internal.mk.nx_log - depression_log * rfc_ctx->internal.mk.q_rcp * rfc_ctx->internal.mk.k;
+            rfc_ctx->internal.mk.pending    = true;
+        }
+
+        if( rfc_ctx->internal.mk.sd > 0.0 )
+        {
+            /* sd(D) = sd * (1-D)^(1/q2), nd(D) is calculated on mk_flush() */
+            rfc_ctx->internal.wl.sd         = rfc_ctx->internal.mk.sd * exp( depression_log * rfc_ctx->internal.mk.q2_rcp );
+            rfc_ctx->internal.mk.pending    = true;
+        }
+    }
+
+    rfc_ctx->internal.wl.D = D_con;
+}
+
+
+/**
+ * @brief      Update the parameters of the impaired Woehler curve in
+ *             .internal.wl from the Miner consequent state.
+ *
+ * @param      rfc_ctx  The rainflow context
+ */
+static
+void mk_flush( rfc_ctx_s *rfc_ctx )
+{
+    if( !rfc_ctx->internal.mk.pending )
+    {
+        return;
+    }
+
+    mk_flushed( rfc_ctx, &rfc_ctx->internal.wl );
+
+    rfc_ctx->internal.mk.pending = false;
+}
+
+
+/**
+ * @brief      Calculate the parameters sx, nx and nd of the impaired
+ *             Woehler curve from the Miner consequent state. Other
+ *             fields of wl are left untouched.
+ *
+ * @param[in]  rfc_ctx  The rainflow context
+ * @param[out] wl       The Woehler curve parameters to update
+ */
+static
+void mk_flushed( const rfc_ctx_s *rfc_ctx, rfc_wl_param_s *wl )
+{
+    if( rfc_ctx->internal.mk.sx > 0.0 )
+    {
+        wl->sx = exp( rfc_ctx->internal.mk.sx_log_imp );
+        wl->nx = exp( rfc_ctx->internal.mk.nx_log_imp );
+    }
+
+    if( rfc_ctx->internal.mk.sd > 0.0 )
+    {
+        (void)RFC_wl_calc_n( rfc_ctx, rfc_ctx->internal.mk.sd, rfc_ctx->internal.mk.nd, rfc_ctx->internal.mk.k2, 
+                             rfc_ctx->internal.wl.sd, &wl->nd );
+    }
+}
+
+
+/**
+ * @brief      Calculate the pseudo damage of one cycle on a given Woehler
+ *             curve (same as damage_calc_amplitude())
+ *
+ * @param[in]  wl  The Woehler curve parameters
+ * @param      Sa  The amplitude
+ *
+ * @return     The damage
+ */
+static
+double damage_multi_calc( const rfc_wl_param_s *wl, double Sa )
+{
+    if( Sa > wl->omission )
+    {
+        if( Sa > wl->sx )
+        {
+            /* Upper slope, finite life scope */
+            return exp( fabs(wl->k)  * ( log(Sa) - log(wl->sx) ) - log(wl->nx) );
+        }
+        else if( Sa > wl->sd )
+        {
+            /* Lower slope, transition scope, modified Miners' rule */
+            return exp( fabs(wl->k2) * ( log(Sa) - log(wl->sx) ) - log(wl->nx) );
+        }
+    }
+
+    /* Amplitudes below fatigue strength have no influence */
+    return 0.0;
+}
+
+
+/**
+ * @brief      Build the multi-curve damage look-up table. Damages are
+ *             indexed by range class |from-to|, the damages of all Woehler
+ *             curves for one range class are contiguous.
+ *
+ * @param      rfc_ctx  The rainflow context
+ *
+ * @return     true on success
+ */
+static
+bool damage_multi_lut_init( rfc_ctx_s *rfc_ctx )
+{
+    unsigned    count       = rfc_ctx->damage_multi_count;
+    unsigned    class_count = rfc_ctx->class_count;
+    double     *lut;
+    unsigned    range, i;
+
+    if( rfc_ctx->damage_multi_lut )
+    {
+        rfc_ctx->mem_alloc( rfc_ctx->damage_multi_lut, 0, 0, RFC_MEM_AIM_DAMAGE_MULTI );
+        rfc_ctx->damage_multi_lut = NULL;
+    }
+    rfc_ctx->damage_multi_lut_classes = 0;
+
+    if( !count || !class_count )
+    {
+        return true;
+    }
+
+    lut = (double*)rfc_ctx->mem_alloc( NULL, (size_t)class_count * count, sizeof(double), RFC_MEM_AIM_DAMAGE_MULTI );
+    if( !lut )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+    }
+
+    for( range = 0; range < class_count; range++ )
+    {
+        double  Sa  = range / 2.0 * rfc_ctx->class_width;
+        double *row = lut + (size_t)range * count;
+
+        for( i = 0; i < count; i++ )
+        {
+            row[i] = damage_multi_calc( &rfc_ctx->damage_multi_wl[i], Sa );
+        }
+    }
+
+    rfc_ctx->damage_multi_lut           = lut;
+    rfc_ctx->damage_multi_lut_classes   = class_count;
+    rfc_ctx->damage_multi_lut_width     = rfc_ctx->class_width;
+
+    return true;
+}
+
+
+/**
+ * @brief      Cumulate the damage of a closed cycle on all Woehler curves
+ *             given by RFC_damage_multi_init()
+ *
+ * @param      rfc_ctx     The rainflow context
+ * @param      class_from  The starting class
+ * @param      class_to    The ending class
+ * @param      weight      The cycle weight (curr_inc / full_inc)
+ */
+static
+void damage_multi_add( rfc_ctx_s *rfc_ctx, unsigned class_from, unsigned class_to, double weight )
+{
+    const rfc_wl_param_s   *wl      = rfc_ctx->damage_multi_wl;
+    double                 *damage  = rfc_ctx->damage_multi;
+    unsigned                count   = rfc_ctx->damage_multi_count;
+    unsigned                range   = ( class_from > class_to ) ? ( class_from - class_to ) : ( class_to - class_from );
+    bool                    use_lut;
+    unsigned                i;
+
+    assert( wl && damage );
+
+    if( !range )
+    {
+        return;
+    }
+
+    /* The look-up table doesn't cover mean load influence */
+    use_lut = range < rfc_ctx->damage_multi_lut_classes && rfc_ctx->damage_multi_lut_width == rfc_ctx->class_width;
+#if RFC_AT_SUPPORT
+    use_lut = use_lut && !rfc_ctx->at.count;
+#if RFC_USE_DELEGATES
+    use_lut = use_lut && !rfc_ctx->at_transform_fcn;
+#endif /*RFC_USE_DELEGATES*/
+#endif /*RFC_AT_SUPPORT*/
+
+    if( use_lut )
+    {
+        const double *row = rfc_ctx->damage_multi_lut + (size_t)range * count;
+
+        for( i = 0; i < count; i++ )
+        {
+            damage[i] += row[i] * weight;
+        }
+    }
+    else
+    {
+        double Sa = range / 2.0 * rfc_ctx->class_width;
+#if RFC_AT_SUPPORT
+        double Sm = ( (int)class_from + (int)class_to ) / 2.0 * rfc_ctx->class_width + rfc_ctx->class_offset;
+
+        if( !RFC_at_transform( rfc_ctx, Sa, Sm, &Sa ) )
+        {
+            return;
+        }
+#endif /*RFC_AT_SUPPORT*/
+
+        for( i = 0; i < count; i++ )
+        {
+            damage[i] += damage_multi_calc( &wl[i], Sa ) * weight;
+        }
+    }
+}
+
+
+/**
+ * @brief      Free the multi-curve damage accumulator
+ *
+ * @param      rfc_ctx  The rainflow context
+ */
+static
+void damage_multi_free( rfc_ctx_s *rfc_ctx )
+{
+    if( rfc_ctx->damage_multi_wl )  rfc_ctx->mem_alloc( rfc_ctx->damage_multi_wl,  0, 0, RFC_MEM_AIM_DAMAGE_MULTI );
+    if( rfc_ctx->damage_multi )     rfc_ctx->mem_alloc( rfc_ctx->damage_multi,     0, 0, RFC_MEM_AIM_DAMAGE_MULTI );
+    if( rfc_ctx->damage_multi_lut ) rfc_ctx->mem_alloc( rfc_ctx->damage_multi_lut, 0, 0, RFC_MEM_AIM_DAMAGE_MULTI );
+
+    rfc_ctx->damage_multi_wl            = NULL;
+    rfc_ctx->damage_multi               = NULL;
+    rfc_ctx->damage_multi_lut           = NULL;
+    rfc_ctx->damage_multi_count         = 0;
+    rfc_ctx->damage_multi_lut_classes   = 0;
+}
+#endif /*!RFC_MINIMAL*/
+
+
+#if RFC_AT_SUPPORT
+/**
+ * @brief      Calculate the normalized mean load (Sa=1) for a given load ratio
+ *             "R"
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      R        Load ratio (Su/So)
+ * @param[out] Sm_norm  Normalized mean load
+ *
+ * @return     true on success
+ */
+static
+bool at_R_to_Sm_norm( rfc_ctx_s *rfc_ctx, double R, double *Sm_norm )
+{
+    if( isinf( R ) || !Sm_norm )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_AT );
+    }
+
+    /* Su      = Sm - Sa */
+    /* So      = Sm + Sa */
+    /* R       = Su / So */
+    /* Sm      = Sa * ( 1 + R ) / ( 1 - R ) */
+    /* Sm_norm = Sm / Sa */
+
+    *Sm_norm = ( 1 + R ) / ( 1 - R );
+
+    return true;
+}
+
+
+/**
+ * @brief      Calculate the influence of (normalized, Sa=1) mean load on
+ *             fatigue strength (Haigh-diagram)
+ *
+ * @param      rfc_ctx      The rainflow context
+ * @param      Sm_norm      Mean load, normalized (Sm/Sa)
+ * @param[out] alleviation  Alleviation factor on reference curve
+ *
+ * @return     true on success
+ */
+static
+bool at_alleviation( rfc_ctx_s *rfc_ctx, double Sm_norm, double *alleviation )
+{
+    assert( rfc_ctx );
+
+    if( !alleviation )
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_AT );
+    }
+
+    if( !rfc_ctx->at.count )
+    {
+        /* No reference curve given, no transformation */
+        *alleviation = 1.0;
+    }
+    else
+    {
+        /* Reference curve */
+        const double   *Sa_   = rfc_ctx->at.Sa;
+        const double   *Sm_   = rfc_ctx->at.Sm;
+              unsigned  count = rfc_ctx->at.count;
+
+        assert( rfc_ctx && Sm_ && Sa_ );
+
+        if( Sm_norm <= Sm_[0] / Sa_[0] )
+        {
+            /* First segment */
+            *alleviation = Sa_[0];  /* Clip to first point */
+        }
+        else if( Sm_norm >= Sm_[count-1] / Sa_[count-1] )
+        {
+            /* Last segment */
+            *alleviation = Sa_[count-1];  /* Clip to last point */
+        }
+        else
+        {
+            unsigned i;
+            bool done = false;
+
+            /* Select correct segment */
+            for( i = 1; !done && i < count; i++ )
+            {
+                assert( Sa_[i-1] > 0.0 && Sa_[i] > 0.0 && Sm_[i-1] <= Sm_[i] );
+
+                if( Sm_norm > Sm_[i-1] / Sa_[i-1] && Sm_norm <= Sm_[i] / Sa_[i] )
+                {
+                    /* Intersection of R slope and M slope */
+                    double M_signed = ( Sa_[i] - Sa_[i-1] ) / ( Sm_[i] - Sm_[i-1] );
+
+                    *alleviation = ( Sa_[i-1] - M_signed * Sm_[i-1] ) / ( 1.0 - M_signed * Sm_norm );
+                    done = true;
+                }
+            }
+
+            if( !done )
+            {
+                assert( false );
+                return error_raise( rfc_ctx, RFC_ERROR_AT );
+            }
+        }
+    }
+
+    return true;
+}
+#endif /*RFC_AT_SUPPORT*/
+
+
+/**
+ * @brief      Calculate pseudo damage for one closed (full) cycle.
+ *
+ * @param      rfc_ctx     The rainflow context
+ * @param      class_from  The starting class
+ * @param      class_to    The ending class
+ * @param[out] damage      The damage value for the closed cycle
+ * @param[out] Sa_ret      The amplitude, may be NULL
+ *
+ * @return     true on success
+ */
+static
+bool damage_calc( rfc_ctx_s *rfc_ctx, unsigned class_from, unsigned class_to, double *damage, double *Sa_ret )
+{
+    double Sa = -1.0;  /* Negative amplitude states undefined */
+    double D  =  0.0;
+
+    assert( damage );
+    assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT );
+
+#if RFC_DAMAGE_FAST
+    if( rfc_ctx->damage_lut && !rfc_ctx->damage_lut_inapt)
+    {
+        if( !damage_calc_fast( rfc_ctx, class_from, class_to, &D, &Sa ) )
+        {
+            return false;
+        }
+    } 
+    else
+#endif /*RFC_DAMAGE_FAST*/
+
+#if RFC_USE_DELEGATES
+    if( rfc_ctx->damage_calc_fcn )
+    {
+        if( !rfc_ctx->damage_calc_fcn( rfc_ctx, class_from, class_to, &D, &Sa ) )
+        {
+            return false;
+        }
+    }
+    else
+#endif /*RFC_USE_DELEGATES*/
+
+
+    if( class_from != class_to )
+    {
+#if RFC_MINIMAL
+        Sa = fabs( (int)class_from - (int)class_to ) / 2.0 * rfc_ctx->class_width;
+
+        if( !damage_calc_amplitude( rfc_ctx, Sa, &D ) )
+        {
+            return false;
+        }
+#else /*!RFC_MINIMAL*/
+        double Sa_i = fabs( (int)class_from - (int)class_to ) / 2.0 * rfc_ctx->class_width;
+        double Sm_i =     ( (int)class_from + (int)class_to ) / 2.0 * rfc_ctx->class_width + rfc_ctx->class_offset;
+
+        if( Sa_i > 0.0 )
+        {
+#if RFC_AT_SUPPORT
+            /* Calculate transformation factor with normalized mean value */
+            if( !RFC_at_transform( rfc_ctx, Sa_i, Sm_i, &Sa ) )
+            {
+                return false;
+            }
+#else /*!RFC_AT_SUPPORT*/
+            Sa = Sa_i;
+#endif /*RFC_AT_SUPPORT*/
+
+            if( !damage_calc_amplitude( rfc_ctx, Sa, &D ) )
+            {
+                return false;
+            }
+        }
+#endif /*RFC_MINIMAL*/
+    }
+
+    if( Sa_ret )
+    {
+        *Sa_ret = Sa;
+    }
+
+    *damage = D;
+
+    return true;
+}
+
+
+#if RFC_DAMAGE_FAST
+/**
+ * @brief      Calculate pseudo damages for a vector of amplitudes (same as
+ *             damage_calc_amplitude()). Woehler curve constants are taken out
+ *             of the loop, the loop body is free of calls into the context.
+ *             Sa and damage may be the same vector.
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param[in]  Sa       The amplitudes (not negative)
+ * @param[out] damage   The damages
+ * @param      count    The number of amplitudes
+ */
+static
+void damage_calc_amplitudes( const rfc_ctx_s *rfc_ctx, const double *Sa, double *damage, size_t count )
+{
+    /* Constants for the Woehler curve */
+    const double SX_log   = log(rfc_ctx->wl_sx);
+    const double NX_log   = log(rfc_ctx->wl_nx);
+    const double k        = fabs(rfc_ctx->wl_k);
+    const double k2       = fabs(rfc_ctx->wl_k2);
+    const double sx       = rfc_ctx->wl_sx;
+    const double sd       = rfc_ctx->wl_sd;
+    const double omission = rfc_ctx->wl_omission;
+    size_t       i;
+
+    for( i = 0; i < count; i++ )
+    {
+        double Sa_i = Sa[i];
+        double D    = 0.0;
+
+        assert( Sa_i >= 0.0 );
+
+        if( Sa_i > omission )
+        {
+            if( Sa_i > sx )
+            {
+                /* Upper slope, finite life scope */
+                D = exp( k  * ( log(Sa_i) - SX_log ) - NX_log );
+            }
+            else if( Sa_i > sd )
+            {
+                /* Lower slope, transition scope, modified Miners' rule */
+                D = exp( k2 * ( log(Sa_i) - SX_log ) - NX_log );
+            }
+            /* Amplitudes below fatigue strength have no influence */
+        }
+
+        damage[i] = D;
+    }
+}
+
+
+/* Rows of a 2D damage look-up table, filled by one worker */
+struct damage_lut_job
+{
+    rfc_ctx_s                          *rfc_ctx;                    /**< The rainflow context */
+    double                             *lut;                        /**< Damage look-up table */
+    double                             *amplitude_lut;              /**< Amplitude look-up table (may be NULL) */
+    unsigned                            first;                      /**< First row */
+    unsigned                            step;                       /**< Row increment (number of workers) */
+    bool                                ok;                         /**< false, if an error occurred */
+};
+
+
+#if RFC_USE_THREADS
+#if defined(_WIN32)
+static
+DWORD WINAPI damage_lut_thread( LPVOID arg )
+{
+    damage_lut_rows( (struct damage_lut_job*)arg );
+    return 0;
+}
+#else /*!_WIN32*/
+static
+void* damage_lut_thread( void *arg )
+{
+    damage_lut_rows( (struct damage_lut_job*)arg );
+    return NULL;
+}
+#endif /*_WIN32*/
+#endif /*RFC_USE_THREADS*/
+
+
+/**
+ * @brief      Fill rows of a 2D damage look-up table (no delegates).
+ *             Damage doesn't depend on the cycle direction, so each row fills
+ *             its upper triangle and mirrors it into the lower triangle.
+ *             Rows are interleaved among workers to balance the triangle.
+ *
+ * @param      job   The job
+ */
+static
+void damage_lut_rows( struct damage_lut_job *job )
 {
-    bool do_margin;
+    rfc_ctx_s  *rfc_ctx     = job->rfc_ctx;
+    unsigned    class_count = rfc_ctx->class_count;
+    unsigned    from, to;
 
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
-    
-    /* Finalize turning points storage */
-    do_margin = rfc_ctx->internal.flags & RFC_FLAGS_ENFORCE_MARGIN;
-    if( do_margin && !rfc_ctx->tp_locked )
+    for( from = job->first; from < class_count; from += job->step )
     {
-        rfc_value_tuple_s *pt_right = &rfc_ctx->internal.margin[1];
+        double *row = job->lut + MAT_OFFS( from, 0 );
 
-        if( tp_interim )
+        /* Amplitudes first, damages in place */
+        for( to = from + 1; to < class_count; to++ )
         {
-            if( rfc_ctx->internal.margin_stage > 0 && tp_interim->value == pt_right->value )
+            double Sa_i = ( (int)to - (int)from )   / 2.0 * rfc_ctx->class_width;
+#if RFC_AT_SUPPORT
+            double Sm_i = ( (int)from + (int)to )   / 2.0 * rfc_ctx->class_width + rfc_ctx->class_offset;
+
+            if( !RFC_at_transform( rfc_ctx, Sa_i, Sm_i, &row[to] ) )
             {
-                if( !tp_set( rfc_ctx, 0, pt_right ) ) return false;
-                tp_interim->tp_pos = pt_right->tp_pos;
+                job->ok = false;
+                return;
             }
-            else
+#else /*!RFC_AT_SUPPORT*/
+            row[to] = Sa_i;
+#endif /*RFC_AT_SUPPORT*/
+        }
+
+#if RFC_AT_SUPPORT
+        if( job->amplitude_lut )
+        {
+            double *Sa = job->amplitude_lut;
+
+            Sa[ MAT_OFFS( from, from ) ] = -1.0;
+            for( to = from + 1; to < class_count; to++ )
             {
-                if( !tp_set( rfc_ctx, 0, tp_interim ) ) return false;
-                if( !tp_set( rfc_ctx, 0, pt_right ) )   return false;
+                Sa[ MAT_OFFS( from, to ) ] = 
+                Sa[ MAT_OFFS( to, from ) ] = row[to];
             }
         }
-        else if( pt_right->pos > 0 )
+#endif /*RFC_AT_SUPPORT*/
+
+        row[from] = 0.0;
+        damage_calc_amplitudes( rfc_ctx, row + from + 1, row + from + 1, class_count - from - 1 );
+
+        for( to = from + 1; to < class_count; to++ )
         {
-            if( !tp_set( rfc_ctx, 0, pt_right ) )   return false;
+            job->lut[ MAT_OFFS( to, from ) ] = row[to];
         }
     }
-    else if( tp_interim )
+}
+
+
+/**
+ * @brief      Replace shared look-up tables by a copy owned by the context
+ *             (copy on write).
+ *
+ * @param      rfc_ctx  The rainflow context
+ *
+ * @return     true on success
+ */
+static
+bool damage_lut_own( rfc_ctx_s *rfc_ctx )
+{
+    rfc_lut_s  *lut = rfc_ctx->lut;
+    double     *damage_lut;
+#if RFC_AT_SUPPORT
+    double     *amplitude_lut = NULL;
+#endif /*RFC_AT_SUPPORT*/
+
+    assert( lut );
+
+    damage_lut = (double*)rfc_ctx->mem_alloc( NULL, lut->size, sizeof(double), RFC_MEM_AIM_DLUT );
+    if( !damage_lut )
     {
-        if( !tp_set( rfc_ctx, 0, tp_interim ) ) return false;
+        return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
     }
+    memcpy( damage_lut, lut->damage, lut->size * sizeof(double) );
+
+#if RFC_AT_SUPPORT
+    if( lut->amplitude )
+    {
+        amplitude_lut = (double*)rfc_ctx->mem_alloc( NULL, lut->size, sizeof(double), RFC_MEM_AIM_ALUT );
+        if( !amplitude_lut )
+        {
+            rfc_ctx->mem_alloc( damage_lut, 0, 0, RFC_MEM_AIM_DLUT );
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
+        memcpy( amplitude_lut, lut->amplitude, lut->size * sizeof(double) );
+    }
+    rfc_ctx->amplitude_lut = amplitude_lut;
+#endif /*RFC_AT_SUPPORT*/
+
+    rfc_ctx->damage_lut = damage_lut;
+    rfc_ctx->lut        = NULL;
+    (void)RFC_lut_release( lut );
 
-    /* Lock turning points storage */
-    tp_lock( rfc_ctx, true );
     return true;
 }
-#endif /*RFC_TP_SUPPORT*/
 
 
-#if RFC_HCM_SUPPORT
 /**
- * @brief      Finalize HCM algorithm: copy residue.
+ * @brief      Initialize a look-up table of damages for closed cycles.
+ *             As long as damage depends on the range only (no amplitude
+ *             transformation, no delegates), the table has class_count
+ *             entries indexed by |from-to|. Otherwise a class_count^2 table
+ *             indexed by from/to is set up, by several workers for large
+ *             class counts. Beyond RFC_CLASS_COUNT_DENSE_MAX classes the 2D
+ *             tables are paged instead, pages are built on first touch (see
+ *             damage_lut_page()).
+ *             Tables are (re)allocated according to the layout required.
  *
  * @param      rfc_ctx  The rainflow context
- * @param      flags    The flags
+ *
+ * @returns    true on success
+ */
+static 
+bool damage_lut_init( rfc_ctx_s *rfc_ctx )
+{
+    double   *lut;
+    unsigned  class_count;
+    unsigned  stride        = 0;
+    bool      use_delegates = false;
+    bool      paged         = false;
+    bool      ok            = true;
+    size_t    size;
+
+    assert( rfc_ctx );
+    assert( rfc_ctx->state == RFC_STATE_INIT );
+
+    if( !rfc_ctx->damage_lut )
+    {
+        return true;
+    }
+
+    /* Shared tables are read-only, own a copy before refilling */
+    if( rfc_ctx->lut && !damage_lut_own( rfc_ctx ) )
+    {
+        return false;
+    }
+
+    class_count = rfc_ctx->class_count;
+
+#if RFC_USE_DELEGATES
+#if RFC_AT_SUPPORT
+    use_delegates = rfc_ctx->damage_calc_fcn || rfc_ctx->at_transform_fcn;
+#else /*!RFC_AT_SUPPORT*/
+    use_delegates = rfc_ctx->damage_calc_fcn != NULL;
+#endif /*RFC_AT_SUPPORT*/
+#endif /*RFC_USE_DELEGATES*/
+#if RFC_AT_SUPPORT
+    if( use_delegates || rfc_ctx->at.count )
+#else /*!RFC_AT_SUPPORT*/
+    if( use_delegates )
+#endif /*RFC_AT_SUPPORT*/
+    {
+        stride = class_count;
+        paged  = class_count > RFC_CLASS_COUNT_DENSE_MAX;
+    }
+
+    size = ( stride && !paged ) ? (size_t)class_count * class_count : class_count;
+
+    if( size != rfc_ctx->damage_lut_size )
+    {
+        void *ptr;
+
+        rfc_ctx->damage_lut_inapt = 1;
+
+        ptr = rfc_ctx->mem_alloc( rfc_ctx->damage_lut, size, sizeof(double), RFC_MEM_AIM_DLUT );
+        if( !ptr )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
+        rfc_ctx->damage_lut = (double*)ptr;
+
+#if RFC_AT_SUPPORT
+        if( rfc_ctx->amplitude_lut )
+        {
+            ptr = rfc_ctx->mem_alloc( rfc_ctx->amplitude_lut, size, sizeof(double), RFC_MEM_AIM_ALUT );
+            if( !ptr )
+            {
+                return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+            }
+            rfc_ctx->amplitude_lut = (double*)ptr;
+        }
+#endif /*RFC_AT_SUPPORT*/
+
+        rfc_ctx->damage_lut_size = size;
+    }
+
+    rfc_ctx->damage_lut_stride = stride;
+
+    /* Pages built so far are outdated */
+    damage_lut_pages_free( rfc_ctx );
+
+    if( paged )
+    {
+        unsigned dim = ( class_count + RFC_DAMAGE_LUT_PAGE_DIM - 1 ) / RFC_DAMAGE_LUT_PAGE_DIM;
+        void    *ptr = rfc_ctx->mem_alloc( NULL, (size_t)dim * dim, sizeof(double*), RFC_MEM_AIM_DLUT );
+
+        if( !ptr )
+        {
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
+
+        memset( ptr, 0, sizeof(double*) * dim * dim );
+        rfc_ctx->damage_lut_pages       = (double**)ptr;
+        rfc_ctx->damage_lut_pages_dim   = dim;
+        rfc_ctx->damage_lut_inapt       = 0;
+
+        return true;
+    }
+
+    /* Calculate damages directly while filling */
+    lut = rfc_ctx->damage_lut;
+    rfc_ctx->damage_lut = NULL;
+
+    if( !stride )
+    {
+        /* Damage by range class */
+        unsigned range;
+
+        lut[0] = 0.0;
+        for( range = 1; range < class_count; range++ )
+        {
+            lut[range] = range / 2.0 * rfc_ctx->class_width;
+        }
+#if RFC_AT_SUPPORT
+        if( rfc_ctx->amplitude_lut )
+        {
+            memcpy( rfc_ctx->amplitude_lut, lut, sizeof(double) * class_count );
+            rfc_ctx->amplitude_lut[0] = -1.0;
+        }
+#endif /*RFC_AT_SUPPORT*/
+        if( class_count > 1 )
+        {
+            damage_calc_amplitudes( rfc_ctx, lut + 1, lut + 1, class_count - 1 );
+        }
+    }
+    else if( use_delegates )
+    {
+        /* Delegates may depend on direction and needn't be thread-safe */
+        unsigned from, to;
+
+        for( from = 0; ok && from < class_count; from++ )
+        {
+            for( to = 0; to < class_count; to++ )
+            {
+                double D, Sa;
+
+                if( !damage_calc( rfc_ctx, from, to, &D, &Sa ) )
+                {
+                    ok = false;
+                    break;
+                }
+                lut[ MAT_OFFS( from, to ) ] = D;
+#if RFC_AT_SUPPORT
+                if( rfc_ctx->amplitude_lut )
+                {
+                    rfc_ctx->amplitude_lut[ MAT_OFFS( from, to ) ] = Sa;
+                }
+#endif /*RFC_AT_SUPPORT*/
+            }
+        }
+    }
+    else
+    {
+        struct damage_lut_job   jobs[RFC_BATCH_THREADS_MAX];
+        unsigned                thread_count = 1;
+        unsigned                i;
+
+        if( class_count >= RFC_DAMAGE_LUT_PARALLEL_MIN )
+        {
+            thread_count = batch_thread_count( 0 );
+        }
+
+        for( i = 0; i < thread_count; i++ )
+        {
+            jobs[i].rfc_ctx       = rfc_ctx;
+            jobs[i].lut           = lut;
+#if RFC_AT_SUPPORT
+            jobs[i].amplitude_lut = rfc_ctx->amplitude_lut;
+#else /*!RFC_AT_SUPPORT*/
+            jobs[i].amplitude_lut = NULL;
+#endif /*RFC_AT_SUPPORT*/
+            jobs[i].first         = i;
+            jobs[i].step          = thread_count;
+            jobs[i].ok            = true;
+        }
+
+#if RFC_USE_THREADS
+        if( thread_count > 1 )
+        {
+            unsigned    started = 0;
+#if defined(_WIN32)
+            HANDLE      threads[RFC_BATCH_THREADS_MAX];
+
+            /* The calling thread is a worker too */
+            for( i = 1; i < thread_count; i++ )
+            {
+                threads[started] = CreateThread( NULL, 0, damage_lut_thread, &jobs[i], 0, NULL );
+                if( !threads[started] ) break;
+                started++;
+            }
+#else /*!_WIN32*/
+            pthread_t   threads[RFC_BATCH_THREADS_MAX];
+
+            /* The calling thread is a worker too */
+            for( i = 1; i < thread_count; i++ )
+            {
+                if( pthread_create( &threads[started], NULL, damage_lut_thread, &jobs[i] ) != 0 ) break;
+                started++;
+            }
+#endif /*_WIN32*/
+
+            damage_lut_rows( &jobs[0] );
+
+            /* Rows of workers not started */
+            for( i = started + 1; i < thread_count; i++ )
+            {
+                damage_lut_rows( &jobs[i] );
+            }
+
+            for( i = 0; i < started; i++ )
+            {
+#if defined(_WIN32)
+                WaitForSingleObject( threads[i], INFINITE );
+                CloseHandle( threads[i] );
+#else /*!_WIN32*/
+                pthread_join( threads[i], NULL );
+#endif /*_WIN32*/
+            }
+        }
+        else
+#endif /*RFC_USE_THREADS*/
+        {
+            damage_lut_rows( &jobs[0] );
+        }
+
+        for( i = 0; i < thread_count; i++ )
+        {
+            ok = ok && jobs[i].ok;
+        }
+    }
+
+    if( !ok )
+    {
+        rfc_ctx->mem_alloc( lut, 0, 0, RFC_MEM_AIM_DLUT );
+        rfc_ctx->damage_lut_size = 0;
+        return false;
+    }
+
+    rfc_ctx->damage_lut          = lut;
+    rfc_ctx->damage_lut_inapt    = 0;
+
+    return true;
+}
+
+
+/**
+ * @brief      Calculate pseudo damage for one closed (full) cycle, using
+ *             look-up table.
+ *
+ * @param      rfc_ctx     The rainflow context
+ * @param      class_from  The starting class
+ * @param      class_to    The ending class
+ * @param[out] damage      The damage value for the closed cycle
+ * @param[out] Sa_ret      The amplitude (-1 if not available), may be NULL
  *
  * @return     true on success
  */
 static
-bool feed_finalize_hcm( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+bool damage_calc_fast( rfc_ctx_s *rfc_ctx, unsigned class_from, unsigned class_to, double *damage, double *Sa_ret )
 {
+    double Sa = -1;    /* -1 means "uninitialized" */
+    double D  =  0.0;
+
+    assert( damage );
     assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    assert( rfc_ctx->state >= RFC_STATE_INIT );
+    assert( class_from < rfc_ctx->class_count );
+    assert( class_to   < rfc_ctx->class_count );
 
-    /* Move HCM stack to residue */
-    if( rfc_ctx->counting_method == RFC_COUNTING_METHOD_HCM )
+    if( rfc_ctx->damage_lut && !rfc_ctx->damage_lut_inapt )
     {
-        int stack_cnt = rfc_ctx->internal.hcm.IZ; /* Number of turning points in HCM stack */
+        const double   *damage_lut      = rfc_ctx->damage_lut;
+#if RFC_AT_SUPPORT
+        const double   *amplitude_lut   = rfc_ctx->amplitude_lut;
+#endif /*RFC_AT_SUPPORT*/
+        size_t          i;
 
-        if( stack_cnt )
+        if( rfc_ctx->damage_lut_pages )
         {
-            /* Reallocate residue */
-            rfc_ctx->residue = (rfc_value_tuple_s*)rfc_ctx->mem_alloc( rfc_ctx->residue, (size_t)stack_cnt, 
-                                                                       sizeof(rfc_value_tuple_s), RFC_MEM_AIM_RESIDUE );
-
-            if( !rfc_ctx->residue )
+            /* Page holds damages, amplitudes following */
+            damage_lut = damage_lut_page( rfc_ctx, class_from, class_to );
+            if( !damage_lut )
+            {
+                return false;
+            }
+            i = (size_t)( class_from % RFC_DAMAGE_LUT_PAGE_DIM ) * RFC_DAMAGE_LUT_PAGE_DIM + class_to % RFC_DAMAGE_LUT_PAGE_DIM;
+#if RFC_AT_SUPPORT
+            if( amplitude_lut )
             {
-                return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+                amplitude_lut = damage_lut + RFC_DAMAGE_LUT_PAGE_DIM * RFC_DAMAGE_LUT_PAGE_DIM;
             }
+#endif /*RFC_AT_SUPPORT*/
+        }
+        else
+        {
+            i = rfc_ctx->damage_lut_stride ? (size_t)class_from * rfc_ctx->damage_lut_stride + class_to 
+                                           : (size_t)abs( (int)class_from - (int)class_to );
+        }
 
-            memcpy( rfc_ctx->residue, rfc_ctx->internal.hcm.stack, sizeof(rfc_value_tuple_s) * stack_cnt );
-
-            rfc_ctx->residue_cap = stack_cnt;
-            rfc_ctx->residue_cnt = stack_cnt;
+        D = damage_lut[i];
 
-            /* Make HCM stack empty */
-            rfc_ctx->internal.hcm.IZ = 0;
-            rfc_ctx->internal.hcm.IR = 1;
+        if( Sa_ret )
+        {
+#if RFC_AT_SUPPORT
+            if( amplitude_lut )
+            {
+                *Sa_ret = amplitude_lut[i];
+            }
+#else /*!RFC_AT_SUPPORT*/
+            *Sa_ret = AMPLITUDE( rfc_ctx, fabs( (int)class_from - (int)class_to ) );
+#endif /*RFC_AT_SUPPORT*/
         }
     }
+    else
+    {
+        return error_raise( rfc_ctx, RFC_ERROR_LUT );
+    }
+
+    *damage = D;
 
     return true;
 }
-#endif /*RFC_HCM_SUPPORT*/
 
 
 /**
- * @brief      Finalize pending counts, ignore residue.
+ * @brief      Return the page of a paged damage look-up table, holding the
+ *             given classes. Pages are built on first touch, so costs scale
+ *             with the region of the rainflow matrix touched.
+ *             A page holds RFC_DAMAGE_LUT_PAGE_DIM^2 damages (row-major),
+ *             followed by as many amplitudes, if amplitude_lut is set.
  *
- * @param      rfc_ctx  The rainflow context
- * @param      flags    The flags
+ * @param      rfc_ctx     The rainflow context
+ * @param      class_from  The starting class
+ * @param      class_to    The ending class
  *
- * @return     true on success
+ * @return     The page, NULL on error
  */
 static
-bool finalize_res_ignore( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+const double * damage_lut_page( rfc_ctx_s *rfc_ctx, unsigned class_from, unsigned class_to )
 {
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    const unsigned  dim         = RFC_DAMAGE_LUT_PAGE_DIM;
+    const unsigned  from_first  = class_from - class_from % dim,
+                    to_first    = class_to   - class_to   % dim;
+    const unsigned  from_last   = ( from_first + dim < rfc_ctx->class_count ) ? from_first + dim : rfc_ctx->class_count,
+                    to_last     = ( to_first   + dim < rfc_ctx->class_count ) ? to_first   + dim : rfc_ctx->class_count;
+    size_t          n           = (size_t)( class_from / dim ) * rfc_ctx->damage_lut_pages_dim + class_to / dim;
+    size_t          tables      = 1;
+    double         *page        = rfc_ctx->damage_lut_pages[n];
+    unsigned        from, to;
+    bool            ok          = true;
 
-    /* Include interim turning point */
-    return feed_finalize( rfc_ctx );
-}
+    if( page )
+    {
+        return page;
+    }
 
+#if RFC_AT_SUPPORT
+    if( rfc_ctx->amplitude_lut ) tables++;
+#endif /*RFC_AT_SUPPORT*/
 
-/**
- * @brief      Finalize pending counts, ignore residue, don't finalize
- *
- * @param      rfc_ctx  The rainflow context
- * @param      flags    The flags
- *
- * @return     true on success
- */
-static
-bool finalize_res_no_finalize( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
-{
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    page = (double*)rfc_ctx->mem_alloc( NULL, tables * dim * dim, sizeof(double), RFC_MEM_AIM_DLUT );
+    if( !page )
+    {
+        (void)error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        return NULL;
+    }
 
-    rfc_ctx->state = RFC_STATE_FINALIZE;
+    /* Disable lut temporarily, values are calculated directly (delegates and amplitude transformation included) */
+    rfc_ctx->damage_lut_inapt++;
+    for( from = from_first; ok && from < from_last; from++ )
+    {
+        for( to = to_first; to < to_last; to++ )
+        {
+            size_t  i = (size_t)( from - from_first ) * dim + ( to - to_first );
+            double  D, Sa;
 
-    return true;
+            if( !damage_calc( rfc_ctx, from, to, &D, &Sa ) )
+            {
+                ok = false;
+                break;
+            }
+            page[i] = D;
+            if( tables > 1 )
+            {
+                page[ dim * dim + i ] = Sa;
+            }
+        }
+    }
+    rfc_ctx->damage_lut_inapt--;
+
+    if( !ok )
+    {
+        rfc_ctx->mem_alloc( page, 0, 0, RFC_MEM_AIM_DLUT );
+        return NULL;
+    }
+
+    rfc_ctx->damage_lut_pages[n] = page;
+
+    return page;
 }
 
 
-#if !RFC_MINIMAL
 /**
- * @brief      Finalize pending counts, discard residue.
+ * @brief      Free all pages of a paged damage look-up table and the page
+ *             table itself.
  *
  * @param      rfc_ctx  The rainflow context
- * @param      flags    The flags
- *
- * @return     true on success
  */
 static
-bool finalize_res_discard( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+void damage_lut_pages_free( rfc_ctx_s *rfc_ctx )
 {
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    size_t i, n;
 
-    /* Include interim turning point */
-    if( !feed_finalize( rfc_ctx ) )
+    if( !rfc_ctx->damage_lut_pages )
     {
-        return false;
+        return;
     }
 
-    /* Empty residue */
-    rfc_ctx->residue_cnt = 0;
+    n = (size_t)rfc_ctx->damage_lut_pages_dim * rfc_ctx->damage_lut_pages_dim;
+    for( i = 0; i < n; i++ )
+    {
+        if( rfc_ctx->damage_lut_pages[i] )
+        {
+            rfc_ctx->mem_alloc( rfc_ctx->damage_lut_pages[i], 0, 0, RFC_MEM_AIM_DLUT );
+        }
+    }
 
-    return true;
+    rfc_ctx->mem_alloc( rfc_ctx->damage_lut_pages, 0, 0, RFC_MEM_AIM_DLUT );
+    rfc_ctx->damage_lut_pages       = NULL;
+    rfc_ctx->damage_lut_pages_dim   = 0;
 }
+#endif /*RFC_DAMAGE_FAST*/
 
 
 /**
- * @brief      Finalize pending counts, weight unclosed cycles into RP,
- *             RF-matrix and damage and discard residue.
+ * @brief      Test data sample for a new turning point and add to the residue
+ *             in that case. Update extrema.
+ *             - 1. Hysteresis Filtering
+ *             - 2. Peak-Valley Filtering
  *
  * @param      rfc_ctx  The rainflow context
- * @param      weight   The weight for closed cycles
- * @param      flags    The flags
+ * @param[in]  pt       The data tuple, must not be NULL
  *
- * @return     true on success
+ * @return     Returns pointer to new turning point in residue or NULL
  */
 static
-bool finalize_res_weight_cycles( rfc_ctx_s *rfc_ctx, rfc_counts_t weight, rfc_flags_e flags )
+rfc_value_tuple_s * feed_filter_pt( rfc_ctx_s *rfc_ctx, const rfc_value_tuple_s *pt )
 {
+    int                 slope;
+    rfc_value_t         delta;
+    rfc_value_tuple_s  *new_tp      = NULL;
+    bool                do_append   = false;
+
     assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state <= RFC_STATE_BUSY_INTERIM );
 
-    /* Include interim turning point */
-    if( !feed_finalize( rfc_ctx ) )
+#if RFC_USE_DELEGATES
+    if( rfc_ctx->tp_next_fcn )
     {
-        return false;
+        new_tp = rfc_ctx->tp_next_fcn( rfc_ctx, pt );
+
+        /* Like the filter below, the delegate is expected to alter the last turning point and the interim one only */
+        residue_mirror_drop( rfc_ctx, rfc_ctx->residue_cnt ? rfc_ctx->residue_cnt - 1 : 0 );
+
+        return new_tp;
     }
+#endif /*RFC_USE_DELEGATES*/
 
-    /* Count every unclosed cycle with the given weight */
-    if( rfc_ctx->residue && rfc_ctx->residue_cnt >= 2 )
+    if( !pt ) return NULL;
+
+    slope = rfc_ctx->internal.slope;
+
+    /* Handle first turning point(s) */
+    if( rfc_ctx->state < RFC_STATE_BUSY_INTERIM )
     {
-        size_t             i;
-        int                flags    = rfc_ctx->internal.flags;
-        rfc_value_tuple_s *from     = rfc_ctx->residue;
-        rfc_counts_t       old_inc  = rfc_ctx->curr_inc;
+        /* Residue is empty, still searching first turning point(s) */
 
-        rfc_ctx->curr_inc = weight;
+        if( rfc_ctx->state == RFC_STATE_INIT )
+        {
+            /* Very first point, initialize local min-max search */
+            rfc_ctx->internal.extrema[0] = 
+            rfc_ctx->internal.extrema[1] = *pt;
+            rfc_ctx->state               =  RFC_STATE_BUSY;
+        }
+        else
+        {
+            int is_falling_slope = -1;
 
-        for( i = 0; i + 1 < rfc_ctx->residue_cnt; i++ )
+            assert( rfc_ctx->state == RFC_STATE_BUSY );
+
+            /* Still searching for first turning point(s) */
+
+            /* Update local extrema */
+            if( pt->value < rfc_ctx->internal.extrema[0].value )
+            {
+                /* Minimum */
+                is_falling_slope = 1;
+                rfc_ctx->internal.extrema[0] = *pt;
+#if RFC_GLOBAL_EXTREMA
+                rfc_ctx->internal.extrema_changed = true;
+#endif /*RFC_GLOBAL_EXTREMA*/
+            }
+            else if( pt->value > rfc_ctx->internal.extrema[1].value )
+            {
+                /* Maximum */
+                is_falling_slope = 0;
+                rfc_ctx->internal.extrema[1] = *pt;
+#if RFC_GLOBAL_EXTREMA
+                rfc_ctx->internal.extrema_changed = true;
+#endif /*RFC_GLOBAL_EXTREMA*/
+            }
+
+            /* Local hysteresis filtering */
+            delta = value_delta( rfc_ctx, &rfc_ctx->internal.extrema[0], &rfc_ctx->internal.extrema[1], NULL /* sign_ptr */ );
+
+            if( is_falling_slope >= 0 && delta > rfc_ctx->hysteresis )
+            {
+                /* Criteria met, new turning point found.
+                 * Emit maximum on falling slope as first interim turning point, 
+                 * minimum as second then (and vice versa) 
+                 * 1st point: internal.extrema[ is_falling_slope]
+                 * 2nd point: internal.extrema[!is_falling_slope]  ==> which is *pt also
+                 */
+                assert( rfc_ctx->residue_cnt < rfc_ctx->residue_cap );
+                rfc_ctx->residue[rfc_ctx->residue_cnt] = rfc_ctx->internal.extrema[is_falling_slope];
+
+                rfc_ctx->internal.slope = is_falling_slope ? -1 : 1;
+
+                /* pt is the new interim turning point */
+                rfc_ctx->state = RFC_STATE_BUSY_INTERIM;
+                do_append = true;
+            }
+        }
+    }
+    else  /* if( rfc_ctx->state < RFC_STATE_BUSY_INTERIM ) */
+    {
+        assert( rfc_ctx->state == RFC_STATE_BUSY_INTERIM );
+
+        /* Consecutive search for turning points */
+
+#if RFC_GLOBAL_EXTREMA
+        /* Build global extrema */
+        if( pt->value < rfc_ctx->internal.extrema[0].value )
         {
-            rfc_value_tuple_s *to   = from + 1;
-            rfc_value_tuple_s *next = ( i + 2 < rfc_ctx->residue_cnt ) ? to + 1 : NULL;
+            /* Minimum */
+            rfc_ctx->internal.extrema[0] = *pt;
+            rfc_ctx->internal.extrema_changed = true;
+        }
+        else if( pt->value > rfc_ctx->internal.extrema[1].value )
+        {
+            /* Maximum */
+            rfc_ctx->internal.extrema[1] = *pt;
+            rfc_ctx->internal.extrema_changed = true;
+        }
+#endif /*RFC_GLOBAL_EXTREMA*/
 
-            cycle_process_counts( rfc_ctx, from, to, next, flags );
+        /* Hysteresis Filtering, check against interim turning point */
+        delta = value_delta( rfc_ctx, &rfc_ctx->residue[rfc_ctx->residue_cnt], pt, &slope /* sign_ptr */ );
+
+        /* There are three scenarios possible here:
+         *   1. Previous slope is continued
+         *      "delta" is ignored whilst hysteresis is exceeded already.
+         *      Interim turning point has just to be adjusted.
+         *   2. Slope reversal, slope is greater than hysteresis
+         *      Interim turning point becomes real turning point.
+         *      Current point becomes new interim turning point
+         *   3. Slope reversal, slope is less than or equal hysteresis
+         *      Nothing to do.
+         */
+
+        /* Peak-Valley Filtering */
+        /* Justify interim turning point, or add a new one (2) */
+        if( slope == rfc_ctx->internal.slope )
+        {
+            /* Scenario (1), Continuous slope */
+
+            /* Replace interim turning point with new extrema */
+            if( rfc_ctx->residue[rfc_ctx->residue_cnt].value != pt->value )
+            {
+                rfc_ctx->residue[rfc_ctx->residue_cnt] = *pt;
+            }
+        }
+        else
+        {
+            if( delta > rfc_ctx->hysteresis )
+            {
+                /* Scenario (2), Criteria met: slope != rfc_ctx->internal.slope && delta > rfc_ctx->hysteresis */
+
+                /* Storage */
+                rfc_ctx->internal.slope = slope;
 
-            from = to;
+                /* Handle new turning point */
+                do_append = true;
+            }
+            else
+            {
+                /* Scenario (3), Turning point found, but still in hysteresis band, nothing to do */
+            }
         }
-
-        rfc_ctx->curr_inc = old_inc;
     }
 
-    /* Empty residue */
-    rfc_ctx->residue_cnt = 0;
+    /* Handle new turning point, that is the current last point in residue */
+    if( do_append )
+    {
+        assert( rfc_ctx->state == RFC_STATE_BUSY_INTERIM );
 
-    return true;
+        /* Increment and set new interim turning point */
+        assert( rfc_ctx->residue_cnt + 1 < rfc_ctx->residue_cap );
+        rfc_ctx->residue[++rfc_ctx->residue_cnt] = *pt;
+
+        /* Return new turning point */
+        new_tp = &rfc_ctx->residue[rfc_ctx->residue_cnt - 1];
+    }
+
+    return new_tp;
 }
 
 
 /**
- * @brief      Finalize pending counts to fit HCM results.
+ * @brief      Check if the block pre-filter feed_filter_block() applies.
  *
  * @param      rfc_ctx  The rainflow context
- * @param      flags    The flags
  *
- * @return     true on success
+ * @return     true, if applicable
  */
 static
-bool finalize_res_clormann_seeger( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+bool feed_filter_block_apt( rfc_ctx_s *rfc_ctx )
 {
-    size_t i;
-
     assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
 
-    /* Include interim turning point */
-    if( !feed_finalize( rfc_ctx ) )
+#if RFC_USE_HYSTERESIS_FILTER
+    if( rfc_ctx->state != RFC_STATE_BUSY_INTERIM )
     {
         return false;
     }
 
-    if( rfc_ctx->counting_method == RFC_COUNTING_METHOD_4PTM )
+#if RFC_USE_DELEGATES
+    if( rfc_ctx->tp_next_fcn )
     {
-        /* Counting correction on residue */
-
-        for( i = 0; i + 4 < rfc_ctx->residue_cnt; )
-        {
-            size_t idx = rfc_ctx->residue_cnt + i;
-
-            double A = (double)rfc_ctx->residue[idx+0].value;
-            double B = (double)rfc_ctx->residue[idx+1].value;
-            double C = (double)rfc_ctx->residue[idx+2].value;
-            double D = (double)rfc_ctx->residue[idx+3].value;
-
-            if( B * C < 0.0 && fabs(D) >= fabs(B) && fabs(B) >= fabs(C) )
-            {
-                rfc_value_tuple_s *from = &rfc_ctx->residue[idx+1];
-                rfc_value_tuple_s *to   = &rfc_ctx->residue[idx+2];
+        return false;
+    }
+#endif /*RFC_USE_DELEGATES*/
 
-                cycle_process_counts( rfc_ctx, from, to, to + 1, flags );
+#if RFC_DH_SUPPORT
+    if( rfc_ctx->dh )
+    {
+        return false;
+    }
+#endif /*RFC_DH_SUPPORT*/
 
-                /* Remove two inner turning points (idx+1 and idx+2) */
-                residue_remove_item( rfc_ctx, i + 1, 2 );
-                rfc_ctx->residue_cnt -= 2;
-            }
-            else
-            {
-                i++;
-            }
-        }
+#if RFC_TP_SUPPORT
+    if( ( rfc_ctx->internal.flags & RFC_FLAGS_ENFORCE_MARGIN ) && !rfc_ctx->tp_locked && rfc_ctx->internal.margin_stage != 2 )
+    {
+        return false;
     }
+#endif /*RFC_TP_SUPPORT*/
 
     return true;
+#else /*!RFC_USE_HYSTERESIS_FILTER*/
+    /* Slope is determined by classes, interim turning point isn't a running extremum then */
+    return false;
+#endif /*RFC_USE_HYSTERESIS_FILTER*/
 }
 
 
 /**
- * @brief      Finalize pending counts, DIN method.
+ * @brief      Block pre-filter for RFC_feed(). Consumes leading samples, that
+ *             can't become turning points: Samples continuing the slope of
+ *             the interim turning point or staying within the hysteresis
+ *             band. Blocks of RFC_FEED_BLOCK_SIZE samples are checked at once
+ *             by their extrema (branch free min/max reduction). Only the
+ *             interim turning point, the global extrema and the right margin
+ *             are updated then, exactly as feed_once() would do it sample by
+ *             sample. Returns at the first turning point candidate, which
+ *             has to pass feed_once() then.
  *
- * @param      rfc_ctx  The rainflow context
- * @param      flags    The flags
+ * @param      rfc_ctx     The rainflow context
+ * @param[in]  data        The data
+ * @param      data_count  The data count
  *
- * @return     true on success
+ * @return     Number of samples consumed
  */
 static
-bool finalize_res_rp_DIN45667( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+size_t feed_filter_block( rfc_ctx_s *rfc_ctx, const rfc_value_t *data, size_t data_count )
 {
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+#if RFC_USE_HYSTERESIS_FILTER
+    rfc_value_t         interim_value;
+    size_t              interim_idx      = 0;
+    bool                interim_moved    = false;
+#if RFC_GLOBAL_EXTREMA
+    rfc_value_t         extrema_value[2];
+    size_t              extrema_idx[2]   = { 0, 0 };
+    bool                extrema_moved[2] = { false, false };
+#endif /*RFC_GLOBAL_EXTREMA*/
+#if RFC_TP_SUPPORT
+    bool                do_margin;
+#endif /*RFC_TP_SUPPORT*/
+    unsigned            cls[RFC_FEED_BLOCK_SIZE];
+    int                 slope;
+    size_t              i, n = 0;
 
-    /* Include interim turning point */
-    if( !feed_finalize( rfc_ctx ) )
+    assert( rfc_ctx && data );
+
+    if( !feed_filter_block_apt( rfc_ctx ) )
     {
-        return false;
+        return 0;
     }
 
-    if( flags && rfc_ctx->residue_cnt > 2 )
-    {
-        int i, j, k;
-        int slopes_cnt = (int)rfc_ctx->residue_cnt - 1;
-        struct slopes
-        {
-            int slope;
-            rfc_value_tuple_s *lhs;
-            rfc_value_tuple_s *rhs;
-        } *slopes, tmp;
+#if RFC_TP_SUPPORT
+    do_margin = ( rfc_ctx->internal.flags & RFC_FLAGS_ENFORCE_MARGIN ) && !rfc_ctx->tp_locked;
+#endif /*RFC_TP_SUPPORT*/
 
-        slopes = (struct slopes*)rfc_ctx->mem_alloc( NULL, slopes_cnt, sizeof( slopes[0] ), RFC_MEM_AIM_TEMP );
+    slope         = rfc_ctx->internal.slope;
+    interim_value = rfc_ctx->residue[rfc_ctx->residue_cnt].value;
+#if RFC_GLOBAL_EXTREMA
+    extrema_value[0] = rfc_ctx->internal.extrema[0].value;
+    extrema_value[1] = rfc_ctx->internal.extrema[1].value;
+#endif /*RFC_GLOBAL_EXTREMA*/
 
-        if( !slopes )
-        {
-            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
-        }
+    while( n < data_count )
+    {
+        size_t n_end, n_valid;
 
-        /* Evaluate slopes */
-        for( i = 0; i < slopes_cnt; i++ )
+        if( data_count - n >= RFC_FEED_BLOCK_SIZE )
         {
-            slopes[i].lhs   = &rfc_ctx->residue[i];
-            slopes[i].rhs   = &rfc_ctx->residue[i+1];
-            slopes[i].slope = (int)slopes[i].rhs->cls - slopes[i].lhs->cls;
-        }
+            const rfc_value_t  *block   = data + n;
+            rfc_value_t         lo      = block[0],
+                                hi      = block[0],
+                                peak;
+            int                 is_nan  = 0;
+            double              delta;
 
-        /* Order slopes (simple "bubble sort") */
-        k = 0;
-        for( i = 0; i < slopes_cnt; i++ )
-        {
-            /* Drag higher ranks */
-            for( j = slopes_cnt - 2; j >= i; j-- )
+            /* Block extrema */
+            for( i = 0; i < RFC_FEED_BLOCK_SIZE; i++ )
             {
-                bool do_swap = false;
-
-                if( ( slopes[j].slope > 0 ) == ( slopes[j+1].slope > 0 ) )
-                {
-                    do_swap = abs( slopes[j].slope ) < abs( slopes[j+1].slope );
-                }
-                else
-                {
-                    do_swap = slopes[j].slope < 0;
-                    k       = j + 1;  /* k indicates the first falling slope now */
-                }
+                rfc_value_t x = block[i];
 
-                if( do_swap )
-                {
-                    tmp         = slopes[j];
-                    slopes[j]   = slopes[j+1];
-                    slopes[j+1] = tmp;
-                }
+                lo      = ( x < lo ) ? x : lo;
+                hi      = ( x > hi ) ? x : hi;
+                is_nan |= ( x != x );
             }
-        }
-
-        assert( k > 0 );
-
-        /* Compare positive slopes with adjacent negative slopes */
-        for( i = 0; i < k && i + k < slopes_cnt; i++ )
-        {
-            /* Get the smaller slope of two adjacent. On equality choose the primarily in time */
-            int lh_slope = slopes[i].slope;
-            int rh_slope = slopes[i+k].slope;
 
-            if( abs( lh_slope ) == abs( rh_slope ) )
+            /* Largest possible slope reversal against the (moving) interim turning point */
+            if( slope > 0 )
             {
-                j = ( slopes[i].rhs->pos < slopes[i+k].rhs->pos ) ? i : (i+k);
+                peak  = ( hi > interim_value ) ? hi : interim_value;
+                delta = (double)peak - (double)lo;
             }
             else
             {
-                j = ( abs( lh_slope ) < abs( rh_slope ) ) ? i : (i+k);
+                peak  = ( lo < interim_value ) ? lo : interim_value;
+                delta = (double)hi - (double)peak;
             }
 
-            /* Do the countings for the matching slope */
-            cycle_process_counts( rfc_ctx, slopes[j].lhs, slopes[j].rhs, NULL, flags );
-        }
-
-        rfc_ctx->mem_alloc( slopes, 0, 0, RFC_MEM_AIM_TEMP );
-    }
+            if( !is_nan && (rfc_value_t)delta <= rfc_ctx->hysteresis &&
+                ( !rfc_ctx->class_count || ( lo >= rfc_ctx->class_offset && QUANTIZE( rfc_ctx, hi ) < rfc_ctx->class_count ) ) )
+            {
+                /* No candidate in this block, interim turning point moves to the first occurrence of the new peak */
+                if( peak != interim_value )
+                {
+                    for( i = 0; block[i] != peak; i++ ) {}
 
-    /* Empty residue */
-    rfc_ctx->residue_cnt = 0;
+                    interim_value = peak;
+                    interim_idx   = n + i;
+                    interim_moved = true;
+                }
 
-    return true;
-}
+#if RFC_GLOBAL_EXTREMA
+                if( lo < extrema_value[0] )
+                {
+                    for( i = 0; block[i] != lo; i++ ) {}
 
+                    extrema_value[0] = lo;
+                    extrema_idx[0]   = n + i;
+                    extrema_moved[0] = true;
+                }
 
-/**
- * @brief      Finalize pending counts, repeated residue method.
- *
- * @param      rfc_ctx  The rainflow context
- * @param      flags    The flags
- *
- * @return     true on success
- */
-static
-bool finalize_res_repeated( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
-{
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+                if( hi > extrema_value[1] )
+                {
+                    for( i = 0; block[i] != hi; i++ ) {}
 
-    /* Process only, if residue is present */
-    if( rfc_ctx->residue && rfc_ctx->residue_cnt && flags )
-    {
-        /* Feed again with the content of the residue itself */
-        size_t              cnt     = rfc_ctx->residue_cnt;
-        rfc_value_tuple_s  *residue = (rfc_value_tuple_s*)rfc_ctx->mem_alloc( NULL, cnt + 1, 
-                                                                              sizeof(rfc_value_tuple_s), RFC_MEM_AIM_TEMP );
+                    extrema_value[1] = hi;
+                    extrema_idx[1]   = n + i;
+                    extrema_moved[1] = true;
+                }
+#endif /*RFC_GLOBAL_EXTREMA*/
 
-        if( rfc_ctx->state == RFC_STATE_BUSY_INTERIM )
-        {
-            cnt++;
+                n += RFC_FEED_BLOCK_SIZE;
+                continue;
+            }
         }
 
-        if( !residue )
-        {
-            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
-        }
-        else
+        /* Block contains a candidate (or is incomplete), check sample by sample as feed_filter_pt() does */
+        n_end   = ( data_count - n < RFC_FEED_BLOCK_SIZE ) ? data_count : n + RFC_FEED_BLOCK_SIZE;
+        n_valid = n + quantize_block( rfc_ctx, data + n, n_end - n, cls );  /* Samples out of range are handled by feed_once() */
+
+        for( ; n < n_valid; n++ )
         {
-            /* Make a copy of the residue */
-            bool                     ok;
-            size_t                   n         = cnt; 
-            int                      old_flags = rfc_ctx->internal.flags;
-            const rfc_value_tuple_s *from      = rfc_ctx->residue;
-                  rfc_value_tuple_s *to        = residue;
+            rfc_value_t x = data[n];
+            double      delta;
 
-            while( n-- )
+            if( x != x )
             {
-                *to++ = *from++;
+                break;
             }
 
-            rfc_ctx->internal.flags = flags;
+            delta = (double)x - (double)interim_value;
 
-            /* 
-             * Feed again with the copy, no new turning points are generated, since residue[].tp_pos
-             * but last cycle might not be closed due to interim state of the last point.
-             * Remove that cycle before feeding with the residue again:
-             */
-            if( cnt >= 4 )
+            if( ( delta < 0.0 ? -1 : 1 ) == slope )
             {
-                size_t idx = cnt - 4;
-
-                unsigned A = residue[idx+0].cls;
-                unsigned B = residue[idx+1].cls;
-                unsigned C = residue[idx+2].cls;
-                unsigned D = residue[idx+3].cls;
-
-                if( B > C )
-                {
-                    unsigned temp = B;
-                    B = C;
-                    C = temp;
-                }
-
-                if( A > D )
+                if( x != interim_value )
                 {
-                    unsigned temp = A;
-                    A = D;
-                    D = temp;
+                    interim_value = x;
+                    interim_idx   = n;
+                    interim_moved = true;
                 }
+            }
+            else if( (rfc_value_t)fabs( delta ) > rfc_ctx->hysteresis )
+            {
+                break;
+            }
 
-                /* Check for closed cycles [3] */
-                if( A <= B && C <= D )
-                {
-                    residue[idx+1] = residue[idx+3];
-                    cnt -= 2;
-                }
+#if RFC_GLOBAL_EXTREMA
+            if( x < extrema_value[0] )
+            {
+                extrema_value[0] = x;
+                extrema_idx[0]   = n;
+                extrema_moved[0] = true;
             }
-
-#if RFC_TP_SUPPORT
-            do
+            else if( x > extrema_value[1] )
             {
-                size_t tp_cnt = rfc_ctx->tp_cnt;
+                extrema_value[1] = x;
+                extrema_idx[1]   = n;
+                extrema_moved[1] = true;
+            }
+#endif /*RFC_GLOBAL_EXTREMA*/
+        }
 
-                /* Feed with all but the last data point, which will be handled later */
-                ok = RFC_feed_tuple( rfc_ctx, residue, cnt - 1 );
+        if( n < n_end ) break;
+    }
 
-                if( ok )
-                {
-                    /* The only scenario in which the number of turning points increases, is when
-                       the interim turning point gets a real turning point */
-                    if( rfc_ctx->tp_cnt > tp_cnt )
-                    {
-                        /* Interim turning point became a turning point, fix the copy */
-                        residue[cnt-1].tp_pos = tp_cnt + 1;
-                    }
-                    // Process the last data point
-                    ok = RFC_feed_tuple( rfc_ctx, residue + cnt - 1, 1 );
-                }
-            } while(0);
-#else /*!RFC_TP_SUPPORT*/
-            ok = RFC_feed_tuple( rfc_ctx, residue, cnt );
-#endif /*RFC_TP_SUPPORT*/
+    if( n )
+    {
+        size_t pos = rfc_ctx->internal.pos;
 
-            rfc_ctx->internal.flags = old_flags;
+        if( interim_moved )
+        {
+            rfc_value_tuple_s tp = { data[interim_idx] };
 
-            /* Free temporary residue */
-            rfc_ctx->mem_alloc( residue, 0, 0, RFC_MEM_AIM_TEMP );
+            tp.pos = pos + interim_idx + 1;
+            tp.cls = QUANTIZE( rfc_ctx, tp.value );
+            rfc_ctx->residue[rfc_ctx->residue_cnt] = tp;
+        }
 
-            if( !ok )
+#if RFC_GLOBAL_EXTREMA
+        for( i = 0; i < 2; i++ )
+        {
+            if( extrema_moved[i] )
             {
-                return false;
+                rfc_value_tuple_s tp = { data[extrema_idx[i]] };
+
+                tp.pos = pos + extrema_idx[i] + 1;
+                tp.cls = QUANTIZE( rfc_ctx, tp.value );
+                rfc_ctx->internal.extrema[i]      = tp;
+                rfc_ctx->internal.extrema_changed = true;
             }
         }
-    }
+#endif /*RFC_GLOBAL_EXTREMA*/
 
-    /* Include interim turning point */
-    if( !feed_finalize( rfc_ctx ) )
-    {
-        return false;
-    }
+#if RFC_TP_SUPPORT
+        if( do_margin )
+        {
+            rfc_value_tuple_s tp = { data[n-1] };
 
-    /* Empty residue */
-    rfc_ctx->residue_cnt = 0;
+            tp.pos = pos + n;
+            tp.cls = QUANTIZE( rfc_ctx, tp.value );
+            rfc_ctx->internal.margin[1] = tp;
+        }
+#endif /*RFC_TP_SUPPORT*/
 
-    return true;
-}
+        rfc_ctx->internal.pos += n;
+    }
 
+    return n;
+#else /*!RFC_USE_HYSTERESIS_FILTER*/
+    return 0;
+#endif /*RFC_USE_HYSTERESIS_FILTER*/
+}
 
+# if !RFC_MINIMAL
 /**
- * @brief         Backup/restore of residue
- *
- * @param         rfc_ctx      The rainflow context
- * @param[in,out] residue      The copy of the current residue
- * @param[out]    residue_cap  The capacity of the given residue
- * @param[out]    residue_cnt  The number of points in the given residue
- * @param         restore      true->restore, false->backup
+ * @brief      Rainflow counting core, assumes
  *
- * @return        true on success
+ * @param      rfc_ctx  The rainflow context
+ * @param      flags    The flags
  */
 static
-bool residue_exchange( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s **residue, size_t *residue_cap, size_t *residue_cnt, bool restore )
+void cycle_find( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
 {
     assert( rfc_ctx );
     assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
-    assert( residue && residue_cap && residue_cnt );
-    assert( rfc_ctx->residue_cap > 0 );
 
-    if( !restore )
+#if RFC_USE_DELEGATES
+    /* Check for delegates */
+    if( rfc_ctx->cycle_find_fcn && rfc_ctx->counting_method == RFC_COUNTING_METHOD_DELEGATED )
     {
-        /* Backup */
-        *residue_cap = rfc_ctx->residue_cap;
-        *residue_cnt = rfc_ctx->residue_cnt;
-        *residue     = (rfc_value_tuple_s*)rfc_ctx->mem_alloc( NULL, *residue_cap, 
-                                                               sizeof(rfc_value_tuple_s), RFC_MEM_AIM_TEMP );
-
-        if( !*residue )
-        {
-            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
-        }
-
-        memcpy( *residue, rfc_ctx->residue, *residue_cnt * sizeof(rfc_value_tuple_s) );
+        rfc_ctx->cycle_find_fcn( rfc_ctx, flags );
+        residue_mirror_drop( rfc_ctx, 0 );
     }
     else
+#endif /*RFC_USE_DELEGATES*/
     {
-        /* Restore */
-
-        /* Release residue */
-        (rfc_value_tuple_s*)rfc_ctx->mem_alloc( rfc_ctx->residue, /*num*/ 0, /*size*/ 0, RFC_MEM_AIM_TEMP );
+        switch( rfc_ctx->counting_method )
+        {
+            case RFC_COUNTING_METHOD_NONE:
+                break;
+            case RFC_COUNTING_METHOD_4PTM:
+                cycle_find_4ptm( rfc_ctx, flags );
+                break;
+#if RFC_HCM_SUPPORT
+            case RFC_COUNTING_METHOD_HCM:
+                cycle_find_hcm( rfc_ctx, flags );
+                break;
+#endif /*RFC_HCM_SUPPORT*/
+#if RFC_ASTM_SUPPORT
+            case RFC_COUNTING_METHOD_ASTM:
+                cycle_find_astm( rfc_ctx, flags );
+                break;
+#endif /*RFC_ASTM_SUPPORT*/
+            case RFC_COUNTING_METHOD_DELEGATED:
+                /* FALLTHROUGH */
+            default:
+                assert( false );
+                break;
+        }
+    }
 
-        /* Assign backup */
-        rfc_ctx->residue_cap = *residue_cap;
-        rfc_ctx->residue_cnt = *residue_cnt;
-        rfc_ctx->residue     = *residue;
+    /* If no rainflow counting is done, just look out for turning points, discard residue */
+    if( rfc_ctx->counting_method == RFC_COUNTING_METHOD_NONE || !rfc_ctx->class_count )
+    {
+        /* Prune residue */
+        if( rfc_ctx->residue_cnt > 1 )
+        {
+            residue_remove_item( rfc_ctx, /*index*/ 0, rfc_ctx->residue_cnt - 1 );
+        }
     }
 
-    return true;
 }
 #endif /*!RFC_MINIMAL*/
 
 
 /**
- * @brief      Remove items (points) from the residue
+ * @brief      Rainflow counting core (4-point-method [3]).
  *
  * @param      rfc_ctx  The rainflow context
- * @param      index    The item position in residue, base 0
- * @param      count    The number of elements to remove
+ * @param      flags    The flags
  */
 static
-void residue_remove_item( rfc_ctx_s *rfc_ctx, size_t index, size_t count )
+void cycle_find_4ptm( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
 {
-    size_t  from = index + count,
-            to   = index, 
-            end;
+    rfc_res_item_s *res;
+    size_t          i;
 
     assert( rfc_ctx );
     assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
-    assert( rfc_ctx->residue && index + count <= rfc_ctx->residue_cnt );
-
-    end = (int)rfc_ctx->residue_cnt;
+    assert( rfc_ctx->internal.res_cnt <= rfc_ctx->residue_cnt );
 
-    /* Example
-                         |cnt(5)
-                         v
-               |O|O|X|O|O|
-                   ^
-                   |index(2)
-
-        elements = 2    (5-2-1+0 = 2, no interim turning point)
-    */
-
-    if( rfc_ctx->state == RFC_STATE_BUSY_INTERIM )
+    /* Mirror turning points appended since last call (usually one) */
+    res = rfc_ctx->internal.res;
+    for( i = rfc_ctx->internal.res_cnt; i < rfc_ctx->residue_cnt; i++ )
     {
-        /* Include interim turning point */
-        end++;
+        res[i].value = rfc_ctx->residue[i].value;
+        res[i].cls   = rfc_ctx->residue[i].cls;
+        res[i].pos   = rfc_ctx->residue[i].pos;
     }
+    rfc_ctx->internal.res_cnt = rfc_ctx->residue_cnt;
 
-    /* Shift points */
-    while( from < end )
+    while( rfc_ctx->residue_cnt >= 4 )
     {
-        rfc_ctx->residue[to++] = rfc_ctx->residue[from++];
-    }
+        size_t idx = rfc_ctx->residue_cnt - 4;
 
-    rfc_ctx->residue_cnt -= count;
+        /* Classes are read from the mirror */
+        unsigned A = res[idx+0].cls;
+        unsigned B = res[idx+1].cls;
+        unsigned C = res[idx+2].cls;
+        unsigned D = res[idx+3].cls;
+
+        if( B > C )
+        {
+            unsigned temp = B;
+            B = C;
+            C = temp;
+        }
+
+        if( A > D )
+        {
+            unsigned temp = A;
+            A = D;
+            D = temp;
+        }
+
+        /* Check for closed cycles [3] */
+        if( A <= B && C <= D )
+        {
+            rfc_value_tuple_s *from = &rfc_ctx->residue[idx+1];
+            rfc_value_tuple_s *to   = &rfc_ctx->residue[idx+2];
+
+            /* Closed cycle found, process countings */
+            rfc_ctx->internal.counts_fcn( rfc_ctx, from, to, to + 1, flags );
+
+            /* Remove two inner turning points (idx+1 and idx+2) */
+            /* Move last turning point */
+            rfc_ctx->residue[idx+1] = rfc_ctx->residue[idx+3];
+            res[idx+1]              = res[idx+3];
+            /* Move interim turning point */
+            if( rfc_ctx->state == RFC_STATE_BUSY_INTERIM )
+            {
+                rfc_ctx->residue[idx+2] = rfc_ctx->residue[idx+4];
+            }
+            rfc_ctx->residue_cnt -= 2;
+            rfc_ctx->internal.res_cnt = rfc_ctx->residue_cnt;
+        }
+        else break;
+    }
 }
 
 
+#if RFC_HCM_SUPPORT
 /**
- * @brief      Calculate damage for one cycle with given amplitude Sa
+ * @brief      Rainflow counting core (HCM method).
  *
  * @param      rfc_ctx  The rainflow context
- * @param      Sa       The amplitude
- * @param[out] damage   The damage
- *
- * @return     true on success
+ * @param      flags    The flags
  */
 static
-bool damage_calc_amplitude( rfc_ctx_s *rfc_ctx, double Sa, double *damage )
+void cycle_find_hcm( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
 {
+    int IZ, IR;
+    double eps = rfc_ctx->class_width / 100;
+
     assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
 
-    do {
-        /* Damage */
-        double D = 0.0;
+    IZ = rfc_ctx->internal.hcm.IZ - 1,  /* hcm.IZ and hcm.IR are base 1! */
+    IR = rfc_ctx->internal.hcm.IR - 1;
 
-        if( Sa >= 0.0 )
-        {
-            /* D =           h /    ND   *    ( Sa /    SD)  ^ ABS(k)   */
-            /* D = exp(  log(h /    ND)  + log( Sa /    SD)  * ABS(k) ) */
-            /* D = exp( (log(h)-log(ND)) + (log(Sa)-log(SD)) * ABS(k) ) */
-            /* D = exp(      0 -log(ND)  + (log(Sa)-log(SD)) * ABS(k) ) */
+    while( rfc_ctx->residue_cnt > 0 )
+    {
+        rfc_value_tuple_s *I, *J, *K;
 
-            /* If D is integer format count:
-             * 
-             * D_integer = (double)(int)range ^ ABS(k)  // where range is 0..class_count-1
-             * 
-             * D = D_integer_sum * exp( log( ND * 2*SD/class_width ) * -ABS(k) )
-             * 
-             */
+        /* Translation from "RAINFLOW.F" */
+/*label_1:*/
+        K = rfc_ctx->residue;  /* Recent value (turning point) */
 
-#if !RFC_MINIMAL
-            if( Sa > rfc_ctx->wl_omission )
-            {
-                /* Constants for the Woehler curve */
-                const double SX_log = log(rfc_ctx->wl_sx);
-                const double NX_log = log(rfc_ctx->wl_nx);
+        /* Place first turning point into stack */
+        if( !IR )
+        {
+            rfc_ctx->internal.hcm.stack[IR++] = *K;
+        }
+
+label_2:
+        if( IZ > IR )
+        {
+            /* There are at least 2 cycles on the stack able to close */
+            I = &rfc_ctx->internal.hcm.stack[IZ-1];
+            J = &rfc_ctx->internal.hcm.stack[IZ];
 
-                if( Sa > rfc_ctx->wl_sx )
-                {
-                    const double k = rfc_ctx->wl_k;
-                    
-                    /* Upper slope, finite life scope */
-                    D = exp( fabs(k) * ( log(Sa) - SX_log ) - NX_log );
-                }
-                else if( Sa > rfc_ctx->wl_sd )
+            if( (double)(K->value - J->value) * (double)(J->value - I->value) + eps >= 0.0 )
+            {
+                /* Is no turning point */
+                /* This should only may happen, when RFC_FLAGS_ENFORCE_MARGIN is set, 
+                   since all values from residue are turning points */
+                assert( rfc_ctx->internal.flags & RFC_FLAGS_ENFORCE_MARGIN );
+                IZ--;
+                /* Test further closed cycles */
+                goto label_2;
+            }
+            else
+            {
+                /* Is a turning point */
+                if( fabs( (double)K->value - (double)J->value ) + eps >= fabs( (double)J->value - (double)I->value ) )
                 {
-                    const double k2 = rfc_ctx->wl_k2;
-
-                    /* Lower slope, transition scope, modified Miners' rule */
-                    D = exp( fabs(k2) * ( log(Sa) - SX_log ) - NX_log );
+                    /* Cycle range is greater or equal to previous, register closed cycle */
+                    rfc_ctx->internal.counts_fcn( rfc_ctx, I, J, NULL, flags );
+                    IZ -= 2;
+                    /* Test further closed cycles */
+                    goto label_2;
                 }
-                /* Amplitudes below fatigue strength have no influence */
             }
-#else /*RFC_MINIMAL*/
-            /* Constants for the Woehler curve */
-            const double SX_log = log(rfc_ctx->wl_sx);
-            const double NX_log = log(rfc_ctx->wl_nx);
-            const double k      = rfc_ctx->wl_k;
+        }
+        else if( IZ == IR )
+        {
+            J = &rfc_ctx->internal.hcm.stack[IZ];
 
-            /* Miner original */
-            D = exp( fabs(k)  * ( log(Sa) - SX_log ) - NX_log );
-#endif /*!RFC_MINIMAL*/
+            if( ( (double)K->value - (double)J->value ) * (double)J->value + eps >= 0.0 )
+            {
+                /* Is no turning point */
+                IZ--;
+                /* Test further closed cycles */
+                goto label_2;
+            }
+            else if( fabs( (double)K->value ) + eps > fabs( (double)J->value ) )
+            {
+                /* Is turning point and range is less than previous */
+                IR++;
+            }
         }
         else
         {
-            assert( false );
-            return error_raise( rfc_ctx, RFC_ERROR_INVARG );
+            /* IZ < IR: There is no cycle on the stack able to close */
         }
 
-        *damage = D;
-        
-    } while(0);
-
-    return true;
-}
+        /* Place cycle able to close */
+        IZ++;
+        assert( IZ < (int)rfc_ctx->internal.hcm.stack_cap );
+        rfc_ctx->internal.hcm.stack[IZ] = *K;
 
+        /* "goto" not necessary: while loop */
+        /* goto label_1; */
 
-#if RFC_AT_SUPPORT
-/**
- * @brief      Calculate the normalized mean load (Sa=1) for a given load ratio
- *             "R"
- *
- * @param      rfc_ctx  The rainflow context
- * @param      R        Load ratio (Su/So)
- * @param[out] Sm_norm  Normalized mean load
- *
- * @return     true on success
- */
-static
-bool at_R_to_Sm_norm( rfc_ctx_s *rfc_ctx, double R, double *Sm_norm )
-{
-    if( isinf( R ) || !Sm_norm )
-    {
-        return error_raise( rfc_ctx, RFC_ERROR_AT );
+        /* Remove K (first element) from residue */
+        residue_remove_item( rfc_ctx, /*index*/ 0, 1 );
     }
 
-    /* Su      = Sm - Sa */
-    /* So      = Sm + Sa */
-    /* R       = Su / So */
-    /* Sm      = Sa * ( 1 + R ) / ( 1 - R ) */
-    /* Sm_norm = Sm / Sa */
-
-    *Sm_norm = ( 1 + R ) / ( 1 - R );
-
-    return true;
+    /* hcm.IZ and hcm.IR are base 1! */
+    rfc_ctx->internal.hcm.IZ = IZ + 1;
+    rfc_ctx->internal.hcm.IR = IR + 1;
 }
+#endif /*RFC_HCM_SUPPORT*/
 
 
+#if RFC_ASTM_SUPPORT
 /**
- * @brief      Calculate the influence of (normalized, Sa=1) mean load on
- *             fatigue strength (Haigh-diagram)
- *
- * @param      rfc_ctx      The rainflow context
- * @param      Sm_norm      Mean load, normalized (Sm/Sa)
- * @param[out] alleviation  Alleviation factor on reference curve
+ * @brief      Rainflow counting core (3-point-method [1], ASTM Standard E 1049, 1985 (2011)).
  *
- * @return     true on success
+ * @param      rfc_ctx  The rainflow context
+ * @param      flags    The flags
  */
 static
-bool at_alleviation( rfc_ctx_s *rfc_ctx, double Sm_norm, double *alleviation )
+void cycle_find_astm( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
 {
     assert( rfc_ctx );
+    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
 
-    if( !alleviation )
-    {
-        return error_raise( rfc_ctx, RFC_ERROR_AT );
-    }
-
-    if( !rfc_ctx->at.count )
-    {
-        /* No reference curve given, no transformation */
-        *alleviation = 1.0;
-    }
-    else
+    while( rfc_ctx->residue_cnt >= 3 )
     {
-        /* Reference curve */
-        const double   *Sa_   = rfc_ctx->at.Sa;
-        const double   *Sm_   = rfc_ctx->at.Sm;
-              unsigned  count = rfc_ctx->at.count;
+        size_t idx = rfc_ctx->residue_cnt - 3;
 
-        assert( rfc_ctx && Sm_ && Sa_ );
+        unsigned A = rfc_ctx->residue[idx+0].cls;
+        unsigned B = rfc_ctx->residue[idx+1].cls;
+        unsigned C = rfc_ctx->residue[idx+2].cls;
+        unsigned Y = abs( A - B );
+        unsigned X = abs( B - C );
 
-        if( Sm_norm <= Sm_[0] / Sa_[0] )
-        {
-            /* First segment */
-            *alleviation = Sa_[0];  /* Clip to first point */
-        }
-        else if( Sm_norm >= Sm_[count-1] / Sa_[count-1] )
-        {
-            /* Last segment */
-            *alleviation = Sa_[count-1];  /* Clip to last point */
-        }
-        else
+        /* Check for closed cycles [1] */
+        if( X >= Y )
         {
-            unsigned i;
-            bool done = false;
+            rfc_value_tuple_s *from = &rfc_ctx->residue[idx+0];
+            rfc_value_tuple_s *to   = &rfc_ctx->residue[idx+1];
+            rfc_value_tuple_s *Z    = &rfc_ctx->residue[0];
 
-            /* Select correct segment */
-            for( i = 1; !done && i < count; i++ )
+            /* Closed cycle found, process countings */
+            
+            /* Does Y include Z? */
+            if( (Z->cls >= A && Z->cls <= B) ||
+                (Z->cls >= B && Z->cls <= A) )
             {
-                assert( Sa_[i-1] > 0.0 && Sa_[i] > 0.0 && Sm_[i-1] <= Sm_[i] );
+                rfc_counts_t old_inc = rfc_ctx->curr_inc;
 
-                if( Sm_norm > Sm_[i-1] / Sa_[i-1] && Sm_norm <= Sm_[i] / Sa_[i] )
-                {
-                    /* Intersection of R slope and M slope */
-                    double M_signed = ( Sa_[i] - Sa_[i-1] ) / ( Sm_[i] - Sm_[i-1] );
+                /* Count as half cycle */
+                rfc_ctx->curr_inc = rfc_ctx->half_inc;
+                rfc_ctx->internal.counts_fcn( rfc_ctx, from, to, to + 1, flags );
+                rfc_ctx->curr_inc = old_inc;
 
-                    *alleviation = ( Sa_[i-1] - M_signed * Sm_[i-1] ) / ( 1.0 - M_signed * Sm_norm );
-                    done = true;
+                /* Remove only first turning point (idx+0) */
+                rfc_ctx->residue[idx+0] = rfc_ctx->residue[idx+1];
+                rfc_ctx->residue[idx+1] = rfc_ctx->residue[idx+2];
+                
+                /* Move interim turning point */
+                if( rfc_ctx->state == RFC_STATE_BUSY_INTERIM )
+                {
+                    rfc_ctx->residue[idx+2] = rfc_ctx->residue[idx+3];
                 }
+                
+                rfc_ctx->residue_cnt--;
             }
-
-            if( !done )
+            else
             {
-                assert( false );
-                return error_raise( rfc_ctx, RFC_ERROR_AT );
+                /* Count as standard cycle */
+                rfc_ctx->internal.counts_fcn( rfc_ctx, from, to, to + 1, flags );
+
+                /* Remove first two turning points (idx+0 and idx+1) */
+                rfc_ctx->residue[idx+0] = rfc_ctx->residue[idx+2];
+                /* Move interim turning point */
+                if( rfc_ctx->state == RFC_STATE_BUSY_INTERIM )
+                {
+                    rfc_ctx->residue[idx+1] = rfc_ctx->residue[idx+3];
+                }
+                rfc_ctx->residue_cnt -= 2;
             }
         }
+        else break;
     }
-
-    return true;
 }
-#endif /*RFC_AT_SUPPORT*/
+#endif /*RFC_ASTM_SUPPORT*/
 
 
+#if !RFC_MINIMAL
 /**
- * @brief      Calculate pseudo damage for one closed (full) cycle.
- *
- * @param      rfc_ctx     The rainflow context
- * @param      class_from  The starting class
- * @param      class_to    The ending class
- * @param[out] damage      The damage value for the closed cycle
- * @param[out] Sa_ret      The amplitude, may be NULL
+ * @brief      Processes LC count (level crossing) for the last slope in residue
  *
- * @return     true on success
+ * @param      rfc_ctx  The rainflow context
+ * @param      flags    Control flags
  */
 static
-bool damage_calc( rfc_ctx_s *rfc_ctx, unsigned class_from, unsigned class_to, double *damage, double *Sa_ret )
+void cycle_process_lc( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
 {
-    double Sa = -1.0;  /* Negative amplitude states undefined */
-    double D  =  0.0;
-
-    assert( damage );
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT );
+    size_t n = rfc_ctx->residue_cnt;
 
-#if RFC_DAMAGE_FAST
-    if( rfc_ctx->damage_lut && !rfc_ctx->damage_lut_inapt)
+    if( n > 1 && (flags & RFC_FLAGS_COUNT_LC) )
     {
-        if( !damage_calc_fast( rfc_ctx, class_from, class_to, &D, &Sa ) )
-        {
-            return false;
-        }
-    } 
-    else
-#endif /*RFC_DAMAGE_FAST*/
+        /* Do the level crossing counting */
+        bool rising = rfc_ctx->residue[n-1].value > rfc_ctx->residue[n-2].value;
 
-#if RFC_USE_DELEGATES
-    if( rfc_ctx->damage_calc_fcn )
-    {
-        if( !rfc_ctx->damage_calc_fcn( rfc_ctx, class_from, class_to, &D, &Sa ) )
+        if( rising )
         {
-            return false;
+            cycle_process_counts( rfc_ctx, &rfc_ctx->residue[n-2], &rfc_ctx->residue[n-1], NULL, flags & (RFC_FLAGS_COUNT_LC_UP | RFC_FLAGS_ENFORCE_MARGIN) );
         }
-    }
-    else
-#endif /*RFC_USE_DELEGATES*/
-
-
-    if( class_from != class_to )
-    {
-#if RFC_MINIMAL
-        Sa = fabs( (int)class_from - (int)class_to ) / 2.0 * rfc_ctx->class_width;
-
-        if( !damage_calc_amplitude( rfc_ctx, Sa, &D ) )
+        else
         {
-            return false;
+            cycle_process_counts( rfc_ctx, &rfc_ctx->residue[n-2], &rfc_ctx->residue[n-1], NULL, flags & (RFC_FLAGS_COUNT_LC_DN | RFC_FLAGS_ENFORCE_MARGIN) );
         }
-#else /*!RFC_MINIMAL*/
-        double Sa_i = fabs( (int)class_from - (int)class_to ) / 2.0 * rfc_ctx->class_width;
-        double Sm_i =     ( (int)class_from + (int)class_to ) / 2.0 * rfc_ctx->class_width + rfc_ctx->class_offset;
+    }
+}
 
-        if( Sa_i > 0.0 )
-        {
-#if RFC_AT_SUPPORT
-            /* Calculate transformation factor with normalized mean value */
-            if( !RFC_at_transform( rfc_ctx, Sa_i, Sm_i, &Sa ) )
-            {
-                return false;
-            }
-#else /*!RFC_AT_SUPPORT*/
-            Sa = Sa_i;
-#endif /*RFC_AT_SUPPORT*/
 
-            if( !damage_calc_amplitude( rfc_ctx, Sa, &D ) )
-            {
-                return false;
-            }
-        }
-#endif /*RFC_MINIMAL*/
+/**
+ * @brief      Add level crossings pending in the difference array to .lc
+ *             (prefix sum) and clear the difference array. Slopes are
+ *             counted in constant time this way, regardless of the number
+ *             of classes crossed.
+ *
+ * @param      rfc_ctx  The rainflow context
+ */
+static
+void lc_flush( rfc_ctx_s *rfc_ctx )
+{
+    rfc_counts_t   *lc_diff = rfc_ctx->internal.lc_diff;
+    rfc_counts_t    sum     = 0;
+    bool            snapshot;
+    unsigned        i;
+
+    if( !rfc_ctx->internal.lc_dirty || !rfc_ctx->lc )
+    {
+        return;
     }
 
-    if( Sa_ret )
+    snapshot = snapshot_begin( rfc_ctx );
+
+    for( i = 0; i < rfc_ctx->class_count; i++ )
     {
-        *Sa_ret = Sa;
+        sum        += lc_diff[i];
+        lc_diff[i]  = 0;
+
+        assert( rfc_ctx->lc[i] <= RFC_COUNTS_LIMIT - sum );
+        rfc_ctx->lc[i] += sum;
     }
 
-    *damage = D;
+    rfc_ctx->internal.lc_dirty = false;
 
-    return true;
+    snapshot_end( rfc_ctx, snapshot );
 }
+#endif /*!RFC_MINIMAL*/
 
 
-#if RFC_DAMAGE_FAST
+#if !RFC_MINIMAL
 /**
- * @brief      Initialize a look-up table of damages for closed cycles. In this
- *             implementation the midrange doesn't matter!
+ * @brief      Allocate an empty sparse rainflow matrix.
  *
  * @param      rfc_ctx  The rainflow context
  *
- * @returns    true on success
+ * @return     true on success
  */
-static 
-bool damage_lut_init( rfc_ctx_s *rfc_ctx )
+static
+bool rfm_sparse_init( rfc_ctx_s *rfc_ctx )
 {
-    double   *lut;
-    unsigned  from, 
-              to;
-    double    Sa;
+    rfc_rfm_sparse_s *rfm_sparse;
 
-    assert( rfc_ctx );
-    assert( rfc_ctx->state == RFC_STATE_INIT );
+    assert( rfc_ctx && !rfc_ctx->rfm_sparse && rfc_ctx->class_count );
 
-    if( rfc_ctx->damage_lut )
+    rfm_sparse = (rfc_rfm_sparse_s*)rfc_ctx->mem_alloc( NULL, 1, sizeof(rfc_rfm_sparse_s), RFC_MEM_AIM_MATRIX );
+
+    if( !rfm_sparse )
     {
-        lut = rfc_ctx->damage_lut;
-        rfc_ctx->damage_lut = NULL;
+        return false;
+    }
 
-        for( from = 0; from < rfc_ctx->class_count; from++ )
-        {
-            for( to = 0; to < rfc_ctx->class_count; to++ )
-            {
-                double D;
+    rfc_ctx->rfm_sparse     = rfm_sparse;
 
-                if( !damage_calc( rfc_ctx, from, to, &D, &Sa ) )
-                {
-                    rfc_ctx->mem_alloc( lut, 0, 0, RFC_MEM_AIM_DLUT );
-                    return false;
-                }
-                lut[from * rfc_ctx->class_count + to] = D;
-#if RFC_AT_SUPPORT
-                if( rfc_ctx->amplitude_lut )
-                {
-                    rfc_ctx->amplitude_lut[from * rfc_ctx->class_count + to] = Sa;
-                }
-#endif /*RFC_AT_SUPPORT*/
-            }
-        }
+    rfm_sparse->count       = 0;
+    rfm_sparse->cap         = RFM_SPARSE_CAP_MIN;
+    rfm_sparse->slots_mask  = 2 * RFM_SPARSE_CAP_MIN - 1;
+    rfm_sparse->items       = (rfc_rfm_item_s*)rfc_ctx->mem_alloc( NULL, rfm_sparse->cap, sizeof(rfc_rfm_item_s), RFC_MEM_AIM_MATRIX );
+    rfm_sparse->next        = (unsigned*)rfc_ctx->mem_alloc( NULL, rfm_sparse->cap, sizeof(unsigned), RFC_MEM_AIM_MATRIX );
+    rfm_sparse->row         = (unsigned*)rfc_ctx->mem_alloc( NULL, rfc_ctx->class_count, sizeof(unsigned), RFC_MEM_AIM_MATRIX );
+    rfm_sparse->slots       = (unsigned*)rfc_ctx->mem_alloc( NULL, rfm_sparse->slots_mask + 1, sizeof(unsigned), RFC_MEM_AIM_MATRIX );
 
-        rfc_ctx->damage_lut          = lut;
-        rfc_ctx->damage_lut_inapt    = 0;
+    if( !rfm_sparse->items || !rfm_sparse->next || !rfm_sparse->row || !rfm_sparse->slots )
+    {
+        rfm_sparse_free( rfc_ctx );
+        return false;
     }
 
+    rfm_sparse_clear( rfc_ctx );
+
     return true;
 }
 
 
 /**
- * @brief      Calculate pseudo damage for one closed (full) cycle, using
- *             look-up table.
- *
- * @param      rfc_ctx     The rainflow context
- * @param      class_from  The starting class
- * @param      class_to    The ending class
- * @param[out] damage      The damage value for the closed cycle
- * @param[out] Sa_ret      The amplitude (-1 if not available), may be NULL
+ * @brief      Free the sparse rainflow matrix.
  *
- * @return     true on success
+ * @param      rfc_ctx  The rainflow context
  */
 static
-bool damage_calc_fast( rfc_ctx_s *rfc_ctx, unsigned class_from, unsigned class_to, double *damage, double *Sa_ret )
+void rfm_sparse_free( rfc_ctx_s *rfc_ctx )
 {
-    double Sa = -1;    /* -1 means "uninitialized" */
-    double D  =  0.0;
-
-    assert( damage );
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT );
-    assert( class_from < rfc_ctx->class_count );
-    assert( class_to   < rfc_ctx->class_count );
+    rfc_rfm_sparse_s *rfm_sparse = rfc_ctx->rfm_sparse;
 
-    if( rfc_ctx->damage_lut && !rfc_ctx->damage_lut_inapt )
-    {
-        D = rfc_ctx->damage_lut[class_from * rfc_ctx->class_count + class_to];
+    assert( rfm_sparse );
 
-        if( Sa_ret )
-        {
-#if RFC_AT_SUPPORT
-            if( rfc_ctx->amplitude_lut )
-            {
-                *Sa_ret = rfc_ctx->amplitude_lut[class_from * rfc_ctx->class_count + class_to];
-            }
-#else /*!RFC_AT_SUPPORT*/
-            *Sa_ret = AMPLITUDE( rfc_ctx, fabs( (int)class_from - (int)class_to ) );
-#endif /*RFC_AT_SUPPORT*/
-        }
-    }
-    else
-    {
-        return error_raise( rfc_ctx, RFC_ERROR_LUT );
-    }
+    if( rfm_sparse->items )     rfc_ctx->mem_alloc( rfm_sparse->items,  0, 0, RFC_MEM_AIM_MATRIX );
+    if( rfm_sparse->next )      rfc_ctx->mem_alloc( rfm_sparse->next,   0, 0, RFC_MEM_AIM_MATRIX );
+    if( rfm_sparse->row )       rfc_ctx->mem_alloc( rfm_sparse->row,    0, 0, RFC_MEM_AIM_MATRIX );
+    if( rfm_sparse->slots )     rfc_ctx->mem_alloc( rfm_sparse->slots,  0, 0, RFC_MEM_AIM_MATRIX );
 
-    *damage = D;
+    rfc_ctx->mem_alloc( rfm_sparse, 0, 0, RFC_MEM_AIM_MATRIX );
 
-    return true;
+    rfc_ctx->rfm_sparse = NULL;
 }
-#endif /*RFC_DAMAGE_FAST*/
 
 
 /**
- * @brief      Test data sample for a new turning point and add to the residue
- *             in that case. Update extrema.
- *             - 1. Hysteresis Filtering
- *             - 2. Peak-Valley Filtering
+ * @brief      Remove all elements from the sparse rainflow matrix. Memory
+ *             is kept for reuse.
  *
  * @param      rfc_ctx  The rainflow context
- * @param[in]  pt       The data tuple, must not be NULL
+ */
+static
+void rfm_sparse_clear( rfc_ctx_s *rfc_ctx )
+{
+    rfc_rfm_sparse_s *rfm_sparse = rfc_ctx->rfm_sparse;
+
+    assert( rfm_sparse );
+
+    rfm_sparse->count = 0;
+    memset( rfm_sparse->row,   0, sizeof(unsigned) * rfc_ctx->class_count );
+    memset( rfm_sparse->slots, 0, sizeof(unsigned) * ( rfm_sparse->slots_mask + 1 ) );
+}
+
+
+/**
+ * @brief      Rebuild the hash table of the sparse rainflow matrix.
  *
- * @return     Returns pointer to new turning point in residue or NULL
+ * @param      rfc_ctx      The rainflow context
+ * @param      slots_count  The new number of slots (power of 2, greater than element count)
+ *
+ * @return     true on success
  */
 static
-rfc_value_tuple_s * feed_filter_pt( rfc_ctx_s *rfc_ctx, const rfc_value_tuple_s *pt )
+bool rfm_sparse_rehash( rfc_ctx_s *rfc_ctx, unsigned slots_count )
 {
-    int                 slope;
-    rfc_value_t         delta;
-    rfc_value_tuple_s  *new_tp      = NULL;
-    bool                do_append   = false;
+    rfc_rfm_sparse_s   *rfm_sparse = rfc_ctx->rfm_sparse;
+    unsigned           *slots;
+    unsigned            i;
 
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state <= RFC_STATE_BUSY_INTERIM );
+    assert( rfm_sparse && slots_count > rfm_sparse->count && !( slots_count & ( slots_count - 1 ) ) );
 
-#if RFC_USE_DELEGATES
-    if( rfc_ctx->tp_next_fcn )
+    slots = (unsigned*)rfc_ctx->mem_alloc( NULL, slots_count, sizeof(unsigned), RFC_MEM_AIM_MATRIX );
+
+    if( !slots )
     {
-        return rfc_ctx->tp_next_fcn( rfc_ctx, pt );
+        return false;
     }
-#endif /*RFC_USE_DELEGATES*/
-
-    if( !pt ) return NULL;
 
-    slope = rfc_ctx->internal.slope;
+    memset( slots, 0, sizeof(unsigned) * slots_count );
 
-    /* Handle first turning point(s) */
-    if( rfc_ctx->state < RFC_STATE_BUSY_INTERIM )
+    for( i = 0; i < rfm_sparse->count; i++ )
     {
-        /* Residue is empty, still searching first turning point(s) */
+        unsigned h = RFM_SPARSE_HASH( rfm_sparse->items[i].from, rfm_sparse->items[i].to );
 
-        if( rfc_ctx->state == RFC_STATE_INIT )
+        h = ( h ^ ( h >> 15 ) ) & ( slots_count - 1 );
+        while( slots[h] )
         {
-            /* Very first point, initialize local min-max search */
-            rfc_ctx->internal.extrema[0] = 
-            rfc_ctx->internal.extrema[1] = *pt;
-            rfc_ctx->state               =  RFC_STATE_BUSY;
+            h = ( h + 1 ) & ( slots_count - 1 );
         }
-        else
-        {
-            int is_falling_slope = -1;
 
-            assert( rfc_ctx->state == RFC_STATE_BUSY );
+        slots[h] = i + 1;
+    }
 
-            /* Still searching for first turning point(s) */
+    rfc_ctx->mem_alloc( rfm_sparse->slots, 0, 0, RFC_MEM_AIM_MATRIX );
+    rfm_sparse->slots       = slots;
+    rfm_sparse->slots_mask  = slots_count - 1;
 
-            /* Update local extrema */
-            if( pt->value < rfc_ctx->internal.extrema[0].value )
-            {
-                /* Minimum */
-                is_falling_slope = 1;
-                rfc_ctx->internal.extrema[0] = *pt;
-#if RFC_GLOBAL_EXTREMA
-                rfc_ctx->internal.extrema_changed = true;
-#endif /*RFC_GLOBAL_EXTREMA*/
-            }
-            else if( pt->value > rfc_ctx->internal.extrema[1].value )
-            {
-                /* Maximum */
-                is_falling_slope = 0;
-                rfc_ctx->internal.extrema[1] = *pt;
-#if RFC_GLOBAL_EXTREMA
-                rfc_ctx->internal.extrema_changed = true;
-#endif /*RFC_GLOBAL_EXTREMA*/
-            }
+    return true;
+}
 
-            /* Local hysteresis filtering */
-            delta = value_delta( rfc_ctx, &rfc_ctx->internal.extrema[0], &rfc_ctx->internal.extrema[1], NULL /* sign_ptr */ );
 
-            if( is_falling_slope >= 0 && delta > rfc_ctx->hysteresis )
-            {
-                /* Criteria met, new turning point found.
-                 * Emit maximum on falling slope as first interim turning point, 
-                 * minimum as second then (and vice versa) 
-                 * 1st point: internal.extrema[ is_falling_slope]
-                 * 2nd point: internal.extrema[!is_falling_slope]  ==> which is *pt also
-                 */
-                assert( rfc_ctx->residue_cnt < rfc_ctx->residue_cap );
-                rfc_ctx->residue[rfc_ctx->residue_cnt] = rfc_ctx->internal.extrema[is_falling_slope];
+/**
+ * @brief      Find an element of the sparse rainflow matrix. New elements
+ *             are linked into their row list, which is kept sorted by
+ *             target class.
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param      from     The start class (row)
+ * @param      to       The target class (col)
+ * @param      create   true, if a missing element has to be created (zero counts)
+ *
+ * @return     The counts of the element, NULL if missing (or out of memory)
+ */
+static
+rfc_counts_t *rfm_sparse_find( rfc_ctx_s *rfc_ctx, unsigned from, unsigned to, bool create )
+{
+    rfc_rfm_sparse_s   *rfm_sparse = rfc_ctx->rfm_sparse;
+    rfc_rfm_item_s     *item;
+    unsigned           *link;
+    unsigned            h, k;
 
-                rfc_ctx->internal.slope = is_falling_slope ? -1 : 1;
+    assert( rfm_sparse && from < rfc_ctx->class_count && to < rfc_ctx->class_count );
 
-                /* pt is the new interim turning point */
-                rfc_ctx->state = RFC_STATE_BUSY_INTERIM;
-                do_append = true;
-            }
-        }
-    }
-    else  /* if( rfc_ctx->state < RFC_STATE_BUSY_INTERIM ) */
-    {
-        assert( rfc_ctx->state == RFC_STATE_BUSY_INTERIM );
+    h = RFM_SPARSE_HASH( from, to );
+    h = ( h ^ ( h >> 15 ) ) & rfm_sparse->slots_mask;
 
-        /* Consecutive search for turning points */
+    for( ; ( k = rfm_sparse->slots[h] ) != 0; h = ( h + 1 ) & rfm_sparse->slots_mask )
+    {
+        item = &rfm_sparse->items[k-1];
 
-#if RFC_GLOBAL_EXTREMA
-        /* Build global extrema */
-        if( pt->value < rfc_ctx->internal.extrema[0].value )
-        {
-            /* Minimum */
-            rfc_ctx->internal.extrema[0] = *pt;
-            rfc_ctx->internal.extrema_changed = true;
-        }
-        else if( pt->value > rfc_ctx->internal.extrema[1].value )
+        if( item->from == from && item->to == to )
         {
-            /* Maximum */
-            rfc_ctx->internal.extrema[1] = *pt;
-            rfc_ctx->internal.extrema_changed = true;
+            return &item->counts;
         }
-#endif /*RFC_GLOBAL_EXTREMA*/
+    }
 
-        /* Hysteresis Filtering, check against interim turning point */
-        delta = value_delta( rfc_ctx, &rfc_ctx->residue[rfc_ctx->residue_cnt], pt, &slope /* sign_ptr */ );
+    if( !create )
+    {
+        return NULL;
+    }
 
-        /* There are three scenarios possible here:
-         *   1. Previous slope is continued
-         *      "delta" is ignored whilst hysteresis is exceeded already.
-         *      Interim turning point has just to be adjusted.
-         *   2. Slope reversal, slope is greater than hysteresis
-         *      Interim turning point becomes real turning point.
-         *      Current point becomes new interim turning point
-         *   3. Slope reversal, slope is less than or equal hysteresis
-         *      Nothing to do.
-         */
+    if( rfm_sparse->count == rfm_sparse->cap )
+    {
+        /* Double capacity, the hash table stays at most half full */
+        unsigned        cap     = 2 * rfm_sparse->cap;
+        rfc_rfm_item_s *items   = (rfc_rfm_item_s*)rfc_ctx->mem_alloc( rfm_sparse->items, cap, sizeof(rfc_rfm_item_s), RFC_MEM_AIM_MATRIX );
+        unsigned       *next;
 
-        /* Peak-Valley Filtering */
-        /* Justify interim turning point, or add a new one (2) */
-        if( slope == rfc_ctx->internal.slope )
+        if( !items )
         {
-            /* Scenario (1), Continuous slope */
-
-            /* Replace interim turning point with new extrema */
-            if( rfc_ctx->residue[rfc_ctx->residue_cnt].value != pt->value )
-            {
-                rfc_ctx->residue[rfc_ctx->residue_cnt] = *pt;
-            }
+            return NULL;
         }
-        else
-        {
-            if( delta > rfc_ctx->hysteresis )
-            {
-                /* Scenario (2), Criteria met: slope != rfc_ctx->internal.slope && delta > rfc_ctx->hysteresis */
+        rfm_sparse->items = items;
+
+        next = (unsigned*)rfc_ctx->mem_alloc( rfm_sparse->next, cap, sizeof(unsigned), RFC_MEM_AIM_MATRIX );
+
+        if( !next )
+        {
+            return NULL;
+        }
+        rfm_sparse->next = next;
 
-                /* Storage */
-                rfc_ctx->internal.slope = slope;
+        if( !rfm_sparse_rehash( rfc_ctx, 2 * cap ) )
+        {
+            return NULL;
+        }
+        rfm_sparse->cap = cap;
 
-                /* Handle new turning point */
-                do_append = true;
-            }
-            else
-            {
-                /* Scenario (3), Turning point found, but still in hysteresis band, nothing to do */
-            }
+        h = RFM_SPARSE_HASH( from, to );
+        h = ( h ^ ( h >> 15 ) ) & rfm_sparse->slots_mask;
+        while( rfm_sparse->slots[h] )
+        {
+            h = ( h + 1 ) & rfm_sparse->slots_mask;
         }
     }
 
-    /* Handle new turning point, that is the current last point in residue */
-    if( do_append )
-    {
-        assert( rfc_ctx->state == RFC_STATE_BUSY_INTERIM );
-
-        /* Increment and set new interim turning point */
-        assert( rfc_ctx->residue_cnt + 1 < rfc_ctx->residue_cap );
-        rfc_ctx->residue[++rfc_ctx->residue_cnt] = *pt;
+    k                   = rfm_sparse->count++;
+    item                = &rfm_sparse->items[k];
+    item->from          = from;
+    item->to            = to;
+    item->counts        = 0;
+    rfm_sparse->slots[h] = k + 1;
 
-        /* Return new turning point */
-        new_tp = &rfc_ctx->residue[rfc_ctx->residue_cnt - 1];
+    /* Link into row list, ascending target class */
+    link = &rfm_sparse->row[from];
+    while( *link && rfm_sparse->items[*link - 1].to < to )
+    {
+        link = &rfm_sparse->next[*link - 1];
     }
 
-    return new_tp;
+    rfm_sparse->next[k] = *link;
+    *link               = k + 1;
+
+    return &item->counts;
 }
 
 
-# if !RFC_MINIMAL
 /**
- * @brief      Rainflow counting core, assumes
+ * @brief      Write a sparse rainflow matrix into a dense one.
  *
- * @param      rfc_ctx  The rainflow context
- * @param      flags    The flags
+ * @param[in]  rfm_sparse   The sparse rainflow matrix
+ * @param[out] rfm          The dense rainflow matrix (class_count^2 elements)
+ * @param      class_count  The class count
  */
 static
-void cycle_find( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+void rfm_sparse_expand( const rfc_rfm_sparse_s *rfm_sparse, rfc_counts_t *rfm, unsigned class_count )
 {
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    unsigned i;
 
-#if RFC_USE_DELEGATES
-    /* Check for delegates */
-    if( rfc_ctx->cycle_find_fcn && rfc_ctx->counting_method == RFC_COUNTING_METHOD_DELEGATED )
-    {
-        rfc_ctx->cycle_find_fcn( rfc_ctx, flags );
-    }
-    else
-#endif /*RFC_USE_DELEGATES*/
-    {
-        switch( rfc_ctx->counting_method )
-        {
-            case RFC_COUNTING_METHOD_NONE:
-                break;
-            case RFC_COUNTING_METHOD_4PTM:
-                cycle_find_4ptm( rfc_ctx, flags );
-                break;
-#if RFC_HCM_SUPPORT
-            case RFC_COUNTING_METHOD_HCM:
-                cycle_find_hcm( rfc_ctx, flags );
-                break;
-#endif /*RFC_HCM_SUPPORT*/
-#if RFC_ASTM_SUPPORT
-            case RFC_COUNTING_METHOD_ASTM:
-                cycle_find_astm( rfc_ctx, flags );
-                break;
-#endif /*RFC_ASTM_SUPPORT*/
-            case RFC_COUNTING_METHOD_DELEGATED:
-                /* FALLTHROUGH */
-            default:
-                assert( false );
-                break;
-        }
-    }
+    assert( rfm_sparse && rfm );
 
-    /* If no rainflow counting is done, just look out for turning points, discard residue */
-    if( rfc_ctx->counting_method == RFC_COUNTING_METHOD_NONE || !rfc_ctx->class_count )
+    memset( rfm, 0, sizeof(rfc_counts_t) * class_count * class_count );
+
+    for( i = 0; i < rfm_sparse->count; i++ )
     {
-        /* Prune residue */
-        if( rfc_ctx->residue_cnt > 1 )
-        {
-            residue_remove_item( rfc_ctx, /*index*/ 0, rfc_ctx->residue_cnt - 1 );
-        }
+        rfm[ MAT_OFFS( rfm_sparse->items[i].from, rfm_sparse->items[i].to ) ] = rfm_sparse->items[i].counts;
     }
-
 }
-#endif /*!RFC_MINIMAL*/
 
 
 /**
- * @brief      Rainflow counting core (4-point-method [3]).
+ * @brief      Bring the summed-area tables of the (dense) rainflow matrix up
+ *             to date. Element (i,j) of a table holds the sum over all rows
+ *             below i and all columns below j, so tables have (class_count+1)^2
+ *             elements. Rows already valid are kept, changed rows and their
+ *             successors are rebuilt.
  *
  * @param      rfc_ctx  The rainflow context
- * @param      flags    The flags
+ * @param      rows     The number of matrix rows needed
+ * @param      damage   true, if the damage table is needed as well
+ *
+ * @return     true on success
  */
 static
-void cycle_find_4ptm( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+bool rfm_sat_update( rfc_ctx_s *rfc_ctx, unsigned rows, bool damage )
 {
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    unsigned            class_count = rfc_ctx->class_count;
+    unsigned            n           = class_count + 1;
+    const rfc_counts_t *rfm         = rfc_ctx->rfm;
+    unsigned            from, to;
 
-    while( rfc_ctx->residue_cnt >= 4 )
-    {
-        size_t idx = rfc_ctx->residue_cnt - 4;
+    assert( rfm && rows <= class_count );
 
-        unsigned A = rfc_ctx->residue[idx+0].cls;
-        unsigned B = rfc_ctx->residue[idx+1].cls;
-        unsigned C = rfc_ctx->residue[idx+2].cls;
-        unsigned D = rfc_ctx->residue[idx+3].cls;
+    if( !rfc_ctx->internal.rfm_sat.counts )
+    {
+        /* Zeroed, so the first row (sums over no rows) is valid */
+        rfc_ctx->internal.rfm_sat.counts = (rfc_counts_t*)rfc_ctx->mem_alloc( NULL, n * n, sizeof(rfc_counts_t), RFC_MEM_AIM_RFM_SAT );
 
-        if( B > C )
+        if( !rfc_ctx->internal.rfm_sat.counts )
         {
-            unsigned temp = B;
-            B = C;
-            C = temp;
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
         }
 
-        if( A > D )
+        rfc_ctx->internal.rfm_sat.rows        = 0;
+        rfc_ctx->internal.rfm_sat.damage_rows = 0;
+    }
+
+    for( from = rfc_ctx->internal.rfm_sat.rows; from < rows; from++ )
+    {
+        const rfc_counts_t *above = rfc_ctx->internal.rfm_sat.counts + from * n;
+        rfc_counts_t       *curr  = rfc_ctx->internal.rfm_sat.counts + ( from + 1 ) * n;
+        rfc_counts_t        sum   = 0;
+
+        curr[0] = 0;
+        for( to = 0; to < class_count; to++ )
         {
-            unsigned temp = A;
-            A = D;
-            D = temp;
+            sum         += rfm[ MAT_OFFS( from, to ) ];
+            curr[to + 1] = above[to + 1] + sum;
         }
+    }
 
-        /* Check for closed cycles [3] */
-        if( A <= B && C <= D )
+    if( rows > rfc_ctx->internal.rfm_sat.rows )
+    {
+        rfc_ctx->internal.rfm_sat.rows = rows;
+    }
+
+    if( !damage )
+    {
+        return true;
+    }
+
+    if( !rfc_ctx->internal.rfm_sat.damage )
+    {
+        rfc_ctx->internal.rfm_sat.damage = (double*)rfc_ctx->mem_alloc( NULL, n * n, sizeof(double), RFC_MEM_AIM_RFM_SAT );
+
+        if( !rfc_ctx->internal.rfm_sat.damage )
         {
-            rfc_value_tuple_s *from = &rfc_ctx->residue[idx+1];
-            rfc_value_tuple_s *to   = &rfc_ctx->residue[idx+2];
+            return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+        }
 
-            /* Closed cycle found, process countings */
-            cycle_process_counts( rfc_ctx, from, to, to + 1, flags );
+        rfc_ctx->internal.rfm_sat.damage_rows = 0;
+    }
 
-            /* Remove two inner turning points (idx+1 and idx+2) */
-            /* Move last turning point */
-            rfc_ctx->residue[idx+1] = rfc_ctx->residue[idx+3];
-            /* Move interim turning point */
-            if( rfc_ctx->state == RFC_STATE_BUSY_INTERIM )
+    for( from = rfc_ctx->internal.rfm_sat.damage_rows; from < rows; from++ )
+    {
+        const double *above = rfc_ctx->internal.rfm_sat.damage + from * n;
+        double       *curr  = rfc_ctx->internal.rfm_sat.damage + ( from + 1 ) * n;
+        double        sum   = 0.0;
+
+        curr[0] = 0.0;
+        for( to = 0; to < class_count; to++ )
+        {
+            rfc_counts_t count = rfm[ MAT_OFFS( from, to ) ];
+
+            if( count )
             {
-                rfc_ctx->residue[idx+2] = rfc_ctx->residue[idx+4];
+                double damage_i;
+
+                if( !damage_calc( rfc_ctx, from, to, &damage_i, NULL /*Sa_ret*/ ) )
+                {
+                    return false;
+                }
+
+                sum += damage_i * count;
             }
-            rfc_ctx->residue_cnt -= 2;
+
+            curr[to + 1] = above[to + 1] + sum;
         }
-        else break;
     }
+
+    if( rows > rfc_ctx->internal.rfm_sat.damage_rows )
+    {
+        rfc_ctx->internal.rfm_sat.damage_rows = rows;
+    }
+
+    return true;
 }
 
 
-#if RFC_HCM_SUPPORT
 /**
- * @brief      Rainflow counting core (HCM method).
+ * @brief      Free the summed-area tables of the rainflow matrix.
  *
  * @param      rfc_ctx  The rainflow context
- * @param      flags    The flags
  */
 static
-void cycle_find_hcm( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+void rfm_sat_free( rfc_ctx_s *rfc_ctx )
 {
-    int IZ, IR;
-    double eps = rfc_ctx->class_width / 100;
-
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
-
-    IZ = rfc_ctx->internal.hcm.IZ - 1,  /* hcm.IZ and hcm.IR are base 1! */
-    IR = rfc_ctx->internal.hcm.IR - 1;
+    if( rfc_ctx->internal.rfm_sat.counts )
+    {
+        rfc_ctx->mem_alloc( rfc_ctx->internal.rfm_sat.counts, 0, 0, RFC_MEM_AIM_RFM_SAT );
+        rfc_ctx->internal.rfm_sat.counts = NULL;
+    }
 
-    while( rfc_ctx->residue_cnt > 0 )
+    if( rfc_ctx->internal.rfm_sat.damage )
     {
-        rfc_value_tuple_s *I, *J, *K;
+        rfc_ctx->mem_alloc( rfc_ctx->internal.rfm_sat.damage, 0, 0, RFC_MEM_AIM_RFM_SAT );
+        rfc_ctx->internal.rfm_sat.damage = NULL;
+    }
 
-        /* Translation from "RAINFLOW.F" */
-/*label_1:*/
-        K = rfc_ctx->residue;  /* Recent value (turning point) */
+    rfc_ctx->internal.rfm_sat.rows        = 0;
+    rfc_ctx->internal.rfm_sat.damage_rows = 0;
+}
 
-        /* Place first turning point into stack */
-        if( !IR )
-        {
-            rfc_ctx->internal.hcm.stack[IR++] = *K;
-        }
 
-label_2:
-        if( IZ > IR )
-        {
-            /* There are at least 2 cycles on the stack able to close */
-            I = &rfc_ctx->internal.hcm.stack[IZ-1];
-            J = &rfc_ctx->internal.hcm.stack[IZ];
+#if RFC_AR_SUPPORT
+/**
+ * @brief      Adapt the sparse rainflow matrix to a new class count.
+ *
+ * @param      rfc_ctx          The rainflow context
+ * @param      class_count_old  The previous class count
+ * @param      class_count      The new class count
+ * @param      class_shift      The number of classes added below
+ *
+ * @return     true on success
+ */
+static
+bool rfm_sparse_resize( rfc_ctx_s *rfc_ctx, unsigned class_count_old, unsigned class_count, unsigned class_shift )
+{
+    rfc_rfm_sparse_s   *rfm_sparse = rfc_ctx->rfm_sparse;
+    unsigned           *row;
+    unsigned            i;
 
-            if( (double)(K->value - J->value) * (double)(J->value - I->value) + eps >= 0.0 )
-            {
-                /* Is no turning point */
-                /* This should only may happen, when RFC_FLAGS_ENFORCE_MARGIN is set, 
-                   since all values from residue are turning points */
-                assert( rfc_ctx->internal.flags & RFC_FLAGS_ENFORCE_MARGIN );
-                IZ--;
-                /* Test further closed cycles */
-                goto label_2;
-            }
-            else
-            {
-                /* Is a turning point */
-                if( fabs( (double)K->value - (double)J->value ) + eps >= fabs( (double)J->value - (double)I->value ) )
-                {
-                    /* Cycle range is greater or equal to previous, register closed cycle */
-                    cycle_process_counts( rfc_ctx, I, J, NULL, flags );
-                    IZ -= 2;
-                    /* Test further closed cycles */
-                    goto label_2;
-                }
-            }
-        }
-        else if( IZ == IR )
-        {
-            J = &rfc_ctx->internal.hcm.stack[IZ];
+    assert( rfm_sparse && class_count >= class_count_old + class_shift );
 
-            if( ( (double)K->value - (double)J->value ) * (double)J->value + eps >= 0.0 )
-            {
-                /* Is no turning point */
-                IZ--;
-                /* Test further closed cycles */
-                goto label_2;
-            }
-            else if( fabs( (double)K->value ) + eps > fabs( (double)J->value ) )
-            {
-                /* Is turning point and range is less than previous */
-                IR++;
-            }
-        }
-        else
-        {
-            /* IZ < IR: There is no cycle on the stack able to close */
-        }
+    row = (unsigned*)rfc_ctx->mem_alloc( NULL, class_count, sizeof(unsigned), RFC_MEM_AIM_MATRIX );
 
-        /* Place cycle able to close */
-        IZ++;
-        assert( IZ < (int)rfc_ctx->internal.hcm.stack_cap );
-        rfc_ctx->internal.hcm.stack[IZ] = *K;
+    if( !row )
+    {
+        return false;
+    }
 
-        /* "goto" not necessary: while loop */
-        /* goto label_1; */
+    /* Row lists keep their order, only classes are shifted */
+    memset( row, 0, sizeof(unsigned) * class_count );
+    for( i = 0; i < class_count_old; i++ )
+    {
+        row[ i + class_shift ] = rfm_sparse->row[i];
+    }
 
-        /* Remove K (first element) from residue */
-        residue_remove_item( rfc_ctx, /*index*/ 0, 1 );
+    rfc_ctx->mem_alloc( rfm_sparse->row, 0, 0, RFC_MEM_AIM_MATRIX );
+    rfm_sparse->row = row;
+
+    for( i = 0; i < rfm_sparse->count; i++ )
+    {
+        rfm_sparse->items[i].from += class_shift;
+        rfm_sparse->items[i].to   += class_shift;
     }
 
-    /* hcm.IZ and hcm.IR are base 1! */
-    rfc_ctx->internal.hcm.IZ = IZ + 1;
-    rfc_ctx->internal.hcm.IR = IR + 1;
+    return rfm_sparse_rehash( rfc_ctx, rfm_sparse->slots_mask + 1 );
 }
-#endif /*RFC_HCM_SUPPORT*/
+#endif /*RFC_AR_SUPPORT*/
+#endif /*!RFC_MINIMAL*/
 
 
-#if RFC_ASTM_SUPPORT
 /**
- * @brief      Rainflow counting core (3-point-method [1], ASTM Standard E 1049, 1985 (2011)).
+ * @brief         Flag-specialized counting kernel. Handles the common cases
+ *                (damage, rainflow matrix and range pair only) without
+ *                runtime checks on flags, since flags are a compile-time
+ *                constant in each kernel variant (see COUNTS_KERNEL()).
  *
- * @param      rfc_ctx  The rainflow context
- * @param      flags    The flags
+ * @param         rfc_ctx  The rainflow context
+ * @param[in]     from     The starting data point
+ * @param[in]     to       The ending data point
+ * @param         flags    Control flags (constant)
+ *
+ * @return        false, if the generic cycle_process_counts() must be used
  */
-static
-void cycle_find_astm( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+static inline
+bool cycle_process_counts_fast( rfc_ctx_s *rfc_ctx, const rfc_value_tuple_s *from, const rfc_value_tuple_s *to, const int flags )
 {
-    assert( rfc_ctx );
-    assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
+    unsigned class_from, class_to;
 
-    while( rfc_ctx->residue_cnt >= 3 )
+#if RFC_TP_SUPPORT
+    if( ( flags & RFC_FLAGS_COUNT_DAMAGE ) && ( from->tp_pos || to->tp_pos ) )
     {
-        size_t idx = rfc_ctx->residue_cnt - 3;
+        /* Turning points in storage have to be paired */
+        return false;
+    }
 
-        unsigned A = rfc_ctx->residue[idx+0].cls;
-        unsigned B = rfc_ctx->residue[idx+1].cls;
-        unsigned C = rfc_ctx->residue[idx+2].cls;
-        unsigned Y = abs( A - B );
-        unsigned X = abs( B - C );
+    /* If flag RFC_FLAGS_ENFORCE_MARGIN is set, cycles less than hysteresis are possible */
+    if( ( flags & RFC_FLAGS_ENFORCE_MARGIN ) && value_delta( rfc_ctx, from, to, NULL /* sign_ptr */ ) <= rfc_ctx->hysteresis )
+    {
+        return true;
+    }
+#endif /*RFC_TP_SUPPORT*/
 
-        /* Check for closed cycles [1] */
-        if( X >= Y )
-        {
-            rfc_value_tuple_s *from = &rfc_ctx->residue[idx+0];
-            rfc_value_tuple_s *to   = &rfc_ctx->residue[idx+1];
-            rfc_value_tuple_s *Z    = &rfc_ctx->residue[0];
+    class_from = from->cls;
+    class_to   = to->cls;
 
-            /* Closed cycle found, process countings */
-            
-            /* Does Y include Z? */
-            if( (Z->cls >= A && Z->cls <= B) ||
-                (Z->cls >= B && Z->cls <= A) )
-            {
-                rfc_counts_t old_inc = rfc_ctx->curr_inc;
+    if( class_from >= rfc_ctx->class_count ) class_from = rfc_ctx->class_count - 1;
+    if( class_to   >= rfc_ctx->class_count ) class_to   = rfc_ctx->class_count - 1;
 
-                /* Count as half cycle */
-                rfc_ctx->curr_inc = rfc_ctx->half_inc;
-                cycle_process_counts( rfc_ctx, from, to, to + 1, flags );
-                rfc_ctx->curr_inc = old_inc;
+    if( class_from == class_to )
+    {
+        return true;
+    }
 
-                /* Remove only first turning point (idx+0) */
-                rfc_ctx->residue[idx+0] = rfc_ctx->residue[idx+1];
-                rfc_ctx->residue[idx+1] = rfc_ctx->residue[idx+2];
-                
-                /* Move interim turning point */
-                if( rfc_ctx->state == RFC_STATE_BUSY_INTERIM )
-                {
-                    rfc_ctx->residue[idx+2] = rfc_ctx->residue[idx+3];
-                }
-                
-                rfc_ctx->residue_cnt--;
-            }
-            else
-            {
-                /* Count as standard cycle */
-                cycle_process_counts( rfc_ctx, from, to, to + 1, flags );
+    if( flags & RFC_FLAGS_COUNT_DAMAGE )
+    {
+        double Sa_i;
+        double D_i;
 
-                /* Remove first two turning points (idx+0 and idx+1) */
-                rfc_ctx->residue[idx+0] = rfc_ctx->residue[idx+2];
-                /* Move interim turning point */
-                if( rfc_ctx->state == RFC_STATE_BUSY_INTERIM )
-                {
-                    rfc_ctx->residue[idx+1] = rfc_ctx->residue[idx+3];
-                }
-                rfc_ctx->residue_cnt -= 2;
-            }
+        if( !damage_calc( rfc_ctx, class_from, class_to, &D_i, &Sa_i ) )
+        {
+            return true;
         }
-        else break;
+
+        rfc_ctx->damage += D_i * rfc_ctx->curr_inc / rfc_ctx->full_inc;
+    }
+
+    if( flags & RFC_FLAGS_COUNT_RFM )
+    {
+        size_t idx = rfc_ctx->class_count * class_from + class_to;
+
+        assert( rfc_ctx->rfm && rfc_ctx->rfm[idx] <= RFC_COUNTS_LIMIT );
+        rfc_ctx->rfm[idx] += rfc_ctx->curr_inc;
+        RFM_SAT_INVALIDATE( rfc_ctx, class_from );
+    }
+
+#if !RFC_MINIMAL
+    if( flags & RFC_FLAGS_COUNT_RP )
+    {
+        int idx = abs( (int)class_from - (int)class_to );
+
+        assert( rfc_ctx->rp && rfc_ctx->rp[idx] <= RFC_COUNTS_LIMIT );
+        rfc_ctx->rp[idx] += rfc_ctx->curr_inc;
     }
+#endif /*!RFC_MINIMAL*/
+
+    return true;
 }
-#endif /*RFC_ASTM_SUPPORT*/
 
 
+/* Flags evaluated by cycle_process_counts() */
+#if !RFC_MINIMAL
+#if RFC_DH_SUPPORT
+#define COUNTS_KERNEL_MASK  ( RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP | RFC_FLAGS_COUNT_LC | \
+                              RFC_FLAGS_COUNT_MK | RFC_FLAGS_ENFORCE_MARGIN | RFC_FLAGS_COUNT_DH )
+#else /*!RFC_DH_SUPPORT*/
+#define COUNTS_KERNEL_MASK  ( RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP | RFC_FLAGS_COUNT_LC | \
+                              RFC_FLAGS_COUNT_MK | RFC_FLAGS_ENFORCE_MARGIN )
+#endif /*RFC_DH_SUPPORT*/
+#else /*RFC_MINIMAL*/
+#define COUNTS_KERNEL_MASK  ( RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE )
+#endif /*!RFC_MINIMAL*/
+
+/* Kernel variant for a constant set of flags, falls back to the generic cycle_process_counts() on any other flags */
+#define COUNTS_KERNEL( name, kernel_flags )                                                                             \
+static                                                                                                                  \
+void name( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s *from, rfc_value_tuple_s *to, rfc_value_tuple_s *next, rfc_flags_e flags ) \
+{                                                                                                                       \
+    if( ( flags & COUNTS_KERNEL_MASK ) != (kernel_flags) || !cycle_process_counts_fast( rfc_ctx, from, to, (kernel_flags) ) ) \
+    {                                                                                                                   \
+        cycle_process_counts( rfc_ctx, from, to, next, flags );                                                         \
+    }                                                                                                                   \
+}
+
+COUNTS_KERNEL( cycle_process_counts_d,          RFC_FLAGS_COUNT_DAMAGE )
+COUNTS_KERNEL( cycle_process_counts_m,          RFC_FLAGS_COUNT_RFM )
+COUNTS_KERNEL( cycle_process_counts_md,         RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE )
 #if !RFC_MINIMAL
+COUNTS_KERNEL( cycle_process_counts_mr,         RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_RP )
+COUNTS_KERNEL( cycle_process_counts_mdr,        RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP )
+#if RFC_TP_SUPPORT
+COUNTS_KERNEL( cycle_process_counts_d_em,       RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_ENFORCE_MARGIN )
+COUNTS_KERNEL( cycle_process_counts_m_em,       RFC_FLAGS_COUNT_RFM | RFC_FLAGS_ENFORCE_MARGIN )
+COUNTS_KERNEL( cycle_process_counts_md_em,      RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_ENFORCE_MARGIN )
+COUNTS_KERNEL( cycle_process_counts_mr_em,      RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_RP | RFC_FLAGS_ENFORCE_MARGIN )
+COUNTS_KERNEL( cycle_process_counts_mdr_em,     RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP | RFC_FLAGS_ENFORCE_MARGIN )
+#endif /*RFC_TP_SUPPORT*/
+#endif /*!RFC_MINIMAL*/
+
+
 /**
- * @brief      Processes LC count (level crossing) for the last slope in residue
+ * @brief      Bind the counting kernel for closed cycles according to the
+ *             current flags. Level crossing is counted per turning point (see
+ *             feed_once()), so it doesn't matter here.
  *
  * @param      rfc_ctx  The rainflow context
- * @param      flags    Control flags
  */
 static
-void cycle_process_lc( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
+void counts_bind( rfc_ctx_s *rfc_ctx )
 {
-    size_t n = rfc_ctx->residue_cnt;
+    rfc_counts_fcn_t    fcn   = cycle_process_counts;
+    int                 flags;
 
-    if( n > 1 && (flags & RFC_FLAGS_COUNT_LC) )
+    assert( rfc_ctx );
+
+    flags = rfc_ctx->internal.flags & COUNTS_KERNEL_MASK;
+#if !RFC_MINIMAL
+    flags &= ~RFC_FLAGS_COUNT_LC;
+#endif /*!RFC_MINIMAL*/
+
+#if RFC_DEBUG_FLAGS
+    if( rfc_ctx->internal.debug_flags & RFC_FLAGS_LOG_CLOSED_CYCLES )
     {
-        /* Do the level crossing counting */
-        bool rising = rfc_ctx->residue[n-1].value > rfc_ctx->residue[n-2].value;
+        flags = -1;
+    }
+#endif /*RFC_DEBUG_FLAGS*/
 
-        if( rising )
-        {
-            cycle_process_counts( rfc_ctx, &rfc_ctx->residue[n-2], &rfc_ctx->residue[n-1], NULL, flags & (RFC_FLAGS_COUNT_LC_UP | RFC_FLAGS_ENFORCE_MARGIN) );
-        }
-        else
-        {
-            cycle_process_counts( rfc_ctx, &rfc_ctx->residue[n-2], &rfc_ctx->residue[n-1], NULL, flags & (RFC_FLAGS_COUNT_LC_DN | RFC_FLAGS_ENFORCE_MARGIN) );
-        }
+    /* Kernels don't check for storages, nor for additional Woehler curves */
+    if( ( ( flags & RFC_FLAGS_COUNT_RFM ) && !rfc_ctx->rfm ) 
+#if !RFC_MINIMAL
+     || ( ( flags & RFC_FLAGS_COUNT_RP  ) && !rfc_ctx->rp )
+     || ( ( flags & RFC_FLAGS_COUNT_DAMAGE ) && rfc_ctx->damage_multi_count )
+#endif /*!RFC_MINIMAL*/
+      )
+    {
+        flags = -1;
     }
-}
+
+    switch( flags )
+    {
+        case RFC_FLAGS_COUNT_DAMAGE:                                                                        fcn = cycle_process_counts_d;       break;
+        case RFC_FLAGS_COUNT_RFM:                                                                           fcn = cycle_process_counts_m;       break;
+        case RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE:                                                  fcn = cycle_process_counts_md;      break;
+#if !RFC_MINIMAL
+        case RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_RP:                                                      fcn = cycle_process_counts_mr;      break;
+        case RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP:                             fcn = cycle_process_counts_mdr;     break;
+#if RFC_TP_SUPPORT
+        case RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_ENFORCE_MARGIN:                                             fcn = cycle_process_counts_d_em;    break;
+        case RFC_FLAGS_COUNT_RFM | RFC_FLAGS_ENFORCE_MARGIN:                                                fcn = cycle_process_counts_m_em;    break;
+        case RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_ENFORCE_MARGIN:                       fcn = cycle_process_counts_md_em;   break;
+        case RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_RP | RFC_FLAGS_ENFORCE_MARGIN:                           fcn = cycle_process_counts_mr_em;   break;
+        case RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP | RFC_FLAGS_ENFORCE_MARGIN:  fcn = cycle_process_counts_mdr_em;  break;
+#endif /*RFC_TP_SUPPORT*/
 #endif /*!RFC_MINIMAL*/
+        default:                                                                                            break;
+    }
+
+    rfc_ctx->internal.counts_fcn = fcn;
+}
 
 
 /**
@@ -5953,11 +11084,54 @@ void cycle_process_lc( rfc_ctx_s *rfc_ctx, rfc_flags_e flags )
 static
 void cycle_process_counts( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s *from, rfc_value_tuple_s *to, rfc_value_tuple_s *next, rfc_flags_e flags )
 {
-    unsigned class_from, class_to;
+    cycle_process_counts_weighted( rfc_ctx, from, to, next, flags, 1 );
+}
+
+
+/**
+ * @brief         Processes counts on a number of identical closing cycles at
+ *                once. Each cycle is weighted by .curr_inc, as in
+ *                cycle_process_counts().
+ *
+ * @param         rfc_ctx  The rainflow context
+ * @param[in,out] from     The starting data point
+ * @param[in,out] to       The ending data point
+ * @param[in,out] next     The point next after "to"
+ * @param         flags    Control flags
+ * @param         cycles   The number of cycles
+ */
+static
+void cycle_process_counts_weighted( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s *from, rfc_value_tuple_s *to, rfc_value_tuple_s *next, rfc_flags_e flags, rfc_counts_t cycles )
+{
+    unsigned     class_from, class_to;
+    rfc_counts_t curr_inc;
 
     assert( rfc_ctx );
     assert( rfc_ctx->state >= RFC_STATE_INIT && rfc_ctx->state < RFC_STATE_FINISHED );
 
+    if( !cycles )
+    {
+        return;
+    }
+
+#if !RFC_MINIMAL
+#if RFC_DH_SUPPORT
+    if( cycles > 1 && ( flags & ( RFC_FLAGS_COUNT_MK | RFC_FLAGS_COUNT_DH ) ) )
+#else /*!RFC_DH_SUPPORT*/
+    if( cycles > 1 && ( flags & RFC_FLAGS_COUNT_MK ) )
+#endif /*RFC_DH_SUPPORT*/
+    {
+        /* Miner's consequent rule and damage history change with each single cycle */
+        for( ; cycles > 0; cycles -= 1 )
+        {
+            cycle_process_counts_weighted( rfc_ctx, from, to, next, flags, 1 );
+        }
+        return;
+    }
+#endif /*!RFC_MINIMAL*/
+
+    curr_inc = rfc_ctx->curr_inc * cycles;
+
     if( !rfc_ctx->class_count || ( from->value >= rfc_ctx->class_offset && to->value >= rfc_ctx->class_offset ) )
     {
         /* If class_count is zero, no counting is done. Otherwise values must be greater than class_offset */
@@ -6060,74 +11234,19 @@ void cycle_process_counts( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s *from, rfc_valu
             }
 
             /* Adding damage for the current cycle, with its actual weight */
-            rfc_ctx->damage += D_i * rfc_ctx->curr_inc / rfc_ctx->full_inc;
+            rfc_ctx->damage += D_i * curr_inc / rfc_ctx->full_inc;
 #if !RFC_MINIMAL
+            if( rfc_ctx->damage_multi_count )
+            {
+                damage_multi_add( rfc_ctx, class_from, class_to, (double)curr_inc / rfc_ctx->full_inc );
+            }
+
             /* Fatigue strength Sd(D) depresses in subject to cumulative damage D.
                Sd(D)/Sd = (1-D)^(1/q), [6] chapter 3.2.9, formula 3.2-44 and 3.2-46
                Only cycles exceeding Sd(D) have damaging effect. */
             if( Sa_i >= rfc_ctx->internal.wl.sd && ( flags & RFC_FLAGS_COUNT_MK ) )
             {
-                rfc_wl_param_s  wl_unimp;                          /* WL parameters unimpaired part */
-                rfc_wl_param_s *wl_imp = &rfc_ctx->internal.wl;    /* WL parameters impaired part */
-                double          D_con;                             /* Current damage, Miners' consequent rule */
-
-                /* Backup Woehler curve parameters and use shadowed ones for the impaired part instead */
-                RFC_wl_param_get( rfc_ctx, &wl_unimp );
-                RFC_wl_param_set( rfc_ctx,  wl_imp );
-
-#if RFC_DAMAGE_FAST
-                if( rfc_ctx->damage_lut )
-                {
-                    /* Disable lut temporarily, since it is only valid for Woehler parameters for unimpaired part */
-                    rfc_ctx->damage_lut_inapt++;
-                    (void)damage_calc_amplitude( rfc_ctx, Sa_i, &D_con );
-                    rfc_ctx->damage_lut_inapt--;
-                }
-                else
-#endif /*RFC_DAMAGE_FAST*/
-                {
-                    (void)damage_calc_amplitude( rfc_ctx, Sa_i, &D_con );
-                }
-
-                D_con += wl_imp->D;
-
-                if( D_con < 1.0 )
-                {
-                    /* Calculate new parameters for the Woehler curve, impaired part */
-                    if( wl_unimp.sx > 0.0 )
-                    {
-                        double q       =       wl_imp->q;
-                        double k       = fabs( wl_imp->k );
-                        rfc_ctx->wl_sx = wl_unimp.sx * pow( 1.0 - D_con, 1.0 / q );
-                     /* rfc_ctx->wl_nx = wl.nx * pow( 1.0 - D_con, -( k - q ) / q );  // Damage accumulation is done in D_con! */
-
-                        (void)RFC_wl_calc_n( rfc_ctx, 
-                                             wl_unimp.sx, 
-                                             wl_unimp.nx, 
-                                             k,
-                                             rfc_ctx->wl_sx,
-                                            &rfc_ctx->wl_nx );
-                    }
-
-                    if( wl_unimp.sd > 0.0 )
-                    {
-                        double q2      =       wl_imp->q2;
-                        double k2      = fabs( wl_imp->k2 );
-                        rfc_ctx->wl_sd = wl_unimp.sd * pow( 1.0 - D_con, 1.0 / q2 );
-                     /* rfc_ctx->wl_nx = wl_unimp.nx * pow( 1.0 - D_con, -( k2 - q2 ) / q2 );  // Damage accumulation is done in D_con! */
-
-                        (void)RFC_wl_calc_n( rfc_ctx, 
-                                             wl_unimp.sd, 
-                                             wl_unimp.nd, 
-                                             k2,
-                                             rfc_ctx->wl_sd,
-                                            &rfc_ctx->wl_nd );
-                    }
-                }
-
-                RFC_wl_param_get( rfc_ctx, wl_imp );
-                rfc_ctx->internal.wl.D = D_con;
-                RFC_wl_param_set( rfc_ctx, &wl_unimp );
+                mk_count( rfc_ctx, Sa_i, D_i );
             }
 #endif /*!RFC_MINIMAL*/
         }
@@ -6147,9 +11266,25 @@ void cycle_process_counts( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s *from, rfc_valu
              */
             size_t idx = rfc_ctx->class_count * class_from + class_to;
             
-            assert( rfc_ctx->rfm[idx] <= RFC_COUNTS_LIMIT );
-            rfc_ctx->rfm[idx] += rfc_ctx->curr_inc;
+            assert( rfc_ctx->rfm[idx] <= RFC_COUNTS_LIMIT - curr_inc );
+            rfc_ctx->rfm[idx] += curr_inc;
+            RFM_SAT_INVALIDATE( rfc_ctx, class_from );
+        }
+#if !RFC_MINIMAL
+        else if( rfc_ctx->rfm_sparse && ( flags & RFC_FLAGS_COUNT_RFM ) )
+        {
+            rfc_counts_t *counts = rfm_sparse_find( rfc_ctx, class_from, class_to, /*create*/ true );
+
+            if( !counts )
+            {
+                error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+                return;
+            }
+
+            assert( *counts <= RFC_COUNTS_LIMIT - curr_inc );
+            *counts += curr_inc;
         }
+#endif /*!RFC_MINIMAL*/
 
 #if !RFC_MINIMAL
         /* Range pair */
@@ -6161,8 +11296,8 @@ void cycle_process_counts( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s *from, rfc_valu
              */
             int idx = abs( (int)class_from - (int)class_to );
             
-            assert( rfc_ctx->rp[idx] <= RFC_COUNTS_LIMIT );
-            rfc_ctx->rp[idx] += rfc_ctx->curr_inc;
+            assert( rfc_ctx->rp[idx] <= RFC_COUNTS_LIMIT - curr_inc );
+            rfc_ctx->rp[idx] += curr_inc;
         }
 
         /* Level crossing, count rising and falling slopes */
@@ -6173,25 +11308,21 @@ void cycle_process_counts( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s *from, rfc_valu
              * Counts class upper bound crossings
              * Class upper bound value = (idx+1) * class_width + class_offset
              */
-            unsigned idx;
-            unsigned idx_from = ( class_from < class_to ) ? class_from : class_to;
-            unsigned idx_to   = ( class_from > class_to ) ? class_from : class_to;
+            unsigned     idx_from = ( class_from < class_to ) ? class_from : class_to;
+            unsigned     idx_to   = ( class_from > class_to ) ? class_from : class_to;
+            rfc_counts_t inc      = 0;
 
-            for( idx = idx_from; idx < idx_to; idx++ )
-            {
-                if( flags & RFC_FLAGS_COUNT_LC_UP )
-                {
-                    /* Count rising slopes */
-                    assert( rfc_ctx->lc[idx] <= RFC_COUNTS_LIMIT );
-                    rfc_ctx->lc[idx] += rfc_ctx->full_inc;
-                }
+            /* Count rising slopes */
+            if( flags & RFC_FLAGS_COUNT_LC_UP ) inc += rfc_ctx->full_inc * cycles;
+            /* Count falling slopes */
+            if( flags & RFC_FLAGS_COUNT_LC_DN ) inc += rfc_ctx->full_inc * cycles;
 
-                if( flags & RFC_FLAGS_COUNT_LC_DN )
-                {
-                    /* Count falling slopes */
-                    assert( rfc_ctx->lc[idx] <= RFC_COUNTS_LIMIT );
-                    rfc_ctx->lc[idx] += rfc_ctx->full_inc;
-                }
+            if( inc && idx_from < idx_to )
+            {
+                /* Classes idx_from..idx_to-1 are crossed, lc_flush() adds them to .lc */
+                rfc_ctx->internal.lc_diff[idx_from] += inc;
+                rfc_ctx->internal.lc_diff[idx_to]   -= inc;
+                rfc_ctx->internal.lc_dirty           = true;
             }
         }
 
@@ -6318,8 +11449,22 @@ bool tp_set( rfc_ctx_s *rfc_ctx, size_t tp_pos, rfc_value_tuple_s *tp )
             /* Reallocation */
             tp_cap_increment = (size_t)1024 * ( rfc_ctx->tp_cap / 640 + 1 );  /* + 60% + 1024 */
             tp_cap_new       = rfc_ctx->tp_cap + tp_cap_increment;
-            tp_new           = rfc_ctx->mem_alloc( rfc_ctx->tp, tp_cap_new, 
-                                                   sizeof(rfc_value_tuple_s), RFC_MEM_AIM_TP );
+
+            if( rfc_ctx->internal.tp_map )
+            {
+                /* File backed storage grows without copying */
+                if( !map_resize( rfc_ctx->internal.tp_map, tp_cap_new * sizeof(rfc_value_tuple_s) ) )
+                {
+                    return error_raise( rfc_ctx, RFC_ERROR_MEMORY );
+                }
+                tp_new     = (rfc_value_tuple_s*)rfc_ctx->internal.tp_map->ptr;
+                tp_cap_new = rfc_ctx->internal.tp_map->bytes / sizeof(rfc_value_tuple_s);
+            }
+            else
+            {
+                tp_new = rfc_ctx->mem_alloc( rfc_ctx->tp, tp_cap_new, 
+                                             sizeof(rfc_value_tuple_s), RFC_MEM_AIM_TP );
+            }
 
             if( tp_new )
             {
@@ -6894,8 +12039,9 @@ bool spread_damage( rfc_ctx_s *rfc_ctx, rfc_value_tuple_s *from,
 
                 if( pos > rfc_ctx->internal.pos )
                 {
-                    pos -= rfc_ctx->internal.pos;
-                    dh  -= rfc_ctx->internal.pos;
+                    pos        -= rfc_ctx->internal.pos;
+                    dh         -= rfc_ctx->internal.pos;
+                    dh_istream -= rfc_ctx->internal.pos;
                 }
 
                 if( pos > rfc_ctx->dh_cap )
@@ -7176,6 +12322,72 @@ rfc_value_t value_delta( rfc_ctx_s* rfc_ctx, const rfc_value_tuple_s* pt_from, c
 }
 
 
+/**
+ * @brief      Quantize a block of data samples (assign class numbers) and
+ *             check their range. Uses the precomputed reciprocal class width,
+ *             results close to a class border are recalculated by division.
+ *             Class numbers are identical to QUANTIZE() that way.
+ *
+ * @param      rfc_ctx  The rainflow context
+ * @param[in]  data     The data
+ * @param      count    The data count
+ * @param[out] cls      The class numbers (count elements)
+ *
+ * @return     Index of the first sample out of range, or count if all are in range
+ */
+static
+size_t quantize_block( rfc_ctx_s *rfc_ctx, const rfc_value_t *data, size_t count, unsigned *cls )
+{
+    const
+    rfc_value_t     class_offset    = rfc_ctx->class_offset;
+    const
+    double          class_rcp       = rfc_ctx->internal.class_rcp,
+                    class_upper     = rfc_ctx->class_count;
+    size_t          i, first        = count;
+
+    assert( rfc_ctx );
+    assert( ( data && cls ) || !count );
+
+    if( !rfc_ctx->class_count )
+    {
+        for( i = 0; i < count; i++ )
+        {
+            cls[i] = 0;
+        }
+
+        return count;
+    }
+
+    /* Multiply by reciprocal, mark samples out of range or near class borders (branch free) */
+    for( i = 0; i < count; i++ )
+    {
+        double      x   = (double)( data[i] - class_offset ) * class_rcp;
+        double      xc  = ( x >= 0.0 && x < class_upper ) ? x : 0.0;
+        unsigned    q   = (unsigned)xc;
+        double      f   = xc - q;
+        double      eps = ( xc + 1.0 ) * QUANTIZE_EPS;
+
+        cls[i] = ( x == xc && f > eps && f < 1.0 - eps ) ? q : UINT_MAX;
+    }
+
+    /* Marked samples are quantized by division */
+    for( i = 0; i < count; i++ )
+    {
+        if( cls[i] == UINT_MAX )
+        {
+            cls[i] = QUANTIZE( rfc_ctx, data[i] );
+
+            if( first == count && ( cls[i] >= rfc_ctx->class_count || data[i] < class_offset ) )
+            {
+                first = i;
+            }
+        }
+    }
+
+    return first;
+}
+
+
 /**
  * @brief      (Re-)Allocate or free memory
  *
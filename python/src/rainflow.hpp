@@ -149,6 +149,7 @@ public:
         RFC_FLAGS_TPPRUNE_PRESERVE_RES          = RF::RFC_FLAGS_TPPRUNE_PRESERVE_RES,           /**< Preserve turning points that exist in resiude on pruning */
         RFC_FLAGS_TPAUTOPRUNE                   = RF::RFC_FLAGS_TPAUTOPRUNE,                    /**< Automatic prune on tp */
         RFC_FLAGS_AUTORESIZE                    = RF::RFC_FLAGS_AUTORESIZE,                     /**< Automatically resize buffers for rp, lc, and rfm */
+        RFC_FLAGS_SPARSE_RFM                    = RF::RFC_FLAGS_SPARSE_RFM,                     /**< Count rainflow matrix into sparse storage */
     };
 
 
@@ -292,8 +293,14 @@ public:
     bool            deinit                  ();
     bool            feed                    ( const rfc_value_t* data, size_t count );
     bool            cycle_process_counts    ( rfc_value_t from_val, rfc_value_t to_val, rfc_flags_e flags );
+    bool            cycle_process_counts    ( rfc_value_t from_val, rfc_value_t to_val, rfc_flags_e flags, rfc_counts_t cycles );
     bool            feed_scaled             ( const rfc_value_t* data, size_t count, double factor );
+    bool            feed                    ( const float* data, size_t count, double scale, double offset = 0.0 );
+    bool            feed                    ( const int16_t* data, size_t count, double scale, double offset = 0.0 );
+    bool            feed                    ( const int32_t* data, size_t count, double scale, double offset = 0.0 );
+    bool            feed_strided            ( const rfc_value_t* data, size_t count, size_t stride );
     bool            feed_tuple              ( rfc_value_tuple_s *data, size_t count );
+    bool            merge                   ( const RainflowT& src );
     bool            finalize                ( rfc_res_method_e residual_method = RFC_RES_IGNORE );
     /* Functions on rainflow matrix */           
     bool            rfm_make_symmetric      ();
@@ -316,6 +323,8 @@ public:
     bool            damage                  ( rfc_value_t *damage = NULL, rfc_value_t *damage_residue = NULL ) const;
     bool            damage_from_rp          ( double *damage, const rfc_counts_t *counts, const rfc_value_t *Sa, rfc_rp_damage_method_e rp_calc_type ) const;
     bool            damage_from_rfm         ( double *damage, const rfc_counts_t *rfm ) const;
+    bool            damage_multi_init       ( const rfc_wl_param_s *wl_param, unsigned count );
+    bool            damage_multi_get        ( double *damage, unsigned count ) const;
     /* Woehler curve */
     bool            wl_calc_sx              ( double s0, double n0, double k, double *sx, double nx, double  k2, double  sd, double nd ) const;
     bool            wl_calc_sd              ( double s0, double n0, double k, double  sx, double nx, double  k2, double *sd, double nd ) const;
@@ -355,6 +364,8 @@ public:
     /* more C++ specific extensions */
     bool            feed                    ( const std::vector<rfc_value_t> data );
     bool            feed_scaled             ( const std::vector<rfc_value_t> data, double factor );
+    template< typename S >
+    bool            feed                    ( const std::vector<S> &data, double scale, double offset = 0.0 );
     bool            rfm_get                 ( rfc_rfm_item_v &buffer ) const;
     bool            rfm_set                 ( const rfc_rfm_item_v &buffer, bool add_only );
     bool            lc_get                  ( rfc_counts_v &lc, rfc_value_v &level ) const;
@@ -537,6 +548,13 @@ bool RainflowT<T>::cycle_process_counts( rfc_value_t from_val, rfc_value_t to_va
 }
 
 
+template< class T >
+bool RainflowT<T>::cycle_process_counts( rfc_value_t from_val, rfc_value_t to_val, rfc_flags_e flags, rfc_counts_t cycles )
+{
+    return RF::RFC_cycle_process_counts_weighted( &m_ctx, (RF::rfc_value_t)from_val, (RF::rfc_value_t)to_val, (RF::rfc_flags_e)flags, cycles );
+}
+
+
 template< class T >
 bool RainflowT<T>::feed_scaled( const rfc_value_t* data, size_t count, double factor )
 {
@@ -544,6 +562,34 @@ bool RainflowT<T>::feed_scaled( const rfc_value_t* data, size_t count, double fa
 }
 
 
+template< class T >
+bool RainflowT<T>::feed( const float* data, size_t count, double scale, double offset )
+{
+    return RF::RFC_feed_f32( &m_ctx, data, count, scale, offset );
+}
+
+
+template< class T >
+bool RainflowT<T>::feed( const int16_t* data, size_t count, double scale, double offset )
+{
+    return RF::RFC_feed_i16( &m_ctx, data, count, scale, offset );
+}
+
+
+template< class T >
+bool RainflowT<T>::feed( const int32_t* data, size_t count, double scale, double offset )
+{
+    return RF::RFC_feed_i32( &m_ctx, data, count, scale, offset );
+}
+
+
+template< class T >
+bool RainflowT<T>::feed_strided( const rfc_value_t* data, size_t count, size_t stride )
+{
+    return RF::RFC_feed_strided( &m_ctx, (const RF::rfc_value_t*)data, count, stride );
+}
+
+
 template< class T >
 bool RainflowT<T>::feed_tuple( rfc_value_tuple_s *data, size_t count )
 {
@@ -551,6 +597,13 @@ bool RainflowT<T>::feed_tuple( rfc_value_tuple_s *data, size_t count )
 }
 
 
+template< class T >
+bool RainflowT<T>::merge( const RainflowT& src )
+{
+    return RF::RFC_merge( &m_ctx, &src.m_ctx );
+}
+
+
 template< class T >
 bool RainflowT<T>::finalize( rfc_res_method_e residual_method )
 {
@@ -690,6 +743,20 @@ bool RainflowT<T>::damage_from_rfm( double *damage, const rfc_counts_t *rfm ) co
 }
 
 
+template< class T >
+bool RainflowT<T>::damage_multi_init( const rfc_wl_param_s *wl_param, unsigned count )
+{
+    return RF::RFC_damage_multi_init( &m_ctx, (const RF::rfc_wl_param_s*) wl_param, count );
+}
+
+
+template< class T >
+bool RainflowT<T>::damage_multi_get( double *damage, unsigned count ) const
+{
+    return RF::RFC_damage_multi_get( &m_ctx, damage, count );
+}
+
+
 template< class T >
 bool RainflowT<T>::wl_calc_sx( double s0, double n0, double k, double *sx, double nx, double  k2, double  sd, double nd ) const
 {
@@ -886,6 +953,14 @@ bool RainflowT<T>::feed_scaled( const std::vector<rfc_value_t> data, double fact
 }
 
 
+template< class T >
+template< typename S >
+bool RainflowT<T>::feed( const std::vector<S> &data, double scale, double offset )
+{
+    return feed( &data[0], data.size(), scale, offset );
+}
+
+
 template< class T >
 bool RainflowT<T>::rfm_get( rfc_rfm_item_v &buffer ) const
 {
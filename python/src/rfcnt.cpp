@@ -8,6 +8,13 @@
 
 typedef std::vector<Rainflow::rfc_value_tuple_s> rfc_residuum_vec;
 
+// NumPy type matching Rainflow::rfc_counts_t
+#if RFC_USE_INTEGRAL_COUNTS
+#define RFC_NPY_COUNTS NPY_ULONGLONG
+#else /*!RFC_USE_INTEGRAL_COUNTS*/
+#define RFC_NPY_COUNTS NPY_DOUBLE
+#endif /*RFC_USE_INTEGRAL_COUNTS*/
+
 
 
 // Convert RFC error numbers to strings
@@ -288,16 +295,16 @@ int parse_rfc_input_series( PyObject* input_series_arg, PyArrayObject **arr_data
 }
 
 
-// Process rainflow counting
+// Process rainflow counting (no Python API calls allowed here, the GIL is released)
 static
-int do_rainflow( Rainflow *rf, npy_double *data, Py_ssize_t len, Rainflow::rfc_res_method res_method, rfc_residuum_vec &residuum_raw )
+bool do_rainflow_nogil( Rainflow *rf, npy_double *data, Py_ssize_t len, Rainflow::rfc_res_method res_method, rfc_residuum_vec &residuum_raw )
 {
     const Rainflow::rfc_value_tuple_s *residuum;
     unsigned residuum_len;
 
-    if( !rf->feed( data, len ) ) goto fail;
+    if( !rf->feed( data, len ) ) return false;
 
-    if( !rf->res_get( &residuum, &residuum_len ) ) goto fail;
+    if( !rf->res_get( &residuum, &residuum_len ) ) return false;
 
     residuum_raw = rfc_residuum_vec( residuum, residuum + residuum_len );
 
@@ -333,12 +340,28 @@ int do_rainflow( Rainflow *rf, npy_double *data, Py_ssize_t len, Rainflow::rfc_r
         }
     }
 
-    if( !rf->finalize( res_method ) ) goto fail;
+    return rf->finalize( res_method );
+}
+
+
+// Process rainflow counting
+static
+int do_rainflow( Rainflow *rf, npy_double *data, Py_ssize_t len, Rainflow::rfc_res_method res_method, rfc_residuum_vec &residuum_raw )
+{
+    bool ok;
+
+    // Counting touches no Python objects, let other Python threads run meanwhile
+    Py_BEGIN_ALLOW_THREADS
+    ok = do_rainflow_nogil( rf, data, len, res_method, residuum_raw );
+    Py_END_ALLOW_THREADS
+
+    if( !ok )
+    {
+        PyErr_Format( PyExc_RuntimeError, "Error while counting (%s)", rfc_err_str( rf->error_get() ) );
+        return 0;
+    }
 
     return 1;
-fail:
-    PyErr_Format( PyExc_RuntimeError, "Error while counting (%s)", rfc_err_str( rf->error_get() ) );
-    return 0;
 }
 
 
@@ -549,9 +572,248 @@ static PyObject* rfc( PyObject *self, PyObject *args, PyObject *kwargs )
 }
 
 
+// Parse input data for batch counting: Sequence of 1D arrays or 2D array (one series per column)
+static
+int parse_rfc_batch_input( PyObject* input_series_arg, std::vector<PyArrayObject*> &arrays, 
+                           std::vector<const npy_double*> &series, std::vector<size_t> &series_len )
+{
+    PyObject *arg1;
+
+    if( !PyArg_ParseTuple( input_series_arg, "O", &arg1 ) )
+    {
+        return 0;
+    }
+
+    if( PyArray_Check( arg1 ) )
+    {
+        // Columns contiguous
+        PyArrayObject *arr = (PyArrayObject*)PyArray_FROM_OTF( arg1, NPY_DOUBLE, NPY_ARRAY_FARRAY_RO );
+        if( !arr ) return 0;
+        arrays.push_back( arr );
+
+        if( PyArray_NDIM( arr ) != 2 )
+        {
+            PyErr_SetString( PyExc_RuntimeError, "Data must have two dimensions (one series per column)!" );
+            return 0;
+        }
+
+        npy_intp rows = PyArray_DIM( arr, 0 );
+        npy_intp cols = PyArray_DIM( arr, 1 );
+
+        for( npy_intp i = 0; i < cols; i++ )
+        {
+            series.push_back( (const npy_double*)PyArray_DATA( arr ) + i * rows );
+            series_len.push_back( (size_t)rows );
+        }
+    }
+    else if( PySequence_Check( arg1 ) )
+    {
+        Py_ssize_t count = PySequence_Size( arg1 );
+        if( count < 0 ) return 0;
+
+        for( Py_ssize_t i = 0; i < count; i++ )
+        {
+            PyObject *item = PySequence_GetItem( arg1, i );
+            if( !item ) return 0;
+
+            PyArrayObject *arr = (PyArrayObject*)PyArray_FROM_OTF( item, NPY_DOUBLE, NPY_ARRAY_IN_ARRAY );
+            Py_DECREF( item );
+            if( !arr ) return 0;
+            arrays.push_back( arr );
+
+            if( PyArray_NDIM( arr ) != 1 )
+            {
+                PyErr_SetString( PyExc_RuntimeError, "Each series must have only one dimension!" );
+                return 0;
+            }
+
+            series.push_back( (const npy_double*)PyArray_DATA( arr ) );
+            series_len.push_back( (size_t)PyArray_DIM( arr, 0 ) );
+        }
+    }
+    else
+    {
+        PyErr_SetString( PyExc_RuntimeError, "Data must be a 2D array or a sequence of 1D arrays!" );
+        return 0;
+    }
+
+    return 1;
+}
+
+
+static PyObject* rfc_batch( PyObject *self, PyObject *args, PyObject *kwargs )
+{
+    std::vector<PyArrayObject*> arrays;
+    std::vector<const npy_double*> series;
+    std::vector<size_t> series_len;
+    PyObject *kw = NULL, *ret = NULL, *item;
+    PyArrayObject *arr, *damage = NULL, *rfm = NULL, *rp = NULL;
+    Rainflow rf;
+    Rainflow::rfc_res_method res_method;
+    Rainflow::rfc_counts_v ct;
+    Rainflow::rfc_value_v sa;
+    unsigned class_count = 0;
+    long n_threads = 0;
+    int do_rfm = 1;
+    npy_intp len[3];
+    size_t n = 0;
+    bool ok = false;
+
+    do
+    {
+        if( !parse_rfc_batch_input( args, arrays, series, series_len ) )
+        {
+            break;
+        }
+        n = series.size();
+
+        // Take n_threads from keywords, the rest is parsed as in rfc()
+        kw = kwargs ? PyDict_Copy( kwargs ) : PyDict_New();
+        if( !kw ) break;
+
+        item = PyDict_GetItemString( kw, "n_threads" );
+        if( item )
+        {
+            n_threads = PyLong_AsLong( item );
+            if( n_threads == -1 && PyErr_Occurred() ) break;
+            if( n_threads < 0 )
+            {
+                PyErr_SetString( PyExc_RuntimeError, "Parameter 'n_threads' must not be negative!" );
+                break;
+            }
+            PyDict_DelItemString( kw, "n_threads" );
+        }
+
+        // Rainflow matrices may be omitted, they need n * class_count^2 values
+        item = PyDict_GetItemString( kw, "rfm" );
+        if( item )
+        {
+            do_rfm = PyObject_IsTrue( item );
+            if( do_rfm == -1 ) break;
+            PyDict_DelItemString( kw, "rfm" );
+        }
+
+        // No damage history in batch mode
+        item = PyDict_GetItemString( kw, "spread_damage" );
+        if( item && PyLong_AsLong( item ) != (long)Rainflow::RFC_SD_NONE )
+        {
+            if( !PyErr_Occurred() )
+            {
+                PyErr_SetString( PyExc_RuntimeError, "Parameter 'spread_damage' is not supported in batch mode!" );
+            }
+            break;
+        }
+        item = PyLong_FromLong( (long)Rainflow::RFC_SD_NONE );
+        if( !item ) break;
+        PyDict_SetItemString( kw, "spread_damage", item );
+        Py_DECREF( item );
+
+        if( !parse_rfc_kwargs( kw, 0, &rf, &res_method ) )
+        {
+            break;
+        }
+
+        // Class ranges
+        if( !rf.class_count( &class_count ) || !rf.rp_get( ct, sa ) )
+        {
+            PyErr_Format( PyExc_RuntimeError, "Rainflow initialization error (%s)", rfc_err_str( rf.error_get() ) );
+            break;
+        }
+
+        // Output arrays are allocated first, the series are counted right into them
+        len[0] = (npy_intp)n;
+        len[1] = class_count;
+        len[2] = class_count;
+        damage = (PyArrayObject*)PyArray_SimpleNew( 1, len, NPY_DOUBLE );
+        rp     = (PyArrayObject*)PyArray_SimpleNew( 2, len, RFC_NPY_COUNTS );
+        rfm    = do_rfm ? (PyArrayObject*)PyArray_SimpleNew( 3, len, RFC_NPY_COUNTS ) : NULL;
+        if( !damage || !rp || ( do_rfm && !rfm ) ) break;
+
+        // Count all series in native threads, the input arrays are held by `arrays`
+        Py_BEGIN_ALLOW_THREADS
+        ok = RF::RFC_batch( &rf.ctx_get(), n, n ? &series[0] : NULL, n ? &series_len[0] : NULL, (RF::rfc_res_method_e)res_method, 
+                            (unsigned)n_threads, n ? (double*)PyArray_DATA( damage ) : NULL, 
+                            ( n && rfm ) ? (Rainflow::rfc_counts_t*)PyArray_DATA( rfm ) : NULL, 
+                            n ? (Rainflow::rfc_counts_t*)PyArray_DATA( rp ) : NULL );
+        Py_END_ALLOW_THREADS
+
+        if( !ok )
+        {
+            PyErr_Format( PyExc_RuntimeError, "Error while counting (%s)", rfc_err_str( rf.error_get() ) );
+            break;
+        }
+        ok = false;
+
+#if RFC_USE_INTEGRAL_COUNTS
+        // Integral counts are scaled to full cycles as in rfc()
+        arr = rp;
+        rp = (PyArrayObject*)PyArray_Cast( arr, NPY_DOUBLE );
+        Py_DECREF( arr );
+        if( !rp ) break;
+        if( rfm )
+        {
+            arr = rfm;
+            rfm = (PyArrayObject*)PyArray_Cast( arr, NPY_DOUBLE );
+            Py_DECREF( arr );
+            if( !rfm ) break;
+            for( npy_intp i = 0; i < PyArray_SIZE( rfm ); i++ )
+            {
+                ((double*)PyArray_DATA( rfm ))[i] /= RFC_FULL_CYCLE_INCREMENT;
+            }
+        }
+#endif /*RFC_USE_INTEGRAL_COUNTS*/
+
+        // Create dict (return value)
+        ret = PyDict_New();
+        if( !ret ) break;
+
+        // Range pair counts, ranges (2 * amplitude) are the same for all series
+        len[0] = class_count;
+        arr = (PyArrayObject*)PyArray_SimpleNew( 1, len, NPY_DOUBLE );
+        if( !arr ) break;
+        for( unsigned j = 0; j < class_count; j++ )
+        {
+            *(double*)PyArray_GETPTR1( arr, j ) = (double)sa[j] * 2;
+        }
+        PyDict_SetItemString( ret, "rp_range", (PyObject*)arr );
+        Py_DECREF( arr );
+
+        PyDict_SetItemString( ret, "damage", (PyObject*)damage );
+        PyDict_SetItemString( ret, "rp", (PyObject*)rp );
+        if( rfm )
+        {
+            PyDict_SetItemString( ret, "rfm", (PyObject*)rfm );
+        }
+
+        ok = true;
+    }
+    while(0);
+
+    if( !ok && ret )
+    {
+        Py_DECREF( ret );
+        ret = NULL;
+    }
+
+    rf.deinit();
+
+    Py_XDECREF( damage );
+    Py_XDECREF( rfm );
+    Py_XDECREF( rp );
+    Py_XDECREF( kw );
+    for( size_t i = 0; i < arrays.size(); i++ )
+    {
+        Py_DECREF( arrays[i] );
+    }
+
+    return ret;
+}
+
+
 // Exported methods are collected in a table
 PyMethodDef method_table[] = {
     {"rfc", (PyCFunction) rfc, METH_VARARGS | METH_KEYWORDS, "Rainflow counting"},
+    {"rfc_batch", (PyCFunction) rfc_batch, METH_VARARGS | METH_KEYWORDS, "Rainflow counting of many series (native threads)"},
     {NULL, NULL, 0, NULL} // Sentinel value ending the table
 };
 
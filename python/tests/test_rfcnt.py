@@ -3,7 +3,7 @@ import unittest
 
 import numpy as np
 
-from .. import rfc, ResidualMethod, SDMethod
+from .. import rfc, rfc_batch, ResidualMethod, SDMethod
 
 
 class TestRainflowCounting(unittest.TestCase):
@@ -145,6 +145,46 @@ class TestRainflowCounting(unittest.TestCase):
 
         self.assertTrue((res["res"].flatten() == [2, 6, 1, 5, 2]).all())
 
+    def test_batch(self):
+        class_count       =  20  # noqa E221
+        rng               =  np.random.default_rng(1)  # noqa E221
+        x                 =  rng.uniform(-1, 1, (500, 7)).cumsum(axis=0)  # noqa E221
+        class_width, \
+         class_offset     =  self.class_param(x.flatten(), class_count)  # noqa E221
+        hysteresis        =  class_width  # noqa E221
+        residual_method   =  ResidualMethod.REPEATED  # noqa E221
+        params            =  dict(class_count=class_count,  # noqa E221
+                                  class_width=class_width,
+                                  class_offset=class_offset,
+                                  hysteresis=hysteresis,
+                                  residual_method=residual_method,
+                                  spread_damage=SDMethod.NONE)
+
+        # One series per column, or a list of (differently sized) series
+        res_2d   = rfc_batch(x, n_threads=3, **params)  # noqa E221
+        res_list = rfc_batch([x[:, i] for i in range(x.shape[1])], **params)  # noqa E221
+
+        self.assertEqual(res_2d["damage"].shape, (x.shape[1],))
+        self.assertEqual(res_2d["rfm"].shape, (x.shape[1], class_count, class_count))
+        self.assertEqual(res_2d["rp"].shape, (x.shape[1], class_count))
+        self.assertEqual(res_2d["rp_range"].shape, (class_count,))
+
+        # Rainflow matrices are optional
+        res_no_rfm = rfc_batch(x, rfm=False, **params)  # noqa E221
+        self.assertNotIn("rfm", res_no_rfm)
+
+        for i in range(x.shape[1]):
+            res = rfc(x[:, i], **params)
+            for batch in (res_2d, res_list, res_no_rfm):
+                self.assertEqual(batch["damage"][i], res["damage"])
+                self.assertTrue((batch["rp_range"] == res["rp"][:, 0]).all())
+                self.assertTrue((batch["rp"][i] == res["rp"][:, 1]).all())
+            for batch in (res_2d, res_list):
+                self.assertTrue((batch["rfm"][i] == res["rfm"]).all())
+
+        with self.assertRaises(RuntimeError):
+            rfc_batch(x, spread_damage=SDMethod.TRANSIENT_23c, **{k: v for k, v in params.items() if k != "spread_damage"})
+
     def test_long_series(self):
         try:
             import pandas as pd
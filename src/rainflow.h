@@ -116,7 +116,10 @@
 #define OFF (0)
 #endif /*OFF*/
 
-#define RFC_CLASS_COUNT_MAX (1024)
+#ifndef RFC_CLASS_COUNT_MAX
+#define RFC_CLASS_COUNT_MAX (65536)         /* Sparse rainflow matrix and paged damage look-up table beyond RFC_CLASS_COUNT_DENSE_MAX */
+#endif /*RFC_CLASS_COUNT_MAX*/
+#define RFC_CLASS_COUNT_DENSE_MAX (1024)    /* Maximum class count for a dense rainflow matrix */
 
 #ifndef RFC_VALUE_TYPE
 #define RFC_VALUE_TYPE double
@@ -153,6 +156,8 @@
 #define RFC_GLOBAL_EXTREMA   OFF
 #undef  RFC_DAMAGE_FAST
 #define RFC_DAMAGE_FAST      OFF
+#undef  RFC_USE_THREADS
+#define RFC_USE_THREADS      OFF
 #else /*!RFC_MINIMAL*/
 #ifndef RFC_MINIMAL
 #define RFC_MINIMAL OFF
@@ -184,6 +189,9 @@
 #ifndef RFC_DAMAGE_FAST
 #define RFC_DAMAGE_FAST ON
 #endif /*RFC_DAMAGE_FAST*/
+#ifndef RFC_USE_THREADS
+#define RFC_USE_THREADS OFF
+#endif /*RFC_USE_THREADS*/
 #ifndef RFC_DEBUG_FLAGS
 #define RFC_DEBUG_FLAGS OFF
 #endif /*RFC_DEBUG_FLAGS*/
@@ -246,6 +254,10 @@ enum rfc_mem_aim
 #endif
 #if !RFC_MINIMAL
     RFC_MEM_AIM_RFM_ELEMENTS        = 10,                           /**< Error on accessing memory for rf matrix elements */
+    RFC_MEM_AIM_BANK                = 11,                           /**< Error on accessing memory for multi-channel bank */
+    RFC_MEM_AIM_SNAPSHOT            = 12,                           /**< Error on accessing memory for snapshot sequence counter */
+    RFC_MEM_AIM_RFM_SAT             = 13,                           /**< Error on accessing memory for summed-area tables of rf matrix */
+    RFC_MEM_AIM_DAMAGE_MULTI        = 14,                           /**< Error on accessing memory for multi-curve damage */
 #endif /*!RFC_MINIMAL*/
 };
 
@@ -286,6 +298,9 @@ enum rfc_flags
 #if RFC_AR_SUPPORT
     RFC_FLAGS_AUTORESIZE            =  1 << 11,                     /**< Automatically resize buffers for rp, lc, and rfm */
 #endif /*RFC_AR_SUPPORT*/
+#if !RFC_MINIMAL
+    RFC_FLAGS_SPARSE_RFM            =  1 << 12,                     /**< Count rainflow matrix into sparse storage (.rfm_sparse instead of .rfm), selected on RFC_init() */
+#endif /*!RFC_MINIMAL*/
 };
 
 
@@ -421,6 +436,7 @@ enum rfc_wl_defaults
 typedef                 RFC_VALUE_TYPE          rfc_value_t;                /** Input data value type */
 typedef                 RFC_COUNTS_VALUE_TYPE   rfc_counts_t;               /** Type of counting values */
 typedef     struct      rfc_value_tuple         rfc_value_tuple_s;          /** Tuple of value and index position */
+typedef     struct      rfc_res_item            rfc_res_item_s;             /** Residue item, hot members of rfc_value_tuple (internal) */
 typedef     struct      rfc_ctx                 rfc_ctx_s;                  /** Forward declaration (rainflow context) */
 typedef     enum        rfc_mem_aim             rfc_mem_aim_e;              /** Memory accessing mode */
 typedef     enum        rfc_flags               rfc_flags_e;                /** Flags, see RFC_FLAGS... */
@@ -438,6 +454,9 @@ typedef     enum        rfc_sd_method           rfc_sd_method_e;            /**
 typedef     struct      rfc_class_param         rfc_class_param_s;          /** Class parameters (width, offset, count) */
 typedef     struct      rfc_wl_param            rfc_wl_param_s;             /** Woehler curve parameters (sd, nd, k, k2, omission) */
 typedef     struct      rfc_rfm_item            rfc_rfm_item_s;             /** Rainflow matrix element */
+typedef     struct      rfc_bank                rfc_bank_s;                 /** Multi-channel bank (contexts sharing class parameters) */
+typedef     struct      rfc_lut                 rfc_lut_s;                  /** Shared damage look-up tables (read-only, reference counted) */
+typedef     struct      rfc_rfm_sparse          rfc_rfm_sparse_s;           /** Sparse rainflow matrix (hash table and row lists) */
 #endif /*!RFC_MINIMAL*/
 
 /* Memory allocation functions typedef */
@@ -459,8 +478,15 @@ bool        RFC_deinit                  (       void *ctx );
 bool        RFC_feed                    (       void *ctx, const rfc_value_t* data, size_t count );
 #if !RFC_MINIMAL
 bool        RFC_cycle_process_counts    (       void *ctx, rfc_value_t from_val, rfc_value_t to_val, rfc_flags_e flags );
+bool        RFC_cycle_process_counts_weighted( void *ctx, rfc_value_t from_val, rfc_value_t to_val, rfc_flags_e flags, rfc_counts_t cycles );
 bool        RFC_feed_scaled             (       void *ctx, const rfc_value_t* data, size_t count, double factor );
+bool        RFC_feed_f32                (       void *ctx, const float* data, size_t count, double scale, double offset );
+bool        RFC_feed_i16                (       void *ctx, const int16_t* data, size_t count, double scale, double offset );
+bool        RFC_feed_i32                (       void *ctx, const int32_t* data, size_t count, double scale, double offset );
+bool        RFC_feed_strided            (       void *ctx, const rfc_value_t* data, size_t count, size_t stride );
+bool        RFC_feed_interleaved        (       void *ctx, size_t ctx_count, const rfc_value_t* data, size_t frame_count );
 bool        RFC_feed_tuple              (       void *ctx, rfc_value_tuple_s *data, size_t count );
+bool        RFC_merge                   (       void *ctx, const void *ctx_src );
 #endif /*!RFC_MINIMAL*/
 bool        RFC_finalize                (       void *ctx, rfc_res_method_e residual_method );
 #if !RFC_MINIMAL
@@ -473,6 +499,7 @@ bool        RFC_rfm_peek                ( const void *ctx, rfc_value_t from_val,
 bool        RFC_rfm_poke                (       void *ctx, rfc_value_t from_val, rfc_value_t to_val, rfc_counts_t counts, bool add_only );
 bool        RFC_rfm_sum                 ( const void *ctx, unsigned from_first, unsigned from_last, unsigned to_first, unsigned to_last, rfc_counts_t *count );
 bool        RFC_rfm_damage              ( const void *ctx, unsigned from_first, unsigned from_last, unsigned to_first, unsigned to_last, double *damage );
+bool        RFC_rfm_sat_enable          (       void *ctx, bool enable );
 bool        RFC_rfm_check               ( const void *ctx );
 bool        RFC_rfm_refeed              (       void *ctx, rfc_value_t new_hysteresis, const rfc_class_param_s *new_class_param );
 bool        RFC_lc_get                  ( const void *ctx, rfc_counts_t *lc, rfc_value_t *level );
@@ -484,6 +511,8 @@ bool        RFC_rp_from_rfm             ( const void *ctx, rfc_counts_t *rp, rfc
 bool        RFC_damage                  ( const void *ctx, rfc_value_t *damage, rfc_value_t *damage_residue );
 bool        RFC_damage_from_rp          ( const void *ctx, double *damage, const rfc_counts_t *counts, const rfc_value_t *Sa, rfc_rp_damage_method_e rp_calc_type );
 bool        RFC_damage_from_rfm         ( const void *ctx, double *damage, const rfc_counts_t *rfm );
+bool        RFC_damage_multi_init       (       void *ctx, const rfc_wl_param_s *wl_param, unsigned count );
+bool        RFC_damage_multi_get        ( const void *ctx, double *damage, unsigned count );
 bool        RFC_wl_calc_sx              ( const void *ctx, double s0, double n0, double k, double *sx, double nx, double  k2, double  sd, double nd );
 bool        RFC_wl_calc_sd              ( const void *ctx, double s0, double n0, double k, double  sx, double nx, double  k2, double *sd, double nd );
 bool        RFC_wl_calc_k2              ( const void *ctx, double s0, double n0, double k, double  sx, double nx, double *k2, double  sd, double nd );
@@ -507,6 +536,7 @@ bool        RFC_flags_check             ( const void *ctx, int flags_to_check, i
 #endif /*!RFC_MINIMAL*/
 #if RFC_TP_SUPPORT
 bool        RFC_tp_init                 (       void *ctx, rfc_value_tuple_s *tp, size_t tp_cap, bool is_static );
+bool        RFC_tp_init_mapped          (       void *ctx, const char *filename, size_t tp_cap );
 bool        RFC_tp_init_autoprune       (       void *ctx, bool autoprune, size_t size, size_t threshold );
 bool        RFC_tp_prune                (       void *ctx, size_t count, rfc_flags_e flags );
 bool        RFC_tp_refeed               (       void *ctx, rfc_value_t new_hysteresis, const rfc_class_param_s *new_class_param );
@@ -515,8 +545,32 @@ bool        RFC_tp_clear                (       void *ctx );
 bool        RFC_res_get                 ( const void *ctx, const rfc_value_tuple_s **residue, unsigned *count );
 #if RFC_DH_SUPPORT
 bool        RFC_dh_init                 (       void *ctx, rfc_sd_method_e method, double *dh, size_t dh_cap, bool is_static );
+bool        RFC_dh_init_mapped          (       void *ctx, rfc_sd_method_e method, const char *filename, size_t dh_cap );
 bool        RFC_dh_get                  ( const void *ctx, const double **dh, size_t *count );
 #endif /*RFC_DH_SUPPORT*/
+#if !RFC_MINIMAL
+/* Multi-channel bank */
+bool        RFC_bank_init               (       void *bank, size_t channel_count, unsigned class_count, rfc_value_t class_width, rfc_value_t class_offset, 
+                                                            rfc_value_t hysteresis, rfc_flags_e flags );
+bool        RFC_bank_feed               (       void *bank, const rfc_value_t* data, size_t frame_count );
+bool        RFC_bank_finalize           (       void *bank, rfc_res_method_e residual_method );
+bool        RFC_bank_deinit             (       void *bank );
+/* Batch counting of independent series */
+bool        RFC_batch                   (       void *ctx, size_t series_count, const rfc_value_t * const *data, const size_t *data_count,
+                                                           rfc_res_method_e residual_method, unsigned thread_count, double *damage, rfc_counts_t *rfm, rfc_counts_t *rp );
+#if RFC_DAMAGE_FAST
+/* Damage look-up tables shared among contexts */
+bool        RFC_lut_create              ( const void *ctx, rfc_lut_s **lut );
+bool        RFC_lut_attach              (       void *ctx, rfc_lut_s *lut );
+bool        RFC_lut_release             (       rfc_lut_s *lut );
+#endif /*RFC_DAMAGE_FAST*/
+/* Snapshots of live counting results (single writer, concurrent readers) */
+bool        RFC_snapshot_enable         (       void *ctx );
+bool        RFC_snapshot                ( const void *ctx, double *damage, rfc_counts_t *rfm, rfc_counts_t *rp, rfc_counts_t *lc );
+/* Checkpoints of live contexts */
+bool        RFC_checkpoint_write        ( const void *ctx, void *buffer, size_t *size );
+bool        RFC_checkpoint_read         (       void *ctx, const void *buffer, size_t size );
+#endif /*!RFC_MINIMAL*/
 
 #if RFC_AT_SUPPORT
 bool        RFC_at_init                 (       void *ctx, const double *Sa, const double *Sm, unsigned count, 
@@ -551,6 +605,9 @@ typedef  int                        ( *rfc_debug_vfprintf_fcn_t )( void *, FILE
 #endif /*RFC_DEBUG_FLAGS*/
 #endif /*RFC_USE_DELEGATES*/
 
+/* Counting kernel typedef (internal) */
+typedef  void                       ( *rfc_counts_fcn_t )        ( rfc_ctx_s *, rfc_value_tuple_s *from, rfc_value_tuple_s *to, rfc_value_tuple_s *next, rfc_flags_e flags );
+
 
 /* Value info struct */
 struct rfc_value_tuple
@@ -568,6 +625,16 @@ struct rfc_value_tuple
 #endif /*RFC_TP_SUPPORT*/
 };
 
+/* Residue item (internal), mirrors the members of rfc_value_tuple read by the cycle search, naturally aligned */
+#pragma pack(push, 8)
+struct rfc_res_item
+{
+    rfc_value_t                         value;                      /**< Value */
+    unsigned                            cls;                        /**< Class number, base 0 */
+    size_t                              pos;                        /**< Absolute position in input data stream, base 1 */
+};
+#pragma pack(pop)
+
 #if !RFC_MINIMAL
 struct rfc_class_param
 {
@@ -711,7 +778,10 @@ struct rfc_ctx
     rfc_counts_t                       *rfm;                        /**< Rainflow matrix, always class_count^2 elements (row-major, row=from, to=col). */
 #if !RFC_MINIMAL
     rfc_counts_t                       *rp;                         /**< Range pair counts, always class_count elements */
-    rfc_counts_t                       *lc;                         /**< Level crossing counts, always class_count elements. Every per .flags selected slope increments by .full_inc! */
+    rfc_counts_t                       *lc;                         /**< Level crossing counts, always class_count elements. Every per .flags selected slope increments by .full_inc! Complete after RFC_finalize() or RFC_lc_get() */
+
+    /* Sparse storage (optional, may be NULL) */
+    rfc_rfm_sparse_s                   *rfm_sparse;                 /**< Rainflow matrix, non-zero elements only (RFC_FLAGS_SPARSE_RFM), .rfm is NULL then */
 #endif /*!RFC_MINIMAL*/
 
 #if RFC_TP_SUPPORT
@@ -735,12 +805,26 @@ struct rfc_ctx
 #if RFC_DAMAGE_FAST
     double                             *damage_lut;                 /**< Damage look-up table */
     int                                 damage_lut_inapt;           /**< Greater 0, if values in damage_lut aren't proper to Woehler curve parameters */
+    size_t                              damage_lut_size;            /**< Number of entries in damage_lut (and amplitude_lut) */
+    unsigned                            damage_lut_stride;          /**< Row length of damage_lut (class_count), 0 if indexed by range class |from-to| only */
+    double                            **damage_lut_pages;           /**< 2D tables beyond RFC_CLASS_COUNT_DENSE_MAX classes, pages built on first touch (damage_lut is unused then) */
+    unsigned                            damage_lut_pages_dim;       /**< Number of pages per row in damage_lut_pages */
+    rfc_lut_s                          *lut;                        /**< Shared look-up tables, damage_lut and amplitude_lut point into (NULL if owned) */
 #if RFC_AT_SUPPORT
     double                             *amplitude_lut;              /**< Amplitude look-up table, only valid if damage_lut_inapt == 0 */
 #endif /*RFC_AT_SUPPORT*/
 #endif /*RFC_DAMAGE_FAST*/
     double                              damage;                     /**< Cumulated damage (damage resulting from residue included) */
     double                              damage_residue;             /**< Partial damage in .damage influenced by taking residue into account (after finalizing) */
+#if !RFC_MINIMAL
+    long                               *snapshot_seq;               /**< Sequence counter for RFC_snapshot(), odd while counts are updated (NULL if disabled) */
+    unsigned                            damage_multi_count;         /**< Number of Woehler curves evaluated additionally (0 if disabled) */
+    rfc_wl_param_s                     *damage_multi_wl;            /**< Woehler curve parameters, damage_multi_count entries */
+    double                             *damage_multi;               /**< Cumulated damage per Woehler curve */
+    double                             *damage_multi_lut;           /**< Damage per range class |from-to|, damage_multi_count values per class */
+    unsigned                            damage_multi_lut_classes;   /**< Number of range classes in damage_multi_lut */
+    double                              damage_multi_lut_width;     /**< Class width damage_multi_lut is built for */
+#endif /*!RFC_MINIMAL*/
 
 #if RFC_AT_SUPPORT
     struct at
@@ -767,6 +851,8 @@ struct rfc_ctx
         int                             debug_flags;                /**< Flags for debugging */
 #endif /*RFC_DEBUG_FLAGS*/
         int                             slope;                      /**< Current signal slope */
+        rfc_counts_fcn_t                counts_fcn;                 /**< Counting kernel for closed cycles, specialized on flags */
+        double                          class_rcp;                  /**< Reciprocal class width (quantization) */
         rfc_value_tuple_s               extrema[2];                 /**< Local or global extrema depending on RFC_GLOBAL_EXTREMA */
 #if RFC_GLOBAL_EXTREMA
         bool                            extrema_changed;            /**< True if one extrema has changed */
@@ -776,16 +862,43 @@ struct rfc_ctx
         rfc_value_tuple_s               residue[3];                 /**< Static residue (if class_count is zero) */
         size_t                          residue_cap;                /**< Capacity of static residue */
         bool                            res_static;                 /**< true, if .residue refers the static residue .internal.residue */
+        rfc_res_item_s                 *res;                        /**< Mirror of .residue for the 4-point method, .residue_cap elements */
+        rfc_res_item_s                  res_buf[3];                 /**< Static mirror (if class_count is zero) */
+        size_t                          res_cnt;                    /**< Number of turning points mirrored in .res (from the start of .residue) */
 #if !RFC_MINIMAL
         rfc_wl_param_s                  wl;                         /**< Shadowed Woehler curve parameters */
+        struct mk
+        {
+            bool                        valid;                      /**< true, if constants below match .wl and the Woehler curve parameters */
+            bool                        pending;                    /**< true, if .wl.sx, .wl.nx and .wl.nd are not yet updated from .sx_log_imp and .nx_log_imp */
+            bool                        lut;                        /**< true, if impaired and unimpaired curve share the upper slope (damage from look-up table applies) */
+            double                      sx, sd, nd;                 /**< Unimpaired curve */
+            double                      sx_log, nx_log;             /**< Unimpaired curve, log(sx), log(nx) */
+            double                      k, k2;                      /**< Impaired curve slopes (absolute) */
+            double                      q_rcp, q2_rcp;              /**< 1/q, 1/q2 */
+            double                      omission;                   /**< Impaired curve omission level */
+            double                      sx_log_imp, nx_log_imp;     /**< Impaired curve, log(sx), log(nx) */
+        }                               mk;                         /**< Miner consequent state, Woehler curve of the impaired part in log domain */
+        rfc_counts_t                   *lc_diff;                    /**< Level crossings not yet added to .lc, as difference array (class_count entries) */
+        bool                            lc_dirty;                   /**< true, if lc_diff holds counts */
+        struct rfm_sat
+        {
+            bool                        enabled;                    /**< true, if RFC_rfm_sum() and RFC_rfm_damage() use summed-area tables */
+            rfc_counts_t               *counts;                     /**< Summed-area table of .rfm, (class_count+1)^2 elements, allocated on first use */
+            double                     *damage;                     /**< Summed-area table of damages (counts weighted) in .rfm, allocated on first use */
+            unsigned                    rows;                       /**< Number of .rfm rows covered by .counts so far */
+            unsigned                    damage_rows;                /**< Number of .rfm rows covered by .damage so far (never more than .rows) */
+        }                               rfm_sat;
 #endif /*!RFC_MINIMAL*/
 #if RFC_TP_SUPPORT
         rfc_value_tuple_s               margin[2];                  /**< First and last data point */
         int                             margin_stage;               /**< 0: Init, 1: Left margin set, 2: 1st turning point is safe */
         bool                            tp_static;                  /**< true, if tp is statically allocated */
+        struct rfc_map                 *tp_map;                     /**< File mapping backing tp (NULL if tp is in memory) */
 #endif /*RFC_TP_SUPPORT*/
 #if RFC_DH_SUPPORT
         bool                            dh_static;                  /**< true, if dh is statically allocated */
+        struct rfc_map                 *dh_map;                     /**< File mapping backing dh (NULL if dh is in memory) */
 #endif /*RFC_DH_SUPPORT*/
 #if RFC_HCM_SUPPORT
         struct hcm
@@ -812,6 +925,48 @@ struct rfc_ctx
                                         internal;
 };
 
+
+#if !RFC_MINIMAL
+/**
+ * Multi-channel bank
+ * 
+ * Holds one rainflow context per channel, all sharing the same class parameters.
+ * RFC_bank_feed() advances all channels by a block of frames (channel-interleaved
+ * data). The hot state of the turning point pre-filter is kept in contiguous arrays
+ * (structure of arrays) and swept over all channels frame by frame. A channel's
+ * context is only visited, when a sample is a turning point candidate.
+ * Channel contexts (.ctx) may be configured individually after RFC_bank_init()
+ * (Woehler curve, turning point storage etc.), but must not be fed directly.
+ */
+struct rfc_bank
+{
+    size_t                              version;                    /**< Version number as sizeof(struct rfc_bank), must be 1st field! */
+    size_t                              channel_count;              /**< Number of channels */
+    rfc_ctx_s                          *ctx;                        /**< Rainflow contexts, one per channel */
+    rfc_mem_alloc_fcn_t                 mem_alloc;                  /**< Allocator for bank memory (may be NULL) */
+    size_t                              pos;                        /**< Frames fed so far (common position of all channels) */
+
+    /* Shared class parameters */
+    unsigned                            class_count;                /**< Class count */
+    rfc_value_t                         class_width;                /**< Class width */
+    rfc_value_t                         class_offset;               /**< Lower bound of first class */
+    rfc_value_t                         hysteresis;                 /**< Hysteresis filtering, slope must exceed hysteresis to be counted! */
+
+    /* Per channel hot state of the turning point pre-filter (structure of arrays) */
+    struct
+    {
+        bool                           *active;                     /**< true, if the channel is pre-filtered */
+        int                            *slope;                      /**< Current signal slope */
+        rfc_value_t                    *interim;                    /**< Value of the interim turning point */
+        size_t                         *interim_pos;                /**< Position of the interim turning point, 0 if unchanged */
+#if RFC_GLOBAL_EXTREMA
+        rfc_value_t                    *extrema[2];                 /**< Global extrema values */
+        size_t                         *extrema_pos[2];             /**< Positions of the global extrema, 0 if unchanged */
+#endif /*RFC_GLOBAL_EXTREMA*/
+    }                                   soa;
+};
+#endif /*!RFC_MINIMAL*/
+
 #ifdef __cplusplus
 }  /* extern "C" */
 }  /* namespace RFC_CPP_NAMESPACE */
@@ -0,0 +1,188 @@
+/*
+ * Benchmark: Flag-specialized counting kernels against the generic kernel
+ *
+ * Counts a noisy random series (many closed cycles) once with the kernel
+ * bound by RFC_init() and once with the generic kernel, for several flag
+ * combinations. Results must be identical, timings are printed.
+ *
+ * Batch counting: The series is split into short series, counted by
+ * RFC_batch() on one worker and on one worker per processor.
+ *
+ * Usage: rfc_bench [sample count [repetitions]]
+ */
+
+#include "../src/rainflow.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define NUMEL(x)    (sizeof(x)/sizeof((x)[0]))
+
+
+static
+double bench_run( rfc_ctx_s *ctx, const rfc_value_t *data, size_t count, unsigned class_count, rfc_flags_e flags,
+                  rfc_counts_fcn_t counts_fcn, int repetitions )
+{
+    double  best = -1.0;
+    int     i;
+
+    for( i = 0; i < repetitions; i++ )
+    {
+        clock_t t0;
+        double  t;
+
+        if( i ) RFC_deinit( ctx );
+
+        if( !RFC_init( ctx, class_count, /*class_width*/ 200.0 / class_count, /*class_offset*/ -100.0,
+                       /*hysteresis*/ 200.0 / class_count, flags ) )
+        {
+            return -1.0;
+        }
+
+        if( counts_fcn )
+        {
+            ctx->internal.counts_fcn = counts_fcn;
+        }
+
+        t0 = clock();
+        if( !RFC_feed( ctx, data, count ) || !RFC_finalize( ctx, RFC_RES_NONE ) )
+        {
+            return -1.0;
+        }
+        t = (double)( clock() - t0 ) / CLOCKS_PER_SEC;
+
+        if( best < 0.0 || t < best ) best = t;
+    }
+
+    return best;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    static const struct
+    {
+        const char *name;
+        int         flags;
+    } cases[] =
+    {
+        { "RFM",            RFC_FLAGS_COUNT_RFM },
+        { "RFM+DAMAGE",     RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE },
+        { "RFM+RP",         RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_RP },
+        { "RFM+DAMAGE+RP",  RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP },
+    };
+    size_t              count           = ( argc > 1 ) ? (size_t)atol( argv[1] ) : 10000000;
+    int                 repetitions     = ( argc > 2 ) ? atoi( argv[2] ) : 5;
+    unsigned            class_count     = 100;
+    rfc_value_t        *data;
+    rfc_ctx_s           ctx             = { sizeof(ctx) };
+    rfc_ctx_s           ctx_generic     = { sizeof(ctx) };
+    rfc_counts_fcn_t    generic;
+    unsigned long       seed            = 1;
+    size_t              i, j;
+    int                 ok              = 1;
+
+    data = (rfc_value_t*)calloc( count, sizeof(rfc_value_t) );
+    if( !data ) return EXIT_FAILURE;
+
+    for( i = 0; i < count; i++ )
+    {
+        seed    = seed * 1103515245UL + 12345UL;
+        data[i] = 90.0 * ( ( seed >> 16 ) % 10000 ) / 10000.0 - 45.0 + 40.0 * sin( i * 0.001 );
+    }
+
+    /* Default flags are counted by the generic kernel */
+    if( !RFC_init( &ctx_generic, class_count, 1.0, 0.0, 1.0, RFC_FLAGS_DEFAULT ) ) return EXIT_FAILURE;
+    generic = ctx_generic.internal.counts_fcn;
+    RFC_deinit( &ctx_generic );
+
+    printf( "%lu samples, %u classes, best of %d\n\n", (unsigned long)count, class_count, repetitions );
+    printf( "%-16s %12s %12s %8s\n", "flags", "generic [s]", "kernel [s]", "gain" );
+
+    for( j = 0; j < NUMEL(cases); j++ )
+    {
+        double t_generic = bench_run( &ctx_generic, data, count, class_count, (rfc_flags_e)cases[j].flags, generic, repetitions );
+        double t_kernel  = bench_run( &ctx,         data, count, class_count, (rfc_flags_e)cases[j].flags, NULL,    repetitions );
+
+        if( t_generic < 0.0 || t_kernel < 0.0 )
+        {
+            fprintf( stderr, "%s: counting failed\n", cases[j].name );
+            return EXIT_FAILURE;
+        }
+
+        /* Results must be identical */
+        if( ctx.damage != ctx_generic.damage ||
+            memcmp( ctx.rfm, ctx_generic.rfm, class_count * class_count * sizeof(rfc_counts_t) ) ||
+            ( ctx.rp && memcmp( ctx.rp, ctx_generic.rp, class_count * sizeof(rfc_counts_t) ) ) )
+        {
+            fprintf( stderr, "%s: results differ\n", cases[j].name );
+            ok = 0;
+        }
+
+        printf( "%-16s %12.4f %12.4f %7.1f%%\n", cases[j].name, t_generic, t_kernel,
+                t_kernel > 0.0 ? 100.0 * ( t_generic / t_kernel - 1.0 ) : 0.0 );
+
+        RFC_deinit( &ctx );
+        RFC_deinit( &ctx_generic );
+    }
+
+    /* Batch counting */
+    if( ok )
+    {
+        size_t               series_len     = 1000;
+        size_t               series_count   = count / series_len;
+        const rfc_value_t  **series         = (const rfc_value_t**)calloc( series_count + 1, sizeof(rfc_value_t*) );
+        size_t              *series_lens    = (size_t*)calloc( series_count + 1, sizeof(size_t) );
+        double              *damage[2];
+        double               t[2];
+        unsigned             threads[2]     = { 1, 0 };
+
+        damage[0] = (double*)calloc( series_count + 1, sizeof(double) );
+        damage[1] = (double*)calloc( series_count + 1, sizeof(double) );
+        if( !series || !series_lens || !damage[0] || !damage[1] ) return EXIT_FAILURE;
+
+        for( i = 0; i < series_count; i++ )
+        {
+            series[i]        = data + i * series_len;
+            series_lens[i] = series_len;
+        }
+
+        if( !RFC_init( &ctx, class_count, 200.0 / class_count, -100.0, 200.0 / class_count, 
+                       RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE ) ) return EXIT_FAILURE;
+
+        for( j = 0; j < 2; j++ )
+        {
+            struct timespec ts0, ts1;  /* Wall clock, clock() sums up all workers */
+
+            timespec_get( &ts0, TIME_UTC );
+            if( !RFC_batch( &ctx, series_count, series, series_lens, RFC_RES_NONE, threads[j], damage[j], NULL, NULL ) )
+            {
+                fprintf( stderr, "batch: counting failed\n" );
+                return EXIT_FAILURE;
+            }
+            timespec_get( &ts1, TIME_UTC );
+            t[j] = ( ts1.tv_sec - ts0.tv_sec ) + 1e-9 * ( ts1.tv_nsec - ts0.tv_nsec );
+        }
+
+        if( memcmp( damage[0], damage[1], series_count * sizeof(double) ) )
+        {
+            fprintf( stderr, "batch: results differ\n" );
+            ok = 0;
+        }
+
+        printf( "\n%lu series of %lu samples: 1 worker %.4f s, all processors %.4f s (%.1fx)\n",
+                (unsigned long)series_count, (unsigned long)series_len, t[0], t[1], t[1] > 0.0 ? t[0] / t[1] : 0.0 );
+
+        RFC_deinit( &ctx );
+        free( damage[0] );
+        free( damage[1] );
+        free( series_lens );
+        free( (void*)series );
+    }
+
+    free( data );
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -57,6 +57,9 @@
 #include <float.h>
 #include <stddef.h>  /* offsetof */
 #include "long_series.h"
+#if RFC_USE_THREADS && !defined(_WIN32)
+#include <pthread.h>
+#endif /*RFC_USE_THREADS*/
 
 
 #define ROUND(x)    ((x)>=0?(long)((x)+0.5):(long)((x)-0.5))
@@ -1554,6 +1557,1821 @@ TEST RFC_long_series( int ccnt, int class_count_ar )
 }
 
 #if !RFC_MINIMAL
+/* Pseudo random numbers (linear congruential generator), reproducible on all platforms */
+static
+unsigned long lcg_next( unsigned long *seed )
+{
+    *seed = *seed * 1103515245UL + 12345UL;
+
+    return *seed >> 16;
+}
+
+
+/* Compare counting state and results of a context to a reference, bit exact */
+TEST RFC_ctx_check( rfc_ctx_s *counted, rfc_ctx_s *ref )
+{
+    unsigned class_count = ref->class_count;
+    size_t   residue_cnt = ref->residue_cnt + ( ( ref->state < RFC_STATE_FINALIZE ) ? 1 : 0 );  /* Interim turning point included */
+
+    ASSERT_EQ( counted->state, ref->state );
+    ASSERT_EQ( counted->internal.pos, ref->internal.pos );
+    ASSERT_EQ( counted->residue_cnt, ref->residue_cnt );
+    ASSERT_MEM_EQ( counted->residue, ref->residue, residue_cnt * sizeof(rfc_value_tuple_s) );
+    ASSERT_MEM_EQ( counted->internal.extrema, ref->internal.extrema, sizeof(ref->internal.extrema) );
+#if RFC_TP_SUPPORT
+    if( ref->internal.flags & RFC_FLAGS_ENFORCE_MARGIN )
+    {
+        ASSERT_MEM_EQ( &counted->internal.margin[1], &ref->internal.margin[1], sizeof(rfc_value_tuple_s) );
+    }
+    ASSERT_EQ( counted->tp_cnt, ref->tp_cnt );
+    ASSERT_MEM_EQ( counted->tp, ref->tp, ref->tp_cnt * sizeof(rfc_value_tuple_s) );
+#endif /*RFC_TP_SUPPORT*/
+    if( ref->rfm ) ASSERT_MEM_EQ( counted->rfm, ref->rfm, class_count * class_count * sizeof(rfc_counts_t) );
+    if( ref->rp )  ASSERT_MEM_EQ( counted->rp,  ref->rp,  class_count * sizeof(rfc_counts_t) );
+    if( ref->lc )  ASSERT_MEM_EQ( counted->lc,  ref->lc,  class_count * sizeof(rfc_counts_t) );
+    ASSERT_EQ( counted->damage, ref->damage );
+
+    PASS();
+}
+
+
+TEST RFC_feed_block_test( int ccnt )
+{
+    static
+    RFC_VALUE_TYPE      data[20000];
+    RFC_VALUE_TYPE      x_max;
+    RFC_VALUE_TYPE      x_min;
+    unsigned            class_count     =  ccnt ? 100 : 0;
+    RFC_VALUE_TYPE      class_width;
+    RFC_VALUE_TYPE      class_offset;
+    RFC_VALUE_TYPE      hysteresis;
+    rfc_ctx_s           ctx_check       = { sizeof(ctx_check) };
+    unsigned long       seed            =  1;
+    size_t              i, n;
+
+    /* Oversampled signal with noise and plateaus, most samples aren't turning points */
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 100.0 * sin( i * 0.002 ) + ( lcg_next( &seed ) % 100 ) / 50.0;
+
+        if( ( i / 1000 ) % 5 == 2 )
+        {
+            data[i] += 20.0 * sin( i * 0.3 );
+        }
+
+        if( ( i / 500 ) % 7 == 3 )
+        {
+            data[i] = ROUND( data[i] / 10.0 ) * 10.0;
+        }
+    }
+
+    calc_extema( data, NUMEL(data), &x_max, &x_min );
+    calc_class_param( x_max, x_min, class_count, &class_width, &class_offset );
+    hysteresis = class_count ? class_width : 2.5;
+
+    ASSERT( RFC_init( &ctx,       class_count, class_width, class_offset, hysteresis, RFC_FLAGS_COUNT_ALL | RFC_FLAGS_ENFORCE_MARGIN ) );
+    ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_COUNT_ALL | RFC_FLAGS_ENFORCE_MARGIN ) );
+#if RFC_TP_SUPPORT
+    ASSERT( RFC_tp_init( &ctx,       /*tp*/ NULL, /*tp_cap*/ 1, /*is_static*/ false ) );
+    ASSERT( RFC_tp_init( &ctx_check, /*tp*/ NULL, /*tp_cap*/ 1, /*is_static*/ false ) );
+#endif /*RFC_TP_SUPPORT*/
+
+    /* Block pre-filtered feed (uneven chunks) against per sample feed */
+    for( i = 0, n = 1; i < NUMEL(data); i += n, n = n * 7 % 1000 + 1 )
+    {
+        if( n > NUMEL(data) - i )
+        {
+            n = NUMEL(data) - i;
+        }
+        ASSERT( RFC_feed( &ctx, data + i, n ) );
+    }
+    ASSERT( RFC_feed_scaled( &ctx_check, data, NUMEL(data), /*factor*/ 1.0 ) );
+
+    /* Interim state */
+    CHECK_CALL( RFC_ctx_check( &ctx, &ctx_check ) );
+
+    ASSERT( RFC_finalize( &ctx,       /* residual_method */ RFC_RES_NONE ) );
+    ASSERT( RFC_finalize( &ctx_check, /* residual_method */ RFC_RES_NONE ) );
+
+    /* Results */
+    CHECK_CALL( RFC_ctx_check( &ctx, &ctx_check ) );
+
+    ASSERT( RFC_deinit( &ctx_check ) );
+
+    if( ctx.state != RFC_STATE_INIT0 )
+    {
+        ASSERT( RFC_deinit( &ctx ) );
+    }
+
+    PASS();
+}
+
+
+#if RFC_TP_SUPPORT
+TEST RFC_quantize_test( void )
+{
+    RFC_VALUE_TYPE      data[2000];
+    unsigned            class_count     =  200;
+    RFC_VALUE_TYPE      class_width     =  0.1;
+    RFC_VALUE_TYPE      class_offset    = -0.3;
+    RFC_VALUE_TYPE      hysteresis      =  class_width;
+    size_t              i, j;
+
+    /* Alternating values on and next to class borders (up to 4 ulps), each one becomes a turning point */
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        unsigned k = ( i & 1 ) ? ( class_count - 1 - i % 97 ) : ( i % 89 );
+
+        data[i] = class_offset + class_width * k;
+
+        for( j = 0; j < i % 5; j++ )
+        {
+            data[i] = nextafter( data[i], ( k && i % 3 ) ? -DBL_MAX : DBL_MAX );
+        }
+    }
+
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_DEFAULT ) );
+    ASSERT( RFC_tp_init( &ctx, /*tp*/ NULL, /*tp_cap*/ 1, /*is_static*/ false ) );
+    ASSERT( RFC_feed( &ctx, data, NUMEL(data) ) );
+    ASSERT( RFC_finalize( &ctx, /* residual_method */ RFC_RES_NONE ) );
+    ASSERT( ctx.tp_cnt > NUMEL(data) / 2 );
+
+    for( i = 0; i < ctx.tp_cnt; i++ )
+    {
+        unsigned cls;
+
+        ASSERT( RFC_class_number( &ctx, ctx.tp[i].value, &cls ) );
+        ASSERT_EQ( ctx.tp[i].cls, cls );
+    }
+    ASSERT( RFC_deinit( &ctx ) );
+
+    /* First sample out of range stops feeding */
+    for( i = 0; i < 40; i++ )
+    {
+        data[i] = ( i & 1 ) ? 5.0 : 0.0;
+    }
+    data[21] = class_offset - class_width;
+
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_DEFAULT ) );
+    ASSERT( !RFC_feed( &ctx, data, 40 ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_DATA_OUT_OF_RANGE );
+    ASSERT_EQ( ctx.internal.pos, 22 );
+
+    if( ctx.state != RFC_STATE_INIT0 )
+    {
+        ASSERT( RFC_deinit( &ctx ) );
+    }
+
+    PASS();
+}
+#endif /*RFC_TP_SUPPORT*/
+
+
+TEST RFC_feed_typed_test( void )
+{
+    static
+    int16_t             data_i16[3000];
+    static
+    int32_t             data_i32[3000];
+    static
+    float               data_f32[3000];
+    static
+    RFC_VALUE_TYPE      data[3][3000];
+    unsigned            class_count     =  100;
+    RFC_VALUE_TYPE      class_width     =  0.25;
+    RFC_VALUE_TYPE      class_offset    = -12.5;
+    RFC_VALUE_TYPE      hysteresis      =  class_width;
+    double              scale           =  1.0 / 2048;
+    double              offset          =  0.5;
+    rfc_ctx_s           ctx_check       = { sizeof(ctx_check) };
+    unsigned long       seed            =  1;
+    size_t              i, j, n;
+
+    /* ADC counts (12 bit) and engineering values */
+    for( i = 0; i < NUMEL(data_i16); i++ )
+    {
+        data_i16[i] = (int16_t)( 2000.0 * sin( i * 0.01 ) + (long)( lcg_next( &seed ) % 64 ) - 32 );
+        data_i32[i] = (int32_t)data_i16[i] * 8;
+        data_f32[i] = (float)data_i16[i] * 0.0625f;
+
+        data[0][i]  = (double)data_i16[i] * scale + offset;
+        data[1][i]  = (double)data_i32[i] * scale / 8 + offset;
+        data[2][i]  = (double)data_f32[i] * scale * 16 + offset;
+    }
+
+    for( j = 0; j < 3; j++ )
+    {
+        ASSERT( RFC_init( &ctx,       class_count, class_width, class_offset, hysteresis, RFC_FLAGS_DEFAULT ) );
+        ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_DEFAULT ) );
+
+        /* Typed feed (uneven chunks) against converted data */
+        for( i = 0, n = 1; i < NUMEL(data_i16); i += n, n = n * 7 % 500 + 1 )
+        {
+            if( n > NUMEL(data_i16) - i )
+            {
+                n = NUMEL(data_i16) - i;
+            }
+
+            switch( j )
+            {
+                case 0: ASSERT( RFC_feed_i16( &ctx, data_i16 + i, n, scale, offset ) );          break;
+                case 1: ASSERT( RFC_feed_i32( &ctx, data_i32 + i, n, scale / 8, offset ) );      break;
+                case 2: ASSERT( RFC_feed_f32( &ctx, data_f32 + i, n, scale * 16, offset ) );     break;
+            }
+        }
+        ASSERT( RFC_feed( &ctx_check, data[j], NUMEL(data[j]) ) );
+
+        ASSERT( RFC_finalize( &ctx,       /* residual_method */ RFC_RES_NONE ) );
+        ASSERT( RFC_finalize( &ctx_check, /* residual_method */ RFC_RES_NONE ) );
+
+        ASSERT_EQ( ctx.internal.pos, NUMEL(data_i16) );
+        ASSERT( ctx.damage > 0.0 );
+        CHECK_CALL( RFC_ctx_check( &ctx, &ctx_check ) );
+
+        ASSERT( RFC_deinit( &ctx_check ) );
+        ASSERT( RFC_deinit( &ctx ) );
+    }
+
+    /* Out of range */
+    data_i16[0] = INT16_MAX;
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_DEFAULT ) );
+    ASSERT( !RFC_feed_i16( &ctx, data_i16, 1, /*scale*/ 1.0, /*offset*/ 0.0 ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_DATA_OUT_OF_RANGE );
+
+    if( ctx.state != RFC_STATE_INIT0 )
+    {
+        ASSERT( RFC_deinit( &ctx ) );
+    }
+
+    PASS();
+}
+
+
+TEST RFC_feed_interleaved_test( void )
+{
+#define CH_COUNT 5
+    static
+    RFC_VALUE_TYPE      data[CH_COUNT][1500];
+    static
+    RFC_VALUE_TYPE      data_il[CH_COUNT * NUMEL(data[0])];
+    rfc_ctx_s           ctx_ch[CH_COUNT];
+    rfc_ctx_s           ctx_check;
+    unsigned            class_count     =  50;
+    RFC_VALUE_TYPE      class_width     =  5.0;
+    RFC_VALUE_TYPE      class_offset    = -125.0;
+    RFC_VALUE_TYPE      hysteresis      =  class_width;
+    unsigned long       seed            =  1;
+    size_t              i, j, n;
+
+    /* Channels with different frequencies and noise, interleaved */
+    for( i = 0; i < NUMEL(data[0]); i++ )
+    {
+        for( j = 0; j < CH_COUNT; j++ )
+        {
+            data[j][i]  = 100.0 * sin( i * 0.01 * ( j + 1 ) ) + ( lcg_next( &seed ) % 100 ) / 10.0;
+
+            data_il[i * CH_COUNT + j] = data[j][i];
+        }
+    }
+
+    for( j = 0; j < CH_COUNT; j++ )
+    {
+        rfc_ctx_s ctx_init = { sizeof(rfc_ctx_s) };
+
+        ctx_ch[j] = ctx_init;
+        ASSERT( RFC_init( &ctx_ch[j], class_count, class_width, class_offset, hysteresis, RFC_FLAGS_DEFAULT ) );
+    }
+
+    /* All channels at once (uneven chunks of frames) */
+    for( i = 0, n = 1; i < NUMEL(data[0]); i += n, n = n * 7 % 400 + 1 )
+    {
+        if( n > NUMEL(data[0]) - i )
+        {
+            n = NUMEL(data[0]) - i;
+        }
+        ASSERT( RFC_feed_interleaved( ctx_ch, CH_COUNT, data_il + i * CH_COUNT, n ) );
+    }
+
+    for( j = 0; j < CH_COUNT; j++ )
+    {
+        rfc_ctx_s ctx_init = { sizeof(rfc_ctx_s) };
+
+        /* Single channel, contiguous */
+        ctx_check = ctx_init;
+        ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_DEFAULT ) );
+        ASSERT( RFC_feed( &ctx_check, data[j], NUMEL(data[j]) ) );
+        ASSERT( RFC_finalize( &ctx_check, /* residual_method */ RFC_RES_NONE ) );
+
+        /* Single channel, strided */
+        ctx = ctx_init;
+        ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_DEFAULT ) );
+        ASSERT( RFC_feed_strided( &ctx, data_il + j, NUMEL(data[j]), CH_COUNT ) );
+        ASSERT( RFC_finalize( &ctx, /* residual_method */ RFC_RES_NONE ) );
+        CHECK_CALL( RFC_ctx_check( &ctx, &ctx_check ) );
+        ASSERT( RFC_deinit( &ctx ) );
+
+        ASSERT( RFC_finalize( &ctx_ch[j], /* residual_method */ RFC_RES_NONE ) );
+        ASSERT_EQ( ctx_ch[j].internal.pos, NUMEL(data[j]) );
+        ASSERT( ctx_ch[j].damage > 0.0 );
+        CHECK_CALL( RFC_ctx_check( &ctx_ch[j], &ctx_check ) );
+
+        ASSERT( RFC_deinit( &ctx_check ) );
+        ASSERT( RFC_deinit( &ctx_ch[j] ) );
+    }
+
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_DEFAULT ) );
+    ASSERT( !RFC_feed_strided( &ctx, data_il, NUMEL(data[0]), /*stride*/ 0 ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_INVARG );
+
+    if( ctx.state != RFC_STATE_INIT0 )
+    {
+        ASSERT( RFC_deinit( &ctx ) );
+    }
+
+    PASS();
+#undef CH_COUNT
+}
+
+
+TEST RFC_bank_test( void )
+{
+#define CH_COUNT 7
+    static
+    RFC_VALUE_TYPE      data[CH_COUNT][5000];
+    static
+    RFC_VALUE_TYPE      data_il[CH_COUNT * NUMEL(data[0])];
+    rfc_bank_s          bank            = { sizeof(rfc_bank_s) };
+    rfc_ctx_s           ctx_check;
+    unsigned            class_count     =  100;
+    RFC_VALUE_TYPE      class_width     =  3.0;
+    RFC_VALUE_TYPE      class_offset    = -150.0;
+    RFC_VALUE_TYPE      hysteresis      =  class_width;
+    int                 flags           =  RFC_FLAGS_COUNT_ALL | RFC_FLAGS_ENFORCE_MARGIN;
+    unsigned long       seed            =  1;
+    size_t              i, j, n;
+
+    /* Oversampled channels with noise, bursts and plateaus, interleaved */
+    for( i = 0; i < NUMEL(data[0]); i++ )
+    {
+        for( j = 0; j < CH_COUNT; j++ )
+        {
+            data[j][i]  = 100.0 * sin( i * 0.002 * ( j + 1 ) ) + ( lcg_next( &seed ) % 100 ) / 50.0;
+
+            if( ( ( i + 300 * j ) / 700 ) % 5 == 2 )
+            {
+                data[j][i] += 20.0 * sin( i * 0.3 );
+            }
+
+            if( ( i / 400 ) % 7 == j % 7 )
+            {
+                data[j][i] = ROUND( data[j][i] / 10.0 ) * 10.0;
+            }
+
+            data_il[i * CH_COUNT + j] = data[j][i];
+        }
+    }
+
+    ASSERT( RFC_bank_init( &bank, CH_COUNT, class_count, class_width, class_offset, hysteresis, flags ) );
+#if RFC_TP_SUPPORT
+    for( j = 0; j < CH_COUNT; j++ )
+    {
+        ASSERT( RFC_tp_init( &bank.ctx[j], /*tp*/ NULL, /*tp_cap*/ 1, /*is_static*/ false ) );
+    }
+#endif /*RFC_TP_SUPPORT*/
+
+    /* All channels at once (uneven chunks of frames) */
+    for( i = 0, n = 1; i < NUMEL(data[0]); i += n, n = n * 7 % 600 + 1 )
+    {
+        if( n > NUMEL(data[0]) - i )
+        {
+            n = NUMEL(data[0]) - i;
+        }
+        ASSERT( RFC_bank_feed( &bank, data_il + i * CH_COUNT, n ) );
+    }
+
+    for( j = 0; j < CH_COUNT; j++ )
+    {
+        rfc_ctx_s  ctx_init = { sizeof(rfc_ctx_s) };
+        rfc_ctx_s *ctx_ch   = &bank.ctx[j];
+
+        ctx_check = ctx_init;
+        ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, flags ) );
+#if RFC_TP_SUPPORT
+        ASSERT( RFC_tp_init( &ctx_check, /*tp*/ NULL, /*tp_cap*/ 1, /*is_static*/ false ) );
+#endif /*RFC_TP_SUPPORT*/
+        ASSERT( RFC_feed( &ctx_check, data[j], NUMEL(data[j]) ) );
+
+        /* Interim state */
+        CHECK_CALL( RFC_ctx_check( ctx_ch, &ctx_check ) );
+
+        ASSERT( RFC_finalize( &ctx_check, /* residual_method */ RFC_RES_NONE ) );
+        ASSERT( RFC_finalize( ctx_ch,     /* residual_method */ RFC_RES_NONE ) );
+
+        /* Results */
+        ASSERT( ctx_ch->damage > 0.0 );
+        CHECK_CALL( RFC_ctx_check( ctx_ch, &ctx_check ) );
+
+        ASSERT( RFC_deinit( &ctx_check ) );
+    }
+    ASSERT( RFC_bank_deinit( &bank ) );
+    ASSERT( !bank.ctx );
+
+    /* Channel out of range, other channels continue */
+    data_il[100 * CH_COUNT + 2] = 1000.0;
+    ASSERT( RFC_bank_init( &bank, CH_COUNT, class_count, class_width, class_offset, hysteresis, flags ) );
+    ASSERT( !RFC_bank_feed( &bank, data_il, NUMEL(data[0]) ) );
+    ASSERT_EQ( RFC_error_get( &bank.ctx[2] ), RFC_ERROR_DATA_OUT_OF_RANGE );
+    ASSERT_EQ( bank.ctx[1].internal.pos, NUMEL(data[0]) );
+    ASSERT_EQ( bank.ctx[3].internal.pos, NUMEL(data[0]) );
+    ASSERT( RFC_bank_deinit( &bank ) );
+
+    PASS();
+#undef CH_COUNT
+}
+
+
+TEST RFC_counts_kernel_test( void )
+{
+    static
+    RFC_VALUE_TYPE      data[20000];
+    static const int    flags[] = 
+    {
+        RFC_FLAGS_COUNT_DAMAGE,
+        RFC_FLAGS_COUNT_RFM,
+        RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE,
+        RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_RP,
+        RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP,
+        RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP | RFC_FLAGS_COUNT_LC,
+#if RFC_TP_SUPPORT
+        RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_ENFORCE_MARGIN,
+        RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP | RFC_FLAGS_ENFORCE_MARGIN,
+#endif /*RFC_TP_SUPPORT*/
+    };
+    unsigned            class_count     =  100;
+    RFC_VALUE_TYPE      class_width     =  2.5;
+    RFC_VALUE_TYPE      class_offset    = -125.0;
+    RFC_VALUE_TYPE      hysteresis      =  class_width;
+    rfc_ctx_s           ctx_check       = { sizeof(ctx_check) };
+    rfc_counts_fcn_t    generic;
+    unsigned long       seed            =  1;
+    size_t              i, j;
+    int                 tp;
+
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 60.0 * sin( i * 0.01 ) + 40.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 20.0;
+    }
+
+    /* Default flags (Miner consequent etc.) are counted by the generic kernel */
+    ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_DEFAULT ) );
+    generic = ctx_check.internal.counts_fcn;
+    ASSERT( generic );
+    ASSERT( RFC_deinit( &ctx_check ) );
+
+    for( tp = 0; tp < 1 + RFC_TP_SUPPORT; tp++ )
+    {
+        for( j = 0; j < NUMEL(flags); j++ )
+        {
+            ASSERT( RFC_init( &ctx,       class_count, class_width, class_offset, hysteresis, (rfc_flags_e)flags[j] ) );
+            ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, (rfc_flags_e)flags[j] ) );
+#if RFC_TP_SUPPORT
+            if( tp )
+            {
+                ASSERT( RFC_tp_init( &ctx,       /*tp*/ NULL, /*tp_cap*/ 1, /*is_static*/ false ) );
+                ASSERT( RFC_tp_init( &ctx_check, /*tp*/ NULL, /*tp_cap*/ 1, /*is_static*/ false ) );
+            }
+#endif /*RFC_TP_SUPPORT*/
+
+            /* Specialized kernel against generic kernel */
+            ASSERT( ctx.internal.counts_fcn != generic );
+            ctx_check.internal.counts_fcn = generic;
+
+            ASSERT( RFC_feed( &ctx,       data, NUMEL(data) ) );
+            ASSERT( RFC_feed( &ctx_check, data, NUMEL(data) ) );
+            ASSERT( RFC_finalize( &ctx,       /* residual_method */ RFC_RES_NONE ) );
+            ASSERT( RFC_finalize( &ctx_check, /* residual_method */ RFC_RES_NONE ) );
+
+            if( flags[j] & RFC_FLAGS_COUNT_DAMAGE )
+            {
+                ASSERT( ctx.damage > 0.0 );
+            }
+            CHECK_CALL( RFC_ctx_check( &ctx, &ctx_check ) );
+
+            ASSERT( RFC_deinit( &ctx_check ) );
+            ASSERT( RFC_deinit( &ctx ) );
+        }
+    }
+
+    /* Flags changed, kernel is rebound */
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE ) );
+    ASSERT( ctx.internal.counts_fcn != generic );
+    ASSERT( RFC_flags_set( &ctx, RFC_FLAGS_COUNT_MK, /*stack*/ 0, /*overwrite*/ false ) );
+    ASSERT( ctx.internal.counts_fcn == generic );
+    ASSERT( RFC_flags_unset( &ctx, RFC_FLAGS_COUNT_MK, /*stack*/ 0 ) );
+    ASSERT( ctx.internal.counts_fcn != generic );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    PASS();
+}
+
+
+TEST RFC_merge_check( rfc_ctx_s *merged, rfc_ctx_s *ref )
+{
+    unsigned        class_count = ref->class_count;
+    rfc_counts_t    lc_merged   = 0,
+                    lc_ref      = 0;
+    unsigned        i, j;
+
+    /* Exact: state, residue values, interim turning point, extrema, rp and lc (pending crossings included) */
+    ASSERT_EQ( merged->state, ref->state );
+    ASSERT_EQ( merged->internal.pos, ref->internal.pos );
+    ASSERT_EQ( merged->residue_cnt, ref->residue_cnt );
+
+    for( i = 0; i < ref->residue_cnt; i++ )
+    {
+        /* Turning points on tied classes may be kept from an earlier position */
+        ASSERT_EQ( merged->residue[i].value, ref->residue[i].value );
+        ASSERT_EQ( merged->residue[i].cls, ref->residue[i].cls );
+        ASSERT( merged->residue[i].pos <= ref->residue[i].pos );
+    }
+    ASSERT_EQ( merged->residue[i].value, ref->residue[i].value );
+    ASSERT_EQ( merged->residue[i].cls, ref->residue[i].cls );
+    ASSERT_EQ( merged->residue[i].pos, ref->residue[i].pos );
+    ASSERT_MEM_EQ( merged->internal.extrema, ref->internal.extrema, sizeof(ref->internal.extrema) );
+    ASSERT_MEM_EQ( merged->rp, ref->rp, class_count * sizeof(rfc_counts_t) );
+
+    for( i = 0; i < class_count; i++ )
+    {
+        lc_merged += merged->internal.lc_diff[i];
+        lc_ref    += ref->internal.lc_diff[i];
+        ASSERT_EQ( merged->lc[i] + lc_merged, ref->lc[i] + lc_ref );
+    }
+
+    /* Cycles closed on tied classes may be counted transposed */
+    for( i = 0; i < class_count; i++ )
+    {
+        for( j = 0; j < class_count; j++ )
+        {
+            ASSERT_EQ( merged->rfm[ i * class_count + j ] + merged->rfm[ j * class_count + i ],
+                       ref->rfm[ i * class_count + j ]    + ref->rfm[ j * class_count + i ] );
+        }
+    }
+
+    /* Damage up to the order of summation */
+    ASSERT_IN_RANGE( ref->damage, merged->damage, ref->damage * 1e-12 );
+    ASSERT_EQ( merged->damage_multi_count, ref->damage_multi_count );
+
+    for( i = 0; i < ref->damage_multi_count; i++ )
+    {
+        ASSERT_IN_RANGE( ref->damage_multi[i], merged->damage_multi[i], ref->damage_multi[i] * 1e-12 );
+    }
+
+    PASS();
+}
+
+
+TEST RFC_merge_test( void )
+{
+    static
+    RFC_VALUE_TYPE      data[20000];
+    /* Segment bounds, including an empty segment and segments too short to have a turning point */
+    static const size_t cuts[]          = { 0, 5000, 5000, 5001, 5003, NUMEL(data) };
+    static rfc_ctx_s    ctx_seg[NUMEL(cuts) - 1];
+    int                 flags           = RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP | RFC_FLAGS_COUNT_LC;
+    unsigned            class_count     =  100;
+    RFC_VALUE_TYPE      class_width     =  2.5;
+    RFC_VALUE_TYPE      class_offset    = -125.0;
+    RFC_VALUE_TYPE      hysteresis      =  class_width;
+    rfc_ctx_s           ctx_check       = { sizeof(ctx_check) };
+    rfc_wl_param_s      wl[2];
+    unsigned long       seed            =  1;
+    size_t              i, step;
+    int                 tree;
+
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 60.0 * sin( i * 0.01 ) + 40.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 20.0;
+    }
+
+    /* Reference: whole series counted at once */
+    ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, (rfc_flags_e)flags ) );
+    ASSERT( RFC_feed( &ctx_check, data, NUMEL(data) ) );
+
+    /* Segments merged one after another (tree = 0) and pairwise (tree = 1) */
+    for( tree = 0; tree < 2; tree++ )
+    {
+        for( i = 0; i < NUMEL(ctx_seg); i++ )
+        {
+            ctx_seg[i].version = sizeof(rfc_ctx_s);
+            ASSERT( RFC_init( &ctx_seg[i], class_count, class_width, class_offset, hysteresis, (rfc_flags_e)flags ) );
+            ASSERT( RFC_feed( &ctx_seg[i], data + cuts[i], cuts[i+1] - cuts[i] ) );
+        }
+
+        if( tree )
+        {
+            for( step = 1; step < NUMEL(ctx_seg); step *= 2 )
+            {
+                for( i = 0; i + step < NUMEL(ctx_seg); i += 2 * step )
+                {
+                    ASSERT( RFC_merge( &ctx_seg[i], &ctx_seg[i+step] ) );
+                }
+            }
+        }
+        else
+        {
+            for( i = 1; i < NUMEL(ctx_seg); i++ )
+            {
+                ASSERT( RFC_merge( &ctx_seg[0], &ctx_seg[i] ) );
+            }
+        }
+
+        CHECK_CALL( RFC_merge_check( &ctx_seg[0], &ctx_check ) );
+        ASSERT( ctx_check.damage > 0.0 );
+
+        /* Merged context continues like the reference */
+        ASSERT( RFC_finalize( &ctx_seg[0], /* residual_method */ RFC_RES_NONE ) );
+
+        for( i = 0; i < NUMEL(ctx_seg); i++ )
+        {
+            ASSERT( RFC_deinit( &ctx_seg[i] ) );
+        }
+    }
+    ASSERT( RFC_deinit( &ctx_check ) );
+
+    /* Coarse data (many cycles closed on equal classes), split at every position */
+    class_count  =  6;
+    class_width  =  1.0;
+    class_offset = -0.5;
+    hysteresis   =  0.5;
+
+    for( i = 0; i < 600; i++ )
+    {
+        data[i] = (RFC_VALUE_TYPE)( lcg_next( &seed ) % class_count );
+    }
+
+    /* Multi-curve damage is counted on both segments */
+    ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, (rfc_flags_e)flags ) );
+    ASSERT( RFC_wl_init_elementary( &ctx_check, /*sx*/ 2.0, /*nx*/ 1e3, /*k*/ -5.0 ) );
+    ASSERT( RFC_wl_param_get( &ctx_check, &wl[0] ) );
+    ASSERT( RFC_wl_init_modified( &ctx_check, /*sx*/ 1.0, /*nx*/ 1e4, /*k*/ -4.0, /*k2*/ -9.0 ) );
+    ASSERT( RFC_wl_param_get( &ctx_check, &wl[1] ) );
+    ASSERT( RFC_deinit( &ctx_check ) );
+
+    ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, (rfc_flags_e)flags ) );
+    ASSERT( RFC_damage_multi_init( &ctx_check, wl, NUMEL(wl) ) );
+    ASSERT( RFC_feed( &ctx_check, data, 600 ) );
+    ASSERT( ctx_check.damage_multi[0] > 0.0 && ctx_check.damage_multi[1] > 0.0 );
+
+    for( step = 0; step <= 600; step++ )
+    {
+        for( i = 0; i < 2; i++ )
+        {
+            ctx_seg[i].version = sizeof(rfc_ctx_s);
+            ASSERT( RFC_init( &ctx_seg[i], class_count, class_width, class_offset, hysteresis, (rfc_flags_e)flags ) );
+            ASSERT( RFC_damage_multi_init( &ctx_seg[i], wl, NUMEL(wl) ) );
+        }
+
+        ASSERT( RFC_feed( &ctx_seg[0], data, step ) );
+        ASSERT( RFC_feed( &ctx_seg[1], data + step, 600 - step ) );
+        ASSERT( RFC_merge( &ctx_seg[0], &ctx_seg[1] ) );
+        CHECK_CALL( RFC_merge_check( &ctx_seg[0], &ctx_check ) );
+
+        ASSERT( RFC_deinit( &ctx_seg[0] ) );
+        ASSERT( RFC_deinit( &ctx_seg[1] ) );
+    }
+    ASSERT( RFC_deinit( &ctx_check ) );
+
+#if RFC_TP_SUPPORT
+    /* Turning point storage isn't merged */
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, (rfc_flags_e)flags ) );
+    ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, (rfc_flags_e)flags ) );
+    ASSERT( RFC_tp_init( &ctx_check, /*tp*/ NULL, /*tp_cap*/ 128, /*is_static*/ false ) );
+    ASSERT( !RFC_merge( &ctx, &ctx_check ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_UNSUPPORTED );
+    ASSERT( RFC_deinit( &ctx ) );
+    ASSERT( RFC_deinit( &ctx_check ) );
+#endif /*RFC_TP_SUPPORT*/
+
+    /* Invalid arguments */
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, (rfc_flags_e)flags ) );
+    ASSERT( !RFC_merge( &ctx, &ctx ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_INVARG );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, (rfc_flags_e)flags ) );
+    ASSERT( RFC_init( &ctx, class_count, class_width * 2, class_offset, hysteresis, (rfc_flags_e)flags ) );
+    ASSERT( !RFC_merge( &ctx, &ctx_check ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_INVARG );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    /* Multi-curve damage on one side only, or on a different number of curves */
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, (rfc_flags_e)flags ) );
+    ASSERT( RFC_damage_multi_init( &ctx, wl, NUMEL(wl) ) );
+    ASSERT( !RFC_merge( &ctx, &ctx_check ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_INVARG );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, (rfc_flags_e)flags ) );
+    ASSERT( RFC_damage_multi_init( &ctx, wl, NUMEL(wl) ) );
+    ASSERT( RFC_damage_multi_init( &ctx_check, wl, 1 ) );
+    ASSERT( !RFC_merge( &ctx, &ctx_check ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_INVARG );
+    ASSERT( RFC_deinit( &ctx ) );
+    ASSERT( RFC_damage_multi_init( &ctx_check, NULL, 0 ) );
+
+    /* Miner consequent depends on the whole history */
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, (rfc_flags_e)( flags | RFC_FLAGS_COUNT_MK ) ) );
+    ASSERT( RFC_flags_set( &ctx_check, RFC_FLAGS_COUNT_MK, /*stack*/ 0, /*overwrite*/ false ) );
+    ASSERT( !RFC_merge( &ctx, &ctx_check ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_UNSUPPORTED );
+    ASSERT( RFC_deinit( &ctx ) );
+    ASSERT( RFC_deinit( &ctx_check ) );
+
+    PASS();
+}
+
+
+TEST RFC_batch_test( void )
+{
+#define SERIES_COUNT 200
+    static
+    RFC_VALUE_TYPE      data[SERIES_COUNT * 300];
+    static
+    rfc_counts_t        rfm[SERIES_COUNT * 20 * 20];
+    static
+    rfc_counts_t        rp[SERIES_COUNT * 20];
+    const RFC_VALUE_TYPE   *series[SERIES_COUNT];
+    size_t              series_len[SERIES_COUNT];
+    double              damage[SERIES_COUNT];
+    static const unsigned threads[] = { 1, 4, 0 };
+    unsigned            class_count     =  20;
+    RFC_VALUE_TYPE      class_width     =  10.0;
+    RFC_VALUE_TYPE      class_offset    = -100.0;
+    RFC_VALUE_TYPE      hysteresis      =  class_width;
+    rfc_ctx_s           ctx_check       = { sizeof(ctx_check) };
+    unsigned long       seed            =  1;
+    size_t              i, j, offset;
+
+    /* Series of different lengths (including an empty one) */
+    for( i = 0, offset = 0; i < SERIES_COUNT; i++ )
+    {
+        series[i]     = data + offset;
+        series_len[i] = ( i * 37 ) % 300;
+
+        for( j = 0; j < series_len[i]; j++ )
+        {
+            data[offset + j] = 80.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 40.0 + 50.0 * sin( j * 0.1 + i );
+        }
+        offset += series_len[i];
+    }
+
+    /* Prototype context, with a modified Woehler curve */
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP ) );
+    ASSERT( RFC_wl_init_modified( &ctx, /*sx*/ 100.0, /*nx*/ 1e6, /*k*/ -5.0, /*k2*/ -9.0 ) );
+
+    for( i = 0; i < NUMEL(threads); i++ )
+    {
+        memset( damage, 0, sizeof(damage) );
+        memset( rfm, 0, sizeof(rfm) );
+        memset( rp, 0, sizeof(rp) );
+
+        ASSERT( RFC_batch( &ctx, SERIES_COUNT, series, series_len, RFC_RES_REPEATED, threads[i], damage, rfm, rp ) );
+
+        /* Each series counted on its own */
+        for( j = 0; j < SERIES_COUNT; j++ )
+        {
+            ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP ) );
+            ASSERT( RFC_wl_init_modified( &ctx_check, /*sx*/ 100.0, /*nx*/ 1e6, /*k*/ -5.0, /*k2*/ -9.0 ) );
+            ASSERT( RFC_feed( &ctx_check, series[j], series_len[j] ) );
+            ASSERT( RFC_finalize( &ctx_check, RFC_RES_REPEATED ) );
+
+            ASSERT( damage[j] == ctx_check.damage );
+            ASSERT_MEM_EQ( rfm + j * class_count * class_count, ctx_check.rfm, class_count * class_count * sizeof(rfc_counts_t) );
+            ASSERT_MEM_EQ( rp + j * class_count, ctx_check.rp, class_count * sizeof(rfc_counts_t) );
+            ASSERT( RFC_deinit( &ctx_check ) );
+        }
+        ASSERT( damage[SERIES_COUNT - 1] > 0.0 );
+    }
+
+    /* Damage only */
+    ASSERT( RFC_batch( &ctx, SERIES_COUNT, series, series_len, RFC_RES_NONE, /*thread_count*/ 2, damage, /*rfm*/ NULL, /*rp*/ NULL ) );
+    ASSERT( RFC_deinit( &ctx ) );
+
+#if RFC_AT_SUPPORT
+    /* Amplitude transformation of the prototype applies to all series */
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_COUNT_DAMAGE ) );
+    ASSERT( RFC_at_init( &ctx, NULL /* Sa */, NULL /* Sm */, 0 /* count */, 0.3 /* M */, 
+                               0.0 /* Sm_rig */, -1.0 /* R_rig */, true /* R_pinned */, false /* symmetric */ ) );
+    ASSERT( RFC_batch( &ctx, SERIES_COUNT, series, series_len, RFC_RES_NONE, /*thread_count*/ 4, damage, /*rfm*/ NULL, /*rp*/ NULL ) );
+
+    for( j = 0; j < SERIES_COUNT; j++ )
+    {
+        ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_COUNT_DAMAGE ) );
+        ASSERT( RFC_at_init( &ctx_check, NULL /* Sa */, NULL /* Sm */, 0 /* count */, 0.3 /* M */, 
+                                         0.0 /* Sm_rig */, -1.0 /* R_rig */, true /* R_pinned */, false /* symmetric */ ) );
+        ASSERT( RFC_feed( &ctx_check, series[j], series_len[j] ) );
+        ASSERT( RFC_finalize( &ctx_check, RFC_RES_NONE ) );
+        ASSERT( damage[j] == ctx_check.damage );
+        ASSERT( RFC_deinit( &ctx_check ) );
+    }
+    ASSERT( RFC_deinit( &ctx ) );
+#endif /*RFC_AT_SUPPORT*/
+
+#if RFC_AR_SUPPORT
+    /* Class count may differ per series */
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_COUNT_RP | RFC_FLAGS_AUTORESIZE ) );
+    ASSERT( !RFC_batch( &ctx, SERIES_COUNT, series, series_len, RFC_RES_NONE, /*thread_count*/ 0, /*damage*/ NULL, /*rfm*/ NULL, rp ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_UNSUPPORTED );
+    ASSERT( RFC_deinit( &ctx ) );
+#endif /*RFC_AR_SUPPORT*/
+
+#if RFC_TP_SUPPORT
+    /* Turning point storage isn't carried over */
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_COUNT_DAMAGE ) );
+    ASSERT( RFC_tp_init( &ctx, /*tp*/ NULL, /*tp_cap*/ 128, /*is_static*/ false ) );
+    ASSERT( !RFC_batch( &ctx, SERIES_COUNT, series, series_len, RFC_RES_NONE, /*thread_count*/ 0, damage, /*rfm*/ NULL, /*rp*/ NULL ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_UNSUPPORTED );
+    ASSERT( RFC_deinit( &ctx ) );
+#endif /*RFC_TP_SUPPORT*/
+
+    /* No rainflow matrix counted by the prototype */
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_COUNT_DAMAGE ) );
+    ASSERT( !RFC_batch( &ctx, SERIES_COUNT, series, series_len, RFC_RES_NONE, /*thread_count*/ 0, damage, rfm, /*rp*/ NULL ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_INVARG );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    PASS();
+#undef SERIES_COUNT
+}
+
+
+#if RFC_DAMAGE_FAST
+TEST RFC_damage_lut_test( void )
+{
+    static
+    rfc_counts_t        rfm[200 * 200];
+    unsigned            class_counts[] = { 20, 200 };  /* Filled by one worker / several workers */
+    size_t              i, j, k;
+
+    for( k = 0; k < NUMEL(class_counts); k++ )
+    {
+        unsigned    class_count = class_counts[k];
+        double      D_lut, D;
+
+        /* Distinct counts per cycle, to compare sums of damages */
+        for( i = 0; i < class_count; i++ )
+        {
+            for( j = 0; j < class_count; j++ )
+            {
+                rfm[ i * class_count + j ] = ( 1 + ( i * 7 + j * 3 ) % 5 ) * RFC_FULL_CYCLE_INCREMENT;
+            }
+        }
+
+        ASSERT( RFC_init( &ctx, class_count, /*class_width*/ 400.0 / class_count, /*class_offset*/ -200.0, /*hysteresis*/ 1.0, RFC_FLAGS_DEFAULT ) );
+        ASSERT( RFC_wl_init_modified( &ctx, /*sx*/ 100.0, /*nx*/ 1e6, /*k*/ -5.0, /*k2*/ -9.0 ) );
+
+        /* Damage depends on range only */
+        ASSERT_EQ( ctx.damage_lut_stride, 0 );
+        ASSERT_EQ( ctx.damage_lut_size, class_count );
+        ASSERT( RFC_damage_from_rfm( &ctx, &D_lut, rfm ) );
+        ctx.damage_lut_inapt++;
+        ASSERT( RFC_damage_from_rfm( &ctx, &D, rfm ) );
+        ctx.damage_lut_inapt--;
+        ASSERT( D_lut > 0.0 );
+        ASSERT_EQ( D_lut, D );
+
+#if RFC_AT_SUPPORT
+        /* Damage depends on range and mean */
+        ASSERT( RFC_at_init( &ctx, NULL /* Sa */, NULL /* Sm */, 0 /* count */, 0.3 /* M */, 
+                                   0.0 /* Sm_rig */, -1.0 /* R_rig */, true /* R_pinned */, false /* symmetric */ ) );
+        ASSERT_EQ( ctx.damage_lut_stride, class_count );
+        ASSERT_EQ( ctx.damage_lut_size, class_count * class_count );
+        ASSERT( RFC_damage_from_rfm( &ctx, &D_lut, rfm ) );
+        ctx.damage_lut_inapt++;
+        ASSERT( RFC_damage_from_rfm( &ctx, &D, rfm ) );
+        ctx.damage_lut_inapt--;
+        ASSERT( D_lut > 0.0 );
+        ASSERT_EQ( D_lut, D );
+
+        /* Back to range only */
+        ASSERT( RFC_at_init( &ctx, NULL /* Sa */, NULL /* Sm */, 0 /* count */, 0.0 /* M */, 
+                                   0.0 /* Sm_rig */, -1.0 /* R_rig */, true /* R_pinned */, false /* symmetric */ ) );
+        ASSERT_EQ( ctx.damage_lut_stride, 0 );
+        ASSERT_EQ( ctx.damage_lut_size, class_count );
+#endif /*RFC_AT_SUPPORT*/
+
+        ASSERT( RFC_deinit( &ctx ) );
+    }
+
+    PASS();
+}
+
+
+TEST RFC_lut_share_test( void )
+{
+#define CTX_COUNT 3
+    static
+    RFC_VALUE_TYPE      data[1000];
+    rfc_ctx_s           ctxs[CTX_COUNT];
+    rfc_ctx_s           ctx_other       = { sizeof(ctx_other) };
+    rfc_lut_s          *lut             = NULL;
+    unsigned            class_count     =  50;
+    RFC_VALUE_TYPE      class_width     =  4.0;
+    RFC_VALUE_TYPE      class_offset    = -100.0;
+    double              damage_ref;
+    unsigned long       seed            =  1;
+    size_t              i;
+
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 160.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 80.0;
+    }
+
+    /* Prototype and reference result */
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, RFC_FLAGS_DEFAULT ) );
+    ASSERT( RFC_wl_init_modified( &ctx, /*sx*/ 50.0, /*nx*/ 1e6, /*k*/ -5.0, /*k2*/ -9.0 ) );
+#if RFC_AT_SUPPORT
+    ASSERT( RFC_at_init( &ctx, NULL /* Sa */, NULL /* Sm */, 0 /* count */, 0.3 /* M */, 
+                               0.0 /* Sm_rig */, -1.0 /* R_rig */, true /* R_pinned */, false /* symmetric */ ) );
+#endif /*RFC_AT_SUPPORT*/
+    ASSERT( RFC_lut_create( &ctx, &lut ) );
+    ASSERT( lut != NULL );
+    ASSERT( RFC_feed( &ctx, data, NUMEL(data) ) );
+    ASSERT( RFC_finalize( &ctx, RFC_RES_REPEATED ) );
+    damage_ref = ctx.damage;
+    ASSERT( damage_ref > 0.0 );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    /* Contexts with equal parameters share the tables */
+    for( i = 0; i < CTX_COUNT; i++ )
+    {
+        memset( &ctxs[i], 0, sizeof(ctxs[i]) );
+        ctxs[i].version = sizeof(ctxs[i]);
+
+        ASSERT( RFC_init( &ctxs[i], class_count, class_width, class_offset, /*hysteresis*/ class_width, RFC_FLAGS_DEFAULT ) );
+        ASSERT( RFC_wl_init_modified( &ctxs[i], /*sx*/ 50.0, /*nx*/ 1e6, /*k*/ -5.0, /*k2*/ -9.0 ) );
+#if RFC_AT_SUPPORT
+        ASSERT( RFC_at_init( &ctxs[i], NULL /* Sa */, NULL /* Sm */, 0 /* count */, 0.3 /* M */, 
+                                       0.0 /* Sm_rig */, -1.0 /* R_rig */, true /* R_pinned */, false /* symmetric */ ) );
+#endif /*RFC_AT_SUPPORT*/
+        ASSERT( RFC_lut_attach( &ctxs[i], lut ) );
+        ASSERT( ctxs[i].lut == lut );
+        ASSERT( ctxs[i].damage_lut == ctxs[0].damage_lut );
+    }
+
+    /* The creator's reference isn't needed any longer */
+    ASSERT( RFC_lut_release( lut ) );
+
+    for( i = 0; i < CTX_COUNT; i++ )
+    {
+        ASSERT( RFC_feed( &ctxs[i], data, NUMEL(data) ) );
+        ASSERT( RFC_finalize( &ctxs[i], RFC_RES_REPEATED ) );
+        ASSERT_EQ( ctxs[i].damage, damage_ref );
+    }
+
+    /* Parameters differ */
+    ASSERT( RFC_init( &ctx_other, class_count, class_width * 2, class_offset, /*hysteresis*/ class_width, RFC_FLAGS_DEFAULT ) );
+    ASSERT( !RFC_lut_attach( &ctx_other, lut ) );
+    ASSERT_EQ( RFC_error_get( &ctx_other ), RFC_ERROR_INVARG );
+    ASSERT( RFC_deinit( &ctx_other ) );
+
+    /* Copy on write, others keep the shared tables */
+    ASSERT( RFC_deinit( &ctxs[1] ) );
+    ASSERT( RFC_init( &ctxs[1], class_count, class_width, class_offset, /*hysteresis*/ class_width, RFC_FLAGS_DEFAULT ) );
+    ASSERT( RFC_wl_init_modified( &ctxs[1], /*sx*/ 50.0, /*nx*/ 1e6, /*k*/ -5.0, /*k2*/ -9.0 ) );
+#if RFC_AT_SUPPORT
+    ASSERT( RFC_at_init( &ctxs[1], NULL /* Sa */, NULL /* Sm */, 0 /* count */, 0.3 /* M */, 
+                                   0.0 /* Sm_rig */, -1.0 /* R_rig */, true /* R_pinned */, false /* symmetric */ ) );
+#endif /*RFC_AT_SUPPORT*/
+    ASSERT( RFC_lut_attach( &ctxs[1], ctxs[0].lut ) );
+    ASSERT( RFC_wl_init_modified( &ctxs[1], /*sx*/ 50.0, /*nx*/ 1e6, /*k*/ -4.0, /*k2*/ -8.0 ) );
+    ASSERT( ctxs[1].lut == NULL );
+    ASSERT( ctxs[1].damage_lut != ctxs[0].damage_lut );
+    ASSERT( RFC_feed( &ctxs[1], data, NUMEL(data) ) );
+    ASSERT( RFC_finalize( &ctxs[1], RFC_RES_REPEATED ) );
+    ASSERT( ctxs[1].damage != damage_ref );
+    ASSERT( ctxs[2].lut == ctxs[0].lut );
+
+    /* Last context detaching frees the tables */
+    for( i = 0; i < CTX_COUNT; i++ )
+    {
+        ASSERT( RFC_deinit( &ctxs[i] ) );
+    }
+
+    PASS();
+#undef CTX_COUNT
+}
+#endif /*RFC_DAMAGE_FAST*/
+
+
+#if RFC_USE_THREADS && !defined(_WIN32)
+static
+void *snapshot_writer( void *arg )
+{
+    static
+    RFC_VALUE_TYPE  data[200000];
+    rfc_ctx_s      *rfc_ctx = (rfc_ctx_s*)arg;
+    unsigned long   seed    = 2;
+    size_t          i;
+
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 160.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 80.0;
+    }
+
+    /* Feed in chunks, readers take snapshots meanwhile */
+    for( i = 0; i < NUMEL(data); i += 1000 )
+    {
+        if( !RFC_feed( rfc_ctx, data + i, 1000 ) ) return NULL;
+    }
+
+    return RFC_finalize( rfc_ctx, RFC_RES_NONE ) ? arg : NULL;
+}
+#endif /*RFC_USE_THREADS*/
+
+
+TEST RFC_snapshot_test( void )
+{
+    static
+    RFC_VALUE_TYPE      data[10000];
+    static
+    rfc_counts_t        rfm[50 * 50];
+    rfc_counts_t        rp[50], lc[50], lc_check[50];
+    unsigned            class_count     =  50;
+    RFC_VALUE_TYPE      class_width     =  4.0;
+    RFC_VALUE_TYPE      class_offset    = -100.0;
+    double              damage;
+    unsigned long       seed            =  1;
+    size_t              i;
+
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 160.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 80.0;
+    }
+
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, RFC_FLAGS_DEFAULT ) );
+
+    /* Not enabled */
+    ASSERT( !RFC_snapshot( &ctx, &damage, NULL, NULL, NULL ) );
+    ASSERT( RFC_snapshot_enable( &ctx ) );
+    ASSERT( ctx.snapshot_seq != NULL );
+
+    /* Results as counted so far */
+    ASSERT( RFC_feed( &ctx, data, NUMEL(data) / 2 ) );
+    ASSERT( RFC_snapshot( &ctx, &damage, rfm, rp, lc ) );
+    ASSERT( damage > 0.0 );
+    ASSERT_EQ( damage, ctx.damage );
+    ASSERT_MEM_EQ( rfm, ctx.rfm, class_count * class_count * sizeof(rfc_counts_t) );
+    ASSERT_MEM_EQ( rp, ctx.rp, class_count * sizeof(rfc_counts_t) );
+    /* Level crossings are completed lazily */
+    ASSERT( RFC_lc_get( &ctx, lc_check, /*level*/ NULL ) );
+    ASSERT_MEM_EQ( lc, lc_check, class_count * sizeof(rfc_counts_t) );
+    ASSERT_MEM_EQ( lc, ctx.lc, class_count * sizeof(rfc_counts_t) );
+    ASSERT_EQ( *ctx.snapshot_seq % 2, 0 );
+
+    ASSERT( RFC_feed( &ctx, data + NUMEL(data) / 2, NUMEL(data) - NUMEL(data) / 2 ) );
+    ASSERT( RFC_finalize( &ctx, RFC_RES_REPEATED ) );
+    ASSERT( RFC_snapshot( &ctx, &damage, NULL, NULL, NULL ) );
+    ASSERT_EQ( damage, ctx.damage );
+    ASSERT_EQ( *ctx.snapshot_seq % 2, 0 );
+    ASSERT( RFC_deinit( &ctx ) );
+
+#if RFC_USE_THREADS && !defined(_WIN32)
+    /* One writer, snapshots are consistent while counting */
+    do
+    {
+        pthread_t   writer;
+        void       *result;
+        double      damage_last = 0.0;
+        int         snapshots   = 0;
+
+        ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, 
+                          RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_RP | RFC_FLAGS_COUNT_DAMAGE ) );
+        ASSERT( RFC_snapshot_enable( &ctx ) );
+        ASSERT_EQ( pthread_create( &writer, NULL, snapshot_writer, &ctx ), 0 );
+
+        while( snapshots < 2000 )
+        {
+            double rfm_sum = 0.0, rp_sum = 0.0;
+
+            ASSERT( RFC_snapshot( &ctx, &damage, rfm, rp, /*lc*/ NULL ) );
+
+            /* Each cycle counted in rfm and rp alike */
+            for( i = 0; i < class_count * class_count; i++ ) rfm_sum += rfm[i];
+            for( i = 0; i < class_count; i++ )               rp_sum  += rp[i];
+            ASSERT_EQ( rfm_sum, rp_sum );
+            ASSERT( damage >= damage_last );
+
+            damage_last = damage;
+            snapshots++;
+        }
+
+        ASSERT_EQ( pthread_join( writer, &result ), 0 );
+        ASSERT( result != NULL );
+        ASSERT( RFC_snapshot( &ctx, &damage, rfm, /*rp*/ NULL, /*lc*/ NULL ) );
+        ASSERT_EQ( damage, ctx.damage );
+        ASSERT_MEM_EQ( rfm, ctx.rfm, class_count * class_count * sizeof(rfc_counts_t) );
+        ASSERT( RFC_deinit( &ctx ) );
+    } while(0);
+#endif /*RFC_USE_THREADS*/
+
+    PASS();
+}
+
+
+TEST RFC_checkpoint_test( void )
+{
+    static
+    RFC_VALUE_TYPE      data[10000];
+    static
+    unsigned char       blob[32768];
+    static
+    rfc_counts_t        rfm[50 * 50];
+    rfc_counts_t        rp[50], lc[50];
+    rfc_wl_param_s      wl, wl_live;
+    int                 methods[]       = { RFC_COUNTING_METHOD_4PTM,
+#if RFC_HCM_SUPPORT
+                                            RFC_COUNTING_METHOD_HCM,
+#endif /*RFC_HCM_SUPPORT*/
+                                          };
+    int                 flags           = RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP | RFC_FLAGS_COUNT_LC | RFC_FLAGS_COUNT_MK;
+    unsigned            class_count     =  50;
+    RFC_VALUE_TYPE      class_width     =  4.0;
+    RFC_VALUE_TYPE      class_offset    = -100.0;
+    double              damage;
+    unsigned long       seed            =  1;
+    size_t              size, i, m;
+
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 160.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 80.0;
+    }
+
+    for( m = 0; m < NUMEL(methods); m++ )
+    {
+        /* Uninterrupted run */
+        ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+        ASSERT( RFC_wl_init_modified( &ctx, /*sx*/ 50.0, /*nx*/ 1e6, /*k*/ -5.0, /*k2*/ -9.0 ) );
+        ctx.counting_method = (rfc_counting_method_e)methods[m];
+        ASSERT( RFC_feed( &ctx, data, NUMEL(data) ) );
+        ASSERT( RFC_finalize( &ctx, RFC_RES_REPEATED ) );
+        damage = ctx.damage;
+        memcpy( rfm, ctx.rfm, sizeof(rfm) );
+        memcpy( rp, ctx.rp, sizeof(rp) );
+        memcpy( lc, ctx.lc, sizeof(lc) );
+        wl = ctx.internal.wl;
+        ASSERT( damage > 0.0 );
+        ASSERT( wl.D > 0.0 && wl.sx < 50.0 );
+        ASSERT( RFC_deinit( &ctx ) );
+
+        /* Interrupted after an odd number of samples */
+        ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+        ASSERT( RFC_wl_init_modified( &ctx, /*sx*/ 50.0, /*nx*/ 1e6, /*k*/ -5.0, /*k2*/ -9.0 ) );
+        ctx.counting_method = (rfc_counting_method_e)methods[m];
+        ASSERT( RFC_feed( &ctx, data, 3777 ) );
+        ASSERT( ctx.internal.mk.pending );
+        wl_live = ctx.internal.wl;
+        ASSERT( RFC_checkpoint_write( &ctx, NULL, &size ) );
+        ASSERT( size <= sizeof(blob) );
+        size--;
+        ASSERT( !RFC_checkpoint_write( &ctx, blob, &size ) );
+        ASSERT( RFC_checkpoint_write( &ctx, blob, &size ) );
+        /* Live context isn't modified */
+        ASSERT( ctx.internal.mk.pending );
+        ASSERT_MEM_EQ( &ctx.internal.wl, &wl_live, sizeof(wl_live) );
+        ASSERT( RFC_deinit( &ctx ) );
+
+        /* Restarted */
+        ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+        ASSERT( RFC_wl_init_modified( &ctx, /*sx*/ 50.0, /*nx*/ 1e6, /*k*/ -5.0, /*k2*/ -9.0 ) );
+        ctx.counting_method = (rfc_counting_method_e)methods[m];
+        ASSERT( RFC_checkpoint_read( &ctx, blob, size ) );
+        ASSERT( RFC_feed( &ctx, data + 3777, NUMEL(data) - 3777 ) );
+        ASSERT( RFC_finalize( &ctx, RFC_RES_REPEATED ) );
+        ASSERT_EQ( ctx.damage, damage );
+        ASSERT_MEM_EQ( ctx.rfm, rfm, sizeof(rfm) );
+        ASSERT_MEM_EQ( ctx.rp, rp, sizeof(rp) );
+        ASSERT_MEM_EQ( ctx.lc, lc, sizeof(lc) );
+        /* Impaired Woehler curve (Miner consequent) */
+        ASSERT_IN_RANGE( 1.0, ctx.internal.wl.D  / wl.D,  1e-12 );
+        ASSERT_IN_RANGE( 1.0, ctx.internal.wl.sx / wl.sx, 1e-12 );
+        ASSERT_IN_RANGE( 1.0, ctx.internal.wl.nx / wl.nx, 1e-12 );
+        ASSERT( RFC_deinit( &ctx ) );
+    }
+
+    /* Parameters differ */
+    ASSERT( RFC_init( &ctx, class_count, class_width * 2, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    ASSERT( !RFC_checkpoint_read( &ctx, blob, size ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_INVARG );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    /* Foreign byte order and truncated checkpoints */
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    ASSERT( !RFC_checkpoint_read( &ctx, blob, size - 1 ) );
+    ASSERT( RFC_deinit( &ctx ) );
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    blob[4] ^= 0xff;
+    ASSERT( !RFC_checkpoint_read( &ctx, blob, size ) );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    PASS();
+}
+
+
+#if RFC_TP_SUPPORT
+TEST RFC_tp_mapped_test( void )
+{
+    static
+    RFC_VALUE_TYPE      data[50000];
+    static
+    rfc_value_tuple_s   tp_file[50000];
+    const char         *filename        = "tp_mapped.bin";
+    rfc_ctx_s           ctx_mem         = { sizeof(ctx_mem) };
+    unsigned            class_count     =  50;
+    RFC_VALUE_TYPE      class_width     =  4.0;
+    RFC_VALUE_TYPE      class_offset    = -100.0;
+    FILE               *file;
+    size_t              tp_cnt;
+    unsigned long       seed            =  1;
+    size_t              i;
+
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 160.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 80.0;
+    }
+
+    /* Same series, turning points in memory and in a mapped file */
+    ASSERT( RFC_init( &ctx_mem, class_count, class_width, class_offset, /*hysteresis*/ class_width, RFC_FLAGS_COUNT_ALL ) );
+    ASSERT( RFC_tp_init( &ctx_mem, /*tp*/ NULL, /*tp_cap*/ 128, /*is_static*/ false ) );
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, RFC_FLAGS_COUNT_ALL ) );
+    ASSERT( RFC_tp_init_mapped( &ctx, filename, /*tp_cap*/ 128 ) );
+    ASSERT( !RFC_tp_init( &ctx, /*tp*/ NULL, /*tp_cap*/ 128, /*is_static*/ false ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_INVARG );
+    ASSERT( RFC_deinit( &ctx ) );
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, RFC_FLAGS_COUNT_ALL ) );
+    ASSERT( RFC_tp_init_mapped( &ctx, filename, /*tp_cap*/ 128 ) );
+#if RFC_DH_SUPPORT
+    ASSERT( RFC_dh_init( &ctx_mem, RFC_SD_HALF_23, /*dh*/ NULL, /*dh_cap*/ 0, /*is_static*/ false ) );
+    ASSERT( RFC_dh_init( &ctx, RFC_SD_HALF_23, /*dh*/ NULL, /*dh_cap*/ 0, /*is_static*/ false ) );
+#endif /*RFC_DH_SUPPORT*/
+
+    ASSERT( RFC_feed( &ctx_mem, data, NUMEL(data) ) );
+    ASSERT( RFC_finalize( &ctx_mem, RFC_RES_REPEATED ) );
+    ASSERT( RFC_feed( &ctx, data, NUMEL(data) ) );
+    ASSERT( RFC_finalize( &ctx, RFC_RES_REPEATED ) );
+
+    /* Storage has grown page-wise */
+    tp_cnt = ctx.tp_cnt;
+    ASSERT( tp_cnt > 128 && tp_cnt <= NUMEL(tp_file) );
+    ASSERT( ctx.tp_cap >= tp_cnt );
+    ASSERT_EQ( ctx_mem.tp_cnt, tp_cnt );
+    ASSERT_EQ( ctx.damage, ctx_mem.damage );
+    ASSERT_MEM_EQ( ctx.tp, ctx_mem.tp, tp_cnt * sizeof(rfc_value_tuple_s) );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    /* File holds the turning points only */
+    file = fopen( filename, "rb" );
+    ASSERT( file != NULL );
+    ASSERT_EQ( fread( tp_file, sizeof(rfc_value_tuple_s), NUMEL(tp_file), file ), tp_cnt );
+    fclose( file );
+    remove( filename );
+    ASSERT_MEM_EQ( tp_file, ctx_mem.tp, tp_cnt * sizeof(rfc_value_tuple_s) );
+    ASSERT( RFC_deinit( &ctx_mem ) );
+
+    PASS();
+}
+#endif /*RFC_TP_SUPPORT*/
+
+#if RFC_DH_SUPPORT
+TEST RFC_dh_mapped_test( void )
+{
+    static
+    RFC_VALUE_TYPE      data[50000];
+    static
+    double              dh_file[50000];
+    const char         *filename        = "dh_mapped.bin";
+    rfc_ctx_s           ctx_mem         = { sizeof(ctx_mem) };
+#if RFC_TP_SUPPORT
+    rfc_sd_method_e     method          =  RFC_SD_TRANSIENT_23;
+#else /*!RFC_TP_SUPPORT*/
+    rfc_sd_method_e     method          =  RFC_SD_HALF_23;  /* Transient spreading needs turning point positions on finalize */
+#endif /*RFC_TP_SUPPORT*/
+    unsigned            class_count     =  50;
+    RFC_VALUE_TYPE      class_width     =  4.0;
+    RFC_VALUE_TYPE      class_offset    = -100.0;
+    const double       *dh;
+    size_t              dh_cnt;
+    FILE               *file;
+    unsigned long       seed            =  1;
+    size_t              i;
+
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 160.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 80.0;
+    }
+
+    /* Same series, damage history in memory and in a mapped file */
+    ASSERT( RFC_init( &ctx_mem, class_count, class_width, class_offset, /*hysteresis*/ class_width, RFC_FLAGS_COUNT_ALL ) );
+    ASSERT( RFC_dh_init( &ctx_mem, method, /*dh*/ NULL, /*dh_cap*/ 128, /*is_static*/ false ) );
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, RFC_FLAGS_COUNT_ALL ) );
+    ASSERT( RFC_dh_init_mapped( &ctx, method, filename, /*dh_cap*/ 128 ) );
+    ASSERT( !RFC_dh_init_mapped( &ctx, method, filename, /*dh_cap*/ 128 ) );
+    ASSERT_EQ( RFC_error_get( &ctx ), RFC_ERROR_INVARG );
+    ASSERT( RFC_deinit( &ctx ) );
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, RFC_FLAGS_COUNT_ALL ) );
+    ASSERT( RFC_dh_init_mapped( &ctx, method, filename, /*dh_cap*/ 128 ) );
+
+    /* Storage grows page-wise, transient spreading reads back and forth */
+    ASSERT( RFC_feed( &ctx_mem, data, NUMEL(data) ) );
+    ASSERT( RFC_feed( &ctx, data, NUMEL(data) ) );
+    ASSERT( RFC_finalize( &ctx_mem, RFC_RES_REPEATED ) );
+    ASSERT( RFC_finalize( &ctx, RFC_RES_REPEATED ) );
+
+    ASSERT( RFC_dh_get( &ctx, &dh, &dh_cnt ) );
+    ASSERT_EQ( dh_cnt, NUMEL(data) );
+    ASSERT_EQ( dh_cnt, ctx_mem.dh_cnt );
+    ASSERT( ctx.dh_cap >= dh_cnt );
+    ASSERT_EQ( ctx.damage, ctx_mem.damage );
+    ASSERT_MEM_EQ( dh, ctx_mem.dh, dh_cnt * sizeof(double) );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    /* File holds the damage history only */
+    file = fopen( filename, "rb" );
+    ASSERT( file != NULL );
+    ASSERT_EQ( fread( dh_file, sizeof(double), NUMEL(dh_file), file ), dh_cnt );
+    fclose( file );
+    remove( filename );
+    ASSERT_MEM_EQ( dh_file, ctx_mem.dh, dh_cnt * sizeof(double) );
+    ASSERT( RFC_deinit( &ctx_mem ) );
+
+    PASS();
+}
+#endif /*RFC_DH_SUPPORT*/
+
+TEST RFC_rfm_sparse_test( void )
+{
+    static
+    RFC_VALUE_TYPE      data[100000];
+    rfc_ctx_s           ctx_dense       = { sizeof(ctx_dense) };
+    rfc_rfm_item_s     *items[2]        = { NULL, NULL };
+    unsigned            count[2]        = { 0, 0 };
+    static
+    rfc_counts_t        rp[2][1024], lc[2][1024];
+    rfc_counts_t        sum[2], counts[2];
+    double              damage[2];
+    int                 flags           = RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP | RFC_FLAGS_COUNT_LC;
+    unsigned            class_count     =  1024;
+    RFC_VALUE_TYPE      class_width     =  0.25;
+    RFC_VALUE_TYPE      class_offset    = -128.0;
+    size_t              size;
+    unsigned long       seed            =  1;
+    size_t              i;
+
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 100.0 * sin( i * 0.01 ) + 20.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 10.0;
+    }
+
+    /* Same series, dense and sparse matrix */
+    ASSERT( RFC_init( &ctx_dense, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)( flags | RFC_FLAGS_SPARSE_RFM ) ) );
+    ASSERT( !ctx.rfm && ctx.rfm_sparse );
+    ASSERT( RFC_feed( &ctx_dense, data, NUMEL(data) ) );
+    ASSERT( RFC_finalize( &ctx_dense, RFC_RES_REPEATED ) );
+    ASSERT( RFC_feed( &ctx, data, NUMEL(data) ) );
+    ASSERT( RFC_finalize( &ctx, RFC_RES_REPEATED ) );
+
+    ASSERT_EQ( ctx.damage, ctx_dense.damage );
+    ASSERT_MEM_EQ( ctx.rp, ctx_dense.rp, class_count * sizeof(rfc_counts_t) );
+    ASSERT_MEM_EQ( ctx.lc, ctx_dense.lc, class_count * sizeof(rfc_counts_t) );
+
+    /* Elements are returned in row-major order, as from the dense matrix */
+    ASSERT( RFC_rfm_get( &ctx_dense, &items[0], &count[0] ) );
+    ASSERT( RFC_rfm_get( &ctx, &items[1], &count[1] ) );
+    ASSERT_EQ( count[1], count[0] );
+    ASSERT( count[1] > 0 && count[1] < class_count * class_count / 20 );
+    ASSERT_MEM_EQ( items[1], items[0], count[0] * sizeof(rfc_rfm_item_s) );
+    ASSERT( RFC_rfm_non_zeros( &ctx, &count[1] ) );
+    ASSERT_EQ( count[1], count[0] );
+    ASSERT( RFC_rfm_check( &ctx ) );
+
+    /* Results derived from the matrix */
+    ASSERT( RFC_lc_from_rfm( &ctx_dense, lc[0], /*level*/ NULL, /*rfm*/ NULL, RFC_FLAGS_COUNT_LC ) );
+    ASSERT( RFC_lc_from_rfm( &ctx, lc[1], /*level*/ NULL, /*rfm*/ NULL, RFC_FLAGS_COUNT_LC ) );
+    ASSERT_MEM_EQ( lc[1], lc[0], class_count * sizeof(rfc_counts_t) );
+    ASSERT( RFC_rp_from_rfm( &ctx_dense, rp[0], /*Sa*/ NULL, /*rfm*/ NULL ) );
+    ASSERT( RFC_rp_from_rfm( &ctx, rp[1], /*Sa*/ NULL, /*rfm*/ NULL ) );
+    ASSERT_MEM_EQ( rp[1], rp[0], class_count * sizeof(rfc_counts_t) );
+    ASSERT( RFC_damage_from_rfm( &ctx_dense, &damage[0], /*rfm*/ NULL ) );
+    ASSERT( RFC_damage_from_rfm( &ctx, &damage[1], /*rfm*/ NULL ) );
+    ASSERT( damage[0] > 0.0 );
+    ASSERT_IN_RANGE( 1.0, damage[1] / damage[0], 1e-12 );
+    ASSERT( RFC_rfm_sum( &ctx_dense, 100, 600, 200, 900, &sum[0] ) );
+    ASSERT( RFC_rfm_sum( &ctx, 100, 600, 200, 900, &sum[1] ) );
+    ASSERT( sum[0] > 0 );
+    ASSERT_EQ( sum[1], sum[0] );
+    ASSERT( RFC_rfm_damage( &ctx_dense, 100, 600, 200, 900, &damage[0] ) );
+    ASSERT( RFC_rfm_damage( &ctx, 100, 600, 200, 900, &damage[1] ) );
+    ASSERT_IN_RANGE( 1.0, damage[1] / damage[0], 1e-12 );
+
+    /* Single elements */
+    ASSERT( RFC_rfm_peek( &ctx, -100.0, 100.0, &counts[1] ) );
+    ASSERT( RFC_rfm_poke( &ctx, -100.0, 100.0, counts[1] + 3, /*add_only*/ false ) );
+    ASSERT( RFC_rfm_poke( &ctx, -100.0, 100.0, 2, /*add_only*/ true ) );
+    ASSERT( RFC_rfm_peek( &ctx, -100.0, 100.0, &counts[0] ) );
+    ASSERT_EQ( counts[0], counts[1] + 5 );
+    ASSERT( RFC_rfm_poke( &ctx, -100.0, 100.0, counts[1], /*add_only*/ false ) );
+
+    /* Symmetric */
+    ASSERT( RFC_rfm_make_symmetric( &ctx_dense ) );
+    ASSERT( RFC_rfm_make_symmetric( &ctx ) );
+    ASSERT( RFC_rfm_get( &ctx_dense, &items[0], &count[0] ) );
+    ASSERT( RFC_rfm_get( &ctx, &items[1], &count[1] ) );
+    ASSERT_EQ( count[1], count[0] );
+    ASSERT_MEM_EQ( items[1], items[0], count[0] * sizeof(rfc_rfm_item_s) );
+
+    /* No checkpoints of sparse matrices */
+    ASSERT( !RFC_checkpoint_write( &ctx, NULL, &size ) );
+
+    ASSERT( RFC_clear_counts( &ctx ) );
+    ASSERT( RFC_rfm_non_zeros( &ctx, &count[1] ) );
+    ASSERT_EQ( count[1], 0 );
+
+    ctx.mem_alloc( items[0], 0, 0, RFC_MEM_AIM_RFM_ELEMENTS );
+    ctx.mem_alloc( items[1], 0, 0, RFC_MEM_AIM_RFM_ELEMENTS );
+    ASSERT( RFC_deinit( &ctx_dense ) );
+    ASSERT( RFC_deinit( &ctx ) );
+    ASSERT( !ctx.rfm_sparse );
+
+    PASS();
+}
+
+
+TEST RFC_class_count_large_test( void )
+{
+    static
+    RFC_VALUE_TYPE      data[10000];
+    rfc_ctx_s           ctx_dense       = { sizeof(ctx_dense) };
+    unsigned            count[2]        = { 0, 0 };
+    int                 flags           = RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE;
+    RFC_VALUE_TYPE      class_width     =  0.25;
+    RFC_VALUE_TYPE      class_offset    = -128.0;
+    unsigned long       seed            =  1;
+    size_t              i;
+
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 50.0 * sin( i * 0.01 ) + 20.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 10.0;
+    }
+
+    /* Beyond the dense limit, the matrix is sparse and 2D damage tables are paged */
+    ASSERT( RFC_init( &ctx_dense, RFC_CLASS_COUNT_DENSE_MAX, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    ASSERT( RFC_init( &ctx, 16 * RFC_CLASS_COUNT_DENSE_MAX, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    ASSERT( !ctx.rfm && ctx.rfm_sparse );
+#if RFC_AT_SUPPORT
+    ASSERT( RFC_at_init( &ctx_dense, NULL /* Sa */, NULL /* Sm */, 0 /* count */, 0.3 /* M */, 
+                                     0.0 /* Sm_rig */, -1.0 /* R_rig */, true /* R_pinned */, false /* symmetric */ ) );
+    ASSERT( RFC_at_init( &ctx, NULL /* Sa */, NULL /* Sm */, 0 /* count */, 0.3 /* M */, 
+                               0.0 /* Sm_rig */, -1.0 /* R_rig */, true /* R_pinned */, false /* symmetric */ ) );
+#if RFC_DAMAGE_FAST
+    ASSERT( !ctx_dense.damage_lut_pages && ctx.damage_lut_pages );
+#endif /*RFC_DAMAGE_FAST*/
+#endif /*RFC_AT_SUPPORT*/
+    ASSERT( RFC_feed( &ctx_dense, data, NUMEL(data) ) );
+    ASSERT( RFC_finalize( &ctx_dense, RFC_RES_REPEATED ) );
+    ASSERT( RFC_feed( &ctx, data, NUMEL(data) ) );
+    ASSERT( RFC_finalize( &ctx, RFC_RES_REPEATED ) );
+
+    ASSERT( ctx_dense.damage > 0.0 );
+    ASSERT_IN_RANGE( 1.0, ctx.damage / ctx_dense.damage, 1e-12 );
+    ASSERT( RFC_rfm_non_zeros( &ctx_dense, &count[0] ) );
+    ASSERT( RFC_rfm_non_zeros( &ctx, &count[1] ) );
+    ASSERT_EQ( count[1], count[0] );
+
+#if RFC_AT_SUPPORT && RFC_DAMAGE_FAST
+    /* Pages touched only */
+    count[1] = 0;
+    for( i = 0; i < (size_t)ctx.damage_lut_pages_dim * ctx.damage_lut_pages_dim; i++ )
+    {
+        if( ctx.damage_lut_pages[i] ) count[1]++;
+    }
+    ASSERT( count[1] > 0 && count[1] < 100 );
+#endif /*RFC_AT_SUPPORT && RFC_DAMAGE_FAST*/
+
+    ASSERT( RFC_deinit( &ctx_dense ) );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    ASSERT( !RFC_init( &ctx, RFC_CLASS_COUNT_MAX + 1, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    ASSERT( RFC_deinit( &ctx ) );
+
+#if RFC_AR_SUPPORT
+    /* Autoresize beyond the dense limit continues sparse */
+    class_width = 0.1;
+    ASSERT( RFC_init( &ctx_dense, 2 * RFC_CLASS_COUNT_DENSE_MAX, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    ASSERT( RFC_init( &ctx, RFC_CLASS_COUNT_DENSE_MAX, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    ASSERT( ctx.rfm && !ctx.rfm_sparse );
+    ASSERT( RFC_flags_set( &ctx, RFC_FLAGS_AUTORESIZE, /* stack */ 0, /* overwrite */ false ) );
+    ASSERT( RFC_feed( &ctx_dense, data, NUMEL(data) ) );
+    ASSERT( RFC_finalize( &ctx_dense, RFC_RES_REPEATED ) );
+    ASSERT( RFC_feed( &ctx, data, NUMEL(data) ) );
+    ASSERT( RFC_finalize( &ctx, RFC_RES_REPEATED ) );
+    ASSERT( ctx.class_count > RFC_CLASS_COUNT_DENSE_MAX );
+    ASSERT( !ctx.rfm && ctx.rfm_sparse );
+
+    ASSERT_IN_RANGE( 1.0, ctx.damage / ctx_dense.damage, 1e-12 );
+    ASSERT( RFC_rfm_non_zeros( &ctx_dense, &count[0] ) );
+    ASSERT( RFC_rfm_non_zeros( &ctx, &count[1] ) );
+    ASSERT_EQ( count[1], count[0] );
+
+    ASSERT( RFC_deinit( &ctx_dense ) );
+    ASSERT( RFC_deinit( &ctx ) );
+#endif /*RFC_AR_SUPPORT*/
+
+    PASS();
+}
+
+
+TEST RFC_rfm_sat_test( void )
+{
+    static
+    RFC_VALUE_TYPE      data[20000];
+    rfc_ctx_s           ctx_direct      = { sizeof(ctx_direct) };
+    rfc_counts_t        sum[2];
+    double              damage[2];
+    int                 flags           = RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE;
+    unsigned            class_count     =  100;
+    RFC_VALUE_TYPE      class_width     =  2.0;
+    RFC_VALUE_TYPE      class_offset    = -100.0;
+    unsigned long       seed            =  1;
+    unsigned            from, to, n;
+    size_t              i;
+
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 80.0 * sin( i * 0.01 ) + 30.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 15.0;
+    }
+
+    ASSERT( RFC_init( &ctx_direct, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    ASSERT( RFC_rfm_sat_enable( &ctx, true ) );
+
+    /* Live, rows touched by new cycles are rebuilt on next query */
+    for( n = 0; n < 2; n++ )
+    {
+        ASSERT( RFC_feed( &ctx_direct, data + n * NUMEL(data) / 2, NUMEL(data) / 2 ) );
+        ASSERT( RFC_feed( &ctx, data + n * NUMEL(data) / 2, NUMEL(data) / 2 ) );
+        ASSERT( ctx.damage > 0.0 );
+
+        for( from = 0; from + 1 < class_count; from += 7 )
+        {
+            for( to = 0; to + 1 < class_count; to += 5 )
+            {
+                unsigned from_last = from + 1 + ( from * 3 + to ) % ( class_count - from - 1 );
+                unsigned to_last   = to   + 1 + ( to * 3 + from ) % ( class_count - to   - 1 );
+
+                ASSERT( RFC_rfm_sum( &ctx_direct, from, from_last, to, to_last, &sum[0] ) );
+                ASSERT( RFC_rfm_sum( &ctx, from, from_last, to, to_last, &sum[1] ) );
+                ASSERT_EQ( sum[1], sum[0] );
+                ASSERT( RFC_rfm_damage( &ctx_direct, from, from_last, to, to_last, &damage[0] ) );
+                ASSERT( RFC_rfm_damage( &ctx, from, from_last, to, to_last, &damage[1] ) );
+                ASSERT( fabs( damage[1] - damage[0] ) <= 1e-12 * ctx.damage );
+            }
+        }
+    }
+    ASSERT( ctx.internal.rfm_sat.counts && ctx.internal.rfm_sat.rows > 0 );
+
+    /* Single elements changed */
+    ASSERT( RFC_rfm_poke( &ctx_direct, -50.0, 50.0, 1000, /*add_only*/ true ) );
+    ASSERT( RFC_rfm_poke( &ctx, -50.0, 50.0, 1000, /*add_only*/ true ) );
+    ASSERT( RFC_rfm_sum( &ctx_direct, 0, class_count - 1, 0, class_count - 1, &sum[0] ) );
+    ASSERT( RFC_rfm_sum( &ctx, 0, class_count - 1, 0, class_count - 1, &sum[1] ) );
+    ASSERT_EQ( sum[1], sum[0] );
+    ASSERT( RFC_rfm_damage( &ctx_direct, 0, class_count - 1, 0, class_count - 1, &damage[0] ) );
+    ASSERT( RFC_rfm_damage( &ctx, 0, class_count - 1, 0, class_count - 1, &damage[1] ) );
+    ASSERT( fabs( damage[1] - damage[0] ) <= 1e-12 * damage[0] );
+
+    ASSERT( RFC_clear_counts( &ctx ) );
+    ASSERT( RFC_rfm_sum( &ctx, 0, class_count - 1, 0, class_count - 1, &sum[1] ) );
+    ASSERT_EQ( sum[1], 0 );
+
+    ASSERT( RFC_deinit( &ctx_direct ) );
+    ASSERT( RFC_deinit( &ctx ) );
+    ASSERT( !ctx.internal.rfm_sat.counts && !ctx.internal.rfm_sat.damage );
+
+    /* Dense matrix needed */
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)( flags | RFC_FLAGS_SPARSE_RFM ) ) );
+    ASSERT( !RFC_rfm_sat_enable( &ctx, true ) );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    PASS();
+}
+
+
+TEST RFC_cycle_weighted_test( void )
+{
+    static
+    RFC_VALUE_TYPE      data[10000];
+    rfc_ctx_s           ctx_check       = { sizeof(ctx_check) };
+    rfc_rfm_item_s     *items           = NULL;
+    unsigned            count           = 0;
+    static
+    rfc_counts_t        lc[2][100];
+    int                 flags           = RFC_FLAGS_COUNT_RFM | RFC_FLAGS_COUNT_DAMAGE | RFC_FLAGS_COUNT_RP | RFC_FLAGS_COUNT_LC;
+    unsigned            class_count     =  100;
+    RFC_VALUE_TYPE      class_width     =  2.0;
+    RFC_VALUE_TYPE      class_offset    = -100.0;
+    unsigned long       seed            =  1;
+    rfc_counts_t        j;
+    size_t              i;
+
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 80.0 * sin( i * 0.01 ) + 30.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 15.0;
+    }
+
+    /* Weighted cycles count as repeated single cycles */
+    ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    for( j = 0; j < 1000; j++ )
+    {
+        ASSERT( RFC_cycle_process_counts( &ctx_check, -50.0, 30.0, (rfc_flags_e)flags ) );
+    }
+    ASSERT( RFC_cycle_process_counts_weighted( &ctx, -50.0, 30.0, (rfc_flags_e)flags, 1000 ) );
+    ASSERT( RFC_cycle_process_counts_weighted( &ctx, -50.0, 30.0, (rfc_flags_e)flags, 0 ) );
+    ASSERT_MEM_EQ( ctx.rfm, ctx_check.rfm, class_count * class_count * sizeof(rfc_counts_t) );
+    ASSERT_MEM_EQ( ctx.rp, ctx_check.rp, class_count * sizeof(rfc_counts_t) );
+    ASSERT( RFC_lc_get( &ctx_check, lc[0], /*level*/ NULL ) );
+    ASSERT( RFC_lc_get( &ctx, lc[1], /*level*/ NULL ) );
+    ASSERT_MEM_EQ( lc[1], lc[0], class_count * sizeof(rfc_counts_t) );
+    ASSERT( ctx_check.damage > 0.0 );
+    ASSERT_IN_RANGE( 1.0, ctx.damage / ctx_check.damage, 1e-12 );
+    ASSERT( RFC_deinit( &ctx_check ) );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    /* Refeed, each matrix element at once */
+    ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, /*hysteresis*/ class_width, (rfc_flags_e)flags ) );
+    ASSERT( RFC_feed( &ctx, data, NUMEL(data) ) );
+    ASSERT( RFC_rfm_poke( &ctx, -90.0, 90.0, 100000000 * ctx.full_inc, /*add_only*/ true ) );
+    ASSERT( RFC_rfm_get( &ctx, &items, &count ) );
+    ASSERT( count > 0 );
+    for( i = 0; i < count; i++ )
+    {
+        rfc_value_t from = class_width * items[i].from + class_offset + class_width / 2;
+        rfc_value_t to   = class_width * items[i].to   + class_offset + class_width / 2;
+
+        if( items[i].counts > 1000 * ctx.full_inc )
+        {
+            ASSERT( RFC_cycle_process_counts_weighted( &ctx_check, from, to, (rfc_flags_e)flags, items[i].counts / ctx.full_inc ) );
+        }
+        else for( j = 0; j < items[i].counts; j += ctx.full_inc )
+        {
+            ASSERT( RFC_cycle_process_counts( &ctx_check, from, to, (rfc_flags_e)flags ) );
+        }
+    }
+    ctx.mem_alloc( items, 0, 0, RFC_MEM_AIM_RFM_ELEMENTS );
+
+    ASSERT( RFC_rfm_refeed( &ctx, /*hysteresis*/ class_width, /*class_param*/ NULL ) );
+    ASSERT_MEM_EQ( ctx.rfm, ctx_check.rfm, class_count * class_count * sizeof(rfc_counts_t) );
+    ASSERT_MEM_EQ( ctx.rp, ctx_check.rp, class_count * sizeof(rfc_counts_t) );
+    ASSERT( RFC_lc_get( &ctx_check, lc[0], /*level*/ NULL ) );
+    ASSERT( RFC_lc_get( &ctx, lc[1], /*level*/ NULL ) );
+    ASSERT_MEM_EQ( lc[1], lc[0], class_count * sizeof(rfc_counts_t) );
+    ASSERT( ctx_check.damage > 0.0 );
+    ASSERT_IN_RANGE( 1.0, ctx.damage / ctx_check.damage, 1e-12 );
+
+    ASSERT( RFC_deinit( &ctx_check ) );
+    ASSERT( RFC_deinit( &ctx ) );
+
+    PASS();
+}
+
+
+TEST RFC_lc_rp_from_rfm_test( void )
+{
+    static
+    rfc_counts_t        rfm[50*50];
+    rfc_counts_t        lc[50], lc_check[50], rp[50], rp_check[50];
+    rfc_value_t         level[50], Sa[50];
+    int                 flags[]         = { RFC_FLAGS_COUNT_LC_UP, RFC_FLAGS_COUNT_LC_DN, RFC_FLAGS_COUNT_LC };
+    unsigned            class_count     =  50;
+    unsigned long       seed            =  1;
+    unsigned            from, to, i, n;
+
+    /* Any matrix, diagonal included */
+    for( i = 0; i < NUMEL(rfm); i++ )
+    {
+        rfm[i] = ( lcg_next( &seed ) % 3 ) ? 0 : (rfc_counts_t)( lcg_next( &seed ) % 1000 ) * RFC_HALF_CYCLE_INCREMENT;
+    }
+
+    ASSERT( RFC_init( &ctx, class_count, /*class_width*/ 1.0, /*class_offset*/ 0.0, /*hysteresis*/ 1.0, RFC_FLAGS_DEFAULT ) );
+
+    /* Level crossings, counted as in the cubic definition */
+    for( n = 0; n < NUMEL(flags); n++ )
+    {
+        ASSERT( RFC_lc_from_rfm( &ctx, lc, level, rfm, (rfc_flags_e)flags[n] ) );
+
+        for( i = 0; i < class_count; i++ )
+        {
+            lc_check[i] = 0;
+            for( from = 0; from <= i; from++ )
+            {
+                for( to = i + 1; to < class_count; to++ )
+                {
+                    if( flags[n] & RFC_FLAGS_COUNT_LC_UP ) lc_check[i] += rfm[ from * class_count + to ] + rfm[ to * class_count + from ];
+                    if( flags[n] & RFC_FLAGS_COUNT_LC_DN ) lc_check[i] += rfm[ from * class_count + to ] + rfm[ to * class_count + from ];
+                }
+            }
+            ASSERT_EQ( level[i], i + 1.0 );
+        }
+        ASSERT_MEM_EQ( lc, lc_check, sizeof(lc) );
+    }
+
+    /* Range pairs, summed along the diagonals */
+    ASSERT( RFC_rp_from_rfm( &ctx, rp, Sa, rfm ) );
+    for( i = 0; i < class_count; i++ )
+    {
+        rp_check[i] = 0;
+        for( to = i; to < class_count; to++ )
+        {
+            rp_check[i] += rfm[ ( to - i ) * class_count + to ] + rfm[ to * class_count + to - i ];
+        }
+        ASSERT_EQ( Sa[i], i / 2.0 );
+    }
+    ASSERT_MEM_EQ( rp, rp_check, sizeof(rp) );
+
+    ASSERT( RFC_deinit( &ctx ) );
+
+    PASS();
+}
+
+
+TEST RFC_damage_multi_test( void )
+{
+    static
+    rfc_value_t         data[10000];
+    rfc_ctx_s           ctx_check       = { sizeof(ctx_check) };
+    rfc_wl_param_s      wl[3];
+    double              damage[3], damage_check[3];
+    unsigned            class_count     =  100;
+    double              class_width     =  2.0;
+    double              class_offset    = -100.0;
+    double              hysteresis      =  class_width;
+    unsigned long       seed            =  1;
+    unsigned            i, at;
+
+    for( i = 0; i < NUMEL(data); i++ )
+    {
+        data[i] = 120.0 * ( lcg_next( &seed ) % 1000 ) / 1000.0 - 60.0 + 30.0 * sin( i * 0.01 );
+    }
+
+    /* Without and with amplitude transformation */
+    for( at = 0; at < 2; at++ )
+    {
+        /* Each Woehler curve counted on its own */
+        for( i = 0; i < NUMEL(wl); i++ )
+        {
+            ASSERT( RFC_init( &ctx_check, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_DEFAULT ) );
+            switch( i )
+            {
+                case 0:  ASSERT( RFC_wl_init_elementary( &ctx_check, /*sx*/ 100.0, /*nx*/ 1e6, /*k*/ -5.0 ) );               break;
+                case 1:  ASSERT( RFC_wl_init_modified( &ctx_check, /*sx*/ 60.0, /*nx*/ 1e7, /*k*/ -4.0, /*k2*/ -9.0 ) );    break;
+                default: ASSERT( RFC_wl_init_original( &ctx_check, /*sd*/ 20.0, /*nd*/ 1e7, /*k*/ -3.0 ) );                 break;
+            }
+#if RFC_AT_SUPPORT
+            ASSERT( RFC_at_init( &ctx_check, NULL /* Sa */, NULL /* Sm */, 0 /* count */, at ? 0.3 : 0.0 /* M */, 
+                                 0.0 /* Sm_rig */, -1.0 /* R_rig */, true /* R_pinned */, false /* symmetric */ ) );
+#endif /*RFC_AT_SUPPORT*/
+            ASSERT( RFC_wl_param_get( &ctx_check, &wl[i] ) );
+            ASSERT( RFC_feed( &ctx_check, data, NUMEL(data) ) );
+            ASSERT( RFC_finalize( &ctx_check, RFC_RES_REPEATED ) );
+            damage_check[i] = ctx_check.damage;
+            ASSERT( damage_check[i] > 0.0 );
+            ASSERT( RFC_deinit( &ctx_check ) );
+        }
+
+        /* All Woehler curves in one pass */
+        ASSERT( RFC_init( &ctx, class_count, class_width, class_offset, hysteresis, RFC_FLAGS_DEFAULT ) );
+#if RFC_AT_SUPPORT
+        ASSERT( RFC_at_init( &ctx, NULL /* Sa */, NULL /* Sm */, 0 /* count */, at ? 0.3 : 0.0 /* M */, 
+                             0.0 /* Sm_rig */, -1.0 /* R_rig */, true /* R_pinned */, false /* symmetric */ ) );
+#endif /*RFC_AT_SUPPORT*/
+        ASSERT( RFC_damage_multi_init( &ctx, wl, NUMEL(wl) ) );
+        ASSERT( RFC_feed( &ctx, data, NUMEL(data) ) );
+        ASSERT( RFC_finalize( &ctx, RFC_RES_REPEATED ) );
+        ASSERT( RFC_damage_multi_get( &ctx, damage, NUMEL(damage) ) );
+
+        for( i = 0; i < NUMEL(wl); i++ )
+        {
+            ASSERT_IN_RANGE( damage_check[i], damage[i], 1e-12 * damage_check[i] );
+        }
+        ASSERT( RFC_deinit( &ctx ) );
+    }
+
+    PASS();
+}
+
+
 TEST RFC_res_DIN45667( void )
 {
 /*
@@ -2412,6 +4230,49 @@ SUITE( RFC_TEST_SUITE )
     RUN_TESTp( RFC_long_series, 1, 50 );  /* Using reduced class_count to test auto resizing */
 #endif /*RFC_AR_SUPPORT*/
 #if !RFC_MINIMAL
+    /* Block turning point pre-filter */
+    RUN_TEST1( RFC_feed_block_test, 0 );
+    RUN_TEST1( RFC_feed_block_test, 1 );
+#if RFC_TP_SUPPORT
+    RUN_TEST( RFC_quantize_test );
+#endif /*RFC_TP_SUPPORT*/
+    /* Typed feeds */
+    RUN_TEST( RFC_feed_typed_test );
+    RUN_TEST( RFC_feed_interleaved_test );
+    /* Multi-channel bank */
+    RUN_TEST( RFC_bank_test );
+    /* Flag-specialized counting kernels */
+    RUN_TEST( RFC_counts_kernel_test );
+    /* Divide and conquer */
+    RUN_TEST( RFC_merge_test );
+    /* Batch counting */
+    RUN_TEST( RFC_batch_test );
+#if RFC_DAMAGE_FAST
+    /* Damage look-up tables */
+    RUN_TEST( RFC_damage_lut_test );
+    RUN_TEST( RFC_lut_share_test );
+#endif /*RFC_DAMAGE_FAST*/
+    /* Snapshots of live counting results */
+    RUN_TEST( RFC_snapshot_test );
+    /* Checkpoint and restore */
+    RUN_TEST( RFC_checkpoint_test );
+#if RFC_TP_SUPPORT
+    /* File backed turning point storage */
+    RUN_TEST( RFC_tp_mapped_test );
+#endif /*RFC_TP_SUPPORT*/
+#if RFC_DH_SUPPORT
+    /* File backed damage history */
+    RUN_TEST( RFC_dh_mapped_test );
+#endif /*RFC_DH_SUPPORT*/
+    /* Sparse rainflow matrix */
+    RUN_TEST( RFC_rfm_sparse_test );
+    RUN_TEST( RFC_class_count_large_test );
+    RUN_TEST( RFC_rfm_sat_test );
+    /* Weighted cycles and refeed */
+    RUN_TEST( RFC_cycle_weighted_test );
+    RUN_TEST( RFC_lc_rp_from_rfm_test );
+    /* Multi-curve damage */
+    RUN_TEST( RFC_damage_multi_test );
     /* Residual methods */
     RUN_TEST( RFC_res_DIN45667 );
     RUN_TEST( RFC_res_repeated );